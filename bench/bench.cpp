@@ -0,0 +1,765 @@
+// Benchmarks for the transport/backend hot paths against the in-process mock DM.
+// Each result reports wall time per operation and the DM traffic it caused,
+// counted on the mock side (register reads/writes, injected instructions and
+// request/response round trips).
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+
+#include <argparse.h>
+#include "logger.h"
+#include "tcputils.h"
+#include "util.h"
+#include "backend.h"
+#include "gdbstub.h"
+#include "trace.h"
+#include "riscv.h"
+#include "mockdm.h"
+
+#define BENCH_MEM_BASE      0x80010000
+#define BENCH_SCRATCH_BASE  0x80f00000  // Target routine scratch memory
+#define BENCH_GDB_PORT_OFS  1           // GDB server port: mock port + offset
+#define BENCH_CONNECT_TRIES 50
+
+#define CHECK_ERR(stmt, msg) \
+    do { \
+        int rc = stmt; \
+        if (rc != RCODE_OK) { \
+            Logger::gerror(std::string(msg) + "  (rc=" + std::to_string(rc) + ")"); \
+            return rc; \
+        } \
+    } while(0)
+
+#define CHECK_ERRS(stmt) \
+    do { \
+        int rc = stmt; \
+        if (rc != RCODE_OK) { \
+           return rc; \
+        } \
+    } while(0)
+
+struct BenchOptions_t {
+    uint16_t port;
+    std::string transport = "tcp";          // Mock DM served over: tcp, unix, shm
+    MockDMConfig_t dm;                      // Protocol/latency settings, platform is set per bench
+    std::string filter;                     // Run benches whose name contains this
+    double iter_scale = 1.0;
+    bool json = false;
+    std::ofstream json_out;
+};
+
+struct BenchResult_t {
+    std::string name;
+    std::string param;
+    std::vector<uint64_t> samples_ns;
+    uint64_t bytes_per_op = 0;
+    uint64_t dm_reads = 0, dm_writes = 0, injects = 0, round_trips = 0;
+};
+
+//==============================================================================
+// Result output
+//==============================================================================
+
+static uint64_t percentile(const std::vector<uint64_t> &sorted, double q) {
+    if (sorted.empty()) return 0;
+    size_t idx = static_cast<size_t>(q * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+static std::string result_json(const BenchResult_t &r, uint64_t p50, uint64_t p99, double avg, size_t n) {
+    return strfmt("{\"bench\":\"%s\",\"param\":\"%s\",\"iters\":%zu,\"avg_us\":%.2f,\"p50_us\":%.2f,\"p99_us\":%.2f,"
+                  "\"max_us\":%.2f,\"dm_reads_per_op\":%.2f,\"dm_writes_per_op\":%.2f,\"injects_per_op\":%.2f,"
+                  "\"round_trips_per_op\":%.2f,\"bytes_per_op\":%llu}",
+        r.name.c_str(), r.param.c_str(), n, avg / 1e3, p50 / 1e3, p99 / 1e3, r.samples_ns.back() / 1e3,
+        double(r.dm_reads) / n, double(r.dm_writes) / n, double(r.injects) / n, double(r.round_trips) / n,
+        (unsigned long long)r.bytes_per_op);
+}
+
+static void report(BenchOptions_t &opts, BenchResult_t &r) {
+    size_t n = r.samples_ns.size();
+    if (n == 0) return;
+    std::sort(r.samples_ns.begin(), r.samples_ns.end());
+    uint64_t sum = 0;
+    for (uint64_t s : r.samples_ns) sum += s;
+    double avg = double(sum) / n;
+    uint64_t p50 = percentile(r.samples_ns, 0.5), p99 = percentile(r.samples_ns, 0.99);
+
+    std::string json = result_json(r, p50, p99, avg, n);
+    if (opts.json_out.is_open())
+        opts.json_out << json << std::endl;
+    if (opts.json) {
+        std::cout << json << std::endl;
+        return;
+    }
+    std::string tput = r.bytes_per_op ? strfmt("%9.2f", r.bytes_per_op / (avg / 1e9) / (1024.0 * 1024.0)) : "        -";
+    std::cout << strfmt("%-16s %-10s %6zu %10.1f %10.1f %10.1f %9.1f %9.1f %8.1f %8.1f %s\n",
+        r.name.c_str(), r.param.c_str(), n, avg / 1e3, p50 / 1e3, p99 / 1e3,
+        double(r.dm_reads) / n, double(r.dm_writes) / n, double(r.injects) / n, double(r.round_trips) / n,
+        tput.c_str());
+}
+
+static void print_header(BenchOptions_t &opts) {
+    const MockDMConfig_t &dm = opts.dm;
+    std::string cfg = strfmt("{\"config\":{\"transport\":\"%s\",\"rtt_us\":%u,\"jitter_us\":%u,\"bin\":%s,\"memblk\":%s,\"injseq\":%s,\"wgather\":%s,\"lanes\":%s}}",
+        opts.transport.c_str(), dm.rtt_us, dm.jitter_us, dm.cap_bin ? "true" : "false", dm.cap_memblk ? "true" : "false",
+        dm.cap_injseq ? "true" : "false", dm.has_wgather ? "true" : "false", dm.has_lanes ? "true" : "false");
+    if (opts.json_out.is_open())
+        opts.json_out << cfg << std::endl;
+    if (opts.json) {
+        std::cout << cfg << std::endl;
+        return;
+    }
+    std::cout << strfmt("Mock DM: %s, rtt %uus +/- %uus, protocol %s, memblk %s, injseq %s, wgather %s, lanes %s\n\n",
+        opts.transport.c_str(), dm.rtt_us, dm.jitter_us, dm.cap_bin ? "binary" : "ascii", dm.cap_memblk ? "on" : "off",
+        dm.cap_injseq ? "on" : "off", dm.has_wgather ? "on" : "off", dm.has_lanes ? "on" : "off");
+    std::cout << strfmt("%-16s %-10s %6s %10s %10s %10s %9s %9s %8s %8s %9s\n",
+        "bench", "param", "iters", "avg(us)", "p50(us)", "p99(us)", "dm_rd/op", "dm_wr/op", "inj/op", "rtt/op", "MiB/s");
+}
+
+//==============================================================================
+// Harness
+//==============================================================================
+
+// Mock DM plus a backend connected to it, all warps halted, warp 0 thread 0 selected
+struct BenchTarget_t {
+    MockDMServer *mock = nullptr;
+    Backend *backend = nullptr;
+
+    ~BenchTarget_t() {
+        delete backend;     // Disconnects first
+        delete mock;
+    }
+};
+
+// Unix socket path / shared memory name derived from the port, so that several
+// vxbench instances can run side by side
+static std::string unix_path(const BenchOptions_t &opts) { return strfmt("/tmp/vxbench-%u.sock", opts.port); }
+static std::string shm_name(const BenchOptions_t &opts)  { return strfmt("/vxbench-%u", opts.port); }
+
+static int start_mock(const BenchOptions_t &opts, MockDMServer &mock) {
+    if (opts.transport == "unix")
+        return mock.start_unix(unix_path(opts));
+    if (opts.transport == "shm")
+        return mock.start_shm(shm_name(opts));
+    return mock.start(opts.port);
+}
+
+static int setup_target(const BenchOptions_t &opts, const MockDMConfig_t &cfg, BenchTarget_t &tgt) {
+    tgt.mock = new MockDMServer(cfg);
+    CHECK_ERRS(start_mock(opts, *tgt.mock));
+    tgt.backend = new Backend("bench");
+    CHECK_ERRS(tgt.backend->transport_setup(opts.transport));
+    if (opts.transport == "unix") {
+        CHECK_ERRS(tgt.backend->transport_connect({{"path", unix_path(opts)}}));
+    } else if (opts.transport == "shm") {
+        CHECK_ERRS(tgt.backend->transport_connect({{"name", shm_name(opts)}}));
+    } else {
+        CHECK_ERRS(tgt.backend->transport_connect({{"ip", "127.0.0.1"}, {"port", std::to_string(opts.port)}}));
+    }
+    CHECK_ERRS(tgt.backend->initialize(true));
+    CHECK_ERRS(tgt.backend->halt_warps());
+    CHECK_ERRS(tgt.backend->select_warp_thread(0, 0));
+    return RCODE_OK;
+}
+
+static int scaled_iters(const BenchOptions_t &opts, int iters) {
+    return std::max(1, static_cast<int>(iters * opts.iter_scale));
+}
+
+// Time 'iters' calls of 'op' (after one untimed warmup call) and report them
+static int run_bench(BenchOptions_t &opts, MockDMServer &mock, const std::string &name, const std::string &param,
+                     int iters, uint64_t bytes_per_op, const std::function<int(int)> &op) {
+    if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+
+    BenchResult_t r;
+    r.name = name;
+    r.param = param;
+    r.bytes_per_op = bytes_per_op;
+    CHECK_ERR(op(-1), "Benchmark " + name + " failed");
+
+    MockDMStats_t &st = mock.stats();
+    st.reset();
+    r.samples_ns.reserve(iters);
+    for (int i = 0; i < iters; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        CHECK_ERR(op(i), "Benchmark " + name + " failed");
+        r.samples_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count());
+    }
+    r.dm_reads = st.reads.get();
+    r.dm_writes = st.writes.get();
+    r.injects = st.injects.get();
+    r.round_trips = st.round_trips.get();
+    report(opts, r);
+    return RCODE_OK;
+}
+
+static std::string size_str(uint32_t nbytes) {
+    if (nbytes >= 1024 * 1024) return std::to_string(nbytes / (1024 * 1024)) + "M";
+    if (nbytes >= 1024) return std::to_string(nbytes / 1024) + "K";
+    return std::to_string(nbytes);
+}
+
+//==============================================================================
+// Benchmarks
+//==============================================================================
+
+static int bench_mem(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("read_mem write_mem").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    BenchTarget_t tgt;
+    CHECK_ERR(setup_target(opts, opts.dm, tgt), "Failed to set up mock target");
+    Backend *b = tgt.backend;
+
+    for (uint32_t nbytes : {4u, 64u, 1024u, 16u * 1024, 256u * 1024, 1024u * 1024}) {
+        int iters = scaled_iters(opts, std::clamp<int>((4 * 1024 * 1024) / nbytes, 4, 200));
+        std::vector<uint8_t> wdata(nbytes);
+        for (uint32_t i = 0; i < nbytes; ++i)
+            wdata[i] = static_cast<uint8_t>(i * 7 + 1);
+
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "write_mem", size_str(nbytes), iters, nbytes, [&](int) {
+            return b->write_mem(BENCH_MEM_BASE, wdata);
+        }));
+
+        std::vector<uint8_t> rdata;
+        CHECK_ERRS(b->write_mem(BENCH_MEM_BASE, wdata));   // write_mem may be filtered out
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "read_mem", size_str(nbytes), iters, nbytes, [&](int) {
+            b->memcache_invalidate();   // Measure target accesses, not the cache
+            CHECK_ERRS(b->read_mem(BENCH_MEM_BASE, nbytes, rdata));
+            if (rdata != wdata) {
+                Logger::gerror("read_mem returned data that differs from what was written");
+                return RCODE_ERROR;
+            }
+            return RCODE_OK;
+        }));
+    }
+    return RCODE_OK;
+}
+
+static int bench_load(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("load").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    BenchTarget_t tgt;
+    CHECK_ERR(setup_target(opts, opts.dm, tgt), "Failed to set up mock target");
+    Backend *b = tgt.backend;
+    b->set_param("scratch_mem", std::to_string(BENCH_SCRATCH_BASE));
+
+    // Reloading a 64K image: everything, then delta with none, one and all chunks changed
+    constexpr uint32_t nbytes = 64 * 1024;
+    std::vector<uint8_t> image(nbytes);
+    for (uint32_t i = 0; i < nbytes; ++i)
+        image[i] = static_cast<uint8_t>(i * 13 + 5);
+    int iters = scaled_iters(opts, 10);
+
+    CHECK_ERRS(run_bench(opts, *tgt.mock, "load", "full", iters, nbytes, [&](int) {
+        return b->load_mem(BENCH_MEM_BASE, image, false);
+    }));
+    CHECK_ERRS(b->load_mem(BENCH_MEM_BASE, image, false));
+    CHECK_ERRS(run_bench(opts, *tgt.mock, "load", "delta_same", iters, nbytes, [&](int) {
+        return b->load_mem(BENCH_MEM_BASE, image, true);
+    }));
+    CHECK_ERRS(run_bench(opts, *tgt.mock, "load", "delta_1chunk", iters, nbytes, [&](int) {
+        image[nbytes / 2]++;
+        return b->load_mem(BENCH_MEM_BASE, image, true);
+    }));
+    CHECK_ERRS(run_bench(opts, *tgt.mock, "load", "delta_all", iters, nbytes, [&](int) {
+        for (uint32_t i = 0; i < nbytes; i += LOAD_CHUNK_SZ)
+            image[i]++;
+        return b->load_mem(BENCH_MEM_BASE, image, true);
+    }));
+
+    std::vector<uint8_t> rdata;
+    b->memcache_invalidate();
+    CHECK_ERRS(b->read_mem(BENCH_MEM_BASE, nbytes, rdata));
+    if (rdata != image) {
+        Logger::gerror("Delta load left target memory different from the image");
+        return RCODE_ERROR;
+    }
+    return RCODE_OK;
+}
+
+// qCRC / qSearch:memory over a 64K region with a breakpoint inserted in it:
+// routine on the target vs reading the region ('param')
+static int bench_scan(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("mem_crc mem_find").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    BenchTarget_t tgt;
+    CHECK_ERR(setup_target(opts, opts.dm, tgt), "Failed to set up mock target");
+    Backend *b = tgt.backend;
+
+    constexpr uint32_t nbytes = 64 * 1024;
+    std::vector<uint8_t> data(nbytes);
+    uint32_t x = 0x12345678;
+    for (uint32_t i = 0; i < nbytes; ++i) {
+        x = x * 1664525 + 1013904223;
+        data[i] = static_cast<uint8_t>(x >> 24);
+    }
+    CHECK_ERRS(b->write_mem(BENCH_MEM_BASE, data));
+    CHECK_ERRS(b->set_breakpoint(BENCH_MEM_BASE + nbytes / 4));
+    CHECK_ERRS(b->commit_breakpoints());
+
+    // Expected results from the image itself; the pattern starts right before the breakpoint
+    uint32_t want_crc = 0xffffffff;
+    for (uint8_t byte : data) {
+        want_crc ^= static_cast<uint32_t>(byte) << 24;
+        for (int k = 0; k < 8; ++k)
+            want_crc = (want_crc & 0x80000000) ? (want_crc << 1) ^ 0x04c11db7 : (want_crc << 1);
+    }
+    const uint32_t want_addr = BENCH_MEM_BASE + nbytes / 4 - 2;
+    std::vector<uint8_t> pattern(data.begin() + (want_addr - BENCH_MEM_BASE), data.begin() + (want_addr - BENCH_MEM_BASE) + 8);
+    const uint32_t late_addr = BENCH_MEM_BASE + nbytes - 16;
+    std::vector<uint8_t> late(data.begin() + (late_addr - BENCH_MEM_BASE), data.begin() + (late_addr - BENCH_MEM_BASE) + 12);
+
+    int iters = scaled_iters(opts, 5);
+    for (bool routine : {false, true}) {
+        b->set_param("scratch_mem", routine ? std::to_string(BENCH_SCRATCH_BASE) : "0");
+        const std::string param = routine ? "target" : "read";
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "mem_crc", param, iters, nbytes, [&](int) {
+            b->memcache_invalidate();
+            uint32_t crc = 0;
+            CHECK_ERRS(b->crc32_mem(BENCH_MEM_BASE, nbytes, crc));
+            if (crc != want_crc) {
+                Logger::gerror(strfmt("crc32_mem returned 0x%08X, expected 0x%08X", crc, want_crc));
+                return RCODE_ERROR;
+            }
+            return RCODE_OK;
+        }));
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "mem_find", param, iters, nbytes, [&](int) {
+            b->memcache_invalidate();
+            bool found = false;
+            uint32_t found_addr = 0;
+            CHECK_ERRS(b->search_mem(BENCH_MEM_BASE, nbytes, pattern, found, found_addr));
+            if (!found || found_addr != want_addr) {
+                Logger::gerror(strfmt("search_mem found %d @0x%08X, expected 0x%08X", found, found_addr, want_addr));
+                return RCODE_ERROR;
+            }
+            CHECK_ERRS(b->search_mem(BENCH_MEM_BASE, nbytes, late, found, found_addr));
+            if (!found || found_addr != late_addr) {
+                Logger::gerror(strfmt("search_mem found %d @0x%08X, expected 0x%08X", found, found_addr, late_addr));
+                return RCODE_ERROR;
+            }
+            return RCODE_OK;
+        }));
+    }
+    return RCODE_OK;
+}
+
+static int bench_warp_status(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("warp_status").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    for (uint32_t nwarps : {32u, 128u, 512u, 1024u, 4096u}) {
+        MockDMConfig_t cfg = opts.dm;
+        cfg.num_warps = 32;
+        cfg.num_cores = nwarps / 32;
+        BenchTarget_t tgt;
+        CHECK_ERR(setup_target(opts, cfg, tgt), "Failed to set up mock target");
+        Backend *b = tgt.backend;
+
+        std::map<int, WarpStatus_t> status;
+        int iters = scaled_iters(opts, std::clamp<int>(8192 / nwarps, 4, 100));
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "warp_status", std::to_string(nwarps), iters, 0, [&](int) {
+            b->warpstate_invalidate();  // Force a full sweep
+            CHECK_ERRS(b->get_warp_status(status, true, true));
+            return status.size() == nwarps ? RCODE_OK : RCODE_ERROR;
+        }));
+    }
+    return RCODE_OK;
+}
+
+// Single steps vs one batched multi-step, with and without traced registers
+static int bench_step(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("step").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    BenchTarget_t tgt;
+    CHECK_ERR(setup_target(opts, opts.dm, tgt), "Failed to set up mock target");
+    Backend *b = tgt.backend;
+    std::vector<int> others;
+    for (uint32_t wid = 1; wid < opts.dm.total_warps(); ++wid)
+        others.push_back(wid);
+    CHECK_ERRS(b->resume_warps(others));       // Stepping with every warp halted warps about deadlock
+
+    constexpr uint32_t nsteps = 256;
+    int iters = scaled_iters(opts, 10);
+    CHECK_ERRS(run_bench(opts, *tgt.mock, "step", "single_256", iters, 0, [&](int) {
+        for (uint32_t i = 0; i < nsteps; ++i)
+            CHECK_ERRS(b->step_warp());
+        return RCODE_OK;
+    }));
+    uint32_t done = 0;
+    CHECK_ERRS(run_bench(opts, *tgt.mock, "step", "multi_256", iters, 0, [&](int) {
+        return b->step_warp(nsteps, done);
+    }));
+    InstrTrace trace;
+    CHECK_ERRS(run_bench(opts, *tgt.mock, "step", "trace_256_r2", iters, 0, [&](int) {
+        trace.reset(0, 0, {RV_GPR_T0, 10});
+        return b->step_warp(nsteps, done, &trace);
+    }));
+    return RCODE_OK;
+}
+
+// One profiler sweep over running warps: gather registers vs halt/read/resume
+static int bench_profile(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("profile").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    for (uint32_t nwarps : {32u, 1024u}) {
+        MockDMConfig_t cfg = opts.dm;
+        cfg.num_warps = 32;
+        cfg.num_cores = nwarps / 32;
+        BenchTarget_t tgt;
+        CHECK_ERR(setup_target(opts, cfg, tgt), "Failed to set up mock target");
+        Backend *b = tgt.backend;
+        CHECK_ERRS(b->resume_warps());
+
+        std::vector<PcSample_t> samples;
+        int iters = scaled_iters(opts, std::clamp<int>(8192 / nwarps, 4, 100));
+        for (bool halting : {false, true}) {
+            if (!halting && !b->has_warp_gather())
+                continue;
+            std::string param = std::to_string(nwarps) + (halting ? "_halt" : "_gather");
+            CHECK_ERRS(run_bench(opts, *tgt.mock, "profile_sweep", param, iters, 0, [&](int) {
+                samples.clear();
+                CHECK_ERRS(b->sample_pcs(halting, samples));
+                return samples.size() == nwarps ? RCODE_OK : RCODE_ERROR;
+            }));
+        }
+    }
+    return RCODE_OK;
+}
+
+static int bench_breakpoints(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("break_insert break_remove").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    BenchTarget_t tgt;
+    CHECK_ERR(setup_target(opts, opts.dm, tgt), "Failed to set up mock target");
+    Backend *b = tgt.backend;
+
+    // Distinct addresses: every insertion reads and patches new words. Breakpoint
+    // changes reach memory on commit, 'param' is the number of changes per commit
+    for (int nbps : {1, 16}) {
+        int iters = scaled_iters(opts, 200 / nbps);
+        auto bp_addr = [&](int i, int k) { return BENCH_MEM_BASE + 4 * ((i + 1) * nbps + k); };
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "break_insert", std::to_string(nbps), iters, 0, [&](int i) {
+            for (int k = 0; k < nbps; ++k)
+                CHECK_ERRS(b->set_breakpoint(bp_addr(i, k)));
+            return b->commit_breakpoints();
+        }));
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "break_remove", std::to_string(nbps), iters, 0, [&](int i) {
+            for (int k = 0; k < nbps; ++k)
+                CHECK_ERRS(b->remove_breakpoint(bp_addr(i, k)));
+            return b->commit_breakpoints();
+        }));
+    }
+    return RCODE_OK;
+}
+
+// A GPR / a word per lane of a 32-thread warp: one thread at a time vs warp-wide
+static int bench_lanes(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("lanes_gpr lanes_mem").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    MockDMConfig_t cfg = opts.dm;
+    cfg.num_threads_log2 = 5;
+    BenchTarget_t tgt;
+    CHECK_ERR(setup_target(opts, cfg, tgt), "Failed to set up mock target");
+    Backend *b = tgt.backend;
+
+    // Adjacent lane words, and scattered ones a memory cache block or more apart
+    const uint32_t nthreads = cfg.num_threads();
+    std::vector<uint32_t> expected(nthreads), addrs(nthreads), scattered(nthreads);
+    std::vector<uint8_t> words(4 * nthreads);
+    for (uint32_t tid = 0; tid < nthreads; ++tid) {
+        expected[tid] = 0x1000 + tid;
+        addrs[tid] = BENCH_MEM_BASE + 4 * tid;
+        scattered[tid] = BENCH_MEM_BASE + 0x10000 + ((tid * 0x2c40) & 0xfffc);
+        std::memcpy(&words[4 * tid], &expected[tid], 4);
+        CHECK_ERRS(b->select_warp_thread(0, tid));
+        CHECK_ERRS(b->write_gpr(10, expected[tid]));
+        CHECK_ERRS(b->write_mem(scattered[tid], std::vector<uint8_t>(&words[4 * tid], &words[4 * tid] + 4)));
+    }
+    CHECK_ERRS(b->select_warp_thread(0, 0));
+    CHECK_ERRS(b->write_mem(BENCH_MEM_BASE, words));
+
+    int iters = scaled_iters(opts, 50);
+    std::vector<uint32_t> values;
+    auto check = [&]() {
+        if (values != expected) {
+            Logger::gerror("Lane read returned values that differ from what was written");
+            return RCODE_ERROR;
+        }
+        return RCODE_OK;
+    };
+    for (bool lanes : {false, true}) {
+        b->set_param("lane_access", lanes ? "1" : "0");
+        const char *param = lanes ? "warp" : "thread";
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "lanes_gpr", param, iters, 0, [&](int) {
+            b->regcache_invalidate();   // Measure target accesses, not the cache
+            CHECK_ERRS(b->read_gpr_lanes(10, values));
+            return check();
+        }));
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "lanes_mem", param, iters, 4 * nthreads, [&](int) {
+            b->regcache_invalidate();
+            b->memcache_invalidate();
+            CHECK_ERRS(b->read_mem_lanes(addrs, values));
+            return check();
+        }));
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "lanes_mem", std::string(param) + "_scattered", iters, 4 * nthreads, [&](int) {
+            b->memcache_invalidate();
+            CHECK_ERRS(b->read_mem_lanes(scattered, values));
+            return check();
+        }));
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "lanes_mem", std::string(param) + "_cached", iters, 4 * nthreads, [&](int) {
+            CHECK_ERRS(b->read_mem(BENCH_MEM_BASE, 4 * nthreads, words));   // Fill the memory cache
+            CHECK_ERRS(b->read_mem_lanes(addrs, values));
+            return check();
+        }));
+    }
+
+    // Every other lane diverged (scattered words): those are loaded through the selected thread
+    delete tgt.backend;
+    delete tgt.mock;
+    tgt.backend = nullptr;
+    tgt.mock = nullptr;
+    cfg.tmask = 0x55555555;
+    CHECK_ERR(setup_target(opts, cfg, tgt), "Failed to set up mock target");
+    b = tgt.backend;
+    for (uint32_t tid = 0; tid < nthreads; ++tid)
+        CHECK_ERRS(b->write_mem(scattered[tid], std::vector<uint8_t>(&words[4 * tid], &words[4 * tid] + 4)));
+    CHECK_ERRS(run_bench(opts, *tgt.mock, "lanes_mem", "diverged", iters, 4 * nthreads, [&](int) {
+        b->memcache_invalidate();
+        CHECK_ERRS(b->read_mem_lanes(scattered, values));
+        return check();
+    }));
+    return RCODE_OK;
+}
+
+// Streamed injections with and without the 'injseq' capability, whatever the
+// command line offers: without it every injection is polled before the next
+// DINJECT goes out, the cost on a debug server that does not hold later ops
+static int bench_injseq(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("inject_gprs inject_mem").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    constexpr uint32_t nbytes = 1024;
+    std::vector<uint8_t> wdata(nbytes);
+    for (uint32_t i = 0; i < nbytes; ++i)
+        wdata[i] = static_cast<uint8_t>(i * 7 + 1);
+
+    for (bool injseq : {true, false}) {
+        MockDMConfig_t cfg = opts.dm;
+        cfg.cap_memblk = false;     // Memory goes through injected loads
+        cfg.cap_injseq = injseq;
+        BenchTarget_t tgt;
+        CHECK_ERR(setup_target(opts, cfg, tgt), "Failed to set up mock target");
+        Backend *b = tgt.backend;
+        const char *param = injseq ? "injseq" : "no_injseq";
+        int iters = scaled_iters(opts, 50);
+
+        std::vector<uint32_t> values;
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "inject_gprs", param, iters, 0, [&](int) {
+            b->regcache_invalidate();
+            return b->read_gprs(values);
+        }));
+        std::vector<uint8_t> rdata;
+        CHECK_ERRS(b->write_mem(BENCH_MEM_BASE, wdata));
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "inject_mem", param + std::string("_") + size_str(nbytes), iters, nbytes, [&](int) {
+            b->memcache_invalidate();
+            CHECK_ERRS(b->read_mem(BENCH_MEM_BASE, nbytes, rdata));
+            if (rdata != wdata) {
+                Logger::gerror("read_mem returned data that differs from what was written");
+                return RCODE_ERROR;
+            }
+            return RCODE_OK;
+        }));
+    }
+    return RCODE_OK;
+}
+
+// Injection latency when the DM takes 'busy_us' to complete it, i.e. how close
+// the poll backoff gets to the actual completion time
+static int bench_poll(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("inject_busy").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    for (unsigned busy_us : {0u, 20u, 200u, 2000u}) {
+        MockDMConfig_t cfg = opts.dm;
+        cfg.busy_us = busy_us;
+        BenchTarget_t tgt;
+        CHECK_ERR(setup_target(opts, cfg, tgt), "Failed to set up mock target");
+        Backend *b = tgt.backend;
+
+        int iters = scaled_iters(opts, std::clamp<int>(200000 / (busy_us + 100), 20, 500));
+        CHECK_ERRS(run_bench(opts, *tgt.mock, "inject_busy", std::to_string(busy_us) + "us", iters, 0, [&](int) {
+            return b->inject_instruction(rv_addi(RV_GPR_ZERO, RV_GPR_ZERO, 0));
+        }));
+    }
+    return RCODE_OK;
+}
+
+//----- GDB 'g' packet end-to-end ----------------------------------------------
+
+// Minimal RSP client: no-ack mode, one packet in flight
+class GdbClient {
+public:
+    int connect(uint16_t port) {
+        for (int i = 0; i < BENCH_CONNECT_TRIES; ++i) {
+            try {
+                client_.connect("127.0.0.1", port);
+                break;
+            } catch (const std::exception &) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+        if (!client_.is_connected())
+            return RCODE_COMM_ERR;
+        std::string reply;
+        CHECK_ERRS(request("QStartNoAckMode", reply));
+        return reply == "OK" ? RCODE_OK : RCODE_ERROR;
+    }
+
+    void disconnect() { client_.disconnect(); }
+
+    int request(const std::string &pkt, std::string &reply) {
+        uint8_t csum = 0;
+        for (char c : pkt) csum += static_cast<uint8_t>(c);
+        std::string frame = "$" + pkt + strfmt("#%02x", csum);
+        client_.send_data(frame.data(), frame.size());
+
+        // fmt: [+]$<payload>#xx
+        RecvBuffer &rx = client_.rxbuf();
+        while (true) {
+            size_t start = rx.find('$');
+            size_t end = start == RecvBuffer::npos ? RecvBuffer::npos : rx.find('#', start);
+            if (end != RecvBuffer::npos && rx.size() >= end + 3) {
+                reply.assign(rx.data() + start + 1, end - start - 1);
+                rx.consume(end + 3);
+                return RCODE_OK;
+            }
+            if (client_.recv_buffered(TCPCLIENT_TIMEOUT_MS) <= 0)
+                return RCODE_TIMEOUT;
+        }
+    }
+
+private:
+    TCPClient client_;
+};
+
+static int bench_gdb(BenchOptions_t &opts) {
+    if (!opts.filter.empty() && std::string("gdb_g").find(opts.filter) == std::string::npos)
+        return RCODE_OK;
+    MockDMConfig_t cfg = opts.dm;
+    cfg.num_cores = 4;
+    cfg.num_warps = 8;
+    BenchTarget_t tgt;
+    CHECK_ERR(setup_target(opts, cfg, tgt), "Failed to set up mock target");
+    Backend *b = tgt.backend;
+
+    GDBStub stub(nullptr, b);       // No CLI behind it: 'monitor' is not used here
+    uint16_t gdb_port = opts.port + BENCH_GDB_PORT_OFS;
+    std::thread server([&]() { stub.serve_forever(gdb_port, false); });
+
+    GdbClient gdb;
+    int rc = gdb.connect(gdb_port);
+    std::string reply;
+    auto g_packet = [&](int) {
+        CHECK_ERRS(gdb.request("g", reply));
+        return reply.size() >= 33 * 8 ? RCODE_OK : RCODE_ERROR;
+    };
+
+    if (rc == RCODE_OK) {
+        // Cold: first 'g' of each thread, registers are fetched from the target
+        int nthreads = b->get_num_warps() * b->get_num_threads_per_warp();
+        rc = run_bench(opts, *tgt.mock, "gdb_g_cold", std::to_string(nthreads), nthreads - 1, 0, [&](int i) {
+            int gtid = 2 + i;   // Warmup call (i = -1) takes thread 1
+            CHECK_ERRS(gdb.request(strfmt("Hg%x", gtid), reply));
+            if (reply != "OK") return RCODE_ERROR;
+            return g_packet(i);
+        });
+    }
+    if (rc == RCODE_OK) {
+        // Warm: repeated 'g' of one thread, served from the register snapshot
+        rc = run_bench(opts, *tgt.mock, "gdb_g", "cached", scaled_iters(opts, 500), 0, g_packet);
+    }
+    if (rc != RCODE_OK)
+        Logger::gerror("GDB 'g' benchmark failed");
+
+    gdb.disconnect();
+    stub.stop();
+    server.join();
+    return rc;
+}
+
+
+//==============================================================================
+// Main
+//==============================================================================
+
+int main(const int argc, char** argv) {
+    ArgParse::ArgumentParser parser("vxbench", "Vortex Debugger benchmarks (mock debug module)");
+    parser.add_argument({"--port"}, "Mock DM port (GDB server uses port+1)", ArgParse::INT, std::to_string(MOCKDM_DEFAULT_PORT));
+    parser.add_argument({"--transport"}, "Serve the mock DM over tcp, unix (/tmp/vxbench-<port>.sock) or shm (/vxbench-<port>)",
+                        ArgParse::STR, "tcp", false, "", {"tcp", "unix", "shm"});
+    parser.add_argument({"--rtt-us"}, "Injected round trip latency (us)", ArgParse::INT, "0");
+    parser.add_argument({"--jitter-us"}, "Max random latency added to each round trip (us)", ArgParse::INT, "0");
+    parser.add_argument({"--ascii"}, "Do not offer the binary register protocol", ArgParse::BOOL, "false");
+    parser.add_argument({"--no-memblk"}, "Do not offer block memory access (MADDR/MDATA)", ArgParse::BOOL, "false");
+    parser.add_argument({"--no-injseq"}, "Do not offer in-order injections (streamed injections poll each one)", ArgParse::BOOL, "false");
+    parser.add_argument({"--no-wgather"}, "Do not offer warp gather registers", ArgParse::BOOL, "false");
+    parser.add_argument({"--no-lanes"}, "Do not offer warp-wide injection and lane scratch registers", ArgParse::BOOL, "false");
+    parser.add_argument({"--filter"}, "Only run benchmarks whose name contains this string", ArgParse::STR, "");
+    parser.add_argument({"--iter-scale"}, "Iteration count multiplier in percent", ArgParse::INT, "100");
+    parser.add_argument({"--json"}, "Print results as JSON lines", ArgParse::BOOL, "false");
+    parser.add_argument({"--json-out"}, "Also write JSON lines to this file", ArgParse::STR, "");
+    parser.add_argument({"--serve"}, "Only run the mock DM server (for manual testing)", ArgParse::BOOL, "false");
+    parser.add_argument({"-v", "--verbose"}, "Set verbosity (0:err, 1:warn, 2:info, 3-9:debug)", ArgParse::INT, "1");
+
+    int rc = parser.parse_args(argc, argv);
+    if (rc != 0)
+        return rc;
+
+    Logger::set_global_level(static_cast<LogLevel>(parser.get<int>("verbose")));
+    Logger::set_global_debug_threshold(parser.get<int>("verbose"));
+
+    BenchOptions_t opts;
+    opts.port = static_cast<uint16_t>(parser.get<int>("port"));
+    opts.transport = parser.get<std::string>("transport");
+    opts.dm.rtt_us = parser.get<int>("rtt_us");
+    opts.dm.jitter_us = parser.get<int>("jitter_us");
+    opts.dm.cap_bin = !parser.get<bool>("ascii");
+    opts.dm.cap_memblk = !parser.get<bool>("no_memblk");
+    opts.dm.cap_injseq = !parser.get<bool>("no_injseq");
+    opts.dm.has_wgather = !parser.get<bool>("no_wgather");
+    opts.dm.has_lanes = !parser.get<bool>("no_lanes");
+    opts.filter = parser.get<std::string>("filter");
+    opts.iter_scale = parser.get<int>("iter_scale") / 100.0;
+    opts.json = parser.get<bool>("json");
+
+    if (parser.get<bool>("serve")) {
+        Logger::set_global_level(LOG_INFO);
+        MockDMServer mock(opts.dm);
+        if (start_mock(opts, mock) != RCODE_OK)
+            return 1;
+        while (true)
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    std::string json_path = parser.get<std::string>("json_out");
+    if (!json_path.empty()) {
+        opts.json_out.open(json_path);
+        if (!opts.json_out.is_open()) {
+            Logger::gerror("Failed to open " + json_path);
+            return 1;
+        }
+    }
+
+    print_header(opts);
+    for (auto bench : {bench_mem, bench_load, bench_scan, bench_warp_status, bench_profile, bench_step, bench_gdb, bench_breakpoints, bench_lanes, bench_injseq, bench_poll}) {
+        if (bench(opts) != RCODE_OK)
+            return 1;
+    }
+    return 0;
+}
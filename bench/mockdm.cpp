@@ -0,0 +1,601 @@
+#include "mockdm.h"
+#include "logger.h"
+#include "tcputils.h"
+#include "shmutils.h"
+#include "util.h"
+#include "dmdefs.h"
+#include "riscv.h"
+#include "transport.h"
+
+#include <chrono>
+#include <cstring>
+
+#define MOCKDM_PLATFORMID 0x1
+
+//==============================================================================
+// MockDM
+//==============================================================================
+
+MockDM::MockDM(const MockDMConfig_t &cfg):
+    cfg_(cfg),
+    dscratch_(cfg.num_threads(), 0),
+    wmask_((cfg.total_warps() + 31) / 32, 0)
+{
+    _reset_warps();
+}
+
+void MockDM::_reset_warps() {
+    warps_.assign(cfg_.total_warps(), Warp_t());
+    for (auto &w : warps_)
+        w.pc = 0x80000000;
+    gprs_.clear();
+}
+
+uint32_t MockDM::_window_bits(bool halted) const {
+    uint32_t bits = 0;
+    for (uint32_t b = 0; b < 32; ++b) {
+        uint32_t wid = _winsel() * 32 + b;
+        if (wid >= warps_.size())
+            break;
+        if (halted ? warps_[wid].halted : warps_[wid].active)
+            bits |= 1u << b;
+    }
+    return bits;
+}
+
+uint32_t MockDM::_dctrl() const {
+    size_t nactive = 0, nhalted = 0;
+    for (const auto &w : warps_) {
+        if (!w.active) continue;
+        nactive++;
+        if (w.halted) nhalted++;
+    }
+    uint32_t v = 0;
+    v = set_dmreg_field(DMReg_t::DCTRL, "dmactive",   v, dmactive_);
+    v = set_dmreg_field(DMReg_t::DCTRL, "allhalted",  v, nactive && nhalted == nactive);
+    v = set_dmreg_field(DMReg_t::DCTRL, "anyhalted",  v, nhalted > 0);
+    v = set_dmreg_field(DMReg_t::DCTRL, "allrunning", v, nactive && nhalted == 0);
+    v = set_dmreg_field(DMReg_t::DCTRL, "anyrunning", v, nhalted < nactive);
+    v = set_dmreg_field(DMReg_t::DCTRL, "allunavail", v, nactive == 0);
+    v = set_dmreg_field(DMReg_t::DCTRL, "anyunavail", v, nactive < warps_.size());
+    if (_warpsel() < warps_.size())
+        v = set_dmreg_field(DMReg_t::DCTRL, "hacause", v, warps_[_warpsel()].hacause);
+    v = set_dmreg_field(DMReg_t::DCTRL, "resethaltreq", v, resethaltreq_);
+    if (cfg_.busy_us && std::chrono::steady_clock::now() < busy_until_) {
+        v = set_dmreg_field(DMReg_t::DCTRL, "injectstate", v, 1);
+        v = set_dmreg_field(DMReg_t::DCTRL, "stepstate", v, 1);
+    }
+    return v;
+}
+
+void MockDM::_write_dctrl(uint32_t value) {
+    auto field = [value](const char *name) { return extract_dmreg_field(DMReg_t::DCTRL, name, value); };
+    dmactive_ = field("dmactive");
+    resethaltreq_ = field("resethaltreq");
+
+    if (field("ndmreset")) {
+        std::vector<uint32_t> wids;
+        for (uint32_t wid = 0; wid < warps_.size(); ++wid)
+            if (_masked(wid)) wids.push_back(wid);
+        _reset_warps();
+        std::fill(wmask_.begin(), wmask_.end(), 0);
+        if (resethaltreq_) {
+            for (uint32_t wid : wids) {
+                warps_[wid].halted = true;
+                warps_[wid].hacause = 4;
+            }
+        }
+        resethaltreq_ = false;
+    }
+    if (field("haltreq")) {
+        for (uint32_t wid = 0; wid < warps_.size(); ++wid) {
+            if (_masked(wid) && !warps_[wid].halted) {
+                warps_[wid].halted = true;
+                warps_[wid].hacause = 2;
+            }
+        }
+    }
+    if (field("resumereq")) {
+        for (uint32_t wid = 0; wid < warps_.size(); ++wid) {
+            if (_masked(wid) && warps_[wid].halted) {
+                warps_[wid].halted = false;
+                warps_[wid].hacause = 0;
+                _run(wid);
+            }
+        }
+    }
+    uint32_t wid = _warpsel();
+    if (field("stepreq") || field("injectreq"))
+        busy_until_ = std::chrono::steady_clock::now() + std::chrono::microseconds(cfg_.busy_us);
+    if (field("stepreq") && wid < warps_.size() && warps_[wid].halted) {
+        warps_[wid].pc += 4;
+        warps_[wid].hacause = 3;
+    }
+    if (field("injectreq") && wid < warps_.size()) {
+        stats_.injects.add();
+        if (extract_dmreg_field(DMReg_t::DCONFIG, "warpinj", dconfig_)) {
+            for (uint32_t tid = 0; tid < cfg_.num_threads(); ++tid) {
+                if ((cfg_.active_threads() >> tid) & 1 && !_execute(wid, tid, dinject_))
+                    Logger::gwarn(strfmt("MockDM: unsupported injected instruction 0x%08X", dinject_));
+            }
+        } else if (!_execute(wid, _threadsel(), dinject_)) {
+            Logger::gwarn(strfmt("MockDM: unsupported injected instruction 0x%08X", dinject_));
+        }
+    }
+}
+
+uint32_t MockDM::read_reg(uint32_t addr) {
+    stats_.reads.add();
+    switch (static_cast<DMReg_t>(addr)) {
+    case DMReg_t::PLATFORM:
+        return (MOCKDM_PLATFORMID << 28) | (cfg_.num_clusters << 21) | (cfg_.num_cores << 12) |
+               (cfg_.num_warps << 3) | cfg_.num_threads_log2;
+    case DMReg_t::DCONFIG: {
+        uint32_t v = set_dmreg_field(DMReg_t::DCONFIG, "wgather", dconfig_, cfg_.has_wgather);
+        return set_dmreg_field(DMReg_t::DCONFIG, "lanes", v, cfg_.has_lanes);
+    }
+    case DMReg_t::DSELECT:  return dselect_;
+    case DMReg_t::WMASK:    return _winsel() < wmask_.size() ? wmask_[_winsel()] : 0;
+    case DMReg_t::WACTIVE:  return _window_bits(false);
+    case DMReg_t::WSTATUS:  return _window_bits(true);
+    case DMReg_t::DCTRL:    return _dctrl();
+    case DMReg_t::DPC:      return _warpsel() < warps_.size() ? warps_[_warpsel()].pc : 0;
+    case DMReg_t::DINJECT:  return dinject_;
+    case DMReg_t::DSCRATCH: return _threadsel() < dscratch_.size() ? dscratch_[_threadsel()] : 0;
+    case DMReg_t::MADDR:    return maddr_;
+    case DMReg_t::MDATA: {
+        uint32_t v = _mem_rd(maddr_);
+        maddr_ += 4;
+        return v;
+    }
+    case DMReg_t::WGSEL:    return wgsel_;
+    case DMReg_t::WGPC:     return wgsel_ < warps_.size() ? warps_[wgsel_].pc : 0;
+    case DMReg_t::WGCAUSE: {
+        uint32_t v = wgsel_ < warps_.size() ? warps_[wgsel_].hacause : 0;
+        wgsel_++;
+        return v;
+    }
+    case DMReg_t::LSEL:     return lsel_;
+    case DMReg_t::LSCRATCH: {
+        uint32_t v = lsel_ < dscratch_.size() ? dscratch_[lsel_] : 0;
+        lsel_ = (lsel_ + 1) & 0x7f;
+        return v;
+    }
+    default:
+        return 0;
+    }
+}
+
+void MockDM::write_reg(uint32_t addr, uint32_t value) {
+    stats_.writes.add();
+    switch (static_cast<DMReg_t>(addr)) {
+    case DMReg_t::DCONFIG:
+        dconfig_ = value & (cfg_.has_lanes ? 0x5 : 0x1);    // ebreakh, warpinj
+        break;
+    case DMReg_t::DSELECT:  dselect_ = value; break;
+    case DMReg_t::WMASK:
+        if (_winsel() < wmask_.size()) wmask_[_winsel()] = value;
+        break;
+    case DMReg_t::DCTRL:    _write_dctrl(value); break;
+    case DMReg_t::DPC:
+        if (_warpsel() < warps_.size()) warps_[_warpsel()].pc = value;
+        break;
+    case DMReg_t::DINJECT:  dinject_ = value; break;
+    case DMReg_t::DSCRATCH:
+        if (_threadsel() < dscratch_.size()) dscratch_[_threadsel()] = value;
+        break;
+    case DMReg_t::MADDR:    maddr_ = value; break;
+    case DMReg_t::MDATA:
+        _mem_wr(maddr_, value, 4);
+        maddr_ += 4;
+        break;
+    case DMReg_t::WGSEL:    wgsel_ = value & 0x7fff; break;
+    case DMReg_t::LSEL:     lsel_ = value & 0x7f; break;
+    case DMReg_t::LSCRATCH:
+        if (lsel_ < dscratch_.size()) dscratch_[lsel_] = value;
+        lsel_ = (lsel_ + 1) & 0x7f;
+        break;
+    default:
+        break;
+    }
+}
+
+uint32_t MockDM::_gpr(uint32_t wid, uint32_t tid, uint32_t reg) const {
+    auto it = gprs_.find((static_cast<uint64_t>(wid) << 16) | (tid << 5) | reg);
+    return it != gprs_.end() ? it->second : 0;
+}
+
+void MockDM::_set_gpr(uint32_t wid, uint32_t tid, uint32_t reg, uint32_t value) {
+    if (reg != 0)
+        gprs_[(static_cast<uint64_t>(wid) << 16) | (tid << 5) | reg] = value;
+}
+
+uint32_t MockDM::_csr_read(uint32_t wid, uint32_t tid, uint32_t csr) const {
+    switch (csr) {
+    case RV_CSR_VX_DSCRATCH: return tid < dscratch_.size() ? dscratch_[tid] : 0;
+    case RV_CSR_VX_ACTIVE_THREADS:
+        return cfg_.active_threads();
+    case 0x301: return 0x40001101;                      // misa: RV32IMA
+    case 0xcc0: return tid;                             // vx_thread_id
+    case 0xcc1: return wid % cfg_.num_warps;            // vx_warp_id
+    case 0xcc2: return wid / cfg_.num_warps;            // vx_core_id
+    case 0xfc0: return cfg_.num_threads();
+    case 0xfc1: return cfg_.num_warps;
+    case 0xfc2: return cfg_.num_clusters * cfg_.num_cores;
+    default:    return 0;
+    }
+}
+
+uint32_t MockDM::_mem_rd(uint32_t addr) const {
+    auto it = mem_.find(addr & ~0x3u);
+    return it != mem_.end() ? it->second : 0;
+}
+
+void MockDM::_mem_wr(uint32_t addr, uint32_t value, uint32_t nbytes) {
+    uint32_t &word = mem_[addr & ~0x3u];
+    if (nbytes == 4) {
+        word = value;
+        return;
+    }
+    uint32_t shift = 8 * (addr & 0x3);
+    uint32_t mask = (nbytes == 2 ? 0xffffu : 0xffu) << shift;
+    word = (word & ~mask) | ((value << shift) & mask);
+}
+
+bool MockDM::_execute(uint32_t wid, uint32_t tid, uint32_t instr) {
+    uint32_t opc = instr & 0x7f;
+    uint32_t rd  = (instr >> 7) & 0x1f;
+    uint32_t f3  = (instr >> 12) & 0x7;
+    uint32_t rs1 = (instr >> 15) & 0x1f;
+    uint32_t rs2 = (instr >> 20) & 0x1f;
+    int32_t immi = static_cast<int32_t>(instr) >> 20;
+    int32_t imms = ((static_cast<int32_t>(instr) >> 25) << 5) | ((instr >> 7) & 0x1f);
+    uint32_t vrs1 = _gpr(wid, tid, rs1);
+
+    switch (opc) {
+    case RV_OPC_SYSTEM: {
+        if (instr == rv_ebreak())
+            return true;
+        uint32_t csr = instr >> 20;
+        uint32_t old = _csr_read(wid, tid, csr);
+        uint32_t val = old;
+        if (f3 == 0x1)                  val = vrs1;             // csrrw
+        else if (f3 == 0x2 && rs1)      val = old | vrs1;       // csrrs
+        else if (f3 == 0x3 && rs1)      val = old & ~vrs1;      // csrrc
+        if (csr == RV_CSR_VX_DSCRATCH && tid < dscratch_.size())
+            dscratch_[tid] = val;
+        _set_gpr(wid, tid, rd, old);
+        return true;
+    }
+    case RV_OPC_OPIMM:
+        if (f3 == 0x0) {
+            _set_gpr(wid, tid, rd, vrs1 + immi);
+            return true;
+        }
+        if (f3 == 0x1 && (instr >> 25) == 0x00) {
+            _set_gpr(wid, tid, rd, vrs1 << rs2);                     // slli
+            return true;
+        }
+        break;
+    case RV_OPC_OP:
+        if (f3 == 0x0 && (instr >> 25) == 0x00) {
+            _set_gpr(wid, tid, rd, vrs1 + _gpr(wid, tid, rs2));     // add
+            return true;
+        }
+        if (f3 == 0x4 && (instr >> 25) == 0x00) {
+            _set_gpr(wid, tid, rd, vrs1 ^ _gpr(wid, tid, rs2));     // xor
+            return true;
+        }
+        break;
+    case RV_OPC_MISCMEM:                                            // fence, fence.i
+        return true;
+    case 0x37:  // lui
+        _set_gpr(wid, tid, rd, instr & 0xfffff000);
+        return true;
+    case RV_OPC_AUIPC:
+        _set_gpr(wid, tid, rd, warps_[wid].pc + (instr & 0xfffff000));
+        return true;
+    case RV_OPC_LOAD: {
+        uint32_t addr = vrs1 + immi;
+        uint32_t word = _mem_rd(addr) >> (8 * (addr & 0x3));
+        switch (f3) {
+        case 0x0: _set_gpr(wid, tid, rd, static_cast<int8_t>(word)); return true;     // lb
+        case 0x1: _set_gpr(wid, tid, rd, static_cast<int16_t>(word)); return true;    // lh
+        case 0x2: _set_gpr(wid, tid, rd, word); return true;                          // lw
+        case 0x4: _set_gpr(wid, tid, rd, word & 0xff); return true;                   // lbu
+        case 0x5: _set_gpr(wid, tid, rd, word & 0xffff); return true;                 // lhu
+        default: break;
+        }
+        break;
+    }
+    case RV_OPC_STORE:
+        if (f3 <= 0x2) {
+            _mem_wr(vrs1 + imms, _gpr(wid, tid, rs2), 1u << f3);
+            return true;
+        }
+        break;
+    default:
+        break;
+    }
+    return false;
+}
+
+bool MockDM::_step(uint32_t wid, uint32_t tid, uint32_t instr, uint32_t &pc) {
+    uint32_t opc = instr & 0x7f;
+    if (opc == RV_OPC_JAL) {
+        uint32_t rd = (instr >> 7) & 0x1f;
+        int32_t off = ((static_cast<int32_t>(instr) >> 31) << 20) | (((instr >> 12) & 0xff) << 12) |
+                      (((instr >> 20) & 0x1) << 11) | (((instr >> 21) & 0x3ff) << 1);
+        _set_gpr(wid, tid, rd, pc + 4);
+        pc += off;
+        return true;
+    }
+    if (opc == RV_OPC_BRANCH) {
+        uint32_t f3 = (instr >> 12) & 0x7;
+        uint32_t a = _gpr(wid, tid, (instr >> 15) & 0x1f);
+        uint32_t b = _gpr(wid, tid, (instr >> 20) & 0x1f);
+        int32_t off = ((static_cast<int32_t>(instr) >> 31) << 12) | (((instr >> 7) & 0x1) << 11) |
+                      (((instr >> 25) & 0x3f) << 5) | (((instr >> 8) & 0xf) << 1);
+        bool taken;
+        switch (f3) {
+        case 0x0: taken = a == b; break;
+        case 0x1: taken = a != b; break;
+        case 0x4: taken = static_cast<int32_t>(a) < static_cast<int32_t>(b); break;
+        case 0x5: taken = static_cast<int32_t>(a) >= static_cast<int32_t>(b); break;
+        case 0x6: taken = a < b; break;
+        case 0x7: taken = a >= b; break;
+        default:  return false;
+        }
+        pc += taken ? off : 4;
+        return true;
+    }
+    if ((opc == RV_OPC_SYSTEM && ((instr >> 12) & 0x7) == 0) || !_execute(wid, tid, instr))
+        return false;
+    pc += 4;
+    return true;
+}
+
+void MockDM::_run(uint32_t wid) {
+    Warp_t &warp = warps_[wid];
+    const uint32_t start = warp.pc;
+    uint32_t end = start;
+    bool hit_ebreak = true;
+    for (uint32_t tid = 0; tid < cfg_.num_threads(); ++tid) {
+        if (!((cfg_.active_threads() >> tid) & 1))
+            continue;
+        uint32_t pc = start;
+        bool hit = false;
+        for (unsigned n = 0; n < MOCKDM_RUN_MAX_INSTRS; ++n) {
+            uint32_t instr = _mem_rd(pc);
+            if (instr == rv_ebreak()) {
+                hit = true;
+                break;
+            }
+            warp.pc = pc;       // auipc
+            if (!_step(wid, tid, instr, pc))
+                break;
+        }
+        hit_ebreak = hit_ebreak && hit;
+        end = pc;
+    }
+    warp.pc = end;
+    if (hit_ebreak && extract_dmreg_field(DMReg_t::DCONFIG, "ebreakh", dconfig_)) {
+        warp.halted = true;
+        warp.hacause = 1;
+    }
+}
+
+
+//==============================================================================
+// MockDMServer
+//==============================================================================
+
+MockDMServer::MockDMServer(const MockDMConfig_t &cfg):
+    cfg_(cfg),
+    dm_(cfg),
+    server_(new TCPServer()),
+    shm_(new ShmChannel()),
+    conn_(server_),
+    log_(new Logger("MockDM")),
+    rng_(1)     // Fixed seed: reproducible jitter
+{}
+
+MockDMServer::~MockDMServer() {
+    stop();
+    delete server_;
+    delete shm_;
+    delete log_;
+}
+
+int MockDMServer::start(uint16_t port) {
+    try {
+        server_->start(port);
+    } catch (const std::exception &e) {
+        log_->error("Failed to start mock DM server: " + std::string(e.what()));
+        return RCODE_ERROR;
+    }
+    port_ = port;
+    conn_ = server_;
+    return _start_thread(strfmt("port %u", port));
+}
+
+int MockDMServer::start_unix(const std::string &path) {
+    try {
+        server_->start_unix(path);
+    } catch (const std::exception &e) {
+        log_->error("Failed to start mock DM server: " + std::string(e.what()));
+        return RCODE_ERROR;
+    }
+    conn_ = server_;
+    return _start_thread("unix:" + path);
+}
+
+int MockDMServer::start_shm(const std::string &name) {
+    try {
+        shm_->create(name);
+    } catch (const std::exception &e) {
+        log_->error("Failed to start mock DM server: " + std::string(e.what()));
+        return RCODE_ERROR;
+    }
+    conn_ = shm_;
+    return _start_thread("shm:" + shm_->get_name());
+}
+
+int MockDMServer::_start_thread(const std::string &where) {
+    stop_requested_ = false;
+    thread_ = std::thread(&MockDMServer::_serve, this);
+    log_->info(strfmt("Mock DM listening on %s (%u warps, rtt %uus +/- %uus)",
+        where.c_str(), cfg_.total_warps(), cfg_.rtt_us, cfg_.jitter_us));
+    return RCODE_OK;
+}
+
+void MockDMServer::stop() {
+    if (!thread_.joinable())
+        return;
+    stop_requested_ = true;
+    thread_.join();
+    server_->stop();
+    shm_->close();
+}
+
+void MockDMServer::_serve() {
+    while (!stop_requested_) {
+        try {
+            if (conn_ == shm_) {
+                if (!shm_->accept(MOCKDM_POLL_MS))
+                    continue;
+            } else {
+                int fd = server_->accept_connection(MOCKDM_POLL_MS);
+                if (fd < 0)
+                    continue;
+                server_->attach_client(fd);
+            }
+        } catch (const std::exception &e) {
+            log_->error(e.what());
+            return;
+        }
+        _serve_client();
+    }
+}
+
+int MockDMServer::_serve_client() {
+    std::string out;
+    try {
+        while (!stop_requested_) {
+            conn_->recv_buffered(MOCKDM_POLL_MS);
+            if (!conn_->is_connected())
+                return RCODE_OK;    // Client disconnected
+
+            out.clear();
+            conn_->rxbuf().consume(_process(out));
+            if (out.empty())
+                continue;
+            _delay();
+            conn_->send_data(out.data(), out.size());
+            dm_.stats().round_trips.add();
+        }
+    } catch (const std::exception &e) {
+        log_->warn("Client connection dropped: " + std::string(e.what()));
+        return RCODE_COMM_ERR;
+    }
+    conn_->disconnect();
+    return RCODE_OK;
+}
+
+size_t MockDMServer::_process(std::string &out) {
+    const RecvBuffer &rx = conn_->rxbuf();
+    size_t pos = 0;
+    while (pos < rx.size()) {
+        // Binary record: op(1) status(1) addr(2) data(4), little endian
+        uint8_t op = static_cast<uint8_t>(rx[pos]);
+        if (op & 0x80) {
+            if (rx.size() - pos < TRANSPORT_BIN_REC_SZ)
+                break;
+            uint8_t rec[TRANSPORT_BIN_REC_SZ];
+            std::memcpy(rec, rx.data() + pos, sizeof(rec));
+            pos += sizeof(rec);
+            uint32_t addr = rec[2] | (rec[3] << 8);
+            uint32_t data = rec[4] | (rec[5] << 8) | (rec[6] << 16) | (static_cast<uint32_t>(rec[7]) << 24);
+            if (op == TRANSPORT_BIN_OP_READ) {
+                data = dm_.read_reg(addr);
+            } else {
+                dm_.write_reg(addr, data);
+                data = 0;
+            }
+            uint8_t resp[TRANSPORT_BIN_REC_SZ] = {op, 0, rec[2], rec[3],
+                static_cast<uint8_t>(data), static_cast<uint8_t>(data >> 8),
+                static_cast<uint8_t>(data >> 16), static_cast<uint8_t>(data >> 24)};
+            out.append(reinterpret_cast<const char*>(resp), sizeof(resp));
+            continue;
+        }
+
+        // ASCII request, newline terminated
+        size_t nl = rx.find('\n', pos);
+        if (nl == RecvBuffer::npos)
+            break;
+        std::string line(rx.data() + pos, nl - pos);
+        pos = nl + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        out += _handle_line(line) + "\n";
+    }
+    return pos;
+}
+
+std::string MockDMServer::_handle_line(const std::string &line) {
+    if (line.empty())
+        return "-";
+    if (line == "p") {
+        std::string caps;
+        if (cfg_.cap_bin) caps += "," TRANSPORT_BIN_CAP;
+        if (cfg_.cap_memblk) caps += "," TRANSPORT_MEMBLK_CAP;
+        if (cfg_.cap_injseq) caps += "," TRANSPORT_INJSEQ_CAP;
+        return caps.empty() ? "+P" : "+P:" + caps.substr(1);
+    }
+    if (line == "b")
+        return cfg_.cap_bin ? "+B" : "-";
+    if (line == "s")
+        return "+";
+
+    const char *args = line.c_str() + 1;
+    switch (line[0]) {
+    case 'r':
+        return strfmt("+%08x", dm_.read_reg(std::strtoul(args, nullptr, 16)));
+    case 'w': {
+        char *end = nullptr;
+        uint32_t addr = std::strtoul(args, &end, 16);
+        if (*end != ':') return "-";
+        dm_.write_reg(addr, std::strtoul(end + 1, nullptr, 16));
+        return "+";
+    }
+    case 'R': {
+        std::string resp = "+";
+        for (const auto &tok : tokenize(args, ',')) {
+            if (resp.size() > 1) resp += ",";
+            resp += strfmt("%08x", dm_.read_reg(std::strtoul(tok.c_str(), nullptr, 16)));
+        }
+        return resp;
+    }
+    case 'W': {
+        size_t semi = line.find(';');
+        if (semi == std::string::npos) return "-";
+        auto addrs = tokenize(line.substr(1, semi - 1), ',');
+        auto vals = tokenize(line.substr(semi + 1), ',');
+        if (addrs.size() != vals.size()) return "-";
+        for (size_t i = 0; i < addrs.size(); ++i)
+            dm_.write_reg(std::strtoul(addrs[i].c_str(), nullptr, 16), std::strtoul(vals[i].c_str(), nullptr, 16));
+        return "+";
+    }
+    default:
+        return "-";
+    }
+}
+
+void MockDMServer::_delay() {
+    if (cfg_.rtt_us == 0 && cfg_.jitter_us == 0)
+        return;
+    unsigned us = cfg_.rtt_us;
+    if (cfg_.jitter_us)
+        us += std::uniform_int_distribution<unsigned>(0, cfg_.jitter_us)(rng_);
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
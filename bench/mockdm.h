@@ -0,0 +1,186 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <cstdint>
+
+#include "stats.h"
+
+// Forward declarations
+class Logger;
+class TCPServer;
+class ShmChannel;
+class ByteStream;
+
+#ifndef MOCKDM_DEFAULT_PORT
+    #define MOCKDM_DEFAULT_PORT 5599
+#endif
+
+#ifndef MOCKDM_POLL_MS
+    #define MOCKDM_POLL_MS 100          // Server loop wakeup to see stop()
+#endif
+
+#ifndef MOCKDM_RUN_MAX_INSTRS
+    #define MOCKDM_RUN_MAX_INSTRS (1u << 26)    // Per lane and resume, the warp is left running after that
+#endif
+
+struct MockDMConfig_t {
+    // Platform (PLATFORM register)
+    uint32_t num_clusters = 1;
+    uint32_t num_cores    = 1;
+    uint32_t num_warps    = 4;          // per core
+    uint32_t num_threads_log2 = 2;
+
+    // Advertised capabilities
+    bool cap_bin     = true;            // binary register records
+    bool cap_memblk  = true;            // MADDR/MDATA block memory access
+    bool cap_injseq  = true;            // injections complete before later ops (true of the model)
+    bool has_wgather = true;            // DCONFIG.wgather
+    bool has_lanes   = true;            // DCONFIG.lanes
+
+    // vx_active_threads of every warp, warp-wide injections skip the other lanes (0: all active)
+    uint32_t tmask   = 0;
+
+    // Injected latency: every response burst waits rtt_us + U(0, jitter_us)
+    unsigned rtt_us    = 0;
+    unsigned jitter_us = 0;
+
+    // Injections and steps report busy (injectstate/stepstate) for this long
+    unsigned busy_us   = 0;
+
+    uint32_t total_warps() const { return num_clusters * num_cores * num_warps; }
+    uint32_t num_threads() const { return 1u << num_threads_log2; }
+    uint32_t active_threads() const {
+        uint32_t all = num_threads() >= 32 ? 0xffffffff : (1u << num_threads()) - 1;
+        return tmask ? tmask & all : all;
+    }
+};
+
+// DM side counters, the ground truth for "DM transactions per operation"
+struct MockDMStats_t {
+    StatCounter reads;                  // DM register reads
+    StatCounter writes;                 // DM register writes
+    StatCounter injects;                // Executed injected instructions
+    StatCounter round_trips;            // Response bursts sent back to the client
+
+    void reset() {
+        for (StatCounter *c : {&reads, &writes, &injects, &round_trips})
+            c->reset();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Software model of the Vortex debug module
+////////////////////////////////////////////////////////////////////////////////
+// Warps start active and running, and only change state through DCTRL requests.
+// Injected instructions are executed on the selected thread, or on every lane
+// of the selected warp with DCONFIG.warpinj (csrr/csrw/csrrs, lb/lbu/lh/lhu/lw,
+// sb/sh/sw, addi, slli, add, xor, lui, auipc, fence, ebreak); lanes outside
+// MockDMConfig_t::tmask skip them, each has its own dscratch. A resumed warp
+// runs each active lane from its PC with branches and jal too: reaching an
+// ebreak halts it (hacause ebreak, with DCONFIG.ebreakh), anything else the
+// model does not execute leaves it running there. Memory is sparse and shared
+// by all cores. Effects are immediate, only the DCTRL busy flags follow
+// MockDMConfig_t::busy_us.
+class MockDM {
+public:
+    explicit MockDM(const MockDMConfig_t &cfg);
+
+    uint32_t read_reg(uint32_t addr);
+    void write_reg(uint32_t addr, uint32_t value);
+
+    MockDMStats_t& stats() { return stats_; }
+
+private:
+    MockDMConfig_t cfg_;
+    MockDMStats_t stats_;
+
+    // DM registers
+    uint32_t dconfig_  = 0;
+    uint32_t dselect_  = 0;
+    uint32_t dinject_  = 0;
+    uint32_t maddr_    = 0;
+    uint32_t wgsel_    = 0;
+    uint32_t lsel_     = 0;
+    std::vector<uint32_t> dscratch_;    // per lane
+    bool dmactive_     = false;
+    bool resethaltreq_ = false;
+    std::chrono::steady_clock::time_point busy_until_;
+    std::vector<uint32_t> wmask_;       // per window
+
+    // Warp/thread state
+    struct Warp_t {
+        bool active = true;
+        bool halted = false;
+        uint32_t pc = 0;
+        uint32_t hacause = 0;
+    };
+    std::vector<Warp_t> warps_;
+    std::unordered_map<uint64_t, uint32_t> gprs_;   // (wid, tid, reg) -> value, x0 never stored
+    std::unordered_map<uint32_t, uint32_t> mem_;    // word address -> value
+
+    void _reset_warps();
+    uint32_t _winsel() const  { return (dselect_ >> 22) & 0x3ff; }
+    uint32_t _warpsel() const { return (dselect_ >> 7) & 0x7fff; }
+    uint32_t _threadsel() const { return dselect_ & 0x7f; }
+    bool _masked(uint32_t wid) const { return (wmask_[wid / 32] >> (wid % 32)) & 0x1; }
+    uint32_t _window_bits(bool halted) const;
+    uint32_t _dctrl() const;
+    void _write_dctrl(uint32_t value);
+
+    uint32_t _gpr(uint32_t wid, uint32_t tid, uint32_t reg) const;
+    void _set_gpr(uint32_t wid, uint32_t tid, uint32_t reg, uint32_t value);
+    uint32_t _csr_read(uint32_t wid, uint32_t tid, uint32_t csr) const;
+    uint32_t _mem_rd(uint32_t addr) const;
+    void _mem_wr(uint32_t addr, uint32_t value, uint32_t nbytes);
+    bool _execute(uint32_t wid, uint32_t tid, uint32_t instr);                // false: not supported
+    bool _step(uint32_t wid, uint32_t tid, uint32_t instr, uint32_t &pc);     // _execute() and control flow
+    void _run(uint32_t wid);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Loopback server speaking the DM register protocol of the stream transports,
+// over TCP, a Unix domain socket or a shared memory segment
+////////////////////////////////////////////////////////////////////////////////
+// One client at a time. Handles the handshake ('p', 'b', 's'), ASCII 'r'/'w'/
+// 'R'/'W' requests and binary records. Everything received in one burst is
+// answered in one send, after the configured RTT.
+class MockDMServer {
+public:
+    explicit MockDMServer(const MockDMConfig_t &cfg);
+    ~MockDMServer();
+
+    // Start serving on 'port' in a background thread
+    int start(uint16_t port);
+
+    // Same, on a Unix domain socket / shared memory segment
+    int start_unix(const std::string &path);
+    int start_shm(const std::string &name);
+    void stop();
+
+    MockDMStats_t& stats() { return dm_.stats(); }
+    uint16_t port() const { return port_; }
+
+private:
+    MockDMConfig_t cfg_;
+    MockDM dm_;
+    TCPServer *server_;
+    ShmChannel *shm_;
+    ByteStream *conn_;                  // server_ or shm_, the one serving
+    Logger *log_;
+    uint16_t port_ = 0;
+    std::thread thread_;
+    std::atomic<bool> stop_requested_{false};
+    std::mt19937 rng_;
+
+    int _start_thread(const std::string &where);
+    void _serve();
+    int _serve_client();
+    size_t _process(std::string &out);     // Consume complete requests in rxbuf, returns bytes used
+    std::string _handle_line(const std::string &line);
+    void _delay();
+};
@@ -1,63 +1,116 @@
 #include "logger.h"
-#include <map>
-
-const std::string prefix_clr = ANSI_GRY;
-
-const std::map<LogLevel, std::string> tag_clr_tab = {
-    {LOG_ERROR, ANSI_RED},
-    {LOG_WARN,  ANSI_YLW},
-    {LOG_INFO,  ANSI_CYN},
-    {LOG_DEBUG, ANSI_GRY},
-    {LOG_DEBUG1, ANSI_GRY},
-    {LOG_DEBUG2, ANSI_GRY},
-    {LOG_DEBUG3, ANSI_GRY},
-    {LOG_DEBUG4, ANSI_GRY},
-    {LOG_DEBUG5, ANSI_GRY},
-    {LOG_DEBUG6, ANSI_GRY}
+#include <thread>
+#include <condition_variable>
+#include <vector>
+
+#define LOG_NUM_LEVELS (LOG_DEBUG6 + 1)
+
+static const char *const prefix_clr = ANSI_GRY;
+
+// Indexed by LogLevel
+static const char *const tag_clr_tab[LOG_NUM_LEVELS] = {
+    ANSI_RED, ANSI_YLW, ANSI_CYN,
+    ANSI_GRY, ANSI_GRY, ANSI_GRY, ANSI_GRY, ANSI_GRY, ANSI_GRY, ANSI_GRY
 };
 
-const std::map<LogLevel, std::string> tag_tab = {
-    {LOG_ERROR, "[ERROR] "},
-    {LOG_WARN,  "[!] "},
-    {LOG_INFO,  "[+] "},
-    {LOG_DEBUG, "[>] "},
-    {LOG_DEBUG1, "[>] "},
-    {LOG_DEBUG2, "[>] "},
-    {LOG_DEBUG3, "[>] "},
-    {LOG_DEBUG4, "[>] "},
-    {LOG_DEBUG5, "[>] "},
-    {LOG_DEBUG6, "[>] "}
+static const char *const tag_tab[LOG_NUM_LEVELS] = {
+    "[ERROR] ", "[!] ", "[+] ",
+    "[>] ", "[>] ", "[>] ", "[>] ", "[>] ", "[>] ", "[>] "
 };
 
-const std::map<LogLevel, std::string> msg_clr_tab = {
-    {LOG_ERROR, ""},
-    {LOG_WARN,  ""},
-    {LOG_INFO,  ""},
-    {LOG_DEBUG, ANSI_GRY},
-    {LOG_DEBUG1, ANSI_GRY},
-    {LOG_DEBUG2, ANSI_GRY},
-    {LOG_DEBUG3, ANSI_GRY},
-    {LOG_DEBUG4, ANSI_GRY},
-    {LOG_DEBUG5, ANSI_GRY},
-    {LOG_DEBUG6, ANSI_GRY}
+static const char *const msg_clr_tab[LOG_NUM_LEVELS] = {
+    "", "", "",
+    ANSI_GRY, ANSI_GRY, ANSI_GRY, ANSI_GRY, ANSI_GRY, ANSI_GRY, ANSI_GRY
 };
 
 
+// Background writer used by set_output_file(path, true): log calls only queue
+// the formatted line, the sink thread does the (blocking) file I/O.
+class AsyncSink {
+public:
+    ~AsyncSink() { stop(); }
+
+    void start(std::ofstream *file) {
+        stop();
+        file_ = file;
+        stop_ = false;
+        thread_ = std::thread(&AsyncSink::run, this);
+    }
+
+    void stop() {
+        if (!thread_.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    void push(std::string &&line) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            queue_.push_back(std::move(line));
+        }
+        cv_.notify_one();
+    }
+
+private:
+    std::thread thread_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::vector<std::string> queue_;
+    std::ofstream *file_ = nullptr;
+    bool stop_ = false;
+
+    void run() {
+        std::vector<std::string> batch;
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (true) {
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            batch.swap(queue_);
+            bool done = stop_;
+            lock.unlock();
+            for (const auto &line : batch)
+                *file_ << line;
+            file_->flush();
+            batch.clear();
+            lock.lock();
+            if (done && queue_.empty())
+                return;
+        }
+    }
+};
+
+static AsyncSink g_sink;
+
+
 Logger::Logger(const std::string &prefix, const int debug_thr): 
     prefix_(prefix), 
     level_(LOG_INFO),  // Default level, will be overridden by global level
     debug_threshold_(debug_thr >= 0 ? debug_thr : g_debug_threshold_)
 {}
 
-void Logger::set_output_file(const std::string& path) {
-    if (g_file_.is_open())
-        g_file_.close();
+void Logger::set_output_file(const std::string& path, bool async) {
+    close_output_file();
+    std::lock_guard<std::mutex> lock(g_mutex_);
     g_file_.open(path, std::ios::app);
-    if (!g_file_.is_open())
+    if (!g_file_.is_open()) {
         std::cerr << "[Logger] Warning: failed to open log file: " << path << '\n';
+        return;
+    }
+    g_file_async_ = async;
+    if (async)
+        g_sink.start(&g_file_);
 }
 
 void Logger::close_output_file() {
+    // Drain the sink before closing the file it writes to (the sink thread
+    // never takes g_mutex_, so holding it here keeps new lines out meanwhile)
+    std::lock_guard<std::mutex> lock(g_mutex_);
+    g_file_async_ = false;
+    g_sink.stop();
     if (g_file_.is_open())
         g_file_.close();
 }
@@ -65,6 +118,9 @@ void Logger::close_output_file() {
 // === Core logic ===
 void Logger::log_internal(const Logger* self, LogLevel lvl,
                           const std::string& msg, int threshold) {
+    if (static_cast<int>(lvl) > static_cast<int>(LOGGER_MAX_LEVEL))
+        return;
+
     const int level      = static_cast<int>(g_level_);  // Always use global level
     const int debug_thr  = self ? self->debug_threshold_ : g_debug_threshold_;
     const std::string& prefix = (self && !self->prefix_.empty()) ? self->prefix_ : g_prefix_;
@@ -83,22 +139,26 @@ void Logger::log_internal(const Logger* self, LogLevel lvl,
         return;
 
     std::string out;
+    out.reserve(prefix.size() + msg.size() + 32);
     if (g_color_enabled_) {
         if(!prefix.empty())
-            out += prefix_clr + "(" + prefix + ")" + ANSI_RST + " ";
-        out += tag_clr_tab.at(lvl) + tag_tab.at(lvl) + ANSI_RST;
-        out += msg_clr_tab.at(lvl) + msg + ANSI_RST + "\n";
+            out.append(prefix_clr).append("(").append(prefix).append(")" ANSI_RST " ");
+        out.append(tag_clr_tab[lvl]).append(tag_tab[lvl]).append(ANSI_RST);
+        out.append(msg_clr_tab[lvl]).append(msg).append(ANSI_RST "\n");
     }
     else {
         if(!prefix.empty())
-            out += "(" + prefix + ") ";
-        out += tag_tab.at(lvl);
-        out += msg + "\n";
+            out.append("(").append(prefix).append(") ");
+        out.append(tag_tab[lvl]);
+        out.append(msg).append("\n");
     }
     
     // Thread-safe output
     std::lock_guard<std::mutex> lock(g_mutex_);
-    if (g_file_.is_open()) {
+    if (g_file_async_) {
+        g_sink.push(std::move(out));
+    }
+    else if (g_file_.is_open()) {
         g_file_ << out;
         g_file_.flush();
     }
@@ -27,6 +27,12 @@ enum LogLevel {
     LOG_DEBUG6 = 9
 };
 
+#ifndef LOGGER_MAX_LEVEL
+    // Most verbose level compiled in; lower it for release builds (e.g. -DLOGGER_MAX_LEVEL=LOG_INFO)
+    // to compile the LOG_DEBUG_LAZY() call sites out entirely
+    #define LOGGER_MAX_LEVEL LOG_DEBUG6
+#endif
+
 
 class Logger {
 public:
@@ -38,9 +44,17 @@ public:
     static void set_global_level(LogLevel level)             { g_level_ = level; }
     static void set_global_debug_threshold(int thr)          { g_debug_threshold_ = thr; }
     static void set_color_enabled(bool enable)               { g_color_enabled_ = enable; }
-    static void set_output_file(const std::string& path);
+    static void set_output_file(const std::string& path, bool async = false);   // async: write from a sink thread
     static void close_output_file();
 
+    // === Level checks (cheap, no formatting) ===
+    static bool level_enabled(LogLevel lvl) {
+        return static_cast<int>(lvl) <= static_cast<int>(LOGGER_MAX_LEVEL) && g_level_ >= lvl;
+    }
+    bool debug_enabled(int threshold = -1) const {
+        return level_enabled(LOG_DEBUG) && g_level_ >= (threshold == -1 ? debug_threshold_ : threshold);
+    }
+
     // === Per-instance logging ===
     void error(const std::string& msg) const;
     void warn (const std::string& msg) const;
@@ -62,6 +76,7 @@ private:
     
     static inline std::mutex g_mutex_;
     static inline std::ofstream g_file_;
+    static inline bool g_file_async_ = false;
 
     // Per-instance config
     std::string prefix_;
@@ -72,3 +87,11 @@ private:
     static void log_internal(const Logger* self, LogLevel lvl,
                              const std::string& msg, int threshold = 3);
 };
+
+// Lazy debug logging: 'msg' is only evaluated when the message would be printed,
+// so strfmt()/string concatenation costs nothing while debug output is off.
+#define LOG_DEBUG_LAZY(logger, msg) \
+    do { if ((logger)->debug_enabled()) (logger)->debug(msg); } while (0)
+
+#define LOG_DEBUG_LAZY_T(logger, thr, msg) \
+    do { if ((logger)->debug_enabled(thr)) (logger)->debug(msg, thr); } while (0)
@@ -0,0 +1,357 @@
+#include "shmutils.h"
+
+#include <unistd.h>
+#include <cstring>
+#include <climits>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+
+//==============================================================================
+// Helpers
+//==============================================================================
+static inline void _cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Sleep while *word == val, up to timeout_us (< 0: indefinitely). The futex is
+// not process private, the word lives in memory shared with the peer.
+static void _futex_wait(const std::atomic<uint32_t> *word, uint32_t val, long timeout_us) {
+#ifdef __linux__
+    timespec ts = {timeout_us / 1000000, (timeout_us % 1000000) * 1000};
+    syscall(SYS_futex, const_cast<std::atomic<uint32_t>*>(word), FUTEX_WAIT, val,
+            timeout_us >= 0 ? &ts : nullptr, nullptr, 0);
+#else
+    (void)word; (void)val;
+    std::this_thread::sleep_for(std::chrono::microseconds(std::min(timeout_us < 0 ? 100L : timeout_us, 100L)));
+#endif
+}
+
+static void _futex_wake(std::atomic<uint32_t> *word) {
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+// POSIX shared memory object names start with a single '/'
+static std::string _shm_name(const std::string &name) {
+    if (name.empty() || name == "/")
+        throw std::runtime_error("Invalid shared memory name: '" + name + "'");
+    return name[0] == '/' ? name : "/" + name;
+}
+
+
+//==============================================================================
+// ShmChannel Implementation
+//==============================================================================
+ShmChannel::ShmChannel():
+    seg_(nullptr),
+    tx_(nullptr),
+    rx_(nullptr),
+    server_(false),
+    connected_(false)
+{}
+
+ShmChannel::~ShmChannel() {
+    close();
+}
+
+void ShmChannel::_map(int fd, const std::string &name) {
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(ShmSegment_t)) {
+        ::close(fd);
+        throw std::runtime_error("Shared memory segment " + name + " is too small or unreadable");
+    }
+    void *p = mmap(nullptr, sizeof(ShmSegment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        throw std::runtime_error("Failed to map shared memory " + name + ": " + std::string(strerror(errno)));
+    seg_ = static_cast<ShmSegment_t*>(p);
+    name_ = name;
+}
+
+void ShmChannel::_unmap() {
+    if (seg_) {
+        munmap(seg_, sizeof(ShmSegment_t));
+        seg_ = nullptr;
+        tx_ = rx_ = nullptr;
+    }
+    connected_ = false;
+}
+
+void ShmChannel::_attach_rings() {
+    tx_ = server_ ? &seg_->s2c : &seg_->c2s;
+    rx_ = server_ ? &seg_->c2s : &seg_->s2c;
+    rxbuf_.clear();
+    connected_ = true;
+}
+
+void ShmChannel::_end_session() {
+    if (server_) {
+        seg_->state.store(SHM_STATE_CLOSED);
+    } else {
+        // Only end our own session, the server may have re-armed the segment
+        // for another client since
+        uint32_t state = SHM_STATE_CONNECTED;
+        if (seg_->client_pid.load() == static_cast<uint32_t>(getpid()))
+            seg_->state.compare_exchange_strong(state, SHM_STATE_CLOSED);
+    }
+    // Wake whoever sleeps on the segment, they re-check the state
+    _futex_wake(&seg_->state);
+    for (ShmRing_t *r : {&seg_->c2s, &seg_->s2c}) {
+        _futex_wake(&r->head);
+        _futex_wake(&r->tail);
+    }
+    connected_ = false;
+}
+
+bool ShmChannel::_peer_alive() const {
+    pid_t pid = static_cast<pid_t>(server_ ? seg_->client_pid.load() : seg_->server_pid.load());
+    return pid == 0 || kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+void ShmChannel::create(const std::string &name) {
+    if (seg_) {
+        return; // Already created
+    }
+    std::string shm_name = _shm_name(name);
+
+    // A segment left behind by a previous server would have stale state
+    shm_unlink(shm_name.c_str());
+    int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        throw std::runtime_error("Failed to create shared memory " + shm_name + ": " + std::string(strerror(errno)));
+    if (ftruncate(fd, sizeof(ShmSegment_t)) < 0) {
+        ::close(fd);
+        shm_unlink(shm_name.c_str());
+        throw std::runtime_error("Failed to size shared memory " + shm_name + ": " + std::string(strerror(errno)));
+    }
+    try {
+        _map(fd, shm_name);
+    } catch (const std::exception&) {
+        shm_unlink(shm_name.c_str());
+        throw;
+    }
+    server_ = true;
+
+    // Freshly truncated memory is zero: rings are empty
+    seg_->magic = SHM_MAGIC;
+    seg_->version = SHM_VERSION;
+    seg_->ring_sz = SHM_RING_SZ;
+    seg_->server_pid.store(static_cast<uint32_t>(getpid()));
+    seg_->state.store(SHM_STATE_LISTEN);
+}
+
+bool ShmChannel::accept(int timeout_ms) {
+    if (!seg_ || !server_) {
+        throw std::runtime_error("Shared memory server is not running");
+    }
+
+    uint32_t state = seg_->state.load();
+    if (state == SHM_STATE_CLOSED) {
+        // Previous session is over, reset the rings for the next client
+        for (ShmRing_t *r : {&seg_->c2s, &seg_->s2c}) {
+            r->head.store(0);
+            r->tail.store(0);
+            r->waiters.store(0);
+        }
+        seg_->client_pid.store(0);
+        seg_->state.store(SHM_STATE_LISTEN);
+        _futex_wake(&seg_->state);
+        state = SHM_STATE_LISTEN;
+    }
+    if (state == SHM_STATE_LISTEN) {
+        _futex_wait(&seg_->state, SHM_STATE_LISTEN, timeout_ms < 0 ? -1L : 1000L * timeout_ms);
+        state = seg_->state.load();
+    }
+    if (state != SHM_STATE_CONNECTED)
+        return false;
+    _attach_rings();
+    return true;
+}
+
+void ShmChannel::open(const std::string &name, unsigned timeout_ms) {
+    if (connected_) {
+        return; // Already connected
+    }
+    std::string shm_name = _shm_name(name);
+    int fd = shm_open(shm_name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open shared memory " + shm_name + ": " + std::string(strerror(errno)));
+    _map(fd, shm_name);
+    server_ = false;
+
+    if (seg_->magic != SHM_MAGIC || seg_->version != SHM_VERSION || seg_->ring_sz != SHM_RING_SZ) {
+        _unmap();
+        throw std::runtime_error("Incompatible shared memory segment " + shm_name);
+    }
+
+    // Claim the segment, waiting for the server to re-arm it after a previous session
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        uint32_t state = SHM_STATE_LISTEN;
+        if (seg_->state.compare_exchange_strong(state, SHM_STATE_CONNECTED))
+            break;
+        if (state == SHM_STATE_CONNECTED) {
+            _unmap();
+            throw std::runtime_error("Shared memory segment " + shm_name + " already has a client");
+        }
+        long left_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left_us <= 0) {
+            _unmap();
+            throw std::runtime_error("Connection timeout");
+        }
+        _futex_wait(&seg_->state, state, left_us);
+    }
+    seg_->client_pid.store(static_cast<uint32_t>(getpid()));
+    _futex_wake(&seg_->state);
+    _attach_rings();
+}
+
+void ShmChannel::disconnect() {
+    if (!seg_) {
+        return;
+    }
+    if (connected_)
+        _end_session();
+    if (!server_)
+        _unmap();
+}
+
+void ShmChannel::close() {
+    if (!seg_) {
+        return;
+    }
+    bool server = server_;
+    std::string name = name_;
+    _end_session();
+    _unmap();
+    if (server)
+        shm_unlink(name.c_str());
+}
+
+bool ShmChannel::is_connected() const {
+    return connected_ && seg_->state.load(std::memory_order_acquire) == SHM_STATE_CONNECTED;
+}
+
+bool ShmChannel::_wait_change(const std::atomic<uint32_t> &word, uint32_t val, ShmRing_t *ring,
+                              uint32_t wait_bit, int timeout_ms) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    auto deadline = start + std::chrono::milliseconds(std::max(timeout_ms, 0));
+    // Spinning on a single CPU only delays the peer we are waiting for
+    static const long spin_us = std::thread::hardware_concurrency() > 1 ? SHM_SPIN_US : 0;
+    auto spin_until = start + std::chrono::microseconds(spin_us);
+    if (timeout_ms >= 0)
+        spin_until = std::min(spin_until, deadline);
+
+    while (true) {
+        if (word.load(std::memory_order_acquire) != val)
+            return true;
+        if (seg_->state.load(std::memory_order_acquire) != SHM_STATE_CONNECTED)
+            return false;
+        auto now = clock::now();
+        if (now < spin_until) {
+            _cpu_relax();
+            continue;
+        }
+        long wait_us = -1;
+        if (timeout_ms >= 0) {
+            if (now >= deadline)
+                return false;
+            wait_us = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count() + 1;
+        }
+        // Announce the sleep, then re-check: the other side publishes its
+        // update before testing 'waiters'
+        ring->waiters.fetch_or(wait_bit);
+        if (word.load() == val && seg_->state.load() == SHM_STATE_CONNECTED)
+            _futex_wait(&word, val, wait_us);
+        ring->waiters.fetch_and(~wait_bit);
+    }
+}
+
+ssize_t ShmChannel::send_data(const char* buf, size_t len) {
+    if (!connected_) {
+        throw std::runtime_error("Not connected");
+    }
+    if (buf == nullptr || len == 0) {
+        return 0;
+    }
+
+    size_t sent = 0;
+    uint32_t head = tx_->head.load(std::memory_order_relaxed);
+    while (sent < len) {
+        uint32_t tail = tx_->tail.load(std::memory_order_acquire);
+        uint32_t space = SHM_RING_SZ - (head - tail);
+        if (space == 0) {
+            // Ring full, wait for the consumer to advance tail
+            if (!_wait_change(tx_->tail, tail, tx_, SHM_WAIT_SPACE, SHM_TIMEOUT_MS)) {
+                if (!is_connected() || !_peer_alive()) {
+                    connected_ = false;
+                    throw std::runtime_error("Connection closed");
+                }
+                throw std::runtime_error("Send timeout");
+            }
+            continue;
+        }
+        uint32_t n = static_cast<uint32_t>(std::min<size_t>(space, len - sent));
+        uint32_t off = head & (SHM_RING_SZ - 1);
+        uint32_t first = std::min(n, SHM_RING_SZ - off);
+        memcpy(tx_->data + off, buf + sent, first);
+        memcpy(tx_->data, buf + sent + first, n - first);
+        head += n;
+        sent += n;
+        tx_->head.store(head);
+        if (tx_->waiters.load() & SHM_WAIT_DATA)
+            _futex_wake(&tx_->head);
+    }
+    return static_cast<ssize_t>(sent);
+}
+
+ssize_t ShmChannel::recv_buffered(int timeout_ms) {
+    if (!connected_) {
+        throw std::runtime_error("Not connected");
+    }
+
+    uint32_t tail = rx_->tail.load(std::memory_order_relaxed);
+    if (!_wait_change(rx_->head, tail, rx_, SHM_WAIT_DATA, timeout_ms)) {
+        // Timeout, or the session ended (possibly without the peer saying so)
+        if (seg_->state.load() != SHM_STATE_CONNECTED || !_peer_alive()) {
+            if (server_)
+                _end_session();
+            connected_ = false;
+        }
+        return 0;
+    }
+
+    uint32_t head = rx_->head.load(std::memory_order_acquire);
+    uint32_t n = head - tail;
+    uint32_t off = tail & (SHM_RING_SZ - 1);
+    uint32_t first = std::min(n, SHM_RING_SZ - off);
+    char *dst = rxbuf_.prepare(n);
+    memcpy(dst, rx_->data + off, first);
+    memcpy(dst + first, rx_->data, n - first);
+    rxbuf_.commit(n);
+    rx_->tail.store(tail + n);
+    if (rx_->waiters.load() & SHM_WAIT_SPACE)
+        _futex_wake(&rx_->tail);
+    return n;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <sys/types.h>
+
+#include "tcputils.h"   // ByteStream, RecvBuffer
+
+#ifndef SHM_RING_SZ
+    #define SHM_RING_SZ 65536           // Bytes per direction (power of 2)
+#endif
+
+#ifndef SHM_SPIN_US
+    #define SHM_SPIN_US 50              // Busy poll an empty/full ring this long before sleeping on the futex (multi-CPU hosts)
+#endif
+
+#ifndef SHM_TIMEOUT_MS
+    #define SHM_TIMEOUT_MS 5000
+#endif
+
+#define SHM_MAGIC       0x53445856      // "VXDS"
+#define SHM_VERSION     1
+
+static_assert((SHM_RING_SZ & (SHM_RING_SZ - 1)) == 0, "SHM_RING_SZ must be a power of 2");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared memory rings need lock-free 32-bit atomics");
+
+// Segment state
+enum : uint32_t {
+    SHM_STATE_LISTEN    = 1,            // Server waiting for a client
+    SHM_STATE_CONNECTED = 2,            // Client attached
+    SHM_STATE_CLOSED    = 3             // Session ended by either side, server re-arms it
+};
+
+// Ring waiters bits
+enum : uint32_t {
+    SHM_WAIT_DATA   = 1,                // Consumer sleeps on 'head'
+    SHM_WAIT_SPACE  = 2                 // Producer sleeps on 'tail'
+};
+
+// Single producer/single consumer byte ring. head and tail are free running
+// byte counters, each written by one side only. A side about to sleep sets its
+// bit in 'waiters' and re-checks the ring, so the other side only makes the
+// futex wake syscall when someone actually sleeps.
+struct ShmRing_t {
+    alignas(64) std::atomic<uint32_t> head;     // Written by the producer
+    alignas(64) std::atomic<uint32_t> tail;     // Written by the consumer
+    alignas(64) std::atomic<uint32_t> waiters;  // SHM_WAIT_* bits
+    alignas(64) uint8_t data[SHM_RING_SZ];
+};
+
+// Layout of the shared memory object, created by the debug server and opened
+// by one client at a time. Both sides must be built with the same SHM_RING_SZ.
+struct ShmSegment_t {
+    uint32_t magic;                             // SHM_MAGIC
+    uint32_t version;                           // SHM_VERSION
+    uint32_t ring_sz;                           // SHM_RING_SZ
+    alignas(64) std::atomic<uint32_t> state;    // SHM_STATE_*
+    std::atomic<uint32_t> server_pid;           // Checked when a wait times out, to notice a dead peer
+    std::atomic<uint32_t> client_pid;
+    ShmRing_t c2s;                              // Client to server (requests)
+    ShmRing_t s2c;                              // Server to client (responses, notifications)
+};
+
+//==============================================================================
+// Byte stream over a POSIX shared memory segment
+//==============================================================================
+class ShmChannel : public ByteStream {
+public:
+    ShmChannel();
+    ~ShmChannel();
+
+    // Server side: create segment 'name' (replacing a stale one), then wait
+    // up to timeout_ms for a client (timeout_ms < 0: wait indefinitely)
+    void create(const std::string& name);
+    bool accept(int timeout_ms);
+
+    // Client side: attach to the segment of a running server
+    void open(const std::string& name, unsigned timeout_ms = SHM_TIMEOUT_MS);
+
+    // End the session: the client detaches, the server keeps the segment for the next client
+    void disconnect() override;
+
+    // Detach, the server also removes the segment
+    void close();
+
+    bool is_connected() const override;
+    std::string get_name() const { return name_; }
+
+    ssize_t send_data(const char* buf, size_t len) override;
+    ssize_t recv_buffered(int timeout_ms) override;
+
+private:
+    std::string name_;
+    ShmSegment_t *seg_;
+    ShmRing_t *tx_;
+    ShmRing_t *rx_;
+    bool server_;
+    bool connected_;
+
+    void _map(int fd, const std::string& name);
+    void _unmap();
+    void _attach_rings();
+    void _end_session();
+    bool _peer_alive() const;
+
+    // Wait until 'word' != 'val' or the session ends, spinning first
+    bool _wait_change(const std::atomic<uint32_t> &word, uint32_t val, ShmRing_t *ring,
+                      uint32_t wait_bit, int timeout_ms);
+};
@@ -4,11 +4,123 @@
 #include <unistd.h>
 #include <cstring>
 #include <stdexcept>
+#include <algorithm>
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <errno.h>
-#include <sys/select.h>
+#include <poll.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/un.h>
+#include <chrono>
+
+
+//==============================================================================
+// Helpers
+//==============================================================================
+// Poll a single fd for 'events'. The timeout is tracked as a deadline so that
+// signal interruptions don't extend the wait. Returns false on timeout.
+static bool _poll_fd(int fd, short events, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    pollfd pfd = {fd, events, 0};
+    int ret;
+    while (true) {
+        int wait_ms = timeout_ms;
+        if (timeout_ms > 0) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            wait_ms = left > 0 ? static_cast<int>(left) : 0;
+        }
+        ret = poll(&pfd, 1, wait_ms);
+        if (ret >= 0 || errno != EINTR)
+            break;
+    }
+    if (ret < 0) {
+        throw std::runtime_error("Poll failed: " + std::string(strerror(errno)));
+    }
+    return ret > 0;     // ready, or hangup/error (reported by the next send/recv)
+}
+
+// Tune a connected socket for small request/response traffic
+static void _tune_socket(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if TCP_ENABLE_QUICKACK && defined(TCP_QUICKACK)
+    setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one));
+#endif
+}
+
+// Linux clears TCP_QUICKACK on its own, so re-arm it after reads
+static inline void _rearm_quickack(int fd) {
+#if TCP_ENABLE_QUICKACK && defined(TCP_QUICKACK)
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one));
+#else
+    (void)fd;
+#endif
+}
+
+// Send all bytes, waiting for buffer space instead of spinning on EAGAIN
+static ssize_t _send_all(int fd, const char* buf, size_t len, int timeout_ms) {
+    size_t total_sent = 0;
+    while (total_sent < len) {
+        ssize_t sent = send(fd, buf + total_sent, len - total_sent, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!_poll_fd(fd, POLLOUT, timeout_ms))
+                    throw std::runtime_error("Send timeout");
+                continue;
+            }
+            throw std::runtime_error("Send failed: " + std::string(strerror(errno)));
+        }
+        if (sent == 0) {
+            throw std::runtime_error("Connection closed");
+        }
+        total_sent += sent;
+    }
+    return static_cast<ssize_t>(total_sent);
+}
+
+// Serve a recv_data() call from buffered bytes first
+static size_t _drain_rxbuf(RecvBuffer &rx, char *buf, size_t maxlen) {
+    size_t n = std::min(rx.size(), maxlen);
+    if (n > 0) {
+        memcpy(buf, rx.data(), n);
+        rx.consume(n);
+    }
+    return n;
+}
+
+
+//==============================================================================
+// RecvBuffer Implementation
+//==============================================================================
+size_t RecvBuffer::find(char c, size_t from) const {
+    if (from >= size())
+        return npos;
+    const void *p = memchr(data() + from, c, size() - from);
+    return p ? static_cast<const char*>(p) - data() : npos;
+}
+
+void RecvBuffer::consume(size_t n) {
+    rpos_ += std::min(n, size());
+    if (rpos_ == wpos_)
+        rpos_ = wpos_ = 0;
+}
+
+char *RecvBuffer::prepare(size_t n) {
+    // Compact consumed bytes before growing the storage
+    if (rpos_ > 0 && wpos_ + n > buf_.size()) {
+        memmove(buf_.data(), buf_.data() + rpos_, wpos_ - rpos_);
+        wpos_ -= rpos_;
+        rpos_ = 0;
+    }
+    if (wpos_ + n > buf_.size())
+        buf_.resize(wpos_ + n);
+    return buf_.data() + wpos_;
+}
 
 
 //==============================================================================
@@ -18,7 +130,8 @@ TCPClient::TCPClient():
     ip_(""),
     port_(0),
     sockfd_(-1),
-    connected_(false)
+    connected_(false),
+    is_unix_(false)
 {}
 
 TCPClient::~TCPClient() {
@@ -32,7 +145,36 @@ void TCPClient::connect(const std::string& ip, uint16_t port, unsigned timeout_m
     ip_ = ip;
     port_ = port;
 
-    sockfd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    if (inet_pton(AF_INET, ip_.c_str(), &addr.sin_addr) <= 0) {
+        throw std::runtime_error("Invalid IP address: " + ip_);
+    }
+    _connect(AF_INET, &addr, sizeof(addr), timeout_ms);
+}
+
+void TCPClient::connect_unix(const std::string& path, unsigned timeout_ms) {
+    if (connected_) {
+        return; // Already connected
+    }
+    ip_ = path;
+    port_ = 0;
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Invalid Unix socket path: " + path);
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    _connect(AF_UNIX, &addr, sizeof(addr), timeout_ms);
+}
+
+void TCPClient::_connect(int domain, const void *addr, unsigned addrlen, unsigned timeout_ms) {
+    rxbuf_.clear();
+    is_unix_ = domain == AF_UNIX;
+
+    sockfd_ = socket(domain, SOCK_STREAM, 0);
     if (sockfd_ < 0) {
         throw std::runtime_error("Socket creation failed: " + std::string(strerror(errno)));
     }
@@ -49,41 +191,23 @@ void TCPClient::connect(const std::string& ip, uint16_t port, unsigned timeout_m
         throw std::runtime_error("Failed to set socket non-blocking: " + std::string(strerror(errno)));
     }
 
-    sockaddr_in addr = {};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port_);
-    if (inet_pton(AF_INET, ip_.c_str(), &addr.sin_addr) <= 0) {
-        close(sockfd_);
-        throw std::runtime_error("Invalid IP address: " + ip_);
-    }
-
-    int ret = ::connect(sockfd_, (sockaddr*)&addr, sizeof(addr));
+    int ret = ::connect(sockfd_, static_cast<const sockaddr*>(addr), addrlen);
     if (ret < 0) {
         if (errno == EINPROGRESS) {
-            // Connection is in progress, wait using select()
-            fd_set fdset;
-            FD_ZERO(&fdset);
-            FD_SET(sockfd_, &fdset);
-
-            if (timeout_ms > 0) {
-                // Use timeout
-                timeval tv;
-                tv.tv_sec = timeout_ms / 1000;
-                tv.tv_usec = (timeout_ms % 1000) * 1000;
-                ret = select(sockfd_ + 1, nullptr, &fdset, nullptr, &tv);
-            } else {
-                // No timeout - wait indefinitely
-                ret = select(sockfd_ + 1, nullptr, &fdset, nullptr, nullptr);
+            // Connection is in progress, wait for it to become writable
+            // (timeout_ms == 0: wait indefinitely)
+            bool ready;
+            try {
+                ready = _poll_fd(sockfd_, POLLOUT, timeout_ms > 0 ? static_cast<int>(timeout_ms) : -1);
+            } catch (const std::exception&) {
+                close(sockfd_);
+                sockfd_ = -1;
+                throw;
             }
-
-            if (ret <= 0) {
+            if (!ready) {
                 close(sockfd_);
                 sockfd_ = -1;
-                if (ret == 0) {
-                    throw std::runtime_error("Connection timeout");
-                } else {
-                    throw std::runtime_error("Select error: " + std::string(strerror(errno)));
-                }
+                throw std::runtime_error("Connection timeout");
             }
 
             // Check for connection errors
@@ -114,6 +238,7 @@ void TCPClient::connect(const std::string& ip, uint16_t port, unsigned timeout_m
         throw std::runtime_error("Failed to restore socket blocking mode: " + std::string(strerror(errno)));
     }
 
+    if (!is_unix_) _tune_socket(sockfd_);
     connected_ = true;
 }
 
@@ -134,27 +259,7 @@ ssize_t TCPClient::send_data(const char* buf, size_t len) {
         return 0;
     }
 
-    ssize_t total_sent = 0;
-    ssize_t remaining = len;
-    
-    while (remaining > 0) {
-        ssize_t sent = send(sockfd_, buf + total_sent, remaining, MSG_NOSIGNAL);
-        if (sent < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // Socket would block, try again
-                continue;
-            }
-            throw std::runtime_error("Send failed: " + std::string(strerror(errno)));
-        }
-        if (sent == 0) {
-            throw std::runtime_error("Connection closed");
-        }
-        
-        total_sent += sent;
-        remaining -= sent;
-    }
-
-    return total_sent;
+    return _send_all(sockfd_, buf, len, TCPCLIENT_TIMEOUT_MS);
 }
 
 ssize_t TCPClient::recv_data(char* buf, size_t maxlen) {
@@ -166,6 +271,10 @@ ssize_t TCPClient::recv_data(char* buf, size_t maxlen) {
         return 0;
     }
 
+    if (!rxbuf_.empty()) {
+        return _drain_rxbuf(rxbuf_, buf, maxlen);
+    }
+
     ssize_t received = recv(sockfd_, buf, maxlen, 0);
     if (received < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -179,6 +288,47 @@ ssize_t TCPClient::recv_data(char* buf, size_t maxlen) {
         return 0;
     }
 
+    if (!is_unix_) _rearm_quickack(sockfd_);
+    return received;
+}
+
+
+
+bool TCPClient::wait_readable(int timeout_ms) {
+    if (!connected_) {
+        throw std::runtime_error("Client not connected");
+    }
+    return _poll_fd(sockfd_, POLLIN, timeout_ms);
+}
+
+bool TCPClient::wait_writable(int timeout_ms) {
+    if (!connected_) {
+        throw std::runtime_error("Client not connected");
+    }
+    return _poll_fd(sockfd_, POLLOUT, timeout_ms);
+}
+
+ssize_t TCPClient::recv_buffered(int timeout_ms) {
+    if (!wait_readable(timeout_ms)) {
+        return 0;
+    }
+
+    char *dst = rxbuf_.prepare(TCP_RECV_CHUNK_SZ);
+    ssize_t received = recv(sockfd_, dst, TCP_RECV_CHUNK_SZ, 0);
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
+        throw std::runtime_error("Receive failed: " + std::string(strerror(errno)));
+    }
+    if (received == 0) {
+        // Connection closed by peer
+        connected_ = false;
+        return 0;
+    }
+
+    rxbuf_.commit(received);
+    if (!is_unix_) _rearm_quickack(sockfd_);
     return received;
 }
 
@@ -238,49 +388,110 @@ void TCPServer::start(uint16_t port) {
     running_ = true;
 }
 
+void TCPServer::start_unix(const std::string& path) {
+    if (running_) {
+        return; // Already running
+    }
+    port_ = 0;
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Invalid Unix socket path: " + path);
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    server_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd_ < 0) {
+        throw std::runtime_error("Failed to create server socket");
+    }
+
+    // A socket file left behind by a previous server would fail the bind
+    unlink(path.c_str());
+    if (bind(server_fd_, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(server_fd_);
+        server_fd_ = -1;
+        throw std::runtime_error("Failed to bind socket to " + path + ": " + std::string(strerror(errno)));
+    }
+
+    if (listen(server_fd_, 5) < 0) {
+        close(server_fd_);
+        server_fd_ = -1;
+        unlink(path.c_str());
+        throw std::runtime_error("Failed to listen on socket");
+    }
+
+    unix_path_ = path;
+    running_ = true;
+}
+
 void TCPServer::accept_client(unsigned timeout_ms) {
     if (!running_) {
         throw std::runtime_error("Server is not running");
     }
 
     if (timeout_ms > 0) {
-        // Use select for timeout
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(server_fd_, &readfds);
-
-        timeval tv;
-        tv.tv_sec = timeout_ms / 1000;
-        tv.tv_usec = (timeout_ms % 1000) * 1000;
-
-        int ret = select(server_fd_ + 1, &readfds, nullptr, nullptr, &tv);
-        if (ret < 0) {
-            throw std::runtime_error("Select failed: " + std::string(strerror(errno)));
-        }
-        if (ret == 0) {
+        if (!_poll_fd(server_fd_, POLLIN, static_cast<int>(timeout_ms))) {
             throw std::runtime_error("Server accept timeout");
         }
     }
-    // When timeout_ms == 0, we don't use select and just call accept() directly
+    // When timeout_ms == 0, we don't poll and just call accept() directly
     // This will block indefinitely until a connection is available
 
-    sockaddr_in client_addr = {};
+    int fd = accept_connection(-1);
+    attach_client(fd);
+}
+
+int TCPServer::accept_connection(int timeout_ms) {
+    if (!running_ || server_fd_ < 0) {
+        throw std::runtime_error("Server is not running");
+    }
+    if (timeout_ms >= 0 && !_poll_fd(server_fd_, POLLIN, timeout_ms)) {
+        return -1;
+    }
+
+    sockaddr_storage client_addr = {};
     socklen_t client_len = sizeof(client_addr);
-    client_fd_ = accept(server_fd_, (sockaddr*)&client_addr, &client_len);
-    if (client_fd_ < 0) {
+    int fd = accept(server_fd_, (sockaddr*)&client_addr, &client_len);
+    if (fd < 0) {
         throw std::runtime_error("Failed to accept client: " + std::string(strerror(errno)));
     }
+    if (unix_path_.empty()) _tune_socket(fd);
+    return fd;
 }
 
-void TCPServer::stop() {
+void TCPServer::attach_client(int fd) {
+    if (client_fd_ >= 0) {
+        close(client_fd_);
+    }
+    client_fd_ = fd;
+    running_ = true;
+    rxbuf_.clear();
+}
+
+void TCPServer::shutdown_client() {
+    if (client_fd_ >= 0) {
+        shutdown(client_fd_, SHUT_RDWR);
+    }
+}
+
+void TCPServer::disconnect() {
     if (client_fd_ >= 0) {
         close(client_fd_);
         client_fd_ = -1;
     }
+}
+
+void TCPServer::stop() {
+    disconnect();
     if (server_fd_ >= 0) {
         close(server_fd_);
         server_fd_ = -1;
     }
+    if (!unix_path_.empty()) {
+        unlink(unix_path_.c_str());
+        unix_path_.clear();
+    }
     running_ = false;
 }
 
@@ -291,28 +502,7 @@ ssize_t TCPServer::send_data(const char* buf, size_t len) {
         return 0;
     }
 
-    ssize_t total_sent = 0;
-    ssize_t remaining = len;
-    
-    while (remaining > 0) {
-        ssize_t sent = send(client_fd_, buf + total_sent, remaining, MSG_NOSIGNAL);
-        if (sent < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // Socket would block, try again
-                usleep(1000); // sleep 1ms before retry
-                continue;
-            }
-            throw std::runtime_error("Send failed: " + std::string(strerror(errno)));
-        }
-        if (sent == 0) {
-            throw std::runtime_error("Connection closed");
-        }
-        
-        total_sent += sent;
-        remaining -= sent;
-    }
-
-    return total_sent;
+    return _send_all(client_fd_, buf, len, TCPSERVER_TIMEOUT_MS);
 }
 
 ssize_t TCPServer::recv_data(char* buf, size_t maxlen) {
@@ -324,6 +514,10 @@ ssize_t TCPServer::recv_data(char* buf, size_t maxlen) {
         return 0;
     }
 
+    if (!rxbuf_.empty()) {
+        return _drain_rxbuf(rxbuf_, buf, maxlen);
+    }
+
     ssize_t received = recv(client_fd_, buf, maxlen, 0);
     if (received < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -337,5 +531,44 @@ ssize_t TCPServer::recv_data(char* buf, size_t maxlen) {
         return 0;
     }
 
+    if (unix_path_.empty()) _rearm_quickack(client_fd_);
     return received;
-}
\ No newline at end of file
+}
+
+bool TCPServer::wait_readable(int timeout_ms) {
+    if (client_fd_ < 0) {
+        throw std::runtime_error("No client connected");
+    }
+    return _poll_fd(client_fd_, POLLIN, timeout_ms);
+}
+
+bool TCPServer::wait_writable(int timeout_ms) {
+    if (client_fd_ < 0) {
+        throw std::runtime_error("No client connected");
+    }
+    return _poll_fd(client_fd_, POLLOUT, timeout_ms);
+}
+
+ssize_t TCPServer::recv_buffered(int timeout_ms) {
+    if (!wait_readable(timeout_ms)) {
+        return 0;
+    }
+
+    char *dst = rxbuf_.prepare(TCP_RECV_CHUNK_SZ);
+    ssize_t received = recv(client_fd_, dst, TCP_RECV_CHUNK_SZ, 0);
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
+        throw std::runtime_error("Receive failed: " + std::string(strerror(errno)));
+    }
+    if (received == 0) {
+        close(client_fd_);
+        client_fd_ = -1; // client disconnected
+        return 0;
+    }
+
+    rxbuf_.commit(received);
+    if (unix_path_.empty()) _rearm_quickack(client_fd_);
+    return received;
+}
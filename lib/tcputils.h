@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <sys/types.h>
 
 #ifndef TCPCLIENT_TIMEOUT_MS
     #define TCPCLIENT_TIMEOUT_MS 5000
@@ -11,43 +12,115 @@
     #define TCPSERVER_TIMEOUT_MS 5000
 #endif
 
+#ifndef TCP_RECV_CHUNK_SZ
+    #define TCP_RECV_CHUNK_SZ 16384     // Bytes requested per recv() into a RecvBuffer
+#endif
+
+#ifndef TCP_ENABLE_QUICKACK
+    #define TCP_ENABLE_QUICKACK 1       // Re-arm TCP_QUICKACK after each read (Linux)
+#endif
+
+//==============================================================================
+// Reusable receive buffer with delimiter scanning
+//==============================================================================
+class RecvBuffer {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Unconsumed bytes
+    const char *data() const { return buf_.data() + rpos_; }
+    size_t size() const { return wpos_ - rpos_; }
+    bool empty() const { return wpos_ == rpos_; }
+    char operator[](size_t i) const { return buf_[rpos_ + i]; }
+
+    // Offset of first 'c' at or after 'from', npos if not buffered yet
+    size_t find(char c, size_t from = 0) const;
+
+    // Drop n bytes from the front
+    void consume(size_t n);
+    void clear() { rpos_ = wpos_ = 0; }
+
+    // Get space for n more bytes at the tail, then commit how many were filled
+    char *prepare(size_t n);
+    void commit(size_t n) { wpos_ += n; }
+
+private:
+    std::vector<char> buf_;     // Storage, only ever grows
+    size_t rpos_ = 0;           // Read offset
+    size_t wpos_ = 0;           // Write offset
+};
+
+//==============================================================================
+// Connected byte stream (TCP/Unix socket, shared memory ring)
+//==============================================================================
+class ByteStream {
+public:
+    virtual ~ByteStream() = default;
+
+    virtual void disconnect() = 0;
+    virtual bool is_connected() const = 0;
+
+    // Send all bytes (throws on error)
+    virtual ssize_t send_data(const char* buf, size_t len) = 0;
+
+    // Wait up to timeout_ms for data and append it to rxbuf().
+    // Returns bytes read, 0 on timeout or if the peer closed the connection.
+    virtual ssize_t recv_buffered(int timeout_ms) = 0;
+    RecvBuffer& rxbuf() { return rxbuf_; }
+
+protected:
+    RecvBuffer rxbuf_;
+};
+
 //==============================================================================
 // Simple TCP client wrapper
 //==============================================================================
-class TCPClient {
+class TCPClient : public ByteStream {
 public:
     TCPClient();
     ~TCPClient();
 
     // Connect to server with optional timeout (ms)
     void connect(const std::string& ip, uint16_t port, unsigned timeout_ms = TCPCLIENT_TIMEOUT_MS);
+
+    // Connect to a Unix domain stream socket instead (get_ip() returns the path)
+    void connect_unix(const std::string& path, unsigned timeout_ms = TCPCLIENT_TIMEOUT_MS);
     
     // Disconnect from server
-    void disconnect();
+    void disconnect() override;
 
     // Check if connected
-    bool is_connected() const { return connected_; }
+    bool is_connected() const override { return connected_; }
 
     // Get connection details
     std::string get_ip() const { return ip_; }
     uint16_t get_port() const  { return port_; }
 
     // Send/Receive data
-    ssize_t send_data(const char* buf, size_t len);
+    ssize_t send_data(const char* buf, size_t len) override;
     ssize_t recv_data(char* buf, size_t maxlen);
 
+    // Wait until socket is readable/writable (timeout_ms < 0: wait indefinitely)
+    bool wait_readable(int timeout_ms);
+    bool wait_writable(int timeout_ms);
+
+    ssize_t recv_buffered(int timeout_ms) override;
+
 private:
     std::string ip_;
     uint16_t port_;
     int sockfd_;
     bool connected_;
+    bool is_unix_;              // No TCP options on Unix sockets
+
+    void _connect(int domain, const void *addr, unsigned addrlen, unsigned timeout_ms);
 };
 
 
 //==============================================================================
 // Simple TCP Server wrapper
 //==============================================================================
-class TCPServer {
+class TCPServer : public ByteStream {
 public:
     TCPServer();
     ~TCPServer();
@@ -55,9 +128,26 @@ public:
     // Start server on specified port
     void start(uint16_t port);
 
+    // Start server on a Unix domain socket, replacing a stale socket file
+    void start_unix(const std::string& path);
+
     // Accept a client connection with optional timeout (ms) (**blocking**)
     void accept_client(unsigned timeout_ms = TCPSERVER_TIMEOUT_MS);
 
+    // Accept a connection without attaching it, returns fd or -1 on timeout
+    // (timeout_ms < 0: wait indefinitely)
+    int accept_connection(int timeout_ms);
+
+    // Serve an already accepted connection (no listening socket)
+    void attach_client(int fd);
+
+    // Wake up a thread blocked on the client socket (it sees a disconnect)
+    void shutdown_client();
+
+    // Close the client connection, keep listening
+    void disconnect() override;
+    bool is_connected() const override { return has_client(); }
+
     // Stop server
     void stop();
 
@@ -67,13 +157,23 @@ public:
     // Get server port
     uint16_t get_port() const { return port_; }
 
+    // Check if a client is connected
+    bool has_client() const { return client_fd_ >= 0; }
+
     // Send/Receive data
-    ssize_t send_data(const char *buf, size_t len);
+    ssize_t send_data(const char *buf, size_t len) override;
     ssize_t recv_data(char *buf, size_t maxlen);
 
+    // Wait until client socket is readable/writable (timeout_ms < 0: wait indefinitely)
+    bool wait_readable(int timeout_ms);
+    bool wait_writable(int timeout_ms);
+
+    ssize_t recv_buffered(int timeout_ms) override;
+
 private:
     uint16_t port_;
     int server_fd_;
     int client_fd_;
     bool running_;
+    std::string unix_path_;     // Socket file to remove on stop(), empty for TCP
 };
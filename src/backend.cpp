@@ -1,4 +1,5 @@
 #include "backend.h"
+#include "trace.h"
 #include "transport.h"
 #include "logger.h"
 #include "util.h"
@@ -6,6 +7,10 @@
 #include <cstring>   // for std::memcpy
 #include <cmath>    // for std::pow
 #include <thread>
+#include <array>
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
 
 #include "riscv.h"
 
@@ -19,6 +24,10 @@
 
 #define msleep(x) usleep(x * 1000)
 
+// Scratch GPR sets (see _scratch_acquire)
+constexpr uint32_t SCRATCH_T0    = 1u << RV_GPR_T0;
+constexpr uint32_t SCRATCH_T0_T1 = SCRATCH_T0 | (1u << RV_GPR_T1);
+
 #define CHECK_ERR(stmt, msg) \
     do { \
         int rc = stmt; \
@@ -68,19 +77,19 @@
 // Backend
 ////////////////////////////////////////////////////////////////////////////////
 
-Backend::Backend(): 
+Backend::Backend(const std::string &target_name): 
     transport_(nullptr),
     transport_type_(""),
-    log_(new Logger("Backend", 4))
+    log_(new Logger(target_name.empty() ? "Backend" : "Backend:" + target_name, 4))
 {
-    if (!rv_toolchain_check()) {
-        log_->warn("RISC-V toolchain not found in PATH. Instruction inject and all dependent functionality will not work");
-    }
+    _update_poll_policy();
 }
 
 Backend::~Backend() {
-    if (transport_) 
+    if (transport_) {
+        _scratch_release();     // don't leave the target with clobbered t0/t1
         delete transport_;
+    }
     if (log_)
         delete log_;    
 }
@@ -88,12 +97,109 @@ Backend::~Backend() {
 void Backend::set_param(const std::string &param, std::string value) {
     if (param == "poll_retries") {
         poll_retries_ = std::stoul(value);
+        _update_poll_policy();
         log_->info("Set parameter poll_retries to " + value);
     } 
     else if (param == "poll_delay_ms") {
         poll_delay_ms_ = std::stoul(value);
+        _update_poll_policy();
         log_->info("Set parameter poll_delay_ms to " + value);
     }
+    else if (param == "poll_spin") {
+        poll_policy_.spin_reads = std::stoul(value);
+        log_->info("Set parameter poll_spin to " + value);
+    }
+    else if (param == "poll_min_us") {
+        poll_policy_.min_delay_us = std::stoul(value);
+        log_->info("Set parameter poll_min_us to " + value);
+    }
+    else if (param == "poll_adaptive") {
+        poll_policy_.adaptive = std::stoul(value) != 0;
+        poll_history_.reset();
+        log_->info("Set parameter poll_adaptive to " + value);
+    }
+    else if (param == "dmreg_cache") {
+        use_dmreg_cache_ = std::stoul(value) != 0;
+        dmreg_cache_invalidate();
+        log_->info("Set parameter dmreg_cache to " + value);
+    }
+    else if (param == "pipeline_window") {
+        pipeline_window_ = std::stoul(value);
+        if (transport_) transport_->set_window(pipeline_window_);
+        log_->info("Set parameter pipeline_window to " + value);
+    }
+    else if (param == "halt_events") {
+        use_halt_events_ = std::stoul(value) != 0;
+        log_->info("Set parameter halt_events to " + value + " (takes effect on next connect)");
+    }
+    else if (param == "reg_cache") {
+        use_reg_cache_ = std::stoul(value) != 0;
+        regcache_invalidate();
+        log_->info("Set parameter reg_cache to " + value);
+    }
+    else if (param == "scratch_hold") {
+        hold_scratch_ = std::stoul(value) != 0;
+        if (!hold_scratch_) _scratch_release();
+        log_->info("Set parameter scratch_hold to " + value);
+    }
+    else if (param == "warp_snapshot") {
+        use_warp_snapshot_ = std::stoul(value) != 0;
+        warpstate_invalidate();
+        log_->info("Set parameter warp_snapshot to " + value);
+    }
+    else if (param == "warp_gather") {
+        use_warp_gather_ = std::stoul(value) != 0;
+        warpstate_invalidate();
+        log_->info("Set parameter warp_gather to " + value);
+    }
+    else if (param == "lane_access") {
+        use_lane_access_ = std::stoul(value) != 0;
+        log_->info("Set parameter lane_access to " + value);
+    }
+    else if (param == "mem_cache") {
+        use_mem_cache_ = std::stoul(value) != 0;
+        memcache_invalidate();
+        log_->info("Set parameter mem_cache to " + value);
+    }
+    else if (param == "mem_bulk_threshold") {
+        mem_bulk_threshold_ = std::stoul(value);
+        log_->info("Set parameter mem_bulk_threshold to " + value);
+    }
+    else if (param == "emulated_breakpoints") {
+        use_emulated_breakpoints_ = std::stoul(value) != 0;
+        log_->info("Set parameter emulated_breakpoints to " + value + " (takes effect on next resume)");
+    }
+    else if (param == "load_chunk") {
+        unsigned chunk = std::stoul(value);
+        if (chunk < 4 || chunk % 4) {
+            log_->warn("load_chunk must be a non-zero multiple of 4");
+            return;
+        }
+        load_chunk_ = chunk;
+        log_->info("Set parameter load_chunk to " + value);
+    }
+    else if (param == "load_delta") {
+        use_load_delta_ = std::stoul(value) != 0;
+        log_->info("Set parameter load_delta to " + value);
+    }
+    else if (param == "scratch_mem") {
+        uint32_t addr = std::stoul(value, nullptr, 0);
+        if (addr & 0x3) {
+            log_->warn("scratch_mem must be word aligned");
+            return;
+        }
+        scratch_mem_addr_ = addr;
+        log_->info("Set parameter scratch_mem to " + value);
+    }
+    else if (param == "scratch_mem_size") {
+        scratch_mem_size_ = std::stoul(value, nullptr, 0) & ~0x3u;
+        log_->info("Set parameter scratch_mem_size to " + value);
+    }
+    else if (param == "binary_proto") {
+        allow_binary_proto_ = std::stoul(value) != 0;
+        if (transport_) transport_->set_allow_binary(allow_binary_proto_);
+        log_->info("Set parameter binary_proto to " + value + " (takes effect on next connect)");
+    }
     else {
         log_->warn("Unknown parameter: " + param);
     }
@@ -106,12 +212,143 @@ std::string Backend::get_param(const std::string &param) const {
     else if (param == "poll_delay_ms") {
         return std::to_string(poll_delay_ms_);
     }
+    else if (param == "poll_spin") {
+        return std::to_string(poll_policy_.spin_reads);
+    }
+    else if (param == "poll_min_us") {
+        return std::to_string(poll_policy_.min_delay_us);
+    }
+    else if (param == "poll_adaptive") {
+        return poll_policy_.adaptive ? "1" : "0";
+    }
+    else if (param == "dmreg_cache") {
+        return use_dmreg_cache_ ? "1" : "0";
+    }
+    else if (param == "pipeline_window") {
+        return std::to_string(pipeline_window_);
+    }
+    else if (param == "binary_proto") {
+        return allow_binary_proto_ ? "1" : "0";
+    }
+    else if (param == "mem_bulk_threshold") {
+        return std::to_string(mem_bulk_threshold_);
+    }
+    else if (param == "mem_cache") {
+        return use_mem_cache_ ? "1" : "0";
+    }
+    else if (param == "reg_cache") {
+        return use_reg_cache_ ? "1" : "0";
+    }
+    else if (param == "scratch_hold") {
+        return hold_scratch_ ? "1" : "0";
+    }
+    else if (param == "halt_events") {
+        return use_halt_events_ ? "1" : "0";
+    }
+    else if (param == "warp_snapshot") {
+        return use_warp_snapshot_ ? "1" : "0";
+    }
+    else if (param == "warp_gather") {
+        return use_warp_gather_ ? "1" : "0";
+    }
+    else if (param == "lane_access") {
+        return use_lane_access_ ? "1" : "0";
+    }
+    else if (param == "emulated_breakpoints") {
+        return use_emulated_breakpoints_ ? "1" : "0";
+    }
+    else if (param == "load_chunk") {
+        return std::to_string(load_chunk_);
+    }
+    else if (param == "load_delta") {
+        return use_load_delta_ ? "1" : "0";
+    }
+    else if (param == "scratch_mem") {
+        return strfmt("0x%08X", scratch_mem_addr_);
+    }
+    else if (param == "scratch_mem_size") {
+        return std::to_string(scratch_mem_size_);
+    }
     else {
         log_->warn("Unknown parameter: " + param);
         return "?";
     }
 }
 
+// "REG.field" for a PollHistory key
+static std::string _poll_key_name(uint64_t key) {
+    uint32_t addr = key >> 32, mask = key & 0xffffffff;
+    for (size_t r = 0; r < static_cast<size_t>(DMReg_t::COUNT); ++r) {
+        const auto& rinfo = get_dmreg(static_cast<DMReg_t>(r));
+        if (rinfo.addr != addr)
+            continue;
+        for (size_t f = 0; f < rinfo.num_fields; ++f) {
+            if (rinfo.fields[f].mask() == mask)
+                return std::string(rinfo.name) + "." + std::string(rinfo.fields[f].name);
+        }
+        return strfmt("%s&0x%08X", std::string(rinfo.name).c_str(), mask);
+    }
+    return strfmt("0x%04X&0x%08X", addr, mask);
+}
+
+std::string Backend::get_stats(bool json) {
+    StatsWriter w(json);
+    if (transport_) {
+        w.begin_section("transport");
+        transport_->stats().dump(w);
+        w.end_section();
+    }
+
+    w.begin_section("backend");
+    w.counter("injects", stats_.injects.get());
+    w.counter("poll_iters", stats_.poll_iters.get());
+    w.counter("poll_sleeps", stats_.poll_sleeps.get());
+    w.counter("poll_timeouts", stats_.poll_timeouts.get());
+    w.counter("mem_rd_bytes", stats_.mem_rd_bytes.get());
+    w.counter("mem_wr_bytes", stats_.mem_wr_bytes.get());
+    w.rate("mem_rd_rate", stats_.mem_rd_bytes.get(), stats_.read_mem.sum_ns());
+    w.rate("mem_wr_rate", stats_.mem_wr_bytes.get(), stats_.write_mem.sum_ns());
+    w.counter("memcache_hits", stats_.memcache_hits.get());
+    w.counter("memcache_misses", stats_.memcache_misses.get());
+    w.counter("load_skipped", stats_.load_skipped.get());
+    w.counter("load_written", stats_.load_written.get());
+    w.hist("inject", stats_.inject);
+    w.hist("read_mem", stats_.read_mem);
+    w.hist("write_mem", stats_.write_mem);
+    w.hist("halt_wait", stats_.halt_wait);
+    w.hist("poll", stats_.poll);
+    w.end_section();
+
+    // Learned completion of each polled field (dmreg_pollfield and batched polls)
+    w.begin_section("poll");
+    for (const auto& [key, e] : poll_history_.entries())
+        w.poll_history(_poll_key_name(key), e.count, e.avg_reads, e.avg_busy_us);
+    w.end_section();
+
+    RvAsmStats_t asm_stats = rv_asm_stats();
+    w.begin_section("asm");
+    w.counter("cache_hits", asm_stats.hits);
+    w.counter("builtin", asm_stats.builtin);
+    w.counter("toolchain", asm_stats.toolchain);
+    w.counter("toolchain_runs", asm_stats.toolchain_runs);
+    w.counter("preloaded_hits", asm_stats.preloaded);
+    w.end_section();
+    return w.str();
+}
+
+void Backend::reset_stats() {
+    if (transport_)
+        transport_->stats().reset();
+    for (StatCounter *c : {&stats_.injects, &stats_.poll_iters, &stats_.poll_sleeps, &stats_.poll_timeouts, &stats_.mem_rd_bytes,
+                           &stats_.mem_wr_bytes, &stats_.memcache_hits, &stats_.memcache_misses,
+                           &stats_.load_skipped, &stats_.load_written})
+        c->reset();
+    for (LatencyHist *h : {&stats_.inject, &stats_.read_mem, &stats_.write_mem, &stats_.halt_wait, &stats_.poll})
+        h->reset();
+    poll_history_.reset();
+    rv_asm_stats(true);
+}
+
 //==============================================================================
 // Transport management
 //==============================================================================
@@ -123,14 +360,27 @@ int Backend::transport_setup(const std::string &type) {
         transport_type_ = "";
     }
     transport_type_ = type;
+    dmreg_cache_invalidate();
+    memcache_invalidate();
+    regcache_invalidate();
+    warpstate_invalidate();
+    scratch_ = ScratchCtx_t();
 
     if (type == "tcp") {
         transport_ = new TCPTransport();
         log_->debug("TCP transport created");
+    } else if (type == "unix") {
+        transport_ = new UnixTransport();
+        log_->debug("Unix socket transport created");
+    } else if (type == "shm") {
+        transport_ = new ShmTransport();
+        log_->debug("Shared memory transport created");
     } else {
         log_->error("Unknown transport type: " + type);
         return RCODE_INVALID_ARG;
     }
+    transport_->set_window(pipeline_window_);
+    transport_->set_allow_binary(allow_binary_proto_);
     return RCODE_OK;
 }
 
@@ -140,14 +390,24 @@ int Backend::transport_connect(const std::map<std::string, std::string> &args) {
         return RCODE_TRANSPORT_ERR;
     }
 
-    if (transport_type_ == "tcp") {
-        log_->debug("Connecting TCP transport");
-        CHECK_ERR(transport_->connect(args), "Failed to connect TCP transport");
+    // DM state may have changed while disconnected
+    dmreg_cache_invalidate();
+    memcache_invalidate();
+    regcache_invalidate();
+    warpstate_invalidate();
+
+    if (transport_type_ == "tcp" || transport_type_ == "unix" || transport_type_ == "shm") {
+        log_->debug("Connecting " + transport_type_ + " transport");
+        CHECK_ERR(transport_->connect(args), "Failed to connect " + transport_type_ + " transport");
         log_->debug("Performing transport handshake");
         CHECK_ERR(transport_->handshake(), "Transport handshake failed");
         log_->debug("Sending start execution cmd");
         std::string resp;
         CHECK_ERR(transport_->send_cmd("s", resp), "Failed to send start execution command");
+        if (use_halt_events_ && transport_->has_cap(TRANSPORT_HALTEV_CAP)) {
+            if (transport_->enable_halt_events() != RCODE_OK)
+                log_->warn("Failed to enable halt notifications, falling back to polling");
+        }
         log_->info("Transport connected!");
     } else {
         log_->error("Transport type not supported for connection: " + transport_type_);
@@ -177,9 +437,9 @@ bool Backend::transport_connected() const {
 // Initialization
 //==============================================================================
 
-int Backend::initialize(bool quiet) {
+int Backend::initialize(bool quiet, bool attach) {
     CHECK_TRANSPORT();
-    log_->info("Initializing backend...");
+    log_->info(attach ? "Attaching to running target..." : "Initializing backend...");
 
     // Try to Wake DM
     log_->debug("Querying debug module status");
@@ -191,7 +451,7 @@ int Backend::initialize(bool quiet) {
 
     // Get platform info
     log_->debug("Fetching platform information...");
-    CHECK_ERR(fetch_platform_info(), "Failed to fetch platform info");
+    CHECK_ERR(fetch_platform_info(attach), "Failed to fetch platform info");
 
     log_->debug("Backend initialized!");
 
@@ -210,21 +470,24 @@ int Backend::initialize(bool quiet) {
 
 //----- Warp Control Methods ---------------------------------------------------
 int Backend::wake_dm() {  
-    // Check if ndmreset is set
-    uint32_t ndmreset = 0;
-    CHECK_ERR(dmreg_rdfield(DMReg_t::DCTRL, "ndmreset", ndmreset), "Failed to read DCTRL.ndmreset field");
+    // Check if ndmreset is set (one DCTRL read for both fields)
+    uint32_t dctrl = 0;
+    CHECK_ERR(dmreg_rd(DMReg_t::DCTRL, dctrl), "Failed to read DCTRL register");
+    uint32_t ndmreset = extract_dmreg_field(DMReg_t::DCTRL, "ndmreset", dctrl);
+    uint32_t dmactive = extract_dmreg_field(DMReg_t::DCTRL, "dmactive", dctrl);
     if (ndmreset) {
         // Wait for ndmreset to low
         log_->debug("Waiting for DCTRL.ndmreset to clear...");
         CHECK_ERR(dmreg_pollfield(DMReg_t::DCTRL, "ndmreset", 0, &ndmreset), "Failed to poll DCTRL.ndmreset field");
+        CHECK_ERR(dmreg_rdfield(DMReg_t::DCTRL, "dmactive", dmactive), "Failed to read DCTRL.dmactive field");
     }
 
     // Check if dm is active
-    uint32_t dmactive = 0;
-    CHECK_ERR(dmreg_rdfield(DMReg_t::DCTRL, "dmactive", dmactive), "Failed to read DCTRL.dmactive field");
     if (!dmactive) {
         // DM is not active, need to wake it up
         log_->debug("DM not active, Waking up DM by setting DCTRL.dmactive...");
+        dmreg_cache_invalidate();   // DM registers are reset while inactive
+        warpstate_invalidate();
         int dmwake_attempt_retries = DMWAKE_ATTEMPT_RETRIES;
         while(!dmactive && dmwake_attempt_retries-- > 0) {
             CHECK_ERR(dmreg_wrfield(DMReg_t::DCTRL, "dmactive", 1), 
@@ -246,6 +509,9 @@ int Backend::setup_dm() {
     // Enable ebreak halt for breakpoints
     CHECK_ERR(dmreg_wrfield(DMReg_t::DCONFIG, "ebreakh", 1), "Failed to set DCONFIG.ebreakh field");
 
+    // Give back borrowed registers while their thread is still selected
+    CHECK_ERR(_scratch_release(), "Failed to restore scratch registers");
+
     // Clear select register
     // - Selects warp 0, thread 0
     // - Select window 0
@@ -267,7 +533,8 @@ int Backend::reset_platform(bool halt_warps) {
         CHECK_ERR(dmreg_wrfield(DMReg_t::DCTRL, "resethaltreq", 1), "Failed to set DCTRL.resethaltreq field");
     }
 
-    // Issue reset
+    // Issue reset, saved scratch registers are lost with everything else
+    scratch_ = ScratchCtx_t();
     log_->debug("Setting DCTRL.ndmreset to initiate reset.");
     CHECK_ERR(dmreg_wrfield(DMReg_t::DCTRL, "ndmreset", 1), "Failed to set DCTRL.ndmreset field");
 
@@ -275,6 +542,10 @@ int Backend::reset_platform(bool halt_warps) {
     log_->debug("Waiting for reset to complete... (DCTRL.ndmreset to clear)");
     uint32_t ndmreset = 1;
     CHECK_ERR(dmreg_pollfield(DMReg_t::DCTRL, "ndmreset", 0, &ndmreset), "Failed to poll DCTRL.ndmreset field after reset");
+    dmreg_cache_invalidate();   // Reset clears DM selection/mask state
+    memcache_invalidate();
+    regcache_invalidate();
+    warpstate_invalidate();
 
     if(halt_warps) {
         WarpSummary_t wsummary;
@@ -297,7 +568,7 @@ int Backend::reset_platform(bool halt_warps) {
     return RCODE_OK;
 }
 
-int Backend::fetch_platform_info() {
+int Backend::fetch_platform_info(bool use_cache) {
     uint32_t platform = 0;
     log_->debug("Reading PLATFORM register to determine hardware parameters");
     CHECK_ERR(dmreg_rd(DMReg_t::PLATFORM, platform), "Failed to read PLATFORM register");
@@ -312,6 +583,18 @@ int Backend::fetch_platform_info() {
     state_.platinfo.num_total_warps = state_.platinfo.num_total_cores * state_.platinfo.num_warps;
     state_.platinfo.num_total_threads = state_.platinfo.num_total_warps * state_.platinfo.num_threads;
 
+    // Optional DM features (read-only DCONFIG bits, bypass the shadow copy)
+    uint32_t dconfig = 0;
+    CHECK_ERR(_dmreg_rd(DMReg_t::DCONFIG, dconfig, true), "Failed to read DCONFIG register");
+    state_.platinfo.has_wgather = extract_dmreg_field(DMReg_t::DCONFIG, "wgather", dconfig) != 0;
+    state_.platinfo.has_lanes   = extract_dmreg_field(DMReg_t::DCONFIG, "lanes", dconfig) != 0;
+
+    // Attaching: a persisted record for this platform spares halting warp 0
+    if (use_cache && _platform_cache_lookup(platform, state_.platinfo.misa)) {
+        log_->debug(strfmt("Using cached platform record for PLATFORM=0x%08x", platform));
+        return RCODE_OK;
+    }
+
     // Check if warps are active
     WarpSummary_t wsummary;
     CHECK_ERR(get_warp_summary(wsummary), "Failed to get warp active summary");
@@ -350,6 +633,7 @@ int Backend::fetch_platform_info() {
     uint32_t misa = 0;
     CHECK_ERR(read_csr(RV_CSR_MISA, misa), "Failed to read MISA CSR");
     state_.platinfo.misa = misa;
+    _platform_cache_store(platform, misa);
 
     if(!w0_is_halted) {
         // resume warp 0 if it was running before
@@ -363,6 +647,42 @@ int Backend::fetch_platform_info() {
     return RCODE_OK;
 }
 
+bool Backend::_platform_cache_lookup(uint32_t platform, uint32_t &misa) const {
+    std::string dir = get_cache_dir();
+    if (dir.empty())
+        return false;
+    std::ifstream ifs(dir + "/" PLATFORM_CACHE_FILE);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        unsigned plat = 0, value = 0;
+        if (std::sscanf(line.c_str(), "%x %x", &plat, &value) == 2 && plat == platform) {
+            misa = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Backend::_platform_cache_store(uint32_t platform, uint32_t misa) const {
+    std::string dir = get_cache_dir();
+    if (dir.empty())
+        return;
+    std::string path = dir + "/" PLATFORM_CACHE_FILE;
+
+    // Keep the records of other platforms, replace ours
+    std::string out;
+    std::ifstream ifs(path);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        unsigned plat = 0, value = 0;
+        if (std::sscanf(line.c_str(), "%x %x", &plat, &value) == 2 && plat != platform)
+            out += line + "\n";
+    }
+    out += strfmt("%08x %08x\n", platform, misa);
+    if (!write_file_atomic(path, out))
+        log_->warn("Failed to write platform cache " + path);
+}
+
 
 //----- Warp Selection ---------------------------------------------------------
 int Backend::select_warps(const std::vector<int> &wids) {
@@ -410,24 +730,29 @@ int Backend::select_warp_thread(int g_wid, int tid) {
         log_->error("Invalid thread ID " + std::to_string(tid));
         return RCODE_INVALID_ARG;
     }
-    // uint32_t dselect = 0;
-    // CHECK_ERR(dmreg_rd(DMReg_t::DSELECT, dselect), "Failed to read DSELECT register");
-    // dselect = set_dmreg_field(DMReg_t::DSELECT, "warpsel", dselect, g_wid);
-    // dselect = set_dmreg_field(DMReg_t::DSELECT, "threadsel", dselect, tid);
-    // CHECK_ERR(dmreg_wr(DMReg_t::DSELECT, dselect), "Failed to write DSELECT register");
+    if (scratch_.saved && (scratch_.wid != g_wid || scratch_.tid != tid))
+        CHECK_ERR(_scratch_release(), "Failed to restore scratch registers");
 
-    CHECK_ERR(dmreg_wrfield(DMReg_t::DSELECT, "warpsel", g_wid), "Failed to write DSELECT.warpsel field");
-    CHECK_ERR(dmreg_wrfield(DMReg_t::DSELECT, "threadsel", tid), "Failed to write DSELECT.threadsel field");
+    // Compose warpsel & threadsel into a single DSELECT write (read is served from shadow cache)
+    uint32_t dselect = 0;
+    CHECK_ERR(dmreg_rd(DMReg_t::DSELECT, dselect), "Failed to read DSELECT register");
+    dselect = set_dmreg_field(DMReg_t::DSELECT, "warpsel", dselect, g_wid);
+    dselect = set_dmreg_field(DMReg_t::DSELECT, "threadsel", dselect, tid);
+    CHECK_ERR(dmreg_wr(DMReg_t::DSELECT, dselect), "Failed to write DSELECT register");
 
     state_.selected_wid = g_wid;
     state_.selected_tid = tid;
     
     // Update cached PC for the newly selected warp
-    uint32_t pc;
-    get_warp_pc(pc);
-    (void)pc;
+    if (_warpsnap_usable(g_wid) && warpsnap_.has_pc && warpsnap_.is_halted(g_wid)) {
+        state_.selected_warp_pc = warpsnap_.pc[g_wid];
+    } else {
+        uint32_t pc;
+        get_warp_pc(pc);
+        (void)pc;
+    }
 
-    log_->debug("Selected warp " + std::to_string(g_wid) + ", thread " + std::to_string(tid) + " for debugging.");
+    LOG_DEBUG_LAZY(log_, "Selected warp " + std::to_string(g_wid) + ", thread " + std::to_string(tid) + " for debugging.");
     return RCODE_OK;
 }
 
@@ -448,48 +773,134 @@ int Backend::get_selected_warp_thread(int &wid, int &tid, bool force_fetch) {
 int Backend::get_warp_status(std::map<int, WarpStatus_t> &warp_status, bool include_pc, bool include_hacause) {
     warp_status.clear();
 
-    // Save current selection
-    int saved_wid = state_.selected_wid;
-    int saved_tid = state_.selected_tid;
+    const WarpStateSnapshot_t *snap = nullptr;
+    CHECK_ERRS(get_warp_snapshot(snap, include_pc, include_hacause));
+
+    for (int wid = 0; wid < static_cast<int>(state_.platinfo.num_total_warps); ++wid) {
+        bool active = snap->is_active(wid);
+        bool halted = snap->is_halted(wid);
+        uint32_t pc = include_pc ? snap->pc[wid] : 0xfafafafa;
+        uint32_t hacause = include_hacause ? snap->hacause[wid] : 0xfafafafa;
+        warp_status[wid] = {wid, active, halted, pc, hacause};
+    }
+    return RCODE_OK;
+}
+
+int Backend::get_warp_snapshot(const WarpStateSnapshot_t *&snap, bool include_pc, bool include_hacause) {
+    // Reuse the last sweep only if no warp can have changed state since
+    bool reuse = use_warp_snapshot_ && warpsnap_.valid && warpsnap_.generation == warpstate_gen_
+                 && warpsnap_.num_running == 0
+                 && (!include_pc || warpsnap_.has_pc) && (!include_hacause || warpsnap_.has_hacause);
+    if (!reuse) {
+        CHECK_ERRS(_warpsnap_refresh(include_pc, include_hacause));
+    }
+    snap = &warpsnap_;
+    return RCODE_OK;
+}
+
+void Backend::warpstate_invalidate() {
+    warpstate_gen_++;
+    warpsnap_.valid = false;
+}
+
+bool Backend::_warpsnap_usable(int wid) const {
+    if (!use_warp_snapshot_ || !warpsnap_.valid || warpsnap_.generation != warpstate_gen_)
+        return false;
+    // Halted warps stay halted until we resume them, everything else is
+    // stable only while no warp runs
+    return warpsnap_.is_halted(wid) || warpsnap_.num_running == 0;
+}
 
-    size_t num_wins = (state_.platinfo.num_total_warps + 31) / 32;
+int Backend::_warpsnap_refresh(bool include_pc, bool include_hacause) {
+    uint32_t num_warps = state_.platinfo.num_total_warps;
+    size_t num_wins = (num_warps + 31) / 32;
+    WarpStateSnapshot_t &snap = warpsnap_;
+    snap.valid = false;
+
+    // Fetch {WACTIVE, WSTATUS} of all windows in one batch
+    uint32_t dselect = 0;
+    CHECK_ERR(dmreg_rd(DMReg_t::DSELECT, dselect), "Failed to read DSELECT register");
+    const uint32_t saved_dselect = dselect;
+    std::vector<BatchOp_t> ops;
+    std::vector<uint32_t> results;
     for (size_t win=0; win < num_wins; ++win) {
-        // Select win
-        CHECK_ERR(dmreg_wrfield(DMReg_t::DSELECT, "winsel", win), "Failed to write DSELECT.winsel field");
+        dselect = set_dmreg_field(DMReg_t::DSELECT, "winsel", dselect, win);
+        _batch_wr(ops, DMReg_t::DSELECT, dselect);
+        _batch_rd(ops, DMReg_t::WACTIVE);
+        _batch_rd(ops, DMReg_t::WSTATUS);
+    }
+    CHECK_ERR(_dmreg_batch(ops, results), "Failed to read WACTIVE/WSTATUS registers");
 
-        // Read Wactive
-        uint32_t wactive = 0;
-        CHECK_ERR(dmreg_rd(DMReg_t::WACTIVE, wactive), "Failed to read WACTIVE register");
+    snap.active.assign(num_wins, 0);
+    snap.halted.assign(num_wins, 0);
+    snap.num_running = 0;
+    for (size_t win=0; win < num_wins; ++win) {
+        // Mask off bits past the last warp
+        uint32_t nbits = std::min<uint32_t>(32, num_warps - win * 32);
+        uint32_t valid_mask = nbits == 32 ? 0xFFFFFFFF : ((1u << nbits) - 1);
+        snap.active[win] = results[2 * win] & valid_mask;
+        snap.halted[win] = results[2 * win + 1] & valid_mask;
+        snap.num_running += __builtin_popcount(snap.active[win] & ~snap.halted[win]);
+    }
 
-        // Read WSTATUS
-        uint32_t wstatus = 0;
-        CHECK_ERR(dmreg_rd(DMReg_t::WSTATUS, wstatus), "Failed to read WSTATUS register");
-        
-        // Parse status bits
-        for (size_t bit=0; bit < 32; ++bit) {
-            int wid = win * 32 + bit;
-            if (wid >= static_cast<int>(state_.platinfo.num_total_warps))
-                break;
-            bool active = (wactive >> bit) & 0x1;
-            bool halted = (wstatus >> bit) & 0x1;
-            uint32_t pc = 0xfafafafa;
-            uint32_t hacause = 0xfafafafa;
-            if(include_pc && (!active || halted)) {
-                select_warp_thread(wid, 0);     // Changes current selection
-                CHECK_ERR(get_warp_pc(pc), "Failed to read PC for warp " + std::to_string(wid));
-            }
-            if(include_hacause && (!active || halted)) {
-                select_warp_thread(wid, 0);     // Changes current selection
-                CHECK_ERR(get_warp_hacause(hacause), "Failed to read HACAUSE for warp " + std::to_string(wid));
-            }
-            warp_status[wid] = {wid, active, halted, pc, hacause};
+    // Fetch PC/hacause of halted (or inactive) warps in a second batch
+    snap.pc.assign(num_warps, 0xfafafafa);
+    snap.hacause.assign(num_warps, 0xfafafafa);
+    if ((include_pc || include_hacause) && use_warp_gather_ && state_.platinfo.has_wgather) {
+        // Gather path: no warp re-selection, WGSEL advances on each WGCAUSE
+        // read so it is only written where the halted warp list has gaps
+        ops.clear();
+        std::vector<int> wids;
+        int next_wid = -1;
+        for (int wid = 0; wid < static_cast<int>(num_warps); ++wid) {
+            if (snap.is_active(wid) && !snap.is_halted(wid))
+                continue;
+            if (wid != next_wid)
+                _batch_wr(ops, DMReg_t::WGSEL, wid);
+            if (include_pc) _batch_rd(ops, DMReg_t::WGPC);
+            _batch_rd(ops, DMReg_t::WGCAUSE);
+            next_wid = wid + 1;
+            wids.push_back(wid);
+        }
+        if (!ops.empty()) {
+            CHECK_ERR(_dmreg_batch(ops, results), "Failed to gather PC/HACAUSE of halted warps");
+        }
+
+        size_t idx = 0;
+        for (int wid : wids) {
+            if (include_pc) snap.pc[wid] = results[idx++];
+            uint32_t wgcause = results[idx++];
+            if (include_hacause) snap.hacause[wid] = extract_dmreg_field(DMReg_t::WGCAUSE, "hacause", wgcause);
         }
     }
-    
-    // Restore original selection
-    if (saved_wid >= 0 && saved_tid >= 0) {
-        CHECK_ERR(select_warp_thread(saved_wid, saved_tid), "Failed to restore original warp/thread selection");
+    else if (include_pc || include_hacause) {
+        ops.clear();
+        std::vector<int> wids;
+        for (int wid = 0; wid < static_cast<int>(num_warps); ++wid) {
+            if (snap.is_active(wid) && !snap.is_halted(wid))
+                continue;
+            dselect = set_dmreg_field(DMReg_t::DSELECT, "warpsel", dselect, wid);
+            dselect = set_dmreg_field(DMReg_t::DSELECT, "threadsel", dselect, 0);
+            _batch_wr(ops, DMReg_t::DSELECT, dselect);
+            if (include_pc) _batch_rd(ops, DMReg_t::DPC);
+            if (include_hacause) _batch_rd(ops, DMReg_t::DCTRL);
+            wids.push_back(wid);
+        }
+        // Restore original selection
+        _batch_wr(ops, DMReg_t::DSELECT, saved_dselect);
+        CHECK_ERR(_dmreg_batch(ops, results), "Failed to read PC/HACAUSE of halted warps");
+
+        size_t idx = 0;
+        for (int wid : wids) {
+            if (include_pc) snap.pc[wid] = results[idx++];
+            if (include_hacause) snap.hacause[wid] = extract_dmreg_field(DMReg_t::DCTRL, "hacause", results[idx++]);
+        }
     }
+
+    snap.has_pc = include_pc;
+    snap.has_hacause = include_hacause;
+    snap.generation = warpstate_gen_;
+    snap.valid = true;
     return RCODE_OK;
 }
 
@@ -511,18 +922,11 @@ int Backend::get_warp_state(int g_wid, bool &active, bool &halted) {
         return RCODE_INVALID_ARG;
     }
 
-    int win_idx = g_wid / 32;
-    CHECK_ERR(dmreg_wrfield(DMReg_t::DSELECT, "winsel", win_idx), "Failed to write DSELECT.winsel field");
-
-    uint32_t wactive = 0;
-    CHECK_ERR(dmreg_rd(DMReg_t::WACTIVE, wactive), "Failed to read WACTIVE register");
-
-    uint32_t wstatus = 0;
-    CHECK_ERR(dmreg_rd(DMReg_t::WSTATUS, wstatus), "Failed to read WSTATUS register");
-    int bit_pos = g_wid % 32;
-
-    active = ((wactive >> bit_pos) & 0x1) ? true : false;
-    halted = ((wstatus >> bit_pos) & 0x1) ? true : false;
+    if (!_warpsnap_usable(g_wid)) {
+        CHECK_ERR(_warpsnap_refresh(false, false), "Failed to refresh warp state");
+    }
+    active = warpsnap_.is_active(g_wid);
+    halted = warpsnap_.is_halted(g_wid);
     return RCODE_OK;
 }
 
@@ -531,7 +935,7 @@ int Backend::get_warp_pc(uint32_t &pc) {
     CHECK_SELECTED();
     CHECK_ERR(dmreg_rd(DMReg_t::DPC, pc), "Failed to read DPC register");
     state_.selected_warp_pc = pc;
-    log_->debug(strfmt("Rd PC => 0x%08X", pc));
+    LOG_DEBUG_LAZY(log_, strfmt("Rd PC => 0x%08X", pc));
     return RCODE_OK;
 }
 
@@ -539,14 +943,16 @@ int Backend::set_warp_pc(const uint32_t pc) {
     CHECK_SELECTED();
     CHECK_ERR(dmreg_wr(DMReg_t::DPC, pc), "Failed to write DPC register");
     state_.selected_warp_pc = pc;
-    log_->debug(strfmt("Wr PC <= 0x%08X", pc));
+    if (warpsnap_.valid && warpsnap_.has_pc)
+        warpsnap_.pc[state_.selected_wid] = pc;
+    LOG_DEBUG_LAZY(log_, strfmt("Wr PC <= 0x%08X", pc));
     return RCODE_OK;
 }
 
 int Backend::get_warp_hacause(uint32_t &hacause) {
     CHECK_SELECTED();
     CHECK_ERR(dmreg_rdfield(DMReg_t::DCTRL, "hacause", hacause), "Failed to read HACAUSE register");
-    log_->debug(strfmt("Rd HACAUSE => 0x%08X", hacause));
+    LOG_DEBUG_LAZY(log_, strfmt("Rd HACAUSE => 0x%08X", hacause));
     return RCODE_OK;
 }
 
@@ -561,12 +967,16 @@ int Backend::halt_warps(const std::vector<int> &wids) {
 
     // Send halt request
     CHECK_ERR(dmreg_wrfield(DMReg_t::DCTRL, "haltreq", 1), "Failed to send halt request");
-       
+    warpstate_invalidate();
+
+    // Verify all warps against a single sweep
+    const WarpStateSnapshot_t *snap = nullptr;
+    CHECK_ERR(get_warp_snapshot(snap), "Failed to get warp state after halt request");
+
     bool ok = true;
     for (int wid : wids) {
-        bool warp_is_active = false;
-        bool warp_is_halted = false;
-        CHECK_ERR(get_warp_state(wid, warp_is_active, warp_is_halted), "Failed to get warp state after halt request");
+        bool warp_is_active = snap->is_active(wid);
+        bool warp_is_halted = snap->is_halted(wid);
         if (!warp_is_active) {
             log_->warn("Warp " + std::to_string(wid) + " not active after halt request");
             ok = false;
@@ -583,7 +993,7 @@ int Backend::halt_warps(const std::vector<int> &wids) {
         return RCODE_ERROR;
     }
 
-    log_->debug("Successfully halted warps: " + vecjoin<int>(wids, ", "));
+    LOG_DEBUG_LAZY(log_, "Successfully halted warps: " + vecjoin<int>(wids, ", "));
     return RCODE_OK;
 }
 
@@ -595,6 +1005,7 @@ int Backend::halt_warps() {
     
     // Send halt request
     CHECK_ERR(dmreg_wrfield(DMReg_t::DCTRL, "haltreq", 1), "Failed to send halt request");
+    warpstate_invalidate();
 
     // Poll until all warps halted
     uint32_t allhalted;
@@ -609,22 +1020,27 @@ int Backend::halt_warps() {
 
 int Backend::resume_warps(const std::vector<int> &wids) {
     log_->info("Resuming warps: " + vecjoin<int>(wids));
+    CHECK_ERRS(commit_breakpoints());
+    CHECK_ERR(_scratch_release(), "Failed to restore scratch registers");
     
     // Select the specified warps
     CHECK_ERR(select_warps(wids), "Failed to select warps for resuming");
+    memcache_invalidate();
+    for (int wid : wids)
+        regcache_invalidate(wid);
 
     // Send resume request
     CHECK_ERR(dmreg_wrfield(DMReg_t::DCTRL, "resumereq", 1), "Failed to send resume request");
+    warpstate_invalidate();
 
-    // Check if given warps are running
-    std::map<int, WarpStatus_t> warp_status;
-    CHECK_ERR(get_warp_status(warp_status, false), "Failed to get warp status after resume request");     // also updates the halted_cache
+    // Check if given warps are running, all against a single sweep
+    const WarpStateSnapshot_t *snap = nullptr;
+    CHECK_ERR(get_warp_snapshot(snap), "Failed to get warp state after resume request");
 
     bool ok = true;
     for (int wid : wids) {
-        bool warp_is_active = false;
-        bool warp_is_halted = false;
-        CHECK_ERR(get_warp_state(wid, warp_is_active, warp_is_halted), "Failed to get warp state after resume request");
+        bool warp_is_active = snap->is_active(wid);
+        bool warp_is_halted = snap->is_halted(wid);
         if (!warp_is_active) {
             log_->warn("Warp " + std::to_string(wid) + " not active after resume request");
             ok = false;
@@ -639,18 +1055,23 @@ int Backend::resume_warps(const std::vector<int> &wids) {
         log_->warn("Some warps failed to resume");
         return RCODE_ERROR;
     }
-    log_->debug("Successfully resumed warps: " + vecjoin<int>(wids, ", "));
+    LOG_DEBUG_LAZY(log_, "Successfully resumed warps: " + vecjoin<int>(wids, ", "));
     return RCODE_OK;
 }
 
 int Backend::resume_warps() {
     log_->info("Resuming all warps");
+    CHECK_ERRS(commit_breakpoints());
+    CHECK_ERR(_scratch_release(), "Failed to restore scratch registers");
     
     // Select all warps
     CHECK_ERR(select_warps(true), "Failed to select all warps for resuming");
+    memcache_invalidate();
+    regcache_invalidate();
 
     // Send resume request
     CHECK_ERR(dmreg_wrfield(DMReg_t::DCTRL, "resumereq", 1), "Failed to send resume request");
+    warpstate_invalidate();
 
     // Poll until all warps running
     uint32_t allrunning;
@@ -661,33 +1082,248 @@ int Backend::resume_warps() {
 }
 
 int Backend::step_warp() {
+    uint32_t nsteps = 0;
+    CHECK_ERRS(step_warp(1, nsteps));
+    log_->info(strfmt("Stepped warp %d to PC=0x%08X", state_.selected_wid, state_.selected_warp_pc));
+    return RCODE_OK;
+}
+
+int Backend::step_warp(uint32_t count, uint32_t &nsteps, InstrTrace *trace) {
+    nsteps = 0;
     CHECK_SELECTED();
     CHECK_HALTED();
 
+    // Checks done once for the whole run
     WarpSummary_t wsummary;
     CHECK_ERR(get_warp_summary(wsummary), "Failed to get warp summary before stepping");
     if (wsummary.allhalted) log_->warn("All warps are halted, Stepping a warp may cause deadlock.");
+    CHECK_ERRS(commit_breakpoints());
+    CHECK_ERR(_scratch_release(), "Failed to restore scratch registers");
+    memcache_invalidate();
+    regcache_invalidate(state_.selected_wid);
+    warpstate_invalidate();
+
+    uint32_t dctrl_stepreq = 0, dctrl_injectreq = 0;
+    CHECK_ERRS(_get_dctrl_req("stepreq", dctrl_stepreq));
+    CHECK_ERRS(_get_dctrl_inject(dctrl_injectreq));
+    const size_t nregs = trace ? trace->regs().size() : 0;
+    if (trace)
+        trace->reserve(trace->size() + count);
+
+    // Stopping on a breakpoint needs each PC before the next step is issued
+    bool any_bp = false;
+    for (const auto &bp : breakpoints_)
+        any_bp |= bp.second.enabled;
+    const uint32_t batch_sz = any_bp ? 1 : STEP_BATCH_SZ;
+
+    // Per step: stepreq, poll stepstate, DPC, then csrw dscratch + DSCRATCH per
+    // traced register. The only round trips are the polls.
+    std::vector<BatchOp_t> ops;
+    std::vector<uint32_t> results;
+    std::vector<uint32_t> values(nregs, 0);
+    uint32_t pc = state_.selected_warp_pc;
+    while (nsteps < count) {
+        uint32_t n = std::min(batch_sz, count - nsteps);
+        ops.clear();
+        for (uint32_t i = 0; i < n; ++i) {
+            ops.push_back(BatchOp_t::wr(get_dmreg(DMReg_t::DCTRL).addr, dctrl_stepreq));
+            _batch_pollfield(ops, DMReg_t::DCTRL, "stepstate", 0);
+            _batch_rd(ops, DMReg_t::DPC);
+            for (size_t r = 0; r < nregs; ++r) {
+                _batch_inject(ops, rv_csrw(RV_CSR_VX_DSCRATCH, trace->regs()[r]), dctrl_injectreq);
+                _batch_rd(ops, DMReg_t::DSCRATCH);
+            }
+        }
+        CHECK_ERR(_dmreg_batch(ops, results), strfmt("Failed to step warp %d (after %u steps)", state_.selected_wid, nsteps));
+
+        size_t idx = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            idx++;      // stepstate
+            pc = results[idx++];
+            for (size_t r = 0; r < nregs; ++r) {
+                idx++;  // injectstate
+                values[r] = results[idx++];
+            }
+            if (trace)
+                trace->append(pc, values.data());
+        }
+        nsteps += n;
+        state_.selected_warp_pc = pc;
+        if (any_bp) {
+            auto it = breakpoints_.find(pc);
+            if (it != breakpoints_.end() && it->second.enabled) {
+                if (nsteps < count)
+                    log_->info(strfmt("Stepping stopped at breakpoint 0x%08X after %u steps", pc, nsteps));
+                break;
+            }
+        }
+    }
+    LOG_DEBUG_LAZY(log_, strfmt("Stepped warp %d %u times to PC=0x%08X", state_.selected_wid, nsteps, pc));
+    return RCODE_OK;
+}
 
-    // Send step request
-    CHECK_ERR(dmreg_wrfield(DMReg_t::DCTRL, "stepreq", 1), "Failed to send step request");
+int Backend::_step_selected(uint32_t &pc) {
+    CHECK_ERR(_scratch_release(), "Failed to restore scratch registers");
+    memcache_invalidate();
+    regcache_invalidate(state_.selected_wid);
+
+    // Step request, completion poll and PC read in one batch
+    uint32_t dctrl_stepreq = 0;
+    CHECK_ERRS(_get_dctrl_req("stepreq", dctrl_stepreq));
+    std::vector<BatchOp_t> ops;
+    std::vector<uint32_t> results;
+    ops.push_back(BatchOp_t::wr(get_dmreg(DMReg_t::DCTRL).addr, dctrl_stepreq));
+    _batch_pollfield(ops, DMReg_t::DCTRL, "stepstate", 0);
+    _batch_rd(ops, DMReg_t::DPC);
+    warpstate_invalidate();
+    CHECK_ERR(_dmreg_batch(ops, results), "Failed to step warp");
+    pc = results[1];
+    state_.selected_warp_pc = pc;
+    return RCODE_OK;
+}
 
-    // Poll for step completion
-    uint32_t stepstate;
-    CHECK_ERR(dmreg_pollfield(DMReg_t::DCTRL, "stepstate", 0, &stepstate), "Failed to poll step state");    
-    
-    // Read updated PC
-    uint32_t warp_pc;
-    CHECK_ERR(dmreg_rd(DMReg_t::DPC, warp_pc), "Failed to read DPC register after step");
-    log_->info(strfmt("Stepped warp %d to PC=0x%08X", state_.selected_wid, warp_pc));
-    state_.selected_warp_pc = warp_pc;
-    
+int Backend::sample_pcs(bool halting, std::vector<PcSample_t> &samples) {
+    CHECK_TRANSPORT();
+    if (!halting && !has_warp_gather()) {
+        log_->error("Sampling running warps without halting needs the warp gather registers");
+        return RCODE_ERROR;
+    }
+    const uint32_t num_warps = state_.platinfo.num_total_warps;
+    const size_t num_wins = (num_warps + 31) / 32;
+    std::vector<BatchOp_t> &ops = sample_ops_;
+    std::vector<uint32_t> &results = sample_results_;
+    std::vector<uint32_t> &running = sample_running_;
+
+    // Window sweep; without halting the PC of every warp rides along in the
+    // same batch (WGSEL advances on each WGCAUSE read, so it is written once)
+    uint32_t dselect = 0;
+    CHECK_ERR(dmreg_rd(DMReg_t::DSELECT, dselect), "Failed to read DSELECT register");
+    const uint32_t saved_dselect = dselect;
+    ops.clear();
+    for (size_t win = 0; win < num_wins; ++win) {
+        dselect = set_dmreg_field(DMReg_t::DSELECT, "winsel", dselect, win);
+        _batch_wr(ops, DMReg_t::DSELECT, dselect);
+        _batch_rd(ops, DMReg_t::WACTIVE);
+        _batch_rd(ops, DMReg_t::WSTATUS);
+    }
+    if (!halting) {
+        _batch_wr(ops, DMReg_t::WGSEL, 0);
+        for (uint32_t wid = 0; wid < num_warps; ++wid) {
+            _batch_rd(ops, DMReg_t::WGPC);
+            _batch_rd(ops, DMReg_t::WGCAUSE);
+        }
+        _batch_wr(ops, DMReg_t::DSELECT, saved_dselect);
+    }
+    CHECK_ERR(_dmreg_batch(ops, results), "Failed to sample warp PCs");
+
+    running.assign(num_wins, 0);
+    bool any_running = false;
+    for (size_t win = 0; win < num_wins; ++win) {
+        uint32_t nbits = std::min<uint32_t>(32, num_warps - win * 32);
+        uint32_t valid_mask = nbits == 32 ? 0xFFFFFFFF : ((1u << nbits) - 1);
+        running[win] = results[2 * win] & ~results[2 * win + 1] & valid_mask;
+        any_running |= running[win] != 0;
+    }
+    if (!halting) {
+        for (uint32_t wid = 0; wid < num_warps; ++wid) {
+            if ((running[wid / 32] >> (wid % 32)) & 0x1)
+                samples.push_back({wid, results[2 * num_wins + 2 * wid]});
+        }
+        return RCODE_OK;
+    }
+    if (!any_running)
+        return RCODE_OK;
+
+    // Halt the running warps and read their PCs and halt causes in one batch.
+    // Only warps the second sweep shows halted are sampled.
+    uint32_t dctrl_haltreq = 0, dctrl_resumereq = 0;
+    CHECK_ERRS(_get_dctrl_req("haltreq", dctrl_haltreq));
+    CHECK_ERRS(_get_dctrl_req("resumereq", dctrl_resumereq));
+    ops.clear();
+    for (size_t win = 0; win < num_wins; ++win) {
+        dselect = set_dmreg_field(DMReg_t::DSELECT, "winsel", dselect, win);
+        _batch_wr(ops, DMReg_t::DSELECT, dselect);
+        _batch_wr(ops, DMReg_t::WMASK, running[win]);
+    }
+    ops.push_back(BatchOp_t::wr(get_dmreg(DMReg_t::DCTRL).addr, dctrl_haltreq));
+    for (size_t win = 0; win < num_wins; ++win) {
+        dselect = set_dmreg_field(DMReg_t::DSELECT, "winsel", dselect, win);
+        _batch_wr(ops, DMReg_t::DSELECT, dselect);
+        _batch_rd(ops, DMReg_t::WSTATUS);
+    }
+    int next_wid = -1;
+    for (uint32_t wid = 0; wid < num_warps; ++wid) {
+        if (!((running[wid / 32] >> (wid % 32)) & 0x1))
+            continue;
+        if (has_warp_gather()) {
+            if (static_cast<int>(wid) != next_wid)
+                _batch_wr(ops, DMReg_t::WGSEL, wid);
+            _batch_rd(ops, DMReg_t::WGPC);
+            _batch_rd(ops, DMReg_t::WGCAUSE);
+            next_wid = wid + 1;
+        } else {
+            dselect = set_dmreg_field(DMReg_t::DSELECT, "warpsel", dselect, wid);
+            dselect = set_dmreg_field(DMReg_t::DSELECT, "threadsel", dselect, 0);
+            _batch_wr(ops, DMReg_t::DSELECT, dselect);
+            _batch_rd(ops, DMReg_t::DPC);
+            _batch_rd(ops, DMReg_t::DCTRL);
+        }
+    }
+    warpstate_invalidate();
+    CHECK_ERR(_dmreg_batch(ops, results), "Failed to sample warp PCs");
+
+    // Resume only the warps this haltreq stopped: a warp that hit a breakpoint
+    // or ebreak in the meantime stays halted for the debugger. Warps not yet
+    // seen halted are resumed too, so that the pending haltreq does not stick.
+    std::vector<uint32_t> resume(running);
+    size_t idx = num_wins;
+    for (uint32_t wid = 0; wid < num_warps; ++wid) {
+        if (!((running[wid / 32] >> (wid % 32)) & 0x1))
+            continue;
+        uint32_t pc = results[idx];
+        uint32_t hacause = has_warp_gather() ? extract_dmreg_field(DMReg_t::WGCAUSE, "hacause", results[idx + 1])
+                                             : extract_dmreg_field(DMReg_t::DCTRL, "hacause", results[idx + 1]);
+        idx += 2;
+        if (!((results[wid / 32] >> (wid % 32)) & 0x1))
+            continue;
+        samples.push_back({wid, pc});
+        if (hacause != 0x2) {
+            resume[wid / 32] &= ~(1u << (wid % 32));
+            LOG_DEBUG_LAZY(log_, strfmt("Warp %u stopped on its own (%s) while sampling, left halted", wid,
+                                        hacause_tostr(hacause).c_str()));
+        }
+    }
+
+    ops.clear();
+    for (size_t win = 0; win < num_wins; ++win) {
+        dselect = set_dmreg_field(DMReg_t::DSELECT, "winsel", saved_dselect, win);
+        _batch_wr(ops, DMReg_t::DSELECT, dselect);
+        _batch_wr(ops, DMReg_t::WMASK, resume[win]);
+    }
+    ops.push_back(BatchOp_t::wr(get_dmreg(DMReg_t::DCTRL).addr, dctrl_resumereq));
+    _batch_wr(ops, DMReg_t::DSELECT, saved_dselect);
+    CHECK_ERR(_dmreg_batch(ops, results), "Failed to resume sampled warps");
     return RCODE_OK;
 }
 
 int Backend::inject_instruction(uint32_t instruction) {
     // NOTE: Caller must make sure a warp/thread is selected and halted
+    ScopedLatency lat(stats_.inject);
+
+    if (pipeline_window_ > 0) {
+        // Batched: {DINJECT write, injectreq write, poll injectstate}
+        uint32_t dctrl_injectreq = 0;
+        CHECK_ERR(_get_dctrl_inject(dctrl_injectreq), "Failed to read DCTRL register");
+        std::vector<BatchOp_t> ops;
+        std::vector<uint32_t> results;
+        _batch_inject(ops, instruction, dctrl_injectreq);
+        CHECK_ERR(_dmreg_batch(ops, results), "Failed to inject instruction");
+        LOG_DEBUG_LAZY(log_, strfmt("Injected instr (wid: %d, tid: %d): 0x%08X", state_.selected_wid, state_.selected_tid, instruction));
+        return RCODE_OK;
+    }
 
     // Write instruction to DINJECT register
+    stats_.injects.add();
     CHECK_ERR(dmreg_wr(DMReg_t::DINJECT, instruction), 
         "Failed to write instruction to DINJECT register");
     
@@ -699,13 +1335,19 @@ int Backend::inject_instruction(uint32_t instruction) {
     uint32_t inject_state;
     CHECK_ERR(dmreg_pollfield(DMReg_t::DCTRL, "injectstate", 0x0, &inject_state), "Failed to poll injection state");
         
-    log_->debug(strfmt("Injected instr (wid: %d, tid: %d): 0x%08X", state_.selected_wid, state_.selected_tid, instruction));
+    LOG_DEBUG_LAZY(log_, strfmt("Injected instr (wid: %d, tid: %d): 0x%08X", state_.selected_wid, state_.selected_tid, instruction));
     return RCODE_OK;
 }
 
 int Backend::inject_instruction(const std::string &asm_instr) {
     // Assemble instruction
-    auto instrs = rv_asm({asm_instr});
+    std::vector<uint32_t> instrs;
+    try {
+        instrs = rv_asm({asm_instr});
+    } catch (const std::exception& e) {
+        log_->error("Failed to assemble instruction: " + std::string(e.what()));
+        return RCODE_ERROR;
+    }
     if (instrs.size() != 1) {
         log_->error("Failed to assemble instruction: " + asm_instr);
         return RCODE_ERROR;
@@ -715,126 +1357,506 @@ int Backend::inject_instruction(const std::string &asm_instr) {
     return RCODE_OK;
 }
 
+int Backend::restore_scratch() {
+    return _scratch_release();
+}
+
 
 // ----- Platform Query/Update Methods -----------------------------------------
 
 int Backend::read_gpr(const uint32_t regnum, uint32_t &value) {
     value = 0xfafafafa;
     CHECK_SELECTED();
+    if (regnum >= 32) {
+        log_->error("Invalid GPR number " + std::to_string(regnum));
+        return RCODE_INVALID_ARG;
+    }
+
+    // Snapshots only exist for halted warps
+    RegSnapshot_t *snap = _regsnap();
+    if (snap && (snap->gpr_valid >> regnum) & 1) {
+        value = snap->gpr[regnum];
+        return RCODE_OK;
+    }
+    if (_scratch_holds(regnum)) {
+        value = scratch_.value[regnum];
+        return RCODE_OK;
+    }
     CHECK_HALTED();
 
-    // move arch reg to dscratch: REG[i] -csrw-> dscratch
-    CHECK_ERR(inject_instruction(strfmt("csrw %d, x%d", RV_CSR_VX_DSCRATCH, regnum)), "Failed to move arch reg to dscratch");
-    // read reg value from dscratch
-    CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, value), "Failed to obtain GPR value from DSCRATCH");
-    log_->debug(strfmt("Rd GPR[x%d] => 0x%08X", regnum, value));
+    if (snap && pipeline_window_ > 0) {
+        // Capture the whole register file, the next reads are free
+        std::vector<uint32_t> values;
+        CHECK_ERRS(read_gprs(values));
+        value = values[regnum];
+        return RCODE_OK;
+    }
+
+    if (pipeline_window_ > 0) {
+        // Single batch: inject csrw, poll completion, read dscratch
+        uint32_t dctrl_injectreq = 0;
+        CHECK_ERR(_get_dctrl_inject(dctrl_injectreq), "Failed to read DCTRL register");
+        std::vector<BatchOp_t> ops;
+        std::vector<uint32_t> results;
+        _batch_inject(ops, rv_csrw(RV_CSR_VX_DSCRATCH, regnum), dctrl_injectreq);
+        _batch_rd(ops, DMReg_t::DSCRATCH);
+        CHECK_ERR(_dmreg_batch(ops, results), "Failed to read GPR through DSCRATCH");
+        value = results.back();
+    } else {
+        // move arch reg to dscratch: REG[i] -csrw-> dscratch
+        CHECK_ERR(inject_instruction(rv_csrw(RV_CSR_VX_DSCRATCH, regnum)), "Failed to move arch reg to dscratch");
+        // read reg value from dscratch
+        CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, value), "Failed to obtain GPR value from DSCRATCH");
+    }
+    if (snap) {
+        snap->gpr[regnum] = value;
+        snap->gpr_valid |= 1u << regnum;
+    }
+    LOG_DEBUG_LAZY(log_, strfmt("Rd GPR[x%d] => 0x%08X", regnum, value));
     return RCODE_OK;
 }
 
-int Backend::write_gpr(const uint32_t regnum, const uint32_t value) {
+int Backend::read_gprs(std::vector<uint32_t> &values) {
+    values.assign(32, 0);
     CHECK_SELECTED();
+
+    RegSnapshot_t *snap = _regsnap();
+    if (snap && snap->gpr_valid == 0xffffffff) {
+        values.assign(snap->gpr, snap->gpr + 32);
+        return RCODE_OK;
+    }
     CHECK_HALTED();
 
-    // move value to dscratch: dbg(value) --> dscratch
-    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value), "Failed to write DSCRATCH register");
-    // move dscratch to arch reg: dscratch -csrr-> REG[i]
-    CHECK_ERR(inject_instruction(strfmt("csrr x%d, %d", regnum, RV_CSR_VX_DSCRATCH)), "Failed to move dscratch to GPR");
-    log_->debug(strfmt("Wr GPR[x%d] <= 0x%08X", regnum, value));
+    if (pipeline_window_ == 0 || _read_gprs_streamed(values.data()) != RCODE_OK) {
+        if (pipeline_window_ > 0)
+            log_->warn("Streamed GPR read failed, retrying in blocking mode");
+        // Blocking fallback, one register at a time
+        if (snap) snap->gpr_valid = 0;
+        for (uint32_t i = 0; i < 32; ++i) {
+            CHECK_ERR(read_gpr(i, values[i]), "Failed to read GPR x" + std::to_string(i));
+        }
+        return RCODE_OK;
+    }
+    if (snap) {
+        std::copy(values.begin(), values.end(), snap->gpr);
+        snap->gpr_valid = 0xffffffff;
+    }
+    log_->debug("Rd GPR[x0-x31] (streamed)");
     return RCODE_OK;
 }
 
-// Get the CSR register value
-int Backend::read_csr(const uint32_t regaddr, uint32_t &value) {
-    CHECK_SELECTED();
-    CHECK_HALTED();
+int Backend::_read_gprs_streamed(uint32_t *values) {
+    uint32_t dctrl_injectreq = 0;
+    CHECK_ERRS(_get_dctrl_inject(dctrl_injectreq));
 
-    // save t0: t0 -csrw-> dscratch --> dbg (t0_val)
-    uint32_t t0_val = 0;
-    CHECK_ERR(inject_instruction(strfmt("csrw %d, t0", RV_CSR_VX_DSCRATCH)), "Failed to save t0 to DSCRATCH");          // TODO: if any subsequent inject fails, fn returns without restoring t0 --> need RAII guard
-    CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, t0_val), "Failed to obtain t0 value from DSCRATCH");
-    // move csr to dscratch through t0: csr -csrr-> t0 ; t0 -csrw-> dscratch
-    CHECK_ERR(inject_instruction(strfmt("csrr t0, %d", regaddr)), "Failed to read CSR into t0");
-    CHECK_ERR(inject_instruction(strfmt("csrw %d, t0", RV_CSR_VX_DSCRATCH)), "Failed to write t0 to DSCRATCH");
-    // read csr value from dscratch: dscratch -dbg-> value
-    CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, value), "Failed to obtain CSR value from DSCRATCH");
-    // restore t0: dbg(t0_val) --> dscratch -csrr-> t0
-    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, t0_val), "Failed to restore t0 value to DSCRATCH");
-    CHECK_ERR(inject_instruction(strfmt("csrr t0, %d", RV_CSR_VX_DSCRATCH)), "Failed to restore t0 from DSCRATCH");
-    log_->debug(strfmt("Rd CSR[0x%03X] => 0x%08X", regaddr, value));
+    // x0 is hardwired
+    values[0] = 0;
+    std::vector<uint32_t> dctrl_after(32, 0);
+    for (uint32_t i = 1; i < 32; ++i) {
+        _queue_inject(rv_csrw(RV_CSR_VX_DSCRATCH, i), dctrl_injectreq, &dctrl_after[i]);
+        _dmreg_queue_rd(DMReg_t::DSCRATCH, &values[i]);
+    }
+    CHECK_ERRS(_dmreg_flush());
+
+    for (uint32_t v : dctrl_after) {
+        if (extract_dmreg_field(DMReg_t::DCTRL, "injectstate", v) != 0) {
+            log_->debug("Streamed injection did not complete in time");
+            return RCODE_TIMEOUT;
+        }
+    }
+    // The thread holds scratch values, report the saved ones
+    for (uint32_t r = 1; r < 32; ++r) {
+        if (_scratch_holds(r))
+            values[r] = scratch_.value[r];
+    }
     return RCODE_OK;
 }
 
-// Set the CSR register value
-int Backend::write_csr(const uint32_t regaddr, const uint32_t value) {
+int Backend::read_gpr_lanes(const uint32_t regnum, std::vector<uint32_t> &values) {
+    const uint32_t nthreads = state_.platinfo.num_threads;
+    values.assign(nthreads, 0);
     CHECK_SELECTED();
+    if (regnum >= 32) {
+        log_->error("Invalid GPR number " + std::to_string(regnum));
+        return RCODE_INVALID_ARG;
+    }
+    const int wid = state_.selected_wid;
+
+    // Nothing to do if every lane has it in its snapshot
+    bool all_cached = use_reg_cache_;
+    for (uint32_t tid = 0; all_cached && tid < nthreads; ++tid) {
+        auto it = regsnap_.find(wid * nthreads + tid);
+        all_cached = it != regsnap_.end() && (it->second.gpr_valid >> regnum) & 1;
+        if (all_cached)
+            values[tid] = it->second.gpr[regnum];
+    }
+    if (all_cached)
+        return RCODE_OK;
     CHECK_HALTED();
 
-    // save t0: t0 -csrw-> dscratch --> dbg (t0_val)
-    uint32_t t0_val = 0;
-    CHECK_ERR(inject_instruction(strfmt("csrw %d, t0", RV_CSR_VX_DSCRATCH)), "Failed to save t0 to DSCRATCH");          // TODO: if any subsequent inject fails, fn returns without restoring t0 --> need RAII guard
-    CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, t0_val), "Failed to obtain t0 value from DSCRATCH");
-    // move value to dscratch: dbg(value) --> dscratch
-    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value), "Failed to write value to DSCRATCH");
-    // move dscratch to csr through t0: dscratch -csrr-> t0 ; t0 -csrw-> csr
-    CHECK_ERR(inject_instruction(strfmt("csrr t0, %d", RV_CSR_VX_DSCRATCH)), "Failed to read DSCRATCH into t0");
-    CHECK_ERR(inject_instruction(strfmt("csrw %d, t0", regaddr)), "Failed to write t0 to CSR");
-    // restore t0: dbg(t0_val) --> dscratch -csrr-> t0
-    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, t0_val), "Failed to restore t0 value to DSCRATCH");
-    CHECK_ERR(inject_instruction(strfmt("csrr t0, %d", RV_CSR_VX_DSCRATCH)), "Failed to restore t0 from DSCRATCH");
-    log_->debug(strfmt("Wr CSR[0x%03X] <= 0x%08X", regaddr, value));
+    if (!has_lane_access() || pipeline_window_ == 0) {
+        // One thread at a time
+        const int sel_tid = state_.selected_tid;
+        for (uint32_t tid = 0; tid < nthreads; ++tid) {
+            CHECK_ERR(select_warp_thread(wid, tid), "Failed to select thread " + std::to_string(tid));
+            CHECK_ERR(read_gpr(regnum, values[tid]), strfmt("Failed to read GPR x%d of thread %d", regnum, tid));
+        }
+        CHECK_ERR(select_warp_thread(wid, sel_tid), "Failed to restore previously selected thread");
+        return RCODE_OK;
+    }
+
+    // Single batch: warp-wide csrw, then sweep the lanes' dscratch
+    uint32_t dctrl_injectreq = 0, dconfig_on = 0, dconfig_off = 0;
+    CHECK_ERR(_get_dctrl_inject(dctrl_injectreq), "Failed to read DCTRL register");
+    CHECK_ERR(_get_dconfig_warpinj(dconfig_on, dconfig_off), "Failed to read DCONFIG register");
+    std::vector<BatchOp_t> ops;
+    std::vector<uint32_t> results;
+    _batch_wr(ops, DMReg_t::DCONFIG, dconfig_on);
+    _batch_inject(ops, rv_csrw(RV_CSR_VX_DSCRATCH, regnum), dctrl_injectreq);
+    _batch_wr(ops, DMReg_t::DCONFIG, dconfig_off);
+    _batch_lanes_rd(ops, nthreads);
+    CHECK_ERR(_lanes_batch(ops, results, dconfig_off), "Failed to read GPR through LSCRATCH");
+    std::copy(results.end() - nthreads, results.end(), values.begin());
+
+    for (uint32_t tid = 0; tid < nthreads; ++tid) {
+        // The thread holding scratch values reports the saved one
+        if (scratch_.wid == wid && scratch_.tid == static_cast<int>(tid) && (scratch_.saved >> regnum) & 1)
+            values[tid] = scratch_.value[regnum];
+        if (use_reg_cache_) {
+            RegSnapshot_t &snap = regsnap_[wid * nthreads + tid];
+            snap.gpr[regnum] = values[tid];
+            snap.gpr_valid |= 1u << regnum;
+        }
+    }
+    LOG_DEBUG_LAZY(log_, strfmt("Rd GPR[x%d] of %u lanes (warp %d)", regnum, nthreads, wid));
     return RCODE_OK;
 }
 
-int Backend::read_reg(const std::string &reg_name, uint32_t &value) {
-    auto regtype = rvreg_gettype(reg_name);
-    if (regtype == RVRegType_t::GPR) {
-        uint32_t regnum = rvgpr_name2num(reg_name);
-        CHECK_ERR(read_gpr(regnum, value), "Failed to read GPR " + reg_name);
-        return RCODE_OK;
+int Backend::read_csrs(const std::vector<uint32_t> &regaddrs, std::vector<uint32_t> &values) {
+    values.assign(regaddrs.size(), 0);
+    CHECK_SELECTED();
+
+    // Collect snapshot misses
+    RegSnapshot_t *snap = _regsnap();
+    std::vector<uint32_t> misses;
+    for (size_t i = 0; i < regaddrs.size(); ++i) {
+        if (snap) {
+            auto it = snap->csrs.find(regaddrs[i]);
+            if (it != snap->csrs.end()) {
+                values[i] = it->second;
+                continue;
+            }
+        }
+        misses.push_back(regaddrs[i]);
     }
-    else if (regtype == RVRegType_t::CSR) {
-        uint32_t csraddr = rvcsr_name2addr(reg_name);
-        CHECK_ERR(read_csr(csraddr, value), "Failed to read CSR " + reg_name);
+    if (misses.empty())
         return RCODE_OK;
+    CHECK_HALTED();
+
+    std::vector<uint32_t> fetched(misses.size(), 0);
+    bool done = false;
+    if (pipeline_window_ > 0 && misses.size() > 1) {
+        ScratchGuard scratch(*this, SCRATCH_T0);
+        CHECK_ERR(scratch.rc(), "Failed to save t0");
+        if (_read_csrs_streamed(misses, fetched.data()) == RCODE_OK) {
+            done = true;
+            scratch.done();
+        } else {
+            log_->warn("Streamed CSR read failed, retrying in blocking mode");
+        }
     }
-    else if (reg_name == "pc") {
-        CHECK_ERR(get_warp_pc(value), "Failed to read PC register");
-        return RCODE_OK;
+    for (size_t i = 0; !done && i < misses.size(); ++i) {
+        CHECK_ERR(read_csr(misses[i], fetched[i]), strfmt("Failed to read CSR 0x%03X", misses[i]));
     }
-    else {
-        log_->error("Unknown register name: " + reg_name);
-        return RCODE_INVALID_ARG;
+
+    // Merge fetched values
+    for (size_t i = 0, m = 0; i < regaddrs.size() && m < misses.size(); ++i) {
+        if (regaddrs[i] != misses[m])
+            continue;
+        values[i] = fetched[m];
+        if (snap && done && !rvcsr_is_volatile(misses[m]))
+            snap->csrs[misses[m]] = fetched[m];
+        m++;
     }
     return RCODE_OK;
 }
 
-// Write processor register
-int Backend::write_reg(const std::string &reg_name, uint32_t value) {
-    auto regtype = rvreg_gettype(reg_name);
-    if (regtype == RVRegType_t::GPR) {
-        uint32_t regnum = rvgpr_name2num(reg_name);
-        CHECK_ERR(write_gpr(regnum, value), "Failed to write GPR " + reg_name);
-        return RCODE_OK;
-    }
-    else if (regtype == RVRegType_t::CSR) {
-        uint32_t csraddr = rvcsr_name2addr(reg_name);
-        CHECK_ERR(write_csr(csraddr, value), "Failed to write CSR " + reg_name);
-        return RCODE_OK;
-    }
-    else if (reg_name == "pc") {
-        CHECK_ERR(set_warp_pc(value), "Failed to write PC register");
-        return RCODE_OK;
+int Backend::_read_csrs_streamed(const std::vector<uint32_t> &regaddrs, uint32_t *values) {
+    uint32_t dctrl_injectreq = 0;
+    CHECK_ERRS(_get_dctrl_inject(dctrl_injectreq));
+
+    // csr -csrr-> t0 -csrw-> dscratch -dbg-> value, for each csr (t0 is held as scratch)
+    constexpr uint32_t csrw_dscratch_t0 = rv_csrw(RV_CSR_VX_DSCRATCH, RV_GPR_T0);
+    std::vector<uint32_t> dctrl_after(2 * regaddrs.size(), 0);
+    for (size_t i = 0; i < regaddrs.size(); ++i) {
+        _queue_inject(rv_csrr(RV_GPR_T0, regaddrs[i]), dctrl_injectreq, &dctrl_after[2 * i]);
+        _queue_inject(csrw_dscratch_t0, dctrl_injectreq, &dctrl_after[2 * i + 1]);
+        _dmreg_queue_rd(DMReg_t::DSCRATCH, &values[i]);
     }
-    else {
-        log_->error("Unknown register name: " + reg_name);
-        return RCODE_INVALID_ARG;
+    CHECK_ERRS(_dmreg_flush());
+
+    for (uint32_t v : dctrl_after) {
+        if (extract_dmreg_field(DMReg_t::DCTRL, "injectstate", v) != 0) {
+            log_->debug("Streamed injection did not complete in time");
+            return RCODE_TIMEOUT;
+        }
     }
     return RCODE_OK;
 }
 
-int Backend::read_regs(const std::vector<std::string> &reg_names, std::vector<uint32_t> &values) {
-    values.clear();
-    for (const auto &reg_name : reg_names) {            // TODO: Optimize multiple register reads
+Backend::RegSnapshot_t* Backend::_regsnap() {
+    if (!use_reg_cache_ || state_.selected_wid < 0 || state_.selected_tid < 0)
+        return nullptr;
+    return &regsnap_[state_.selected_wid * state_.platinfo.num_threads + state_.selected_tid];
+}
+
+void Backend::regcache_invalidate(int wid) {
+    if (wid < 0) {
+        regsnap_.clear();
+        return;
+    }
+    for (uint32_t tid = 0; tid < state_.platinfo.num_threads; ++tid)
+        regsnap_.erase(wid * state_.platinfo.num_threads + tid);
+}
+
+bool Backend::_scratch_holds(uint32_t regnum) const {
+    return regnum < 32 && ((scratch_.saved >> regnum) & 1)
+        && scratch_.wid == state_.selected_wid && scratch_.tid == state_.selected_tid;
+}
+
+int Backend::_scratch_acquire(uint32_t regmask) {
+    if (scratch_.saved && (scratch_.wid != state_.selected_wid || scratch_.tid != state_.selected_tid)) {
+        log_->error("Scratch registers held by another thread");
+        return RCODE_ERROR;
+    }
+    scratch_.wid = state_.selected_wid;
+    scratch_.tid = state_.selected_tid;
+
+    // Values known from the snapshot cost nothing, the rest is read in one go
+    RegSnapshot_t *snap = _regsnap();
+    std::vector<uint32_t> regs;
+    for (uint32_t r = 1; r < 32; ++r) {
+        if (!((regmask >> r) & 1) || (scratch_.saved >> r) & 1)
+            continue;
+        if (snap && (snap->gpr_valid >> r) & 1) {
+            scratch_.value[r] = snap->gpr[r];
+            scratch_.saved |= 1u << r;
+        } else {
+            regs.push_back(r);
+        }
+    }
+    if (regs.empty())
+        return RCODE_OK;
+
+    // save reg: reg -csrw-> dscratch --> dbg (value)
+    std::vector<uint32_t> values(regs.size(), 0);
+    bool done = false;
+    if (pipeline_window_ > 0) {
+        uint32_t dctrl_injectreq = 0;
+        std::vector<uint32_t> dctrl_after(regs.size(), 0);
+        CHECK_ERRS(_get_dctrl_inject(dctrl_injectreq));
+        for (size_t i = 0; i < regs.size(); ++i) {
+            _queue_inject(rv_csrw(RV_CSR_VX_DSCRATCH, regs[i]), dctrl_injectreq, &dctrl_after[i]);
+            _dmreg_queue_rd(DMReg_t::DSCRATCH, &values[i]);
+        }
+        CHECK_ERRS(_dmreg_flush());
+        done = true;
+        for (size_t i = 0; i < regs.size(); ++i)
+            done = done && extract_dmreg_field(DMReg_t::DCTRL, "injectstate", dctrl_after[i]) == 0;
+        if (!done)
+            log_->debug("Streamed scratch save did not complete in time, retrying in blocking mode");
+    }
+    if (!done) {
+        for (size_t i = 0; i < regs.size(); ++i) {
+            CHECK_ERR(inject_instruction(rv_csrw(RV_CSR_VX_DSCRATCH, regs[i])), "Failed to move scratch register to DSCRATCH");
+            CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, values[i]), "Failed to obtain scratch register from DSCRATCH");
+        }
+    }
+    for (size_t i = 0; i < regs.size(); ++i) {
+        scratch_.value[regs[i]] = values[i];
+        scratch_.saved |= 1u << regs[i];
+        if (snap) {
+            snap->gpr[regs[i]] = values[i];
+            snap->gpr_valid |= 1u << regs[i];
+        }
+    }
+    LOG_DEBUG_LAZY(log_, strfmt("Saved scratch registers (wid: %d, tid: %d)", scratch_.wid, scratch_.tid));
+    return RCODE_OK;
+}
+
+int Backend::_scratch_release() {
+    if (!scratch_.saved)
+        return RCODE_OK;
+
+    // Dropped even if the restore fails, it is not retried
+    ScratchCtx_t ctx = scratch_;
+    scratch_ = ScratchCtx_t();
+    if (ctx.wid != state_.selected_wid || ctx.tid != state_.selected_tid) {
+        log_->error(strfmt("Scratch registers of warp %d, thread %d lost, thread no longer selected", ctx.wid, ctx.tid));
+        return RCODE_ERROR;
+    }
+
+    // restore reg: dbg(value) --> dscratch -csrr-> reg
+    std::vector<uint32_t> regs;
+    for (uint32_t r = 1; r < 32; ++r) {
+        if ((ctx.saved >> r) & 1)
+            regs.push_back(r);
+    }
+    bool done = false;
+    if (pipeline_window_ > 0) {
+        uint32_t dctrl_injectreq = 0;
+        std::vector<uint32_t> dctrl_after(regs.size(), 0);
+        CHECK_ERRS(_get_dctrl_inject(dctrl_injectreq));
+        for (size_t i = 0; i < regs.size(); ++i) {
+            _dmreg_queue_wr(DMReg_t::DSCRATCH, ctx.value[regs[i]]);
+            _queue_inject(rv_csrr(regs[i], RV_CSR_VX_DSCRATCH), dctrl_injectreq, &dctrl_after[i]);
+        }
+        CHECK_ERRS(_dmreg_flush());
+        done = true;
+        for (size_t i = 0; i < regs.size(); ++i)
+            done = done && extract_dmreg_field(DMReg_t::DCTRL, "injectstate", dctrl_after[i]) == 0;
+        if (!done)
+            log_->debug("Streamed scratch restore did not complete in time, retrying in blocking mode");
+    }
+    if (!done) {
+        for (uint32_t r : regs) {
+            CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, ctx.value[r]), "Failed to write scratch register value to DSCRATCH");
+            CHECK_ERR(inject_instruction(rv_csrr(r, RV_CSR_VX_DSCRATCH)), "Failed to restore scratch register from DSCRATCH");
+        }
+    }
+    LOG_DEBUG_LAZY(log_, strfmt("Restored scratch registers (wid: %d, tid: %d)", ctx.wid, ctx.tid));
+    return RCODE_OK;
+}
+
+int Backend::write_gpr(const uint32_t regnum, const uint32_t value) {
+    CHECK_SELECTED();
+    if (regnum >= 32) {
+        log_->error("Invalid GPR number " + std::to_string(regnum));
+        return RCODE_INVALID_ARG;
+    }
+    RegSnapshot_t *snap = _regsnap();
+    if (snap && (snap->gpr_valid >> regnum) & 1 && snap->gpr[regnum] == value) {
+        // Unchanged (e.g. GDB 'G' packet rewriting all registers)
+        return RCODE_OK;
+    }
+    CHECK_HALTED();
+
+    if (_scratch_holds(regnum)) {
+        // Lands in the register when the scratch context is restored
+        scratch_.value[regnum] = value;
+    } else {
+        // move value to dscratch: dbg(value) --> dscratch
+        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value), "Failed to write DSCRATCH register");
+        // move dscratch to arch reg: dscratch -csrr-> REG[i]
+        CHECK_ERR(inject_instruction(rv_csrr(regnum, RV_CSR_VX_DSCRATCH)), "Failed to move dscratch to GPR");
+    }
+    if (snap && regnum != 0) {
+        snap->gpr[regnum] = value;
+        snap->gpr_valid |= 1u << regnum;
+    }
+    LOG_DEBUG_LAZY(log_, strfmt("Wr GPR[x%d] <= 0x%08X", regnum, value));
+    return RCODE_OK;
+}
+
+// Get the CSR register value
+int Backend::read_csr(const uint32_t regaddr, uint32_t &value) {
+    CHECK_SELECTED();
+    RegSnapshot_t *snap = rvcsr_is_volatile(regaddr) ? nullptr : _regsnap();
+    if (snap) {
+        auto it = snap->csrs.find(regaddr);
+        if (it != snap->csrs.end()) {
+            value = it->second;
+            return RCODE_OK;
+        }
+    }
+    CHECK_HALTED();
+
+    // t0 is saved once and restored when the thread runs (or on failure)
+    ScratchGuard scratch(*this, SCRATCH_T0);
+    CHECK_ERR(scratch.rc(), "Failed to save t0");
+    // move csr to dscratch through t0: csr -csrr-> t0 ; t0 -csrw-> dscratch
+    CHECK_ERR(inject_instruction(rv_csrr(RV_GPR_T0, regaddr)), "Failed to read CSR into t0");
+    CHECK_ERR(inject_instruction(rv_csrw(RV_CSR_VX_DSCRATCH, RV_GPR_T0)), "Failed to write t0 to DSCRATCH");
+    // read csr value from dscratch: dscratch -dbg-> value
+    CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, value), "Failed to obtain CSR value from DSCRATCH");
+    scratch.done();
+    if (snap) snap->csrs[regaddr] = value;
+    LOG_DEBUG_LAZY(log_, strfmt("Rd CSR[0x%03X] => 0x%08X", regaddr, value));
+    return RCODE_OK;
+}
+
+// Set the CSR register value
+int Backend::write_csr(const uint32_t regaddr, const uint32_t value) {
+    CHECK_SELECTED();
+    CHECK_HALTED();
+
+    ScratchGuard scratch(*this, SCRATCH_T0);
+    CHECK_ERR(scratch.rc(), "Failed to save t0");
+    // move value to dscratch: dbg(value) --> dscratch
+    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value), "Failed to write value to DSCRATCH");
+    // move dscratch to csr through t0: dscratch -csrr-> t0 ; t0 -csrw-> csr
+    CHECK_ERR(inject_instruction(rv_csrr(RV_GPR_T0, RV_CSR_VX_DSCRATCH)), "Failed to read DSCRATCH into t0");
+    CHECK_ERR(inject_instruction(rv_csrw(regaddr, RV_GPR_T0)), "Failed to write t0 to CSR");
+    scratch.done();
+    RegSnapshot_t *snap = _regsnap();
+    if (snap) {
+        // Read-only/WARL bits make the written value unreliable, re-read on next access
+        snap->csrs.erase(regaddr);
+    }
+    LOG_DEBUG_LAZY(log_, strfmt("Wr CSR[0x%03X] <= 0x%08X", regaddr, value));
+    return RCODE_OK;
+}
+
+int Backend::read_reg(const std::string &reg_name, uint32_t &value) {
+    auto regtype = rvreg_gettype(reg_name);
+    if (regtype == RVRegType_t::GPR) {
+        uint32_t regnum = rvgpr_name2num(reg_name);
+        CHECK_ERR(read_gpr(regnum, value), "Failed to read GPR " + reg_name);
+        return RCODE_OK;
+    }
+    else if (regtype == RVRegType_t::CSR) {
+        uint32_t csraddr = rvcsr_name2addr(reg_name);
+        CHECK_ERR(read_csr(csraddr, value), "Failed to read CSR " + reg_name);
+        return RCODE_OK;
+    }
+    else if (reg_name == "pc") {
+        CHECK_ERR(get_warp_pc(value), "Failed to read PC register");
+        return RCODE_OK;
+    }
+    else {
+        log_->error("Unknown register name: " + reg_name);
+        return RCODE_INVALID_ARG;
+    }
+    return RCODE_OK;
+}
+
+// Write processor register
+int Backend::write_reg(const std::string &reg_name, uint32_t value) {
+    auto regtype = rvreg_gettype(reg_name);
+    if (regtype == RVRegType_t::GPR) {
+        uint32_t regnum = rvgpr_name2num(reg_name);
+        CHECK_ERR(write_gpr(regnum, value), "Failed to write GPR " + reg_name);
+        return RCODE_OK;
+    }
+    else if (regtype == RVRegType_t::CSR) {
+        uint32_t csraddr = rvcsr_name2addr(reg_name);
+        CHECK_ERR(write_csr(csraddr, value), "Failed to write CSR " + reg_name);
+        return RCODE_OK;
+    }
+    else if (reg_name == "pc") {
+        CHECK_ERR(set_warp_pc(value), "Failed to write PC register");
+        return RCODE_OK;
+    }
+    else {
+        log_->error("Unknown register name: " + reg_name);
+        return RCODE_INVALID_ARG;
+    }
+    return RCODE_OK;
+}
+
+int Backend::read_regs(const std::vector<std::string> &reg_names, std::vector<uint32_t> &values) {
+    values.clear();
+    for (const auto &reg_name : reg_names) {            // TODO: Optimize multiple register reads
         uint32_t value = 0;
         CHECK_ERR(read_reg(reg_name, value), "Failed to read register " + reg_name);
         values.push_back(value);
@@ -858,6 +1880,167 @@ int Backend::read_mem(const uint32_t addr, const uint32_t nbytes, std::vector<ui
     CHECK_SELECTED();
     CHECK_HALTED();
 
+    data.clear();
+    if (nbytes == 0)
+        return RCODE_OK;
+    ScopedLatency lat(stats_.read_mem);
+    stats_.mem_rd_bytes.add(nbytes);
+
+    // Cache is only coherent while nothing runs. Once all warps were seen halted
+    // they stay so until the warp state generation moves (resume, step, reset,
+    // raw DM writes), only then is DCTRL probed again.
+    bool cacheable = false;
+    if (use_mem_cache_) {
+        if (memcache_halted_gen_ != warpstate_gen_) {
+            bool allhalted = false;
+            if (warpsnap_.valid && warpsnap_.generation == warpstate_gen_) {
+                allhalted = warpsnap_.num_running == 0;
+            } else {
+                WarpSummary_t wsummary;
+                CHECK_ERR(get_warp_summary(wsummary), "Failed to get warp summary");
+                allhalted = wsummary.allhalted;
+            }
+            memcache_invalidate();
+            if (allhalted)
+                memcache_halted_gen_ = warpstate_gen_;
+        }
+        int core = state_.selected_wid / static_cast<int>(state_.platinfo.num_warps);
+        cacheable = memcache_halted_gen_ == warpstate_gen_;
+        if (core != memcache_core_)
+            memcache_invalidate();
+        memcache_core_ = core;
+    }
+
+    if (!cacheable) {
+        CHECK_ERRS(_read_mem(addr, nbytes, data));
+        _patch_breakpoints(addr, data);
+        return RCODE_OK;
+    }
+
+    // Fetch runs of missing blocks, each with a single uncached read
+    const uint32_t first_blk = addr & ~(MEMCACHE_BLOCK_SZ - 1);
+    const uint32_t last_blk = (addr + nbytes - 1) & ~(MEMCACHE_BLOCK_SZ - 1);
+    for (uint64_t blk = first_blk; blk <= last_blk; blk += MEMCACHE_BLOCK_SZ) {
+        if (memcache_.count(blk)) {
+            stats_.memcache_hits.add();
+            continue;
+        }
+        uint64_t run_end = blk + MEMCACHE_BLOCK_SZ;
+        while (run_end <= last_blk && !memcache_.count(run_end))
+            run_end += MEMCACHE_BLOCK_SZ;
+        stats_.memcache_misses.add((run_end - blk) / MEMCACHE_BLOCK_SZ);
+
+        std::vector<uint8_t> run;
+        CHECK_ERRS(_read_mem(blk, run_end - blk, run));
+        for (uint64_t b = blk; b < run_end; b += MEMCACHE_BLOCK_SZ) {
+            auto begin = run.begin() + (b - blk);
+            memcache_[b].assign(begin, begin + MEMCACHE_BLOCK_SZ);
+        }
+        LOG_DEBUG_LAZY(log_, strfmt("Memory cache fill 0x%08X-0x%08X", static_cast<uint32_t>(blk), static_cast<uint32_t>(run_end - 1)));
+        blk = run_end - MEMCACHE_BLOCK_SZ;
+    }
+
+    data.resize(nbytes);
+    for (uint64_t i = 0; i < nbytes; ) {
+        uint32_t a = addr + i;
+        uint32_t blk = a & ~(MEMCACHE_BLOCK_SZ - 1);
+        uint32_t off = a - blk;
+        uint32_t take = std::min<uint64_t>(MEMCACHE_BLOCK_SZ - off, nbytes - i);
+        std::memcpy(&data[i], &memcache_[blk][off], take);
+        i += take;
+    }
+    _patch_breakpoints(addr, data);
+    return RCODE_OK;
+}
+
+int Backend::read_mem_lanes(const std::vector<uint32_t> &addrs, std::vector<uint32_t> &values) {
+    const uint32_t nthreads = state_.platinfo.num_threads;
+    values.assign(addrs.size(), 0);
+    CHECK_SELECTED();
+    if (addrs.empty() || addrs.size() > nthreads) {
+        log_->error(strfmt("Expected 1 to %u lane addresses, got %zu", nthreads, addrs.size()));
+        return RCODE_INVALID_ARG;
+    }
+    for (uint32_t a : addrs) {
+        if (a & 0x3) {
+            log_->error(strfmt("Lane address 0x%08X is not word aligned", a));
+            return RCODE_INVALID_ARG;
+        }
+    }
+    CHECK_HALTED();
+    stats_.mem_rd_bytes.add(4 * addrs.size());
+
+    // The warp-wide load is one batch but always goes to the target. With block
+    // access read_mem() costs one block read per uncached block, cheaper for
+    // lane words that are cached or packed in a few blocks.
+    bool few_misses = has_mem_bulk();
+    std::vector<uint32_t> missing;
+    for (size_t i = 0; few_misses && i < addrs.size(); ++i) {
+        uint32_t blk = addrs[i] & ~(MEMCACHE_BLOCK_SZ - 1);
+        if (!_memcache_holds(blk, 4) && std::find(missing.begin(), missing.end(), blk) == missing.end())
+            missing.push_back(blk);
+        few_misses = missing.size() <= LANES_MEM_BULK_MAX_MISSES;
+    }
+    if (!has_lane_access() || pipeline_window_ == 0 || few_misses) {
+        // Lanes share the memory of their core, the selected thread reads for all
+        std::vector<uint8_t> data;
+        for (size_t i = 0; i < addrs.size(); ++i) {
+            CHECK_ERR(read_mem(addrs[i], 4, data), strfmt("Failed to read memory at 0x%08X", addrs[i]));
+            WordBytes_t w;
+            std::memcpy(w.bytes, data.data(), 4);
+            values[i] = w.word;
+        }
+        return RCODE_OK;
+    }
+
+    // Single batch, t0 is swapped with dscratch around the load:
+    // addr -> dscratch <-> t0, lw t0, t0 <-> dscratch -> value
+    // Inactive lanes skip the injections and would report their address, so the
+    // selected thread then swaps the thread mask out through dscratch the same way.
+    uint32_t dctrl_injectreq = 0, dconfig_on = 0, dconfig_off = 0;
+    CHECK_ERR(_get_dctrl_inject(dctrl_injectreq), "Failed to read DCTRL register");
+    CHECK_ERR(_get_dconfig_warpinj(dconfig_on, dconfig_off), "Failed to read DCONFIG register");
+    std::vector<uint32_t> lane_addrs(nthreads, addrs[0]);     // Spare lanes load a valid address
+    std::copy(addrs.begin(), addrs.end(), lane_addrs.begin());
+    constexpr uint32_t swap_t0 = rv_csrrw(RV_GPR_T0, RV_CSR_VX_DSCRATCH, RV_GPR_T0);
+    std::vector<BatchOp_t> ops;
+    std::vector<uint32_t> results;
+    _batch_wr(ops, DMReg_t::DCONFIG, dconfig_on);
+    _batch_lanes_wr(ops, lane_addrs);
+    _batch_inject(ops, swap_t0, dctrl_injectreq);
+    _batch_inject(ops, rv_lw(RV_GPR_T0, 0, RV_GPR_T0), dctrl_injectreq);
+    _batch_inject(ops, swap_t0, dctrl_injectreq);
+    _batch_wr(ops, DMReg_t::DCONFIG, dconfig_off);
+    _batch_lanes_rd(ops, addrs.size());
+    _batch_inject(ops, swap_t0, dctrl_injectreq);
+    _batch_inject(ops, rv_csrr(RV_GPR_T0, RV_CSR_VX_ACTIVE_THREADS), dctrl_injectreq);
+    _batch_inject(ops, swap_t0, dctrl_injectreq);
+    _batch_rd(ops, DMReg_t::DSCRATCH);
+    CHECK_ERR(_lanes_batch(ops, results, dconfig_off), "Failed to read memory through LSCRATCH");
+
+    // Results end with the lanes, three injection polls and the thread mask
+    const uint32_t tmask = results.back();
+    auto lanes_end = results.end() - 4;
+    std::copy(lanes_end - addrs.size(), lanes_end, values.begin());
+    for (size_t i = 0; i < addrs.size(); ++i) {
+        if (!((tmask >> i) & 1)) {
+            // Diverged lane, the selected thread loads for it
+            std::vector<uint8_t> data;
+            CHECK_ERR(read_mem(addrs[i], 4, data), strfmt("Failed to read memory at 0x%08X", addrs[i]));
+            WordBytes_t w;
+            std::memcpy(w.bytes, data.data(), 4);
+            values[i] = w.word;
+            continue;
+        }
+        auto bp = breakpoints_.find(addrs[i]);
+        if (bp != breakpoints_.end() && bp->second.inserted)
+            values[i] = bp->second.replaced_instr;
+    }
+    LOG_DEBUG_LAZY(log_, strfmt("Rd MEM of %zu lanes (warp %d)", addrs.size(), state_.selected_wid));
+    return RCODE_OK;
+}
+
+int Backend::_read_mem(const uint32_t addr, const uint32_t nbytes, std::vector<uint8_t> &data) {
     if(nbytes == 0)
         return RCODE_OK;
 
@@ -870,161 +2053,948 @@ int Backend::read_mem(const uint32_t addr, const uint32_t nbytes, std::vector<ui
 
     data.resize(size_in_bytes);     // allocate buffer
 
-    // Save t0 & t1: t0/t1 -csrw-> dscratch --> dbg (t0_val/t1_val)
-    uint32_t t0_val = 0, t1_val = 0;
-    CHECK_ERR(inject_instruction(strfmt("csrw %d, t0", RV_CSR_VX_DSCRATCH)), "Failed to save t0 to DSCRATCH");          // TODO: if any subsequent inject fails, fn returns without restoring t0,t1 --> need RAII guard
-    CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, t0_val), "Failed to obtain t0 value from DSCRATCH");
-    CHECK_ERR(inject_instruction(strfmt("csrw %d, t1", RV_CSR_VX_DSCRATCH)), "Failed to save t1 to DSCRATCH");
-    CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, t1_val), "Failed to obtain t1 value from DSCRATCH");
+    if (_use_mem_bulk(size_in_bytes)) {
+        CHECK_ERR(_read_mem_bulk(start_addr, data.data(), size_in_bytes / 4), "Failed to read memory block");
+    } else {
+        // t0 (address) and t1 (data) are saved once and restored when the thread runs
+        ScratchGuard scratch(*this, SCRATCH_T0_T1);
+        CHECK_ERR(scratch.rc(), "Failed to save t0/t1");
+
+        // Put start address in t0: dbg(start_addr) --> dscratch -csrr-> t0
+        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, start_addr), "Failed to write start address to DSCRATCH");
+        CHECK_ERR(inject_instruction(rv_csrr(RV_GPR_T0, RV_CSR_VX_DSCRATCH)), "Failed to load start address into t0");
+
+        // Read words
+
+        // pre-encoded loop instructions
+        constexpr uint32_t lw_t1 = rv_lw(RV_GPR_T1, 0, RV_GPR_T0);
+        constexpr uint32_t csrw_dscratch_t1 = rv_csrw(RV_CSR_VX_DSCRATCH, RV_GPR_T1);
+        constexpr uint32_t addi_t0_4 = rv_addi(RV_GPR_T0, RV_GPR_T0, 4);
+
+        size_t nwords = 0;
+        for (size_t i = 0; i < size_in_bytes; i += 4 * nwords) {
+            nwords = std::min<size_t>((size_in_bytes - i) / 4, MEM_STREAM_CHUNK_WORDS);
+            if (pipeline_window_ > 0) {
+                if (_read_words_streamed(&data[i], nwords) == RCODE_OK)
+                    continue;
+                // Fall back to blocking injection for this chunk, resynchronize t0 first
+                log_->warn(strfmt("Streamed read at 0x%08X failed, retrying in blocking mode", start_addr + static_cast<uint32_t>(i)));
+                CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, start_addr + i), "Failed to write chunk address to DSCRATCH");
+                CHECK_ERR(inject_instruction(rv_csrr(RV_GPR_T0, RV_CSR_VX_DSCRATCH)), "Failed to load chunk address into t0");
+            }
+            for (size_t w = 0; w < nwords; ++w) {
+                uint32_t rword;
+                // Load word from memory to t1
+                CHECK_ERR(inject_instruction(lw_t1), "Failed to load word from memory");
+                // Move t1 to dscratch for reading
+                CHECK_ERR(inject_instruction(csrw_dscratch_t1), "Failed to write t1 to DSCRATCH");
+                CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, rword), "Failed to obtain word from DSCRATCH");
+                // Increment address in t0
+                CHECK_ERR(inject_instruction(addi_t0_4), "Failed to increment address in t0");
+                // write data to buffer
+                std::memcpy(&data[i + 4 * w], &rword, sizeof(rword));
+            }
+        }
 
-    // Put start address in t0: dbg(start_addr) --> dscratch -csrr-> t0
-    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, start_addr), "Failed to write start address to DSCRATCH");
-    CHECK_ERR(inject_instruction(strfmt("csrr t0, %d", RV_CSR_VX_DSCRATCH)), "Failed to load start address into t0");
+        scratch.done();
+    }
 
-    // Read words
+    // trim extra bytes
+    size_t head_offset = addr - start_addr;
+    if (head_offset || size_in_bytes != nbytes) {
+        // Adjust for unaligned start address and requested size
+        if (head_offset) data.erase(data.begin(), data.begin() + head_offset);
+        // Trim to requested size
+        if (data.size() > nbytes) data.resize(nbytes);
+    }
+    return RCODE_OK;
+}
 
-    // pre format and compile loop instructions for speed
-    const uint32_t lw_t1 = rv_asm({"lw t1, 0(t0)"}).at(0);
-    const uint32_t csrw_dscratch_t1 = rv_asm({strfmt("csrw %d, t1", RV_CSR_VX_DSCRATCH)}).at(0);
-    const uint32_t addi_t0_4 = rv_asm({"addi t0, t0, 4"}).at(0);
+// Write memory
+int Backend::write_mem(const uint32_t addr, const std::vector<uint8_t> &data) {
+    CHECK_SELECTED();
+    CHECK_HALTED();
+
+    // Inserted ebreaks stay in place (their removal may be pending), the data
+    // under them is restored when the breakpoint is removed
+    std::vector<uint8_t> image(data);
+    _overlay_breakpoints(addr, image);
+    return _write_mem_overlaid(addr, image);
+}
+
+int Backend::_write_mem_overlaid(const uint32_t addr, const std::vector<uint8_t> &image) {
+    ScopedLatency lat(stats_.write_mem);
+    stats_.mem_wr_bytes.add(image.size());
 
-    for (size_t i = 0; i < size_in_bytes; i += 4) {
-        uint32_t rword;
-        // Load word from memory to t1
-        CHECK_ERR(inject_instruction(lw_t1), "Failed to load word from memory");
-        // Move t1 to dscratch for reading
-        CHECK_ERR(inject_instruction(csrw_dscratch_t1), "Failed to write t1 to DSCRATCH");
-        CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, rword), "Failed to obtain word from DSCRATCH");
-        // Increment address in t0
-        CHECK_ERR(inject_instruction(addi_t0_4), "Failed to increment address in t0");
-        // write data to buffer
-        std::memcpy(&data[i], &rword, sizeof(rword));
+    int rc = _write_mem(addr, image);
+    // Keep cached blocks in sync, contents are unknown after a failed write
+    _memcache_update(addr, image, rc != RCODE_OK);
+    return rc;
+}
+
+void Backend::memcache_invalidate() {
+    memcache_.clear();
+}
+
+bool Backend::_memcache_holds(const uint32_t addr, const uint32_t nbytes) const {
+    // Mirrors the coherence check of read_mem(): no warp ran since the cache was
+    // filled and the selected warp shares its core
+    if (!use_mem_cache_ || memcache_halted_gen_ != warpstate_gen_
+        || state_.selected_wid / static_cast<int>(state_.platinfo.num_warps) != memcache_core_)
+        return false;
+    const uint64_t last_blk = (static_cast<uint64_t>(addr) + nbytes - 1) & ~(MEMCACHE_BLOCK_SZ - 1ull);
+    for (uint64_t blk = addr & ~(MEMCACHE_BLOCK_SZ - 1); blk <= last_blk; blk += MEMCACHE_BLOCK_SZ) {
+        if (!memcache_.count(blk))
+            return false;
+    }
+    return true;
+}
+
+void Backend::_memcache_update(const uint32_t addr, const std::vector<uint8_t> &data, bool invalidate) {
+    if (memcache_.empty() || data.empty())
+        return;
+    for (uint64_t i = 0; i < data.size(); ) {
+        uint32_t a = addr + i;
+        uint32_t blk = a & ~(MEMCACHE_BLOCK_SZ - 1);
+        uint32_t off = a - blk;
+        uint32_t take = std::min<uint64_t>(MEMCACHE_BLOCK_SZ - off, data.size() - i);
+        auto it = memcache_.find(blk);
+        if (it != memcache_.end()) {
+            if (invalidate)
+                memcache_.erase(it);
+            else
+                std::memcpy(&it->second[off], &data[i], take);
+        }
+        i += take;
+    }
+}
+
+void Backend::_patch_breakpoints(const uint32_t addr, std::vector<uint8_t> &data) const {
+    // Show original instructions instead of the inserted ebreaks
+    const uint64_t end = static_cast<uint64_t>(addr) + data.size();
+    for (const auto& [bpaddr, bpinfo] : breakpoints_) {
+        if (!bpinfo.inserted || bpaddr + 4ull <= addr || bpaddr >= end)
+            continue;
+        WordBytes_t orig;
+        orig.word = bpinfo.replaced_instr;
+        for (unsigned b = 0; b < 4; ++b) {
+            uint64_t a = static_cast<uint64_t>(bpaddr) + b;
+            if (a >= addr && a < end)
+                data[a - addr] = orig.bytes[b];
+        }
+    }
+}
+
+int Backend::_write_mem(const uint32_t addr, const std::vector<uint8_t> &data) {
+    size_t nbytes = data.size();   
+    if (nbytes == 0)
+        return RCODE_OK;
+
+    // Compute word aligned address
+    uint32_t end_addr   = (addr + nbytes);
+
+    if (_use_mem_bulk(nbytes)) {
+        // Widen to whole words, patching partial head/tail words with their current contents
+        uint32_t start_base = addr & ~0x3;
+        uint32_t end_base = (end_addr + 3) & ~0x3;
+        size_t nwords = (end_base - start_base) / 4;
+        std::vector<uint8_t> buf(end_base - start_base);
+        if (addr != start_base)
+            CHECK_ERR(_read_mem_bulk(start_base, buf.data(), 1), "Failed to read head word");
+        if (end_addr != end_base && (nwords > 1 || addr == start_base))
+            CHECK_ERR(_read_mem_bulk(end_base - 4, &buf[buf.size() - 4], 1), "Failed to read tail word");
+        std::memcpy(&buf[addr - start_base], data.data(), nbytes);
+        CHECK_ERR(_write_mem_bulk(start_base, buf.data(), nwords), "Failed to write memory block");
+        return RCODE_OK;
+    }
+    
+    // --- Hold t0 & t1 as scratch ---
+    ScratchGuard scratch(*this, SCRATCH_T0_T1);
+    CHECK_ERR(scratch.rc(), "Failed to save t0/t1");
+
+    // --- Pre-encoded common instructions ---
+    constexpr uint32_t csrr_t0_dscratch = rv_csrr(RV_GPR_T0, RV_CSR_VX_DSCRATCH);
+    constexpr uint32_t csrr_t1_dscratch = rv_csrr(RV_GPR_T1, RV_CSR_VX_DSCRATCH);
+    constexpr uint32_t csrw_dscratch_t1 = rv_csrw(RV_CSR_VX_DSCRATCH, RV_GPR_T1);
+    constexpr uint32_t lw_t1_t0         = rv_lw(RV_GPR_T1, 0, RV_GPR_T0);
+    constexpr uint32_t sw_t1_t0         = rv_sw(RV_GPR_T1, 0, RV_GPR_T0);
+    constexpr uint32_t addi_t0_4        = rv_addi(RV_GPR_T0, RV_GPR_T0, 4);
+
+    uint32_t cur = addr;    // running address
+    size_t idx = 0;
+
+    // --- Leading partial word ---
+    if (cur % 4 != 0) {
+        uint32_t curr_base_addr = cur & ~0x3;
+        // Synchronize t0 with current address
+        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, curr_base_addr), "Failed to write base addr");
+        CHECK_ERR(inject_instruction(csrr_t0_dscratch), "Failed to read t0 from DSCRATCH");
+
+        // Read original value
+        WordBytes_t value;
+        CHECK_ERR(inject_instruction(lw_t1_t0), "Failed to load original word into t1");
+        CHECK_ERR(inject_instruction(csrw_dscratch_t1), "Failed to save t1");
+        CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, value.word), "Failed to read orig word");
+
+        // Patch original word
+        size_t head_offset = cur % 4;
+        size_t take = std::min<size_t>(4 - head_offset, data.size() - idx);
+        for (unsigned i = head_offset; i < head_offset + take; ++i)
+            value.bytes[i] = data[idx++];
+        cur += take;
+
+        // Write back patched word
+        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value.word), "Failed to write patched word");
+        CHECK_ERR(inject_instruction(csrr_t1_dscratch), "Failed to read t1 from DSCRATCH");
+        CHECK_ERR(inject_instruction(sw_t1_t0), "Failed to store word into memory");
+    }
+
+    // --- Middle full words ---
+    if (end_addr - cur >= 4) {  // at least one full word to write
+        // Synchronize t0 with current address
+        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, cur), "Failed to write current addr");
+        CHECK_ERR(inject_instruction(csrr_t0_dscratch), "Failed to read t0 from DSCRATCH");
+
+        while ((end_addr - cur) >= 4) {
+            size_t nwords = std::min<size_t>((end_addr - cur) / 4, MEM_STREAM_CHUNK_WORDS);
+            if (pipeline_window_ > 0) {
+                if (_write_words_streamed(&data[idx], nwords) == RCODE_OK) {
+                    cur += 4 * nwords;
+                    idx += 4 * nwords;
+                    continue;
+                }
+                // Fall back to blocking injection for this chunk, resynchronize t0 first
+                log_->warn(strfmt("Streamed write at 0x%08X failed, retrying in blocking mode", cur));
+                CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, cur), "Failed to write current addr");
+                CHECK_ERR(inject_instruction(csrr_t0_dscratch), "Failed to read t0 from DSCRATCH");
+            }
+            for (size_t w = 0; w < nwords; ++w) {
+                WordBytes_t value;
+                std::memcpy(value.bytes, &data[idx], 4);
+                CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value.word), "Failed to write word to DSCRATCH");
+                CHECK_ERR(inject_instruction(csrr_t1_dscratch), "Failed to read t1 from DSCRATCH");
+                CHECK_ERR(inject_instruction(sw_t1_t0), "Failed to store word into memory");
+                CHECK_ERR(inject_instruction(addi_t0_4), "Failed to increment t0");
+                cur += 4;
+                idx += 4;
+            }
+        }
+    }
+        
+    // --- Trailing partial word ---
+    if (cur < end_addr) {
+        // synchronize t0 with current address
+        uint32_t base = cur & ~0x3;
+        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, base), "Failed to write current addr");
+        CHECK_ERR(inject_instruction(csrr_t0_dscratch), "Failed to read t0 from DSCRATCH");
+
+        // Read original word
+        WordBytes_t value;
+        CHECK_ERR(inject_instruction(lw_t1_t0), "Failed to load original word into t1");
+        CHECK_ERR(inject_instruction(csrw_dscratch_t1), "Failed to save t1");
+        CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, value.word), "Failed to read orig word");
+
+        // Patch original word
+        size_t take = end_addr - cur;
+        for (unsigned i = 0; i < take; ++i)
+            value.bytes[i] = data[idx++];
+        cur += take;
+
+        // Write back patched word
+        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value.word), "Failed to write patched word to DSCRATCH");
+        CHECK_ERR(inject_instruction(csrr_t1_dscratch), "Failed to read t1 from DSCRATCH");
+        CHECK_ERR(inject_instruction(sw_t1_t0), "Failed to store word into memory");
+    }
+
+    scratch.done();
+    return RCODE_OK;
+}
+
+bool Backend::has_mem_bulk() const {
+    return mem_bulk_threshold_ > 0 && transport_ && transport_->has_cap(TRANSPORT_MEMBLK_CAP);
+}
+
+bool Backend::_use_mem_bulk(size_t nbytes) const {
+    return has_mem_bulk() && nbytes >= mem_bulk_threshold_;
+}
+
+int Backend::_read_mem_bulk(uint32_t addr, uint8_t *dst, size_t nwords) {
+    // NOTE: DM accesses memory directly, i.e. not through the selected thread's caches
+    std::vector<uint32_t> words(nwords, 0);
+    _dmreg_queue_wr(DMReg_t::MADDR, addr);
+    for (size_t w = 0; w < nwords; ++w)
+        _dmreg_queue_rd(DMReg_t::MDATA, &words[w]);
+    CHECK_ERRS(_dmreg_flush());
+    std::memcpy(dst, words.data(), 4 * nwords);
+    LOG_DEBUG_LAZY(log_, strfmt("Block read %zu words @0x%08X", nwords, addr));
+    return RCODE_OK;
+}
+
+int Backend::_write_mem_bulk(uint32_t addr, const uint8_t *src, size_t nwords) {
+    _dmreg_queue_wr(DMReg_t::MADDR, addr);
+    for (size_t w = 0; w < nwords; ++w) {
+        WordBytes_t value;
+        std::memcpy(value.bytes, src + 4 * w, 4);
+        _dmreg_queue_wr(DMReg_t::MDATA, value.word);
+    }
+    CHECK_ERRS(_dmreg_flush());
+    LOG_DEBUG_LAZY(log_, strfmt("Block write %zu words @0x%08X", nwords, addr));
+    return RCODE_OK;
+}
+
+int Backend::_read_words_streamed(uint8_t *dst, size_t nwords) {
+    constexpr uint32_t lw_t1 = rv_lw(RV_GPR_T1, 0, RV_GPR_T0);
+    constexpr uint32_t csrw_dscratch_t1 = rv_csrw(RV_CSR_VX_DSCRATCH, RV_GPR_T1);
+    constexpr uint32_t addi_t0_4 = rv_addi(RV_GPR_T0, RV_GPR_T0, 4);
+
+    uint32_t dctrl_injectreq = 0;
+    CHECK_ERRS(_get_dctrl_inject(dctrl_injectreq));
+
+    // Queue the whole inject->read sequence, completion of each injection is verified afterwards
+    std::vector<uint32_t> words(nwords, 0);
+    std::vector<uint32_t> dctrl_after(3 * nwords, 0);
+    for (size_t w = 0; w < nwords; ++w) {
+        _queue_inject(lw_t1, dctrl_injectreq, &dctrl_after[3 * w]);
+        _queue_inject(csrw_dscratch_t1, dctrl_injectreq, &dctrl_after[3 * w + 1]);
+        _dmreg_queue_rd(DMReg_t::DSCRATCH, &words[w]);
+        _queue_inject(addi_t0_4, dctrl_injectreq, &dctrl_after[3 * w + 2]);
+    }
+    CHECK_ERRS(_dmreg_flush());
+
+    for (uint32_t v : dctrl_after) {
+        if (extract_dmreg_field(DMReg_t::DCTRL, "injectstate", v) != 0) {
+            log_->debug("Streamed injection did not complete in time");
+            return RCODE_TIMEOUT;
+        }
+    }
+    std::memcpy(dst, words.data(), 4 * nwords);
+    return RCODE_OK;
+}
+
+int Backend::_write_words_streamed(const uint8_t *src, size_t nwords) {
+    constexpr uint32_t csrr_t1_dscratch = rv_csrr(RV_GPR_T1, RV_CSR_VX_DSCRATCH);
+    constexpr uint32_t sw_t1_t0 = rv_sw(RV_GPR_T1, 0, RV_GPR_T0);
+    constexpr uint32_t addi_t0_4 = rv_addi(RV_GPR_T0, RV_GPR_T0, 4);
+
+    uint32_t dctrl_injectreq = 0;
+    CHECK_ERRS(_get_dctrl_inject(dctrl_injectreq));
+
+    std::vector<uint32_t> dctrl_after(3 * nwords, 0);
+    for (size_t w = 0; w < nwords; ++w) {
+        WordBytes_t value;
+        std::memcpy(value.bytes, src + 4 * w, 4);
+        _dmreg_queue_wr(DMReg_t::DSCRATCH, value.word);
+        _queue_inject(csrr_t1_dscratch, dctrl_injectreq, &dctrl_after[3 * w]);
+        _queue_inject(sw_t1_t0, dctrl_injectreq, &dctrl_after[3 * w + 1]);
+        _queue_inject(addi_t0_4, dctrl_injectreq, &dctrl_after[3 * w + 2]);
+    }
+    CHECK_ERRS(_dmreg_flush());
+
+    for (uint32_t v : dctrl_after) {
+        if (extract_dmreg_field(DMReg_t::DCTRL, "injectstate", v) != 0) {
+            log_->debug("Streamed injection did not complete in time");
+            return RCODE_TIMEOUT;
+        }
+    }
+    return RCODE_OK;
+}
+
+// ----- Target Routines -------------------------------------------------------
+
+// Registers a staged routine may clobber, saved and restored in every lane
+static const std::vector<uint32_t> ROUTINE_GPRS = {
+    RV_GPR_T0, RV_GPR_T1, RV_GPR_T2, RV_GPR_T3, RV_GPR_T4, RV_GPR_T5, RV_GPR_T6, RV_GPR_A0
+};
+
+// Digests (see mem_digest) of the chunk sized pieces of [start, end) to the out
+// area, s1 then s2 per chunk. Arguments: start, end, chunk.
+constexpr size_t CKSUM_NCODE = 21;
+static std::vector<uint32_t> routine_checksum(uint32_t start, uint32_t end, uint32_t chunk) {
+    constexpr int32_t args = 4 * CKSUM_NCODE;
+    std::vector<uint32_t> image = {
+        rv_auipc(RV_GPR_T6, 0),
+        rv_lw(RV_GPR_T0, args, RV_GPR_T6),              // t0: address
+        rv_lw(RV_GPR_T1, args + 4, RV_GPR_T6),          // t1: end
+        rv_lw(RV_GPR_T5, args + 8, RV_GPR_T6),          // t5: chunk size
+        rv_addi(RV_GPR_T6, RV_GPR_T6, args + 12),       // t6: out
+        rv_beq(RV_GPR_T0, RV_GPR_T1, 60),               // next chunk, done at the end
+        rv_add(RV_GPR_T4, RV_GPR_T0, RV_GPR_T5),        // t4: chunk end, clamped to end
+        rv_bgeu(RV_GPR_T1, RV_GPR_T4, 8),
+        rv_addi(RV_GPR_T4, RV_GPR_T1, 0),
+        rv_addi(RV_GPR_T2, 0, 0),                       // t2: s1
+        rv_addi(RV_GPR_T3, 0, 0),                       // t3: s2
+        rv_lw(RV_GPR_A0, 0, RV_GPR_T0),                 // next word
+        rv_add(RV_GPR_T2, RV_GPR_T2, RV_GPR_A0),
+        rv_add(RV_GPR_T3, RV_GPR_T3, RV_GPR_T2),
+        rv_addi(RV_GPR_T0, RV_GPR_T0, 4),
+        rv_bne(RV_GPR_T0, RV_GPR_T4, -16),
+        rv_sw(RV_GPR_T2, 0, RV_GPR_T6),
+        rv_sw(RV_GPR_T3, 4, RV_GPR_T6),
+        rv_addi(RV_GPR_T6, RV_GPR_T6, 8),
+        rv_jal(0, -56),
+        rv_ebreak(),
+        start, end, chunk
+    };
+    return image;
+}
+
+bool Backend::_scratch_mem_overlaps(uint64_t addr, uint64_t nbytes) const {
+    return has_scratch_mem() && addr < scratch_mem_addr_ + static_cast<uint64_t>(scratch_mem_size_)
+        && scratch_mem_addr_ < addr + nbytes;
+}
+
+int Backend::_read_gprs_lanes(const std::vector<uint32_t> &regs, std::vector<std::vector<uint32_t>> &values) {
+    const uint32_t nthreads = state_.platinfo.num_threads;
+    values.assign(regs.size(), std::vector<uint32_t>(nthreads, 0));
+    if (!has_lane_access() || pipeline_window_ == 0) {
+        for (size_t i = 0; i < regs.size(); ++i)
+            CHECK_ERR(read_gpr_lanes(regs[i], values[i]), strfmt("Failed to read GPR x%d of all lanes", regs[i]));
+        return RCODE_OK;
+    }
+
+    // Single batch: per register a warp-wide csrw, then a sweep of the lanes' dscratch
+    uint32_t dctrl_injectreq = 0, dconfig_on = 0, dconfig_off = 0;
+    CHECK_ERR(_get_dctrl_inject(dctrl_injectreq), "Failed to read DCTRL register");
+    CHECK_ERR(_get_dconfig_warpinj(dconfig_on, dconfig_off), "Failed to read DCONFIG register");
+    std::vector<BatchOp_t> ops;
+    std::vector<uint32_t> results;
+    for (uint32_t r : regs) {
+        _batch_wr(ops, DMReg_t::DCONFIG, dconfig_on);
+        _batch_inject(ops, rv_csrw(RV_CSR_VX_DSCRATCH, r), dctrl_injectreq);
+        _batch_wr(ops, DMReg_t::DCONFIG, dconfig_off);
+        _batch_lanes_rd(ops, nthreads);
+    }
+    CHECK_ERR(_lanes_batch(ops, results, dconfig_off), "Failed to read GPRs through LSCRATCH");
+
+    // Results per register: the injection poll, then the lanes
+    auto it = results.begin();
+    for (size_t i = 0; i < regs.size(); ++i) {
+        it++;
+        std::copy(it, it + nthreads, values[i].begin());
+        it += nthreads;
+    }
+    return RCODE_OK;
+}
+
+int Backend::_write_gprs_lanes(const std::vector<uint32_t> &regs, const std::vector<std::vector<uint32_t>> &values) {
+    const uint32_t nthreads = state_.platinfo.num_threads;
+    const int wid = state_.selected_wid;
+    regcache_invalidate(wid);
+    if (!has_lane_access() || pipeline_window_ == 0) {
+        // One thread at a time
+        const int sel_tid = state_.selected_tid;
+        for (uint32_t tid = 0; tid < nthreads; ++tid) {
+            CHECK_ERR(select_warp_thread(wid, tid), "Failed to select thread " + std::to_string(tid));
+            for (size_t i = 0; i < regs.size(); ++i)
+                CHECK_ERR(write_gpr(regs[i], values[i][tid]), strfmt("Failed to write GPR x%d of thread %d", regs[i], tid));
+        }
+        CHECK_ERR(select_warp_thread(wid, sel_tid), "Failed to restore previously selected thread");
+        return RCODE_OK;
+    }
+
+    // Single batch: per register the lanes' dscratch, then a warp-wide csrr
+    uint32_t dctrl_injectreq = 0, dconfig_on = 0, dconfig_off = 0;
+    CHECK_ERR(_get_dctrl_inject(dctrl_injectreq), "Failed to read DCTRL register");
+    CHECK_ERR(_get_dconfig_warpinj(dconfig_on, dconfig_off), "Failed to read DCONFIG register");
+    std::vector<BatchOp_t> ops;
+    std::vector<uint32_t> results;
+    for (size_t i = 0; i < regs.size(); ++i) {
+        _batch_lanes_wr(ops, values[i]);
+        _batch_wr(ops, DMReg_t::DCONFIG, dconfig_on);
+        _batch_inject(ops, rv_csrr(regs[i], RV_CSR_VX_DSCRATCH), dctrl_injectreq);
+        _batch_wr(ops, DMReg_t::DCONFIG, dconfig_off);
+    }
+    CHECK_ERR(_lanes_batch(ops, results, dconfig_off), "Failed to write GPRs through LSCRATCH");
+    return RCODE_OK;
+}
+
+int Backend::_run_routine(const std::vector<uint32_t> &image, size_t ncode, size_t nout,
+                          std::vector<uint32_t> &out, uint32_t &result) {
+    CHECK_SELECTED();
+    CHECK_HALTED();
+    CHECK_TRANSPORT();
+    out.clear();
+    result = 0;
+    const uint32_t base = scratch_mem_addr_;
+    const uint32_t nbytes = 4 * (image.size() + nout);
+    if (!has_scratch_mem() || nbytes > scratch_mem_size_) {
+        log_->error(strfmt("Routine needs %u bytes of scratch memory, %u available", nbytes,
+                           has_scratch_mem() ? scratch_mem_size_ : 0));
+        return RCODE_INVALID_ARG;
+    }
+    for (auto& [bpaddr, bpinfo] : breakpoints_) {
+        if (bpinfo.inserted && _scratch_mem_overlaps(bpaddr, 4)) {
+            log_->error(strfmt("Breakpoint at 0x%08X lies in scratch memory", bpaddr));
+            return RCODE_ERROR;
+        }
+    }
+    const int wid = state_.selected_wid;
+    const uint32_t ebreak_pc = base + 4 * (ncode - 1);
+
+    // The result comes from the selected thread, it has to run the routine
+    uint32_t tmask = 0;
+    CHECK_ERR(read_csr(RV_CSR_VX_ACTIVE_THREADS, tmask), "Failed to read the active threads");
+    if (!((tmask >> state_.selected_tid) & 1)) {
+        log_->error(strfmt("Thread %d is inactive, select an active thread to run a routine", state_.selected_tid));
+        return RCODE_ERROR;
+    }
+
+    // Save what the routine clobbers: its registers in every lane, the PC and the scratch memory
+    std::vector<std::vector<uint32_t>> saved_gprs;
+    std::vector<uint8_t> saved_mem;
+    uint32_t saved_pc = 0;
+    CHECK_ERR(_scratch_release(), "Failed to restore scratch registers");
+    CHECK_ERR(_read_gprs_lanes(ROUTINE_GPRS, saved_gprs), "Failed to save routine registers");
+    CHECK_ERR(get_warp_pc(saved_pc), "Failed to save PC");
+    CHECK_ERR(_read_mem(base, nbytes, saved_mem), "Failed to save scratch memory");
+
+    std::vector<uint8_t> staged(nbytes, 0);
+    std::memcpy(staged.data(), image.data(), 4 * image.size());
+    int rc = _write_mem(base, staged);
+    // Instruction fetch must not see an older routine staged at the same place
+    if (rc == RCODE_OK)
+        rc = _scratch_release();
+    if (rc == RCODE_OK)
+        rc = inject_instruction(rv_fence_i());
+    if (rc == RCODE_OK)
+        rc = set_warp_pc(base);
+    if (rc == RCODE_OK)
+        rc = select_warps(std::vector<int>{wid});
+
+    // Resume the warp alone and wait for its WSTATUS bit, the PC and dscratch
+    // are read in the same batch
+    uint32_t pc = 0;
+    if (rc == RCODE_OK) {
+        memcache_invalidate();
+        regcache_invalidate(wid);
+        uint32_t dselect = 0, dctrl_resumereq = 0;
+        rc = dmreg_rd(DMReg_t::DSELECT, dselect);
+        if (rc == RCODE_OK)
+            rc = _get_dctrl_req("resumereq", dctrl_resumereq);
+        if (rc == RCODE_OK) {
+            const uint32_t bit = 1u << (wid % 32);
+            std::vector<BatchOp_t> ops;
+            std::vector<uint32_t> results;
+            _batch_wr(ops, DMReg_t::DSELECT, set_dmreg_field(DMReg_t::DSELECT, "winsel", dselect, wid / 32));
+            ops.push_back(BatchOp_t::wr(get_dmreg(DMReg_t::DCTRL).addr, dctrl_resumereq));
+            ops.push_back(BatchOp_t::poll(get_dmreg(DMReg_t::WSTATUS).addr, bit, bit));
+            _batch_rd(ops, DMReg_t::DPC);
+            _batch_rd(ops, DMReg_t::DSCRATCH);
+            _batch_wr(ops, DMReg_t::DSELECT, dselect);
+            PollPolicy_t policy = poll_policy_;
+            policy.timeout_ms = ROUTINE_TIMEOUT_MS;
+            warpstate_invalidate();
+            rc = transport_->batch(ops, results, policy, &poll_history_);
+            if (rc != RCODE_OK) {
+                dmreg_cache_invalidate();
+                if (rc == RCODE_TIMEOUT) {
+                    // Stop it where it is, the warp is restored below
+                    log_->error(strfmt("Routine did not reach its ebreak within %d ms, halting warp %d", ROUTINE_TIMEOUT_MS, wid));
+                    uint32_t dctrl_haltreq = 0;
+                    ops.clear();
+                    if (_get_dctrl_req("haltreq", dctrl_haltreq) == RCODE_OK) {
+                        _batch_wr(ops, DMReg_t::DSELECT, set_dmreg_field(DMReg_t::DSELECT, "winsel", dselect, wid / 32));
+                        ops.push_back(BatchOp_t::wr(get_dmreg(DMReg_t::DCTRL).addr, dctrl_haltreq));
+                        ops.push_back(BatchOp_t::poll(get_dmreg(DMReg_t::WSTATUS).addr, bit, bit));
+                        _batch_wr(ops, DMReg_t::DSELECT, dselect);
+                    }
+                    if (ops.empty() || _dmreg_batch(ops, results) != RCODE_OK) {
+                        log_->error(strfmt("Warp %d did not halt, its registers and scratch memory are lost", wid));
+                        return RCODE_TIMEOUT;
+                    }
+                }
+            } else {
+                pc = results[results.size() - 2];
+                result = results.back();
+            }
+        }
+    }
+    if (rc == RCODE_OK && pc != ebreak_pc) {
+        log_->error(strfmt("Routine stopped at 0x%08X, not at its final ebreak 0x%08X", pc, ebreak_pc));
+        rc = RCODE_ERROR;
+    }
+    if (rc == RCODE_OK && nout) {
+        std::vector<uint8_t> outbytes;
+        rc = _read_mem(base + 4 * image.size(), 4 * nout, outbytes);
+        if (rc == RCODE_OK) {
+            out.resize(nout);
+            std::memcpy(out.data(), outbytes.data(), 4 * nout);
+        }
+    }
+
+    // Put everything back, also after a failed run
+    warpstate_invalidate();
+    memcache_invalidate();
+    int restore_rc = _write_mem(base, saved_mem);
+    if (restore_rc == RCODE_OK)
+        restore_rc = _scratch_release();
+    if (restore_rc == RCODE_OK)
+        restore_rc = set_warp_pc(saved_pc);
+    if (restore_rc == RCODE_OK)
+        restore_rc = _write_gprs_lanes(ROUTINE_GPRS, saved_gprs);
+    regcache_invalidate(wid);
+    CHECK_ERR(restore_rc, "Failed to restore the warp after a routine run");
+    if (rc != RCODE_OK)
+        return rc;
+    LOG_DEBUG_LAZY(log_, strfmt("Ran routine of %zu words on warp %d => 0x%08X", ncode, wid, result));
+    return RCODE_OK;
+}
+
+// ----- Memory Scans ----------------------------------------------------------
+
+// MSB first CRC-32 used by GDB (gdb/gdbsupport/crc32 semantics)
+constexpr uint32_t CRC32_POLY = 0x04c11db7;
+static const std::array<uint32_t, 256> CRC32_TABLE = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i << 24;
+        for (int b = 0; b < 8; ++b)
+            c = (c & 0x80000000) ? (c << 1) ^ CRC32_POLY : (c << 1);
+        table[i] = c;
+    }
+    return table;
+}();
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        crc = (crc << 8) ^ CRC32_TABLE[((crc >> 24) ^ data[i]) & 0xff];
+    return crc;
+}
+
+// CRC-32 of [start, end) from crc, bitwise, left in dscratch. Arguments: start, end, crc, polynomial.
+constexpr size_t CRC32_NCODE = 20;
+static std::vector<uint32_t> routine_crc32(uint32_t start, uint32_t end, uint32_t crc) {
+    constexpr int32_t args = 4 * CRC32_NCODE;
+    std::vector<uint32_t> image = {
+        rv_auipc(RV_GPR_T6, 0),
+        rv_lw(RV_GPR_T0, args, RV_GPR_T6),              // t0: address
+        rv_lw(RV_GPR_T1, args + 4, RV_GPR_T6),          // t1: end
+        rv_lw(RV_GPR_T2, args + 8, RV_GPR_T6),          // t2: crc
+        rv_lw(RV_GPR_T3, args + 12, RV_GPR_T6),         // t3: polynomial
+        rv_beq(RV_GPR_T0, RV_GPR_T1, 52),               // next byte, done at the end
+        rv_lbu(RV_GPR_T4, 0, RV_GPR_T0),
+        rv_slli(RV_GPR_T4, RV_GPR_T4, 24),
+        rv_xor(RV_GPR_T2, RV_GPR_T2, RV_GPR_T4),
+        rv_addi(RV_GPR_T5, 0, 8),                       // t5: bits left
+        rv_slli(RV_GPR_T4, RV_GPR_T2, 1),               // next bit
+        rv_bge(RV_GPR_T2, 0, 8),
+        rv_xor(RV_GPR_T4, RV_GPR_T4, RV_GPR_T3),
+        rv_addi(RV_GPR_T2, RV_GPR_T4, 0),
+        rv_addi(RV_GPR_T5, RV_GPR_T5, -1),
+        rv_bne(RV_GPR_T5, 0, -20),
+        rv_addi(RV_GPR_T0, RV_GPR_T0, 1),
+        rv_jal(0, -48),
+        rv_csrw(RV_CSR_VX_DSCRATCH, RV_GPR_T2),
+        rv_ebreak(),
+        start, end, crc, CRC32_POLY
+    };
+    return image;
+}
+
+// First address in [start, stop) where pattern starts, stop if none, left in
+// dscratch. Arguments: start, stop, pattern size, pattern bytes.
+constexpr size_t SEARCH_NCODE = 19;
+static std::vector<uint32_t> routine_search(uint32_t start, uint32_t stop, const std::vector<uint8_t> &pattern) {
+    constexpr int32_t args = 4 * SEARCH_NCODE;
+    std::vector<uint32_t> image = {
+        rv_auipc(RV_GPR_T6, 0),
+        rv_lw(RV_GPR_T0, args, RV_GPR_T6),              // t0: candidate
+        rv_lw(RV_GPR_T1, args + 4, RV_GPR_T6),          // t1: stop
+        rv_lw(RV_GPR_T2, args + 8, RV_GPR_T6),          // t2: pattern size
+        rv_addi(RV_GPR_T6, RV_GPR_T6, args + 12),       // t6: pattern
+        rv_beq(RV_GPR_T0, RV_GPR_T1, 48),               // next candidate, done at stop
+        rv_addi(RV_GPR_T3, 0, 0),                       // t3: bytes matched
+        rv_beq(RV_GPR_T3, RV_GPR_T2, 40),               // next byte, done once all match
+        rv_add(RV_GPR_T4, RV_GPR_T0, RV_GPR_T3),
+        rv_lbu(RV_GPR_T4, 0, RV_GPR_T4),
+        rv_add(RV_GPR_T5, RV_GPR_T6, RV_GPR_T3),
+        rv_lbu(RV_GPR_T5, 0, RV_GPR_T5),
+        rv_bne(RV_GPR_T4, RV_GPR_T5, 12),
+        rv_addi(RV_GPR_T3, RV_GPR_T3, 1),
+        rv_jal(0, -28),
+        rv_addi(RV_GPR_T0, RV_GPR_T0, 1),
+        rv_jal(0, -44),
+        rv_csrw(RV_CSR_VX_DSCRATCH, RV_GPR_T0),
+        rv_ebreak(),
+        start, stop, static_cast<uint32_t>(pattern.size())
+    };
+    std::vector<uint8_t> padded(pattern);
+    padded.resize((pattern.size() + 3) & ~size_t(0x3), 0);
+    for (size_t i = 0; i < padded.size(); i += 4) {
+        WordBytes_t w;
+        std::memcpy(w.bytes, &padded[i], 4);
+        image.push_back(w.word);
+    }
+    return image;
+}
+
+int Backend::crc32_mem(const uint32_t addr, const uint32_t nbytes, uint32_t &crc) {
+    crc = 0xffffffff;
+    if (!has_scratch_mem() || _scratch_mem_overlaps(addr, nbytes)) {
+        // Read it all
+        std::vector<uint8_t> data;
+        for (uint64_t off = 0; off < nbytes; off += MEM_SCAN_CHUNK_SZ) {
+            uint32_t n = std::min<uint64_t>(MEM_SCAN_CHUNK_SZ, nbytes - off);
+            CHECK_ERR(read_mem(addr + off, n, data), strfmt("Failed to read memory @0x%08X", static_cast<uint32_t>(addr + off)));
+            crc = crc32_update(crc, data.data(), data.size());
+        }
+        LOG_DEBUG_LAZY(log_, strfmt("CRC32 %u bytes @0x%08X => 0x%08X", nbytes, addr, crc));
+        return RCODE_OK;
+    }
+
+    const uint64_t end = static_cast<uint64_t>(addr) + nbytes;
+    std::vector<uint32_t> out;
+    for (uint64_t cur = addr; cur < end; cur += ROUTINE_SCAN_SZ) {
+        uint64_t n = std::min<uint64_t>(ROUTINE_SCAN_SZ, end - cur);
+        CHECK_ERR(_run_routine(routine_crc32(cur, cur + n, crc), CRC32_NCODE, 0, out, crc),
+                  strfmt("Failed to compute CRC32 @0x%08X", static_cast<uint32_t>(cur)));
+    }
+
+    // The routine read inserted ebreaks. The CRC is linear, crc(A) ^ crc(B) is
+    // the CRC from 0 of A ^ B, so the difference to the originals is folded in.
+    std::vector<uint8_t> diff;
+    for (const auto& [bpaddr, bpinfo] : breakpoints_) {
+        if (!bpinfo.inserted || bpaddr + 4ull <= addr || bpaddr >= end)
+            continue;
+        diff.resize(nbytes, 0);
+        WordBytes_t orig, brk;
+        orig.word = bpinfo.replaced_instr;
+        brk.word = rv_ebreak();
+        for (unsigned b = 0; b < 4; ++b) {
+            uint64_t a = static_cast<uint64_t>(bpaddr) + b;
+            if (a >= addr && a < end)
+                diff[a - addr] = orig.bytes[b] ^ brk.bytes[b];
+        }
+    }
+    if (!diff.empty())
+        crc ^= crc32_update(0, diff.data(), diff.size());
+    LOG_DEBUG_LAZY(log_, strfmt("CRC32 %u bytes @0x%08X => 0x%08X (on target)", nbytes, addr, crc));
+    return RCODE_OK;
+}
+
+int Backend::_search_mem_host(const uint32_t addr, const uint32_t nbytes, const std::vector<uint8_t> &pattern,
+                              bool &found, uint32_t &found_addr) {
+    // Keep the last pattern.size()-1 bytes so matches across chunk boundaries are seen
+    std::vector<uint8_t> window, data;
+    uint64_t window_addr = addr;
+    for (uint64_t off = 0; off < nbytes; off += MEM_SCAN_CHUNK_SZ) {
+        uint32_t n = std::min<uint64_t>(MEM_SCAN_CHUNK_SZ, nbytes - off);
+        CHECK_ERR(read_mem(addr + off, n, data), strfmt("Failed to read memory @0x%08X", static_cast<uint32_t>(addr + off)));
+        window.insert(window.end(), data.begin(), data.end());
+        auto it = std::search(window.begin(), window.end(), pattern.begin(), pattern.end());
+        if (it != window.end()) {
+            found = true;
+            found_addr = window_addr + (it - window.begin());
+            return RCODE_OK;
+        }
+        size_t keep = std::min(window.size(), pattern.size() - 1);
+        window_addr += window.size() - keep;
+        window.erase(window.begin(), window.end() - keep);
+    }
+    return RCODE_OK;
+}
+
+int Backend::_search_mem_routine(const uint64_t start, const uint64_t stop, const std::vector<uint8_t> &pattern,
+                                 bool &found, uint32_t &found_addr) {
+    // Each candidate may compare the whole pattern
+    const uint64_t piece = std::max<uint64_t>(1, ROUTINE_SCAN_SZ / pattern.size());
+    std::vector<uint32_t> out;
+    for (uint64_t cur = start; cur < stop; cur += piece) {
+        uint64_t n = std::min<uint64_t>(piece, stop - cur);
+        uint32_t result = 0;
+        CHECK_ERR(_run_routine(routine_search(cur, cur + n, pattern), SEARCH_NCODE, 0, out, result),
+                  strfmt("Failed to search memory @0x%08X", static_cast<uint32_t>(cur)));
+        if (result != static_cast<uint32_t>(cur + n)) {
+            found = true;
+            found_addr = result;
+            return RCODE_OK;
+        }
+    }
+    return RCODE_OK;
+}
+
+int Backend::search_mem(const uint32_t addr, const uint32_t nbytes, const std::vector<uint8_t> &pattern,
+                        bool &found, uint32_t &found_addr) {
+    found = false;
+    found_addr = 0;
+    if (pattern.empty()) {
+        log_->error("Empty search pattern");
+        return RCODE_INVALID_ARG;
+    }
+    if (nbytes < pattern.size())
+        return RCODE_OK;
+
+    const size_t max_pattern = 4 * (scratch_mem_size_ / 4 - std::min<size_t>(scratch_mem_size_ / 4, SEARCH_NCODE + 3));
+    if (!has_scratch_mem() || _scratch_mem_overlaps(addr, nbytes) || pattern.size() > max_pattern) {
+        CHECK_ERRS(_search_mem_host(addr, nbytes, pattern, found, found_addr));
+    } else {
+        // Candidate start addresses whose match would cover an inserted ebreak
+        // are checked on the host, the target searches the ones in between
+        const uint64_t plen = pattern.size();
+        const uint64_t stop = static_cast<uint64_t>(addr) + nbytes - plen + 1;
+        std::vector<std::pair<uint64_t, uint64_t>> hostside;
+        for (const auto& [bpaddr, bpinfo] : breakpoints_) {
+            if (!bpinfo.inserted)
+                continue;
+            uint64_t from = std::max<uint64_t>(addr, bpaddr + 1 > plen ? bpaddr + 1 - plen : 0);
+            uint64_t to = std::min<uint64_t>(stop, bpaddr + 4ull);
+            if (from < to)
+                hostside.push_back({from, to});
+        }
+        std::sort(hostside.begin(), hostside.end());
+        uint64_t cur = addr;
+        for (auto [from, to] : hostside) {
+            if (to <= cur)
+                continue;
+            from = std::max(from, cur);
+            CHECK_ERRS(_search_mem_routine(cur, from, pattern, found, found_addr));
+            if (!found)
+                CHECK_ERRS(_search_mem_host(from, to - from + plen - 1, pattern, found, found_addr));
+            if (found)
+                break;
+            cur = to;
+        }
+        if (!found)
+            CHECK_ERRS(_search_mem_routine(cur, stop, pattern, found, found_addr));
+    }
+    if (found)
+        LOG_DEBUG_LAZY(log_, strfmt("Pattern of %zu bytes found @0x%08X", pattern.size(), found_addr));
+    return RCODE_OK;
+}
+
+// ----- Program Loading -------------------------------------------------------
+
+uint64_t mem_digest(const uint8_t *data, size_t nwords) {
+    uint32_t s1 = 0, s2 = 0;
+    for (size_t w = 0; w < nwords; ++w) {
+        WordBytes_t value;
+        std::memcpy(value.bytes, data + 4 * w, 4);
+        s1 += value.word;
+        s2 += s1;
+    }
+    return (static_cast<uint64_t>(s2) << 32) | s1;
+}
+
+int Backend::checksum_mem(const uint32_t addr, const uint32_t nbytes, const uint32_t chunk, std::vector<uint64_t> &digests) {
+    CHECK_SELECTED();
+    digests.clear();
+    if ((addr | nbytes | chunk) & 0x3 || chunk == 0) {
+        log_->error("Checksum range and chunk size must be word aligned");
+        return RCODE_INVALID_ARG;
+    }
+    if (nbytes == 0)
+        return RCODE_OK;
+    if (!has_scratch_mem()) {
+        log_->error("No scratch memory for the checksum routine (param scratch_mem)");
+        return RCODE_ERROR;
+    }
+    if (_scratch_mem_overlaps(addr, nbytes)) {
+        log_->error(strfmt("Checksum range @0x%08X overlaps scratch memory", addr));
+        return RCODE_INVALID_ARG;
     }
 
-    // Restore t0 & t1
-    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, t0_val), "Failed to restore t0 value to DSCRATCH");
-    CHECK_ERR(inject_instruction(strfmt("csrr t0, %d", RV_CSR_VX_DSCRATCH)), "Failed to restore t0 from DSCRATCH");
-    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, t1_val), "Failed to restore t1 value to DSCRATCH");
-    CHECK_ERR(inject_instruction(strfmt("csrr t1, %d", RV_CSR_VX_DSCRATCH)), "Failed to restore t1 from DSCRATCH");
-
-
-    // trim extra bytes
-    size_t head_offset = addr - start_addr;
-    if (head_offset || size_in_bytes != nbytes) {
-        // Adjust for unaligned start address and requested size
-        if (head_offset) data.erase(data.begin(), data.begin() + head_offset);
-        // Trim to requested size
-        if (data.size() > nbytes) data.resize(nbytes);
+    // As many chunks per run as the out area after the routine holds
+    const size_t max_chunks = (scratch_mem_size_ / 4 - CKSUM_NCODE - 3) / 2;
+    if (scratch_mem_size_ / 4 <= CKSUM_NCODE + 3 + 2) {
+        log_->error(strfmt("Scratch memory of %u bytes is too small for the checksum routine", scratch_mem_size_));
+        return RCODE_INVALID_ARG;
+    }
+    const uint64_t end = static_cast<uint64_t>(addr) + nbytes;
+    std::vector<uint32_t> out;
+    uint32_t result = 0;
+    for (uint64_t cur = addr; cur < end; ) {
+        uint64_t n = std::min<uint64_t>(end - cur, static_cast<uint64_t>(max_chunks) * chunk);
+        size_t nchunks = (n + chunk - 1) / chunk;
+        CHECK_ERR(_run_routine(routine_checksum(cur, cur + n, chunk), CKSUM_NCODE, 2 * nchunks, out, result),
+                  strfmt("Failed to checksum %u bytes @0x%08X", static_cast<uint32_t>(n), static_cast<uint32_t>(cur)));
+        for (size_t i = 0; i < nchunks; ++i)
+            digests.push_back((static_cast<uint64_t>(out[2 * i + 1]) << 32) | out[2 * i]);
+        cur += n;
     }
+    LOG_DEBUG_LAZY(log_, strfmt("Checksummed %u bytes @0x%08X in %zu chunks", nbytes, addr, digests.size()));
     return RCODE_OK;
 }
 
-// Write memory
-int Backend::write_mem(const uint32_t addr, const std::vector<uint8_t> &data) {
+int Backend::load_mem(const uint32_t addr, const std::vector<uint8_t> &data, bool delta, LoadStats_t *stats) {
     CHECK_SELECTED();
     CHECK_HALTED();
 
-    size_t nbytes = data.size();   
-    if (nbytes == 0)
+    LoadStats_t st;
+    if (stats) *stats = st;
+    if (data.empty())
         return RCODE_OK;
 
-    // Compute word aligned address
-    uint32_t end_addr   = (addr + nbytes);
-    
-    // --- Save t0 & t1 ---
-    uint32_t t0_val = 0, t1_val = 0;
-    CHECK_ERR(inject_instruction(strfmt("csrw %d, t0", RV_CSR_VX_DSCRATCH)), "Failed to save t0");
-    CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, t0_val), "Failed to read t0");
-    CHECK_ERR(inject_instruction(strfmt("csrw %d, t1", RV_CSR_VX_DSCRATCH)), "Failed to save t1");
-    CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, t1_val), "Failed to read t1");
-
-    // --- Pre-assemble common instructions ---
-    const uint32_t csrr_t0_dscratch = rv_asm({strfmt("csrr t0, %d", RV_CSR_VX_DSCRATCH)}).at(0);
-    const uint32_t csrr_t1_dscratch = rv_asm({strfmt("csrr t1, %d", RV_CSR_VX_DSCRATCH)}).at(0);
-    const uint32_t csrw_dscratch_t1 = rv_asm({strfmt("csrw %d, t1", RV_CSR_VX_DSCRATCH)}).at(0);
-    const uint32_t lw_t1_t0         = rv_asm({"lw t1, 0(t0)"}).at(0);
-    const uint32_t sw_t1_t0         = rv_asm({"sw t1, 0(t0)"}).at(0);
-    const uint32_t addi_t0_4        = rv_asm({"addi t0, t0, 4"}).at(0);
-
-    uint32_t cur = addr;    // running address
-    size_t idx = 0;
-
-    // --- Leading partial word ---
-    if (cur % 4 != 0) {
-        uint32_t curr_base_addr = cur & ~0x3;
-        // Synchronize t0 with current address
-        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, curr_base_addr), "Failed to write base addr");
-        CHECK_ERR(inject_instruction(csrr_t0_dscratch), "Failed to read t0 from DSCRATCH");
-
-        // Read original value
-        WordBytes_t value;
-        CHECK_ERR(inject_instruction(lw_t1_t0), "Failed to load original word into t1");
-        CHECK_ERR(inject_instruction(csrw_dscratch_t1), "Failed to save t1");
-        CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, value.word), "Failed to read orig word");
-
-        // Patch original word
-        size_t head_offset = cur % 4;
-        size_t take = std::min<size_t>(4 - head_offset, data.size() - idx);
-        for (unsigned i = head_offset; i < head_offset + take; ++i)
-            value.bytes[i] = data[idx++];
-        cur += take;
+    std::vector<uint8_t> image(data);
+    _overlay_breakpoints(addr, image);
 
-        // Write back patched word
-        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value.word), "Failed to write patched word");
-        CHECK_ERR(inject_instruction(csrr_t1_dscratch), "Failed to read t1 from DSCRATCH");
-        CHECK_ERR(inject_instruction(sw_t1_t0), "Failed to store word into memory");
+    // Partial head/tail words are written as is, whole words are checked in chunks
+    const uint64_t end = static_cast<uint64_t>(addr) + image.size();
+    const uint64_t wstart = (static_cast<uint64_t>(addr) + 3) & ~0x3ull;
+    const uint64_t wend = std::max<uint64_t>(wstart, end & ~0x3ull);
+    if (delta && (!has_scratch_mem() || _scratch_mem_overlaps(addr, image.size()) || wend == wstart)) {
+        log_->debug("No scratch memory for the checksum routine, loading without checksums");
+        delta = false;
+    }
+    std::vector<uint64_t> digests;
+    if (delta)
+        CHECK_ERR(checksum_mem(wstart, wend - wstart, load_chunk_, digests), strfmt("Failed to checksum @0x%08X", addr));
+    if (!delta) {
+        CHECK_ERR(_write_mem_overlaid(addr, image), strfmt("Failed to load %zu bytes @0x%08X", image.size(), addr));
+        st.chunks_written = 1;
+        st.bytes_written = image.size();
+        stats_.load_written.add();
+        if (stats) *stats = st;
+        return RCODE_OK;
     }
 
-    // --- Middle full words ---
-    if (end_addr - cur >= 4) {  // at least one full word to write
-        // Synchronize t0 with current address
-        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, cur), "Failed to write current addr");
-        CHECK_ERR(inject_instruction(csrr_t0_dscratch), "Failed to read t0 from DSCRATCH");
-
-        while ((end_addr - cur) >= 4) {
-            WordBytes_t value;
-            std::memcpy(value.bytes, &data[idx], 4);
-            CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value.word), "Failed to write word to DSCRATCH");
-            CHECK_ERR(inject_instruction(csrr_t1_dscratch), "Failed to read t1 from DSCRATCH");
-            CHECK_ERR(inject_instruction(sw_t1_t0), "Failed to store word into memory");
-            CHECK_ERR(inject_instruction(addi_t0_4), "Failed to increment t0");
-            cur += 4;
-            idx += 4;
+    // Runs of changed chunks (and the partial words) are written in one go
+    auto write_range = [&](uint64_t from, uint64_t to) {
+        std::vector<uint8_t> part(image.begin() + (from - addr), image.begin() + (to - addr));
+        return _write_mem_overlaid(from, part);
+    };
+    uint64_t pending = addr;            // start of the range still to be written
+    uint64_t cur = wstart;
+    for (uint64_t digest : digests) {
+        uint64_t n = std::min<uint64_t>(load_chunk_, wend - cur);
+        if (digest == mem_digest(&image[cur - addr], n / 4)) {
+            if (pending < cur)
+                CHECK_ERR(write_range(pending, cur), strfmt("Failed to load chunk @0x%08X", static_cast<uint32_t>(pending)));
+            pending = cur + n;
+            st.chunks_skipped++;
+            stats_.load_skipped.add();
+        } else {
+            st.chunks_written++;
+            st.bytes_written += n;
+            stats_.load_written.add();
         }
+        cur += n;
     }
-        
-    // --- Trailing partial word ---
-    if (cur < end_addr) {
-        // synchronize t0 with current address
-        uint32_t base = cur & ~0x3;
-        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, base), "Failed to write current addr");
-        CHECK_ERR(inject_instruction(csrr_t0_dscratch), "Failed to read t0 from DSCRATCH");
-
-        // Read original word
-        WordBytes_t value;
-        CHECK_ERR(inject_instruction(lw_t1_t0), "Failed to load original word into t1");
-        CHECK_ERR(inject_instruction(csrw_dscratch_t1), "Failed to save t1");
-        CHECK_ERR(dmreg_rd(DMReg_t::DSCRATCH, value.word), "Failed to read orig word");
-
-        // Patch original word
-        size_t take = end_addr - cur;
-        for (unsigned i = 0; i < take; ++i)
-            value.bytes[i] = data[idx++];
-        cur += take;
+    if (pending < end)
+        CHECK_ERR(write_range(pending, end), strfmt("Failed to load chunk @0x%08X", static_cast<uint32_t>(pending)));
+    st.bytes_written += (wstart - addr) + (end - wend);
+    LOG_DEBUG_LAZY(log_, strfmt("Loaded %zu bytes @0x%08X: %u chunks skipped, %u written", image.size(), addr,
+                                st.chunks_skipped, st.chunks_written));
+    if (stats) *stats = st;
+    return RCODE_OK;
+}
 
-        // Write back patched word
-        CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, value.word), "Failed to write patched word to DSCRATCH");
-        CHECK_ERR(inject_instruction(csrr_t1_dscratch), "Failed to read t1 from DSCRATCH");
-        CHECK_ERR(inject_instruction(sw_t1_t0), "Failed to store word into memory");
+void Backend::_overlay_breakpoints(const uint32_t addr, std::vector<uint8_t> &image) {
+    const uint64_t end = static_cast<uint64_t>(addr) + image.size();
+    for (auto& [bpaddr, bpinfo] : breakpoints_) {
+        if (!bpinfo.inserted || bpaddr + 4ull <= addr || bpaddr >= end)
+            continue;
+        WordBytes_t orig, brk;
+        orig.word = bpinfo.replaced_instr;
+        brk.word = rv_ebreak();
+        for (unsigned b = 0; b < 4; ++b) {
+            uint64_t a = static_cast<uint64_t>(bpaddr) + b;
+            if (a >= addr && a < end) {
+                orig.bytes[b] = image[a - addr];
+                image[a - addr] = brk.bytes[b];
+            }
+        }
+        bpinfo.replaced_instr = orig.word;
     }
-
-    // --- Restore t0 & t1 ---
-    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, t0_val), "Failed to restore t0 value to DSCRATCH");
-    CHECK_ERR(inject_instruction(strfmt("csrr t0, %d", RV_CSR_VX_DSCRATCH)), "Failed to restore t0 from DSCRATCH");
-    CHECK_ERR(dmreg_wr(DMReg_t::DSCRATCH, t1_val), "Failed to restore t1 value to DSCRATCH");
-    CHECK_ERR(inject_instruction(strfmt("csrr t1, %d", RV_CSR_VX_DSCRATCH)), "Failed to restore t1 from DSCRATCH");
-
-    return RCODE_OK;
 }
 
 // ----- Breakpoint Management -------------------------------------------------
@@ -1036,27 +3006,19 @@ int Backend::set_breakpoint(uint32_t addr) {
         log_->warn(strfmt("Breakpoint already exists at 0x%08X", addr));
         return RCODE_OK;
     }
+    if (addr & 0x3) {
+        log_->error(strfmt("Breakpoint address 0x%08X is not word aligned", addr));
+        return RCODE_INVALID_ARG;
+    }
 
-    // Get instruction at address
-    WordBytes_t instr;
-    std::vector<uint8_t> instr_data;
-    CHECK_ERR(read_mem(addr, 4, instr_data), "Failed to read instruction for breakpoint");
-    std::copy(instr_data.begin(), instr_data.begin() + 4, instr.bytes);
-
-    // Write ebreak instruction at the address
-    WordBytes_t ebreak_instr;
-    ebreak_instr.word = rv_asm({"ebreak"}).at(0);
-    std::vector<uint8_t> ebreak_data(ebreak_instr.bytes, ebreak_instr.bytes + 4);
-    CHECK_ERR(write_mem(addr, ebreak_data), "Failed to write ebreak instruction for breakpoint");
-    
-    // Add to breakpoint table
-    BreakPointInfo_t bpinfo = {
-        .enabled = true,
-        .addr = addr,
-        .replaced_instr = instr.word,
-        .hit_count = 0
-    };
-    breakpoints_[addr] = bpinfo;    // insert new breakpoint
+    if (it != breakpoints_.end()) {
+        it->second.enabled = true;      // Pending removal: the ebreak is still in memory
+    } else {
+        BreakPointInfo_t bpinfo;
+        bpinfo.enabled = true;
+        bpinfo.addr = addr;
+        breakpoints_[addr] = bpinfo;    // inserted on next commit
+    }
 
     log_->info(strfmt("Breakpoint set at 0x%08X", addr));
     return RCODE_OK;
@@ -1070,21 +3032,190 @@ int Backend::remove_breakpoint(uint32_t addr) {
         return RCODE_OK;
     }
 
-    // Restore original instruction
-    WordBytes_t orig_instr;
-    orig_instr.word = it->second.replaced_instr;
-    std::vector<uint8_t> orig_data(orig_instr.bytes, orig_instr.bytes + 4);
-    CHECK_ERR(write_mem(addr, orig_data), "Failed to restore original instruction for breakpoint");
-
-    // Remove from breakpoint table
-    breakpoints_.erase(it);
+    if (it->second.inserted)
+        it->second.enabled = false;     // original instruction restored on next commit
+    else
+        breakpoints_.erase(it);         // never reached memory
 
     log_->info(strfmt("Breakpoint removed at 0x%08X", addr));
     return RCODE_OK;
 }
 
+int Backend::commit_breakpoints() {
+    // Collect pending changes, set+remove pairs of the same address have cancelled out already
+    std::vector<uint32_t> ins_addrs, wr_addrs, wr_vals;
+    for (const auto& [addr, bpinfo] : breakpoints_) {
+        bool want = bpinfo.enabled && !use_emulated_breakpoints_;
+        if (want && !bpinfo.inserted) {
+            ins_addrs.push_back(addr);
+        } else if (!want && bpinfo.inserted) {
+            wr_addrs.push_back(addr);
+            wr_vals.push_back(bpinfo.replaced_instr);
+        }
+    }
+    if (ins_addrs.empty() && wr_addrs.empty())
+        return RCODE_OK;
+
+    size_t nremoved = wr_addrs.size();
+    for (uint32_t addr : ins_addrs) {
+        wr_addrs.push_back(addr);
+        wr_vals.push_back(rv_ebreak());
+    }
+
+    std::vector<uint32_t> orig_instrs;
+    CHECK_ERR(_bp_mem_session(ins_addrs, orig_instrs, wr_addrs, wr_vals), "Failed to commit breakpoints");
+
+    for (size_t i = 0; i < wr_addrs.size(); ++i) {
+        WordBytes_t word;
+        word.word = wr_vals[i];
+        _memcache_update(wr_addrs[i], std::vector<uint8_t>(word.bytes, word.bytes + 4), false);
+        auto it = breakpoints_.find(wr_addrs[i]);
+        if (i < nremoved) {
+            if (it->second.enabled)
+                it->second.inserted = false;    // emulated mode: keep the breakpoint
+            else
+                breakpoints_.erase(it);
+        } else {
+            it->second.inserted = true;
+            it->second.replaced_instr = orig_instrs[i - nremoved];
+        }
+    }
+    LOG_DEBUG_LAZY(log_, strfmt("Committed breakpoints: %zu inserted, %zu removed", ins_addrs.size(), nremoved));
+    return RCODE_OK;
+}
+
+int Backend::_bp_mem_session(const std::vector<uint32_t> &rd_addrs, std::vector<uint32_t> &rd_vals,
+                             const std::vector<uint32_t> &wr_addrs, const std::vector<uint32_t> &wr_vals) {
+    rd_vals.assign(rd_addrs.size(), 0);
+
+    if (has_mem_bulk()) {
+        // One MADDR/MDATA pair per word, all in a single flush
+        for (size_t i = 0; i < rd_addrs.size(); ++i) {
+            _dmreg_queue_wr(DMReg_t::MADDR, rd_addrs[i]);
+            _dmreg_queue_rd(DMReg_t::MDATA, &rd_vals[i]);
+        }
+        for (size_t i = 0; i < wr_addrs.size(); ++i) {
+            _dmreg_queue_wr(DMReg_t::MADDR, wr_addrs[i]);
+            _dmreg_queue_wr(DMReg_t::MDATA, wr_vals[i]);
+        }
+        return _dmreg_flush();
+    }
+
+    // Injection needs a halted thread, borrow one if the selected warp is running
+    CHECK_SELECTED();
+    const int orig_wid = state_.selected_wid, orig_tid = state_.selected_tid;
+    bool is_active = false, is_halted = false;
+    CHECK_ERR(get_warp_state(orig_wid, is_active, is_halted), "Failed to get selected warp state");
+    if (!is_active || !is_halted) {
+        const WarpStateSnapshot_t *snap = nullptr;
+        CHECK_ERR(get_warp_snapshot(snap), "Failed to get warp state");
+        int wid = 0;
+        const int nwarps = get_num_warps();
+        while (wid < nwarps && !(snap->is_active(wid) && snap->is_halted(wid)))
+            wid++;
+        if (wid == nwarps) {
+            log_->error("No halted warp to access memory through");
+            return RCODE_WARP_NOT_HALTED;
+        }
+        CHECK_ERRS(select_warp_thread(wid, 0));
+    }
+
+    int rc = RCODE_TIMEOUT;
+    bool reads_done = false;
+    if (pipeline_window_ > 0) {
+        rc = _bp_mem_session_injected(rd_addrs, rd_vals, wr_addrs, wr_vals, reads_done);
+        if (rc == RCODE_TIMEOUT)
+            log_->warn("Streamed breakpoint commit failed, retrying in blocking mode");
+    }
+    if (rc == RCODE_TIMEOUT) {
+        // Unpipelined: word by word. Some streamed ebreak writes may have landed,
+        // so originals are only re-read if the streamed reads did not complete
+        // (no write was queued then).
+        rc = RCODE_OK;
+        std::vector<uint8_t> data;
+        for (size_t i = 0; i < rd_addrs.size() && !reads_done && rc == RCODE_OK; ++i) {
+            rc = _read_mem(rd_addrs[i], 4, data);
+            if (rc == RCODE_OK)
+                std::memcpy(&rd_vals[i], data.data(), 4);
+        }
+        for (size_t i = 0; i < wr_addrs.size() && rc == RCODE_OK; ++i) {
+            WordBytes_t word;
+            word.word = wr_vals[i];
+            rc = _write_mem(wr_addrs[i], std::vector<uint8_t>(word.bytes, word.bytes + 4));
+        }
+    }
+
+    if (state_.selected_wid != orig_wid)
+        CHECK_ERRS(select_warp_thread(orig_wid, orig_tid));
+    return rc;
+}
+
+int Backend::_bp_mem_session_injected(const std::vector<uint32_t> &rd_addrs, std::vector<uint32_t> &rd_vals,
+                                      const std::vector<uint32_t> &wr_addrs, const std::vector<uint32_t> &wr_vals,
+                                      bool &reads_done) {
+    constexpr uint32_t csrw_dscratch_t1 = rv_csrw(RV_CSR_VX_DSCRATCH, RV_GPR_T1);
+    constexpr uint32_t csrr_t0_dscratch = rv_csrr(RV_GPR_T0, RV_CSR_VX_DSCRATCH);
+    constexpr uint32_t csrr_t1_dscratch = rv_csrr(RV_GPR_T1, RV_CSR_VX_DSCRATCH);
+    constexpr uint32_t lw_t1_t0 = rv_lw(RV_GPR_T1, 0, RV_GPR_T0);
+    constexpr uint32_t sw_t1_t0 = rv_sw(RV_GPR_T1, 0, RV_GPR_T0);
+
+    ScratchGuard scratch(*this, SCRATCH_T0_T1);
+    CHECK_ERR(scratch.rc(), "Failed to save t0/t1");
+    uint32_t dctrl_injectreq = 0;
+    CHECK_ERRS(_get_dctrl_inject(dctrl_injectreq));
+
+    // Completion of every injection is verified after each flush
+    std::vector<uint32_t> dctrl_after;
+    size_t ninj = 0;
+    auto inject = [&](uint32_t instr) { _queue_inject(instr, dctrl_injectreq, &dctrl_after[ninj++]); };
+    auto completed = [&]() {
+        for (uint32_t v : dctrl_after) {
+            if (extract_dmreg_field(DMReg_t::DCTRL, "injectstate", v) != 0) {
+                log_->debug("Streamed injection did not complete in time");
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Originals first: an ebreak write must not land before its word was read
+    reads_done = false;
+    dctrl_after.assign(3 * rd_addrs.size(), 0);
+    for (size_t i = 0; i < rd_addrs.size(); ++i) {
+        _dmreg_queue_wr(DMReg_t::DSCRATCH, rd_addrs[i]);
+        inject(csrr_t0_dscratch);
+        inject(lw_t1_t0);
+        inject(csrw_dscratch_t1);
+        _dmreg_queue_rd(DMReg_t::DSCRATCH, &rd_vals[i]);
+    }
+    CHECK_ERRS(_dmreg_flush());
+    if (!completed())
+        return RCODE_TIMEOUT;
+    reads_done = true;
+
+    dctrl_after.assign(3 * wr_addrs.size(), 0);
+    ninj = 0;
+    for (size_t i = 0; i < wr_addrs.size(); ++i) {
+        _dmreg_queue_wr(DMReg_t::DSCRATCH, wr_addrs[i]);
+        inject(csrr_t0_dscratch);
+        _dmreg_queue_wr(DMReg_t::DSCRATCH, wr_vals[i]);
+        inject(csrr_t1_dscratch);
+        inject(sw_t1_t0);
+    }
+    CHECK_ERRS(_dmreg_flush());
+    if (!completed())
+        return RCODE_TIMEOUT;
+    scratch.done();
+    return RCODE_OK;
+}
+
 std::unordered_map<uint32_t, BreakPointInfo_t> Backend::get_breakpoints() const {
-    return breakpoints_;
+    std::unordered_map<uint32_t, BreakPointInfo_t> bps;
+    for (const auto& [addr, bpinfo] : breakpoints_) {
+        if (bpinfo.enabled)
+            bps[addr] = bpinfo;
+    }
+    return bps;
 }
 
 int Backend::any_breakpoints(bool &anybps) const {
@@ -1098,46 +3229,118 @@ int Backend::any_breakpoints(bool &anybps) const {
     return RCODE_OK;
 }
 
-int Backend::until_breakpoint(bool auto_select) {
-    while(true) {
-        // Check if any warp halted
+int Backend::_wait_any_halted() {
+    ScopedLatency lat(stats_.halt_wait);
+    bool events = transport_->halt_events_enabled();
+    unsigned delay_ms = HALT_WAIT_MIN_DELAY_MS;
+    while (true) {
         WarpSummary_t wsummary;
         CHECK_ERR(get_warp_summary(wsummary), "Failed to get warp summary during continue");
-        if (wsummary.anyhalted) {
-            log_->info("A warp has halted");
+        if (wsummary.anyhalted)
+            return RCODE_OK;
 
-            std::map<int, WarpStatus_t> warp_status;
-            CHECK_ERR(get_warp_status(warp_status), "Failed to get warp status after halt");
-            
-            // Find warps halted due to breakpoint
-            std::vector<int> halted_wids;
-            for (const auto& [wid, wstatus] : warp_status) {
-                if (wstatus.halted && wstatus.hacause == 0x1) {  // halt caused by breakpoint
-                    halted_wids.push_back(wid);
-                    log_->info(strfmt("Warp %d halted due to breakpoint", wid));
-                }
-            }
+        if (events) {
+            // Notification or periodic re-check, whichever comes first
+            int rc = transport_->wait_halt_event(HALT_EVENT_RECHECK_MS);
+            if (rc != RCODE_OK && rc != RCODE_TIMEOUT) return rc;
+        } else {
+            msleep(delay_ms);
+            delay_ms = std::min(2 * delay_ms, static_cast<unsigned>(HALT_WAIT_MAX_DELAY_MS));
+        }
+    }
+}
 
-            if(halted_wids.empty()) {
-                log_->info("No warps halted due to breakpoint, continuing...");
-                // Resume all warps and continue polling
-                CHECK_ERR(resume_warps(), "Failed to resume warps during continue");
-                continue;
-            }
+bool Backend::halt_events_enabled() const {
+    return transport_ && transport_->halt_events_enabled();
+}
+
+int Backend::wait_halt_event(unsigned timeout_ms) {
+    CHECK_TRANSPORT();
+    return transport_->wait_halt_event(timeout_ms);
+}
+
+std::unique_lock<std::recursive_mutex> Backend::lock_cmd() {
+    cmd_waiters_++;
+    std::unique_lock<std::recursive_mutex> lk(cmd_mtx_);
+    cmd_waiters_--;
+    return lk;
+}
+
+int Backend::until_breakpoint(bool auto_select) {
+    if (use_emulated_breakpoints_)
+        return _until_breakpoint_emulated(auto_select);
+
+    while(true) {
+        // Wait until any warp halted
+        CHECK_ERRS(_wait_any_halted());
+        log_->info("A warp has halted");
 
-            if (auto_select && !halted_wids.empty()) {
-                CHECK_ERR(select_warp_thread(halted_wids[0], 0), "Failed to select halted warp");
-                log_->info(strfmt("Automatically selected warp %d, thread 0", halted_wids[0]));
+        std::map<int, WarpStatus_t> warp_status;
+        CHECK_ERR(get_warp_status(warp_status), "Failed to get warp status after halt");
+        
+        // Find warps halted due to breakpoint
+        std::vector<int> halted_wids;
+        for (const auto& [wid, wstatus] : warp_status) {
+            if (wstatus.halted && wstatus.hacause == 0x1) {  // halt caused by breakpoint
+                halted_wids.push_back(wid);
+                auto bp = breakpoints_.find(wstatus.pc);
+                if (bp != breakpoints_.end())
+                    bp->second.hit_count++;
+                log_->info(strfmt("Warp %d halted due to breakpoint", wid));
             }
-            return RCODE_OK;
         }
-        // Sleep for a short duration before polling again
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        if(halted_wids.empty()) {
+            log_->info("No warps halted due to breakpoint, continuing...");
+            // Resume all warps and continue polling
+            CHECK_ERR(resume_warps(), "Failed to resume warps during continue");
+            continue;
+        }
+
+        if (auto_select && !halted_wids.empty()) {
+            CHECK_ERR(select_warp_thread(halted_wids[0], 0), "Failed to select halted warp");
+            log_->info(strfmt("Automatically selected warp %d, thread 0", halted_wids[0]));
+        }
+        return RCODE_OK;
     }
+}
 
-    log_->warn("continue until breakpoint not supported yet");
-    return RCODE_OK;
+int Backend::_until_breakpoint_emulated(bool auto_select) {
+    // No ebreaks in code memory: step the halted warps in turn and compare PCs
+    CHECK_ERRS(commit_breakpoints());   // takes out previously inserted ebreaks
+
+    std::map<int, WarpStatus_t> warp_status;
+    CHECK_ERR(get_warp_status(warp_status, false, false), "Failed to get warp status");
+    std::vector<int> wids;
+    for (const auto& [wid, wstatus] : warp_status) {
+        if (wstatus.active && wstatus.halted)
+            wids.push_back(wid);
+    }
+    if (wids.empty()) {
+        log_->error("Emulated breakpoints need halted warps to step");
+        return RCODE_WARP_NOT_HALTED;
+    }
 
+    const int orig_wid = state_.selected_wid, orig_tid = state_.selected_tid;
+    log_->info("Stepping warps " + vecjoin<int>(wids) + " until a breakpoint is reached (emulated breakpoints)");
+    while (true) {
+        for (int wid : wids) {
+            uint32_t pc;
+            CHECK_ERRS(select_warp_thread(wid, 0));
+            CHECK_ERR(_step_selected(pc), "Failed to step warp " + std::to_string(wid));
+            auto it = breakpoints_.find(pc);
+            if (it == breakpoints_.end() || !it->second.enabled)
+                continue;
+            it->second.hit_count++;
+            log_->info(strfmt("Warp %d reached breakpoint at 0x%08X", wid, pc));
+            if (auto_select) {
+                log_->info(strfmt("Automatically selected warp %d, thread 0", wid));
+            } else if (orig_wid >= 0) {
+                CHECK_ERRS(select_warp_thread(orig_wid, orig_tid));
+            }
+            return RCODE_OK;
+        }
+    }
 }
 
 //==============================================================================
@@ -1160,6 +3363,8 @@ std::string Backend::_get_platform_info_str() const {
     info += strfmt("  Total Cores   : %u\n", state_.platinfo.num_total_cores);
     info += strfmt("  Total Warps   : %u\n", state_.platinfo.num_total_warps);
     info += strfmt("  Total Threads : %u\n", state_.platinfo.num_total_threads);
+    info += strfmt("  Warp Gather   : %s\n", state_.platinfo.has_wgather ? "Yes" : "No");
+    info += strfmt("  Lane Access   : %s\n", state_.platinfo.has_lanes ? "Yes" : "No");
     return info;
 }
 
@@ -1167,19 +3372,235 @@ std::string Backend::_get_platform_info_str() const {
 // Low-level DM register access
 //==============================================================================
 
-int Backend::dmreg_rd(const DMReg_t &reg, uint32_t &value) {
+Backend::DMRegShadow_t* Backend::_dmreg_shadow(const DMReg_t &reg) {
+    if (!use_dmreg_cache_ || get_dmreg(reg).policy != DMRegPolicy_t::CACHED)
+        return nullptr;
+
+    if (reg == DMReg_t::WMASK) {
+        // WMASK is banked by DSELECT.winsel, only cacheable if winsel is known
+        const auto &dselect = dmreg_shadow_[static_cast<size_t>(DMReg_t::DSELECT)];
+        if (!dselect.valid)
+            return nullptr;
+        return &wmask_shadow_[extract_dmreg_field(DMReg_t::DSELECT, "winsel", dselect.value)];
+    }
+    return &dmreg_shadow_[static_cast<size_t>(reg)];
+}
+
+void Backend::dmreg_cache_invalidate() {
+    for (auto &shadow : dmreg_shadow_)
+        shadow.valid = false;
+    wmask_shadow_.clear();
+    dctrl_inject_.valid = false;
+}
+
+int Backend::_dmreg_rd(const DMReg_t &reg, uint32_t &value, bool bypass_cache) {
     CHECK_TRANSPORT();
     const auto& rinfo = get_dmreg(reg);
+    DMRegShadow_t *shadow = _dmreg_shadow(reg);
+    if (shadow && shadow->valid && !bypass_cache) {
+        value = shadow->value;
+        return RCODE_OK;
+    }
     CHECK_ERR(transport_->read_reg(rinfo.addr, value), "Failed to read DM register " + std::string(rinfo.name));
-    log_->debug(strfmt("Rd DM.%s(0x%02X) => 0x%08X", rinfo.name.data(), rinfo.addr, value));
+    if (shadow) {
+        shadow->valid = true;
+        shadow->value = value;
+    }
     return RCODE_OK;
 }
 
-int Backend::dmreg_wr(const DMReg_t &reg, const uint32_t &value) {
+int Backend::_dmreg_wr(const DMReg_t &reg, const uint32_t &value) {
+    CHECK_TRANSPORT();
+    const auto& rinfo = get_dmreg(reg);
+    DMRegShadow_t *shadow = _dmreg_shadow(reg);
+    if (shadow && shadow->valid && shadow->value == value) {
+        // Cached registers have no write side effects, skip redundant write
+        return RCODE_OK;
+    }
+    if (reg == DMReg_t::DCTRL)
+        dctrl_inject_.valid = false;
+    int rc = transport_->write_reg(rinfo.addr, value);
+    if (rc != RCODE_OK) {
+        // Register state unknown after a failed write
+        if (shadow) shadow->valid = false;
+        log_->error("Failed to write DM register " + std::string(rinfo.name) + "  (rc=" + std::to_string(rc) + ")");
+        return rc;
+    }
+    if (shadow) {
+        shadow->valid = true;
+        shadow->value = value;
+    }
+    return RCODE_OK;
+}
+
+void Backend::_dmreg_queue_rd(const DMReg_t &reg, uint32_t *value) {
+    if (inject_stalled_)
+        return;
+    DMRegShadow_t *shadow = _dmreg_shadow(reg);
+    if (shadow && shadow->valid) {
+        *value = shadow->value;
+        return;
+    }
+    transport_->queue_read_reg(get_dmreg(reg).addr, value);
+}
+
+void Backend::_dmreg_queue_wr(const DMReg_t &reg, const uint32_t value) {
+    if (inject_stalled_)
+        return;
+    DMRegShadow_t *shadow = _dmreg_shadow(reg);
+    if (shadow && shadow->valid && shadow->value == value)
+        return;
+    transport_->queue_write_reg(get_dmreg(reg).addr, value);
+    if (shadow) {
+        // Optimistic update, invalidated if the flush fails
+        shadow->valid = true;
+        shadow->value = value;
+    }
+}
+
+int Backend::_dmreg_flush() {
+    CHECK_TRANSPORT();
+    int rc = transport_->flush();
+    if (inject_stalled_) {
+        inject_stalled_ = false;
+        if (rc == RCODE_OK)
+            rc = inject_stall_rc_;
+    }
+    if (rc != RCODE_OK) {
+        dmreg_cache_invalidate();
+        log_->error("Failed to flush pipelined DM access  (rc=" + std::to_string(rc) + ")");
+    }
+    return rc;
+}
+
+void Backend::_queue_inject(uint32_t instruction, uint32_t dctrl_injectreq, uint32_t *dctrl_after) {
+    if (inject_stalled_)
+        return;
+    if (!transport_->has_cap(TRANSPORT_INJSEQ_CAP)) {
+        // The DM may take the next DINJECT write while this one still runs:
+        // send what is queued, then inject and poll before anything else goes out
+        std::vector<BatchOp_t> ops;
+        std::vector<uint32_t> results;
+        _batch_inject(ops, instruction, dctrl_injectreq);
+        int rc = transport_->flush();
+        if (rc == RCODE_OK)
+            rc = _dmreg_batch(ops, results);
+        if (rc == RCODE_OK) {
+            *dctrl_after = results.back();
+            return;
+        }
+        // Callers see a timed out injection as incomplete and fall back
+        *dctrl_after = set_dmreg_field(DMReg_t::DCTRL, "injectstate", 0, 1);
+        inject_stalled_ = true;
+        inject_stall_rc_ = rc == RCODE_TIMEOUT ? RCODE_OK : rc;
+        return;
+    }
+    _dmreg_queue_wr(DMReg_t::DINJECT, instruction);
+    _dmreg_queue_wr(DMReg_t::DCTRL, dctrl_injectreq);
+    _dmreg_queue_rd(DMReg_t::DCTRL, dctrl_after);
+}
+
+int Backend::_get_dctrl_inject(uint32_t &dctrl_injectreq) {
+    if (!dctrl_inject_.valid || !use_dmreg_cache_) {
+        uint32_t dctrl = 0;
+        CHECK_ERRS(_dmreg_rd(DMReg_t::DCTRL, dctrl));
+        // Keep only the sticky control bits, request bits are pulses
+        uint32_t base = set_dmreg_field(DMReg_t::DCTRL, "dmactive", 0, extract_dmreg_field(DMReg_t::DCTRL, "dmactive", dctrl));
+        base = set_dmreg_field(DMReg_t::DCTRL, "resethaltreq", base, extract_dmreg_field(DMReg_t::DCTRL, "resethaltreq", dctrl));
+        dctrl_inject_.value = set_dmreg_field(DMReg_t::DCTRL, "injectreq", base, 1);
+        dctrl_inject_.valid = true;
+    }
+    dctrl_injectreq = dctrl_inject_.value;
+    return RCODE_OK;
+}
+
+int Backend::_get_dctrl_req(const std::string &reqname, uint32_t &dctrl) {
+    CHECK_ERRS(_get_dctrl_inject(dctrl));
+    dctrl = set_dmreg_field(DMReg_t::DCTRL, "injectreq", dctrl, 0);
+    dctrl = set_dmreg_field(DMReg_t::DCTRL, reqname, dctrl, 1);
+    return RCODE_OK;
+}
+
+void Backend::_batch_rd(std::vector<BatchOp_t> &ops, const DMReg_t &reg) {
+    ops.push_back(BatchOp_t::rd(get_dmreg(reg).addr));
+}
+
+void Backend::_batch_wr(std::vector<BatchOp_t> &ops, const DMReg_t &reg, const uint32_t value) {
+    DMRegShadow_t *shadow = _dmreg_shadow(reg);
+    if (shadow && shadow->valid && shadow->value == value)
+        return;
+    ops.push_back(BatchOp_t::wr(get_dmreg(reg).addr, value));
+    if (shadow) {
+        // Optimistic update, invalidated if the batch fails
+        shadow->valid = true;
+        shadow->value = value;
+    }
+}
+
+void Backend::_batch_pollfield(std::vector<BatchOp_t> &ops, const DMReg_t &reg, const std::string &fieldname,
+                               const uint32_t exp_value) {
+    const FieldInfo_t* finfo = get_dmreg_field(reg, fieldname);
+    ops.push_back(BatchOp_t::poll(get_dmreg(reg).addr, finfo->mask(), (exp_value << finfo->lsb) & finfo->mask()));
+}
+
+void Backend::_batch_inject(std::vector<BatchOp_t> &ops, uint32_t instruction, uint32_t dctrl_injectreq) {
+    stats_.injects.add();
+    _batch_wr(ops, DMReg_t::DINJECT, instruction);
+    _batch_wr(ops, DMReg_t::DCTRL, dctrl_injectreq);
+    _batch_pollfield(ops, DMReg_t::DCTRL, "injectstate", 0x0);
+}
+
+int Backend::_get_dconfig_warpinj(uint32_t &dconfig_on, uint32_t &dconfig_off) {
+    uint32_t dconfig = 0;
+    CHECK_ERRS(_dmreg_rd(DMReg_t::DCONFIG, dconfig));   // Served from the shadow copy
+    dconfig_on = set_dmreg_field(DMReg_t::DCONFIG, "warpinj", dconfig, 1);
+    dconfig_off = set_dmreg_field(DMReg_t::DCONFIG, "warpinj", dconfig, 0);
+    return RCODE_OK;
+}
+
+void Backend::_batch_lanes_rd(std::vector<BatchOp_t> &ops, size_t nlanes) {
+    ops.push_back(BatchOp_t::wr(get_dmreg(DMReg_t::LSEL).addr, 0));
+    for (size_t i = 0; i < nlanes; ++i)
+        _batch_rd(ops, DMReg_t::LSCRATCH);
+}
+
+void Backend::_batch_lanes_wr(std::vector<BatchOp_t> &ops, const std::vector<uint32_t> &values) {
+    ops.push_back(BatchOp_t::wr(get_dmreg(DMReg_t::LSEL).addr, 0));
+    for (uint32_t v : values)
+        ops.push_back(BatchOp_t::wr(get_dmreg(DMReg_t::LSCRATCH).addr, v));
+}
+
+int Backend::_lanes_batch(const std::vector<BatchOp_t> &ops, std::vector<uint32_t> &results, uint32_t dconfig_off) {
+    int rc = _dmreg_batch(ops, results);
+    if (rc != RCODE_OK) {
+        // Later single-thread injections must not run warp-wide
+        if (_dmreg_wr(DMReg_t::DCONFIG, dconfig_off) != RCODE_OK)
+            log_->warn("Failed to clear DCONFIG.warpinj");
+    }
+    return rc;
+}
+
+int Backend::_dmreg_batch(const std::vector<BatchOp_t> &ops, std::vector<uint32_t> &results) {
     CHECK_TRANSPORT();
+    int rc = transport_->batch(ops, results, poll_policy_, &poll_history_);
+    if (rc != RCODE_OK) {
+        dmreg_cache_invalidate();
+        log_->error("Failed to execute DM register batch  (rc=" + std::to_string(rc) + ")");
+    }
+    return rc;
+}
+
+int Backend::dmreg_rd(const DMReg_t &reg, uint32_t &value) {
+    const auto& rinfo = get_dmreg(reg);
+    CHECK_ERRS(_dmreg_rd(reg, value));
+    LOG_DEBUG_LAZY(log_, strfmt("Rd DM.%s(0x%02X) => 0x%08X", rinfo.name.data(), rinfo.addr, value));
+    return RCODE_OK;
+}
+
+int Backend::dmreg_wr(const DMReg_t &reg, const uint32_t &value) {
     const auto& rinfo = get_dmreg(reg);
-    CHECK_ERR(transport_->write_reg(rinfo.addr, value), "Failed to write DM register " + std::string(rinfo.name));
-    log_->debug(strfmt("Wr DM.%s(0x%02X) <= 0x%08X", rinfo.name.data(), rinfo.addr, value));
+    CHECK_ERRS(_dmreg_wr(reg, value));
+    LOG_DEBUG_LAZY(log_, strfmt("Wr DM.%s(0x%02X) <= 0x%08X", rinfo.name.data(), rinfo.addr, value));
     return RCODE_OK;
 }
 
@@ -1190,9 +3611,9 @@ int Backend::dmreg_rdfield(const DMReg_t &reg, const std::string &fieldname, uin
         const FieldInfo_t* finfo = get_dmreg_field(reg, fieldname);
     
         uint32_t reg_value = 0;
-        CHECK_ERR(transport_->read_reg(rinfo.addr, reg_value), "Failed to read DM register " + std::string(rinfo.name));
+        CHECK_ERRS(_dmreg_rd(reg, reg_value));
         value = extract_dmreg_field(reg, fieldname, reg_value);
-        log_->debug(strfmt("Rd DM.%s(0x%02X).%s => 0x%X", rinfo.name.data(), rinfo.addr, finfo->name.data(), value));
+        LOG_DEBUG_LAZY(log_, strfmt("Rd DM.%s(0x%02X).%s => 0x%X", rinfo.name.data(), rinfo.addr, finfo->name.data(), value));
         return RCODE_OK;
     } catch (const std::exception& e) {
         log_->error("Failed to read field: " + std::string(e.what()));
@@ -1207,17 +3628,17 @@ int Backend::dmreg_wrfield(const DMReg_t &reg, const std::string &fieldname, con
     try {
         const FieldInfo_t* finfo = get_dmreg_field(reg, fieldname);
 
-        // Read current register value
+        // Read current register value (served from shadow cache for CACHED registers)
         uint32_t curr_reg_value = 0;
-        CHECK_ERR(transport_->read_reg(rinfo.addr, curr_reg_value), "Failed to read DM register " + std::string(rinfo.name));
+        CHECK_ERRS(_dmreg_rd(reg, curr_reg_value));
 
         // Modify only the specific field
         uint32_t new_reg_value = set_dmreg_field(reg, fieldname, curr_reg_value, value);
         
         // Write back the modified register
-        CHECK_ERR(transport_->write_reg(rinfo.addr, new_reg_value), "Failed to write DM register " + std::string(rinfo.name));
+        CHECK_ERRS(_dmreg_wr(reg, new_reg_value));
 
-        log_->debug(strfmt("Wr DM.%s(0x%02X).%s <= 0x%X (NewRegVal: 0x%08X, OldRegVal: 0x%08X)", 
+        LOG_DEBUG_LAZY(log_, strfmt("Wr DM.%s(0x%02X).%s <= 0x%X (NewRegVal: 0x%08X, OldRegVal: 0x%08X)", 
                     rinfo.name.data(), rinfo.addr, finfo->name.data(), value, new_reg_value, curr_reg_value));
         return RCODE_OK;
     } catch (const std::exception& e) {
@@ -1231,51 +3652,66 @@ int Backend::dmreg_pollfield(const DMReg_t &reg, const std::string &fieldname, c
     CHECK_TRANSPORT();
     const auto& rinfo = get_dmreg(reg);
     
-    // Use default values if not provided
-    if (max_retries == -1) max_retries = poll_retries_;
-    if (delay_ms == -1) delay_ms = poll_delay_ms_;
+    // Explicit values override the deadline (retries x delay) and the backoff ceiling
+    PollPolicy_t policy = poll_policy_;
+    if (max_retries != -1 || delay_ms != -1) {
+        unsigned retries = max_retries == -1 ? poll_retries_ : max_retries;
+        unsigned delay = delay_ms == -1 ? poll_delay_ms_ : delay_ms;
+        policy.timeout_ms = retries * delay;
+        policy.max_delay_us = delay * 1000;
+    }
     
     try {
         const FieldInfo_t* finfo = get_dmreg_field(reg, fieldname);
 
         uint32_t field_mask = finfo->mask();
         uint32_t value = 0;
+        uint64_t key = PollHistory::key(rinfo.addr, field_mask);
+        ScopedLatency lat(stats_.poll);
     
-        for (int attempt = 0; attempt < max_retries; ++attempt) {
+        // Immediate re-read(s), then geometric backoff from the learned completion time
+        PollWaiter waiter(policy, poll_history_.initial_delay_us(key, policy));
+        do {
             // Read register value
             uint32_t reg_value = 0;
-            CHECK_ERR(transport_->read_reg(rinfo.addr, reg_value), "Failed to read DM register " + std::string(rinfo.name));
+            stats_.poll_iters.add();
+            CHECK_ERRS(_dmreg_rd(reg, reg_value, true));
             
             // Extract field value
             value = (reg_value & field_mask) >> finfo->lsb;
-            log_->debug(strfmt("Poll DM.%s(0x%02X).%s => 0x%X == 0x%X (RegVal: 0x%08X)", 
+            LOG_DEBUG_LAZY(log_, strfmt("Poll DM.%s(0x%02X).%s => 0x%X == 0x%X (RegVal: 0x%08X)", 
                         rinfo.name.data(), rinfo.addr, finfo->name.data(), value, exp_value, reg_value));
             
             // Check if expected value is reached
             if (value == exp_value) {
+                poll_history_.record(key, waiter);
+                stats_.poll_sleeps.add(waiter.sleeps());
                 if (final_value) {
                     *final_value = value;
                 }
                 return RCODE_OK;
             }
-            
-            // Don't sleep on the last iteration
-            if (attempt < max_retries - 1) {
-                msleep(delay_ms);
-            }
-        }
+        } while (waiter.next());
+        stats_.poll_sleeps.add(waiter.sleeps());
     
         // Store final value for caller inspection
         if (final_value) {
             *final_value = value;
         }
         
+        stats_.poll_timeouts.add();
         log_->error("MaxRetryReached: Field " + std::string(rinfo.name) + "." + std::string(finfo->name) +
                     " did not reach expected value 0x" + hex2str(exp_value) + 
-                    " (final value: 0x" + hex2str(value) + ")");
+                    " (final value: 0x" + hex2str(value) + ", " + std::to_string(waiter.reads()) + " reads)");
         return RCODE_TIMEOUT;
     } catch (const std::exception& e) {
         log_->error("Failed to poll field: " + std::string(e.what()));
         return RCODE_INVALID_ARG;
     }
 }
+
+void Backend::_update_poll_policy() {
+    // Same worst case as poll_retries_ reads poll_delay_ms_ apart
+    poll_policy_.timeout_ms = poll_retries_ * poll_delay_ms_;
+    poll_policy_.max_delay_us = poll_delay_ms_ * 1000;
+}
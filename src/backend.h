@@ -4,9 +4,13 @@
 #include <map>
 #include <unordered_map>
 #include <cstdint>
+#include <mutex>
+#include <atomic>
 
 #include "dmdefs.h"
 #include "util.h"  // Include util.h for RCODE_OK and other return codes
+#include "stats.h"
+#include "dmpoll.h"
 
 #ifndef DEFAULT_POLL_RETRIES
     #define DEFAULT_POLL_RETRIES 10
@@ -14,20 +18,91 @@
 #ifndef DEFAULT_POLL_DELAY_MS
     #define DEFAULT_POLL_DELAY_MS 100
 #endif
+#ifndef DEFAULT_PIPELINE_WINDOW
+    #define DEFAULT_PIPELINE_WINDOW 16
+#endif
+#ifndef DEFAULT_MEM_BULK_THRESHOLD
+    // Min transfer size (bytes) for DM block memory access, 0 disables it
+    #define DEFAULT_MEM_BULK_THRESHOLD 16
+#endif
+#ifndef HALT_WAIT_MIN_DELAY_MS
+    // Backoff bounds for halt polling when the server can't push halt notifications
+    #define HALT_WAIT_MIN_DELAY_MS 1
+    #define HALT_WAIT_MAX_DELAY_MS 64
+#endif
+#ifndef HALT_EVENT_RECHECK_MS
+    // Max wait for a halt notification before re-checking DCTRL
+    #define HALT_EVENT_RECHECK_MS 1000
+#endif
+#ifndef MEMCACHE_BLOCK_SZ
+    // Target memory cache block size in bytes (power of 2)
+    #define MEMCACHE_BLOCK_SZ 64
+#endif
+#ifndef LANES_MEM_BULK_MAX_MISSES
+    // Uncached memory cache blocks up to which read_mem_lanes() reads through
+    // read_mem() when block access is available, more take the warp-wide load
+    #define LANES_MEM_BULK_MAX_MISSES 4
+#endif
+#ifndef MEM_STREAM_CHUNK_WORDS
+    // Words per pipelined read_mem/write_mem chunk
+    #define MEM_STREAM_CHUNK_WORDS 64
+#endif
+
+#ifndef MEM_SCAN_CHUNK_SZ
+    // Bytes read per step by crc32_mem()/search_mem() without scratch memory
+    #define MEM_SCAN_CHUNK_SZ 4096
+#endif
+#ifndef ROUTINE_SCAN_SZ
+    // Bytes read per crc32_mem()/search_mem() routine run at most (bounds its run time)
+    #define ROUTINE_SCAN_SZ (256 * 1024)
+#endif
+#ifndef LOAD_CHUNK_SZ
+    // Default load_mem() delta chunk size in bytes (multiple of 4)
+    #define LOAD_CHUNK_SZ 1024
+#endif
+#ifndef DEFAULT_SCRATCH_MEM_SZ
+    // Default scratch memory size in bytes for target routines (param scratch_mem_size)
+    #define DEFAULT_SCRATCH_MEM_SZ 4096
+#endif
+#ifndef ROUTINE_TIMEOUT_MS
+    // Max run time of a target routine, the warp is halted after that
+    #define ROUTINE_TIMEOUT_MS 10000
+#endif
+
+#ifndef PLATFORM_CACHE_FILE
+    // Platform records (keyed by PLATFORM register value) in get_cache_dir()
+    #define PLATFORM_CACHE_FILE "platform.cache"
+#endif
+
+#ifndef STEP_BATCH_SZ
+    // Steps per batch of a multi-instruction step_warp()
+    #define STEP_BATCH_SZ 64
+#endif
 
 // Forward declarations
 class Transport;
+class InstrTrace;
+struct BatchOp_t;
 class Logger;
 class Backend;
 
+// Breakpoints are committed to target memory lazily (see commit_breakpoints):
+// 'enabled' is what was requested, 'inserted' what target memory holds.
 struct BreakPointInfo_t {
     bool enabled = false;       // Is the breakpoint enabled?
+    bool inserted = false;      // Is the ebreak currently written to memory?
     uint32_t addr = 0;          // Address of the breakpoint
-    uint32_t replaced_instr;    // Original instruction replaced by breakpoint
+    uint32_t replaced_instr = 0;    // Original instruction replaced by breakpoint (valid if inserted)
     uint32_t hit_count = 0;     // Number of times breakpoint has been hit
 };
 
 
+// PC of one running warp, as taken by Backend::sample_pcs()
+struct PcSample_t {
+    uint32_t wid;
+    uint32_t pc;
+};
+
 struct WarpStatus_t {
     int wid;
     bool active;
@@ -36,6 +111,51 @@ struct WarpStatus_t {
     uint32_t hacause;
 };
 
+// Higher level op counters (transport level ones are in TransportStats_t)
+struct BackendStats_t {
+    StatCounter injects;                    // Injected instructions (batched or not)
+    StatCounter poll_iters;                 // dmreg_pollfield() reads
+    StatCounter poll_sleeps;                // dmreg_pollfield() backoff sleeps
+    StatCounter poll_timeouts;
+    StatCounter mem_rd_bytes, mem_wr_bytes;
+    StatCounter memcache_hits, memcache_misses;   // In blocks
+    StatCounter load_skipped, load_written;       // load_mem() chunks
+    LatencyHist inject;                     // inject_instruction() calls
+    LatencyHist read_mem, write_mem;
+    LatencyHist halt_wait;                  // Blocking waits for a halt (continue)
+    LatencyHist poll;                       // dmreg_pollfield() calls
+};
+
+// Active/halted state of all warps from one batched sweep, packed as one
+// bitmap per 32-warp window. Halted warps keep their state (and PC/hacause)
+// until the debugger resumes/steps/resets them, which bumps the generation.
+struct WarpStateSnapshot_t {
+    bool valid = false;
+    uint64_t generation = 0;        // Backend warp state generation at sweep time
+    bool has_pc = false;            // pc[] fetched for halted/inactive warps
+    bool has_hacause = false;       // hacause[] fetched for halted/inactive warps
+    uint32_t num_running = 0;       // active and not halted at sweep time
+    std::vector<uint32_t> active;   // per window
+    std::vector<uint32_t> halted;   // per window
+    std::vector<uint32_t> pc;       // per warp
+    std::vector<uint32_t> hacause;  // per warp
+
+    bool is_active(int wid) const { return (active[wid / 32] >> (wid % 32)) & 0x1; }
+    bool is_halted(int wid) const { return (halted[wid / 32] >> (wid % 32)) & 0x1; }
+};
+
+// Outcome of one load_mem() call
+struct LoadStats_t {
+    uint32_t chunks_skipped = 0;    // Target checksum matched, not written
+    uint32_t chunks_written = 0;
+    uint64_t bytes_written = 0;
+};
+
+// Fletcher style digest of nwords little-endian words, as computed on the
+// target by Backend::checksum_mem(): s1 = sum(w[i]), s2 = sum(s1), both mod 2^32;
+// the digest is s2 << 32 | s1
+uint64_t mem_digest(const uint8_t *data, size_t nwords);
+
 struct WarpSummary_t {
     bool allhalted;
     bool anyhalted;
@@ -50,11 +170,15 @@ struct WarpSummary_t {
 ////////////////////////////////////////////////////////////////////////////////
 class Backend {
 public:
-    Backend();
+    explicit Backend(const std::string &target_name = "");
     ~Backend();
     void set_param(const std::string &param, std::string value);
     std::string get_param(const std::string &param) const;
 
+    // Transport, backend and assembler statistics as text or JSON
+    std::string get_stats(bool json);
+    void reset_stats();
+
     //==========================================================================
     // Transport management
     //==========================================================================
@@ -69,8 +193,10 @@ public:
     // Check transport connection status
     bool transport_connected() const;
 
-    // Initialization
-    int initialize(bool quiet=false);
+    // Initialization. attach: connect to a running target as is, reusing the
+    // persisted platform record instead of halting warp 0 to read MISA; warp
+    // state is fetched on first use.
+    int initialize(bool quiet=false, bool attach=false);
 
     //==========================================================================
     // API Methods
@@ -86,8 +212,9 @@ public:
     // Resets the target system, optionally halting all warps after reset
     int reset_platform(bool halt=false);
 
-    // Retrieves platform information from the target
-    int fetch_platform_info();
+    // Retrieves platform information from the target (use_cache: skip the
+    // MISA read if a record for this PLATFORM value was persisted)
+    int fetch_platform_info(bool use_cache=false);
 
     
     //----- Warp Selection -----------------
@@ -114,6 +241,12 @@ public:
     // Get active/halted state of a specific warp
     int get_warp_state(int wid, bool &active, bool &halted);
 
+    // Get the warp state snapshot, re-swept if it may be stale
+    int get_warp_snapshot(const WarpStateSnapshot_t *&snap, bool include_pc = false, bool include_hacause = false);
+
+    // Drop the warp state snapshot (warps may have changed state)
+    void warpstate_invalidate();
+
     // Read program counter of selected warp/thread
     int get_warp_pc(uint32_t &pc);
     
@@ -140,12 +273,31 @@ public:
     // Step currently selected warp/thread
     int step_warp();
 
+    // Step the selected warp/thread count times in batches of STEP_BATCH_SZ,
+    // appending the PC (and the traced GPRs) after every step to trace. Stops
+    // early on landing on a breakpoint; nsteps is the number of steps done.
+    int step_warp(uint32_t count, uint32_t &nsteps, InstrTrace *trace = nullptr);
+
+    // Append the PC of every running warp to samples, for the profiler. Without
+    // halting it is one batch over the gather registers; halting briefly halts
+    // the running warps, reads their PCs and resumes those stopped by the
+    // sampler (not the ones that hit a breakpoint meanwhile), in three batches.
+    // The DSELECT selection is restored either way.
+    int sample_pcs(bool halting, std::vector<PcSample_t> &samples);
+
+    // WGSEL/WGPC/WGCAUSE available and enabled (non-halting sample_pcs)
+    bool has_warp_gather() const { return use_warp_gather_ && state_.platinfo.has_wgather; }
+
     // Inject a single instruction into the selected warp/thread
     // NOTE: 
     //  - to enable fast injection, it skips selected/halted checks
     //  - Caller must make sure a warp is selected and halted
     int inject_instruction(uint32_t instruction);
     int inject_instruction(const std::string &asm_instr);
+
+    // Put back t0/t1 if they are held as scratch registers, call before
+    // injecting instructions that may use them
+    int restore_scratch();
     
     
     //----- Platform State Query/Update ----
@@ -153,6 +305,24 @@ public:
     int read_gpr(const uint32_t regnum, uint32_t &value);
     int write_gpr(const uint32_t regnum, const uint32_t value);
 
+    // Read all 32 GPRs of the selected thread in one sequence
+    int read_gprs(std::vector<uint32_t> &values);
+
+    // Read GPR regnum of every lane of the selected warp (values[tid]). With
+    // DCONFIG.lanes it is one warp-wide injection and one LSCRATCH sweep in a
+    // single batch, otherwise one thread at a time. Values of inactive lanes
+    // are undefined (see the vx_active_threads CSR).
+    int read_gpr_lanes(const uint32_t regnum, std::vector<uint32_t> &values);
+
+    // Warp-wide injection and LSEL/LSCRATCH available and enabled
+    bool has_lane_access() const { return use_lane_access_ && state_.platinfo.has_lanes; }
+
+    // Read multiple CSRs, saving/restoring t0 only once
+    int read_csrs(const std::vector<uint32_t> &regaddrs, std::vector<uint32_t> &values);
+
+    // Drop register snapshots of warp 'wid' (-1: all warps)
+    void regcache_invalidate(int wid = -1);
+
     // Read/Write the CSR value
     int read_csr(const uint32_t regaddr, uint32_t &value);
     int write_csr(const uint32_t regaddr, const uint32_t value);
@@ -166,15 +336,66 @@ public:
     int write_regs(const std::vector<std::string> &reg_names, const std::vector<uint32_t> &values);
 
     // Read/Write memory
+    // Reads are served from the memory cache while all warps are halted, breakpoint
+    // locations read back the original instruction; writes over an inserted
+    // breakpoint keep the ebreak and become its new original instruction.
     int read_mem(const uint32_t addr, const uint32_t nbytes, std::vector<uint8_t> &data);
     int write_mem(const uint32_t addr, const std::vector<uint8_t> &data);
 
+    // Load the word at addrs[i] (word aligned) in lane i of the selected warp,
+    // one load per active lane in parallel, bypassing the memory cache; t0 is
+    // parked in dscratch around the load, no register is clobbered. Lanes
+    // inactive in vx_active_threads are read through the selected thread. With
+    // block access, words in at most LANES_MEM_BULK_MAX_MISSES uncached blocks
+    // are read through read_mem() instead.
+    int read_mem_lanes(const std::vector<uint32_t> &addrs, std::vector<uint32_t> &values);
+
+    // Drop all cached target memory
+    void memcache_invalidate();
+
+    // Is block memory transfer (MADDR/MDATA) available on this connection?
+    bool has_mem_bulk() const;
+
+    // Scratch memory for target routines: scratch_mem_size bytes at scratch_mem
+    // (params), 0 (default) when the target has none. Its contents are saved
+    // and restored around every run.
+    bool has_scratch_mem() const { return scratch_mem_addr_ != 0; }
+
+    // Digests (see mem_digest) of the chunk sized pieces of [addr, addr + nbytes),
+    // the last one may be shorter; all word aligned. A routine staged in scratch
+    // memory computes them on the selected warp, only the digests are read back.
+    int checksum_mem(const uint32_t addr, const uint32_t nbytes, const uint32_t chunk, std::vector<uint64_t> &digests);
+
+    // CRC-32 of nbytes at addr as GDB's qCRC computes it (poly 0x04c11db7, MSB
+    // first, initial value 0xffffffff, no final xor), breakpoints read as originals.
+    // A routine staged in scratch memory computes it on the selected warp, only
+    // the CRC is read back. Without scratch memory (or when the region overlaps
+    // it) the region is read through read_mem() and the CRC computed here.
+    int crc32_mem(const uint32_t addr, const uint32_t nbytes, uint32_t &crc);
+
+    // First occurrence of pattern in [addr, addr + nbytes), breakpoints read as
+    // originals. Searched by a staged routine like crc32_mem(), only the match
+    // address is read back; matches covering an inserted breakpoint, and the
+    // whole search without scratch memory, are checked on read_mem() data.
+    int search_mem(const uint32_t addr, const uint32_t nbytes, const std::vector<uint8_t> &pattern,
+                   bool &found, uint32_t &found_addr);
+
+    // Write a program image. With delta, load_chunk sized chunks whose target
+    // checksum (checksum_mem) matches are skipped; without scratch memory the
+    // image is written in full. Inserted breakpoints are kept in place.
+    int load_mem(const uint32_t addr, const std::vector<uint8_t> &data, bool delta, LoadStats_t *stats = nullptr);
+
     // ----- Breakpoint Management -----
-    // Set/Remove breakpoints
+    // Set/Remove breakpoints, only recorded until the next commit_breakpoints()
     int set_breakpoint(uint32_t addr);
     int remove_breakpoint(uint32_t addr);
 
-    // Get breakpoints
+    // Write pending insertions/removals to target memory in one batched session.
+    // Called before warps resume/step; with emulated breakpoints code memory is
+    // left untouched and until_breakpoint() single-steps instead.
+    int commit_breakpoints();
+
+    // Get enabled breakpoints
     std::unordered_map<uint32_t, BreakPointInfo_t> get_breakpoints() const;
 
     // Check if any breakpoints are set
@@ -183,20 +404,53 @@ public:
     // Continue execution until any warp hits a breakpoint
     int until_breakpoint(bool auto_select = false);
 
+    // Server pushed halt notifications (see Transport::wait_halt_event)
+    bool halt_events_enabled() const;
+    int wait_halt_event(unsigned timeout_ms);
+
     // ----- Accessors -----
     int get_num_warps() const { return state_.platinfo.num_total_warps; }
     int get_num_threads_per_warp() const { return state_.platinfo.num_threads; }
+    int get_num_warps_per_core() const { return state_.platinfo.num_warps; }
+
+    // Held for the duration of a debugger command by each frontend sharing
+    // this backend (CLI, GDB clients); recursive for nested commands
+    std::recursive_mutex& cmd_mutex() { return cmd_mtx_; }
+
+    // Take cmd_mutex(), counted in cmd_waiters() while blocked so background
+    // holders (GDB halt waiters) know to step aside
+    std::unique_lock<std::recursive_mutex> lock_cmd();
+    int cmd_waiters() const { return cmd_waiters_.load(); }
 
 private:
     // Transport 
     Transport *transport_;
     std::string transport_type_;
     Logger *log_;
+    std::recursive_mutex cmd_mtx_;
+    std::atomic<int> cmd_waiters_{0};
 
     // Parameters
     unsigned poll_retries_    = DEFAULT_POLL_RETRIES;
     unsigned poll_delay_ms_   = DEFAULT_POLL_DELAY_MS;
+    PollPolicy_t poll_policy_;              // Deadline/ceiling follow poll_retries_ * poll_delay_ms_
+    PollHistory poll_history_;              // Learned completion times of DM field polls
     bool use_emulated_breakpoints_ = false;
+    bool use_dmreg_cache_     = true;
+    unsigned pipeline_window_ = DEFAULT_PIPELINE_WINDOW;   // 0: disable pipelined DM access
+    bool allow_binary_proto_  = true;                      // Negotiate binary wire protocol on connect
+    unsigned mem_bulk_threshold_ = DEFAULT_MEM_BULK_THRESHOLD;
+    bool use_mem_cache_       = true;
+    bool use_reg_cache_       = true;
+    bool hold_scratch_        = true;   // Keep scratch GPRs saved across accesses until the thread runs
+    bool use_halt_events_     = true;   // Use server pushed halt notifications if supported
+    bool use_warp_snapshot_   = true;   // Serve warp state queries from warpsnap_
+    bool use_warp_gather_     = true;   // Fetch PC/hacause via WGSEL/WGPC/WGCAUSE if supported
+    bool use_lane_access_     = true;   // Warp-wide injection + LSCRATCH for *_lanes() reads if supported
+    unsigned load_chunk_      = LOAD_CHUNK_SZ;  // load_mem() delta granularity in bytes
+    bool use_load_delta_      = false;  // GDB memory writes of at least a chunk go through delta load_mem()
+    uint32_t scratch_mem_addr_ = 0;     // Target routine scratch memory, 0: none
+    uint32_t scratch_mem_size_ = DEFAULT_SCRATCH_MEM_SZ;
 
     // Current Debugger state
     struct State_t {
@@ -218,17 +472,87 @@ private:
             uint32_t num_total_warps        = 0;
             uint32_t num_total_threads      = 0;
             uint32_t misa                   = 0;
+            bool has_wgather                = false;    // DCONFIG.wgather
+            bool has_lanes                  = false;    // DCONFIG.lanes
         } platinfo;
 
     } state_;
 
     std::unordered_map<uint32_t, BreakPointInfo_t> breakpoints_;
 
+    // Shadow copies of DM registers with DMRegPolicy_t::CACHED
+    struct DMRegShadow_t {
+        bool valid = false;
+        uint32_t value = 0;
+    };
+    DMRegShadow_t dmreg_shadow_[static_cast<size_t>(DMReg_t::COUNT)];
+    std::unordered_map<uint32_t, DMRegShadow_t> wmask_shadow_;     // winsel -> WMASK
+    DMRegShadow_t dctrl_inject_;    // DCTRL value that requests an injection (sticky control bits + injectreq)
+    bool inject_stalled_ = false;   // A waited-for queued injection failed, drop queued ops until _dmreg_flush()
+    int inject_stall_rc_ = RCODE_OK;
+
+    // Target memory cache: block base address -> MEMCACHE_BLOCK_SZ bytes.
+    // Only valid while all warps stay halted, local memory is per core.
+    std::unordered_map<uint32_t, std::vector<uint8_t>> memcache_;
+    int memcache_core_ = -1;        // core whose view of memory is cached
+    uint64_t memcache_halted_gen_ = ~0ull;  // warpstate_gen_ at which all warps were seen halted
+
+    // Register snapshot of a halted (warp, thread), dropped when the warp resumes
+    struct RegSnapshot_t {
+        uint32_t gpr_valid = 0;     // bitmask of valid gpr[] entries
+        uint32_t gpr[32] = {};
+        std::unordered_map<uint32_t, uint32_t> csrs;    // csr addr -> value
+    };
+    std::unordered_map<uint32_t, RegSnapshot_t> regsnap_;   // (wid * num_threads + tid) -> snapshot
+
+    // GPRs (t0/t1) of the selected (warp, thread) saved while
+    // CSR/memory accesses use them as scratch. Restored once before the thread
+    // runs or is deselected.
+    struct ScratchCtx_t {
+        int wid = -1;
+        int tid = -1;
+        uint32_t saved = 0;         // bitmask of saved GPRs
+        uint32_t value[32] = {};    // by GPR number
+    };
+    ScratchCtx_t scratch_;
+
+    // Scratch registers for one access: acquired on construction, restored on
+    // destruction unless done() was called and the context is kept
+    class ScratchGuard {
+    public:
+        ScratchGuard(Backend &backend, uint32_t regmask):
+            backend_(backend), rc_(backend._scratch_acquire(regmask)) {}
+        ~ScratchGuard() {
+            if (!done_ || !backend_.hold_scratch_)
+                backend_._scratch_release();
+        }
+        int rc() const { return rc_; }
+        void done() { done_ = true; }
+    private:
+        Backend &backend_;
+        int rc_;
+        bool done_ = false;
+    };
+
+    WarpStateSnapshot_t warpsnap_;
+    uint64_t warpstate_gen_ = 0;    // bumped by warpstate_invalidate()
+
+    // sample_pcs() working buffers, kept to avoid allocating per sample
+    std::vector<BatchOp_t> sample_ops_;
+    std::vector<uint32_t> sample_results_;
+    std::vector<uint32_t> sample_running_;
+
+    BackendStats_t stats_;
+
     //==============================================================================
     // Helpers
     //==============================================================================
     std::string _get_platform_info_str() const;
 
+    // Persisted platform records: "<platform> <misa>" per line, in hex
+    bool _platform_cache_lookup(uint32_t platform, uint32_t &misa) const;
+    void _platform_cache_store(uint32_t platform, uint32_t misa) const;
+
     //==============================================================================
     // Low-level DM register access
     //==============================================================================
@@ -238,6 +562,118 @@ private:
     int dmreg_wrfield(const DMReg_t &reg, const std::string &fieldname, const uint32_t &value);
     int dmreg_pollfield(const DMReg_t &reg, const std::string &fieldname, const uint32_t &exp_value, uint32_t *final_value,
                         int max_retries=-1, int delay_ms=-1);
+    void _update_poll_policy();
+
+    // Shadow cache aware register access (no logging)
+    int _dmreg_rd(const DMReg_t &reg, uint32_t &value, bool bypass_cache=false);
+    int _dmreg_wr(const DMReg_t &reg, const uint32_t &value);
+    DMRegShadow_t* _dmreg_shadow(const DMReg_t &reg);
+    void dmreg_cache_invalidate();
+
+    // Pipelined DM register access: ops are queued and complete on _dmreg_flush()
+    void _dmreg_queue_rd(const DMReg_t &reg, uint32_t *value);
+    void _dmreg_queue_wr(const DMReg_t &reg, const uint32_t value);
+    int _dmreg_flush();
+
+    // Queue an injection, DCTRL is read back into *dctrl_after. Without the server's
+    // injseq capability the injection is flushed and polled to completion right away
+    // (a later DINJECT write must not overtake it); if that fails the following
+    // queued ops are dropped, *dctrl_after reports it busy and _dmreg_flush() any
+    // transport error.
+    void _queue_inject(uint32_t instruction, uint32_t dctrl_injectreq, uint32_t *dctrl_after);
+
+    // DCTRL value to write for an injection request (cached until DCTRL is written)
+    int _get_dctrl_inject(uint32_t &dctrl_injectreq);
+
+    // Same for any other request bit (haltreq, resumereq, stepreq)
+    int _get_dctrl_req(const std::string &reqname, uint32_t &dctrl);
+
+    // Batched DM register access, executed by _dmreg_batch() (see Transport::batch)
+    void _batch_rd(std::vector<BatchOp_t> &ops, const DMReg_t &reg);
+    void _batch_wr(std::vector<BatchOp_t> &ops, const DMReg_t &reg, const uint32_t value);
+    void _batch_pollfield(std::vector<BatchOp_t> &ops, const DMReg_t &reg, const std::string &fieldname,
+                          const uint32_t exp_value);
+    void _batch_inject(std::vector<BatchOp_t> &ops, uint32_t instruction, uint32_t dctrl_injectreq);
+    int _dmreg_batch(const std::vector<BatchOp_t> &ops, std::vector<uint32_t> &results);
+
+    // Warp-wide access: DCONFIG values with warpinj set/cleared, LSCRATCH
+    // sweeps from lane 0, and a batch that never leaves warpinj set on failure
+    int _get_dconfig_warpinj(uint32_t &dconfig_on, uint32_t &dconfig_off);
+    void _batch_lanes_rd(std::vector<BatchOp_t> &ops, size_t nlanes);
+    void _batch_lanes_wr(std::vector<BatchOp_t> &ops, const std::vector<uint32_t> &values);
+    int _lanes_batch(const std::vector<BatchOp_t> &ops, std::vector<uint32_t> &results, uint32_t dconfig_off);
+
+    // Streamed word loops for read_mem/write_mem (t0 holds the current address)
+    int _read_words_streamed(uint8_t *dst, size_t nwords);
+    int _write_words_streamed(const uint8_t *src, size_t nwords);
+
+    // Snapshot of the selected (warp, thread), nullptr if disabled
+    RegSnapshot_t* _regsnap();
+    int _read_gprs_streamed(uint32_t *values);
+    int _read_csrs_streamed(const std::vector<uint32_t> &regaddrs, uint32_t *values);
+
+    // Save the GPRs in regmask of the selected thread unless already saved / restore them
+    int _scratch_acquire(uint32_t regmask);
+    int _scratch_release();
+    bool _scratch_holds(uint32_t regnum) const;
+
+    // Sweep all windows (and PC/hacause of halted warps) into warpsnap_
+    int _warpsnap_refresh(bool include_pc, bool include_hacause);
+
+    // Can warpsnap_ answer for warp 'wid' without a new sweep?
+    bool _warpsnap_usable(int wid) const;
+
+    // Block until any warp halts: waits on halt notifications or polls with backoff
+    int _wait_any_halted();
+
+    // Breakpoint commit: read words at rd_addrs, then write wr_vals to wr_addrs
+    int _bp_mem_session(const std::vector<uint32_t> &rd_addrs, std::vector<uint32_t> &rd_vals,
+                        const std::vector<uint32_t> &wr_addrs, const std::vector<uint32_t> &wr_vals);
+    // Streamed variant: reads are flushed and verified before any write is queued,
+    // 'reads_done' tells a RCODE_TIMEOUT caller whether rd_vals are valid
+    int _bp_mem_session_injected(const std::vector<uint32_t> &rd_addrs, std::vector<uint32_t> &rd_vals,
+                                 const std::vector<uint32_t> &wr_addrs, const std::vector<uint32_t> &wr_vals,
+                                 bool &reads_done);
+
+    // GPRs regs[i] of every lane of the selected warp (values[i][tid]), one batch
+    // with lane access, otherwise one thread at a time
+    int _read_gprs_lanes(const std::vector<uint32_t> &regs, std::vector<std::vector<uint32_t>> &values);
+    int _write_gprs_lanes(const std::vector<uint32_t> &regs, const std::vector<std::vector<uint32_t>> &values);
+
+    // Run a routine on the selected warp: image (code, its final ebreak at word
+    // ncode - 1, then its arguments) is staged at scratch_mem followed by nout
+    // words of output, read back into out; result is the selected thread's
+    // dscratch at the ebreak. Registers, PC and scratch memory are restored.
+    int _search_mem_host(const uint32_t addr, const uint32_t nbytes, const std::vector<uint8_t> &pattern,
+                         bool &found, uint32_t &found_addr);
+    int _search_mem_routine(const uint64_t start, const uint64_t stop, const std::vector<uint8_t> &pattern,
+                            bool &found, uint32_t &found_addr);
+    int _run_routine(const std::vector<uint32_t> &image, size_t ncode, size_t nout,
+                     std::vector<uint32_t> &out, uint32_t &result);
+    bool _scratch_mem_overlaps(uint64_t addr, uint64_t nbytes) const;
+
+    // Step the selected warp and read back its PC (no checks, no logging)
+    int _step_selected(uint32_t &pc);
+
+    // until_breakpoint() for emulated breakpoints: single-step halted warps until one reaches a breakpoint
+    int _until_breakpoint_emulated(bool auto_select);
+
+    // Uncached memory access (caller checks selection/halted state)
+    int _read_mem(const uint32_t addr, const uint32_t nbytes, std::vector<uint8_t> &data);
+    int _write_mem(const uint32_t addr, const std::vector<uint8_t> &data);
+    bool _memcache_holds(const uint32_t addr, const uint32_t nbytes) const;
+    void _memcache_update(const uint32_t addr, const std::vector<uint8_t> &data, bool invalidate);
+    // write_mem() of an image that already has the breakpoints overlaid
+    int _write_mem_overlaid(const uint32_t addr, const std::vector<uint8_t> &image);
+    void _patch_breakpoints(const uint32_t addr, std::vector<uint8_t> &data) const;
+    // Put inserted ebreaks into an image about to overwrite them, its words become the replaced instructions
+    void _overlay_breakpoints(const uint32_t addr, std::vector<uint8_t> &image);
+
+    // Block memory access through MADDR/MDATA (word aligned, no injection)
+    bool _use_mem_bulk(size_t nbytes) const;
+
+    int _read_mem_bulk(uint32_t addr, uint8_t *dst, size_t nwords);
+    int _write_mem_bulk(uint32_t addr, const uint8_t *src, size_t nwords);
 
     
     // Friend classes
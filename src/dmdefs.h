@@ -30,15 +30,31 @@ enum class DMReg_t : uint8_t {
     DPC      = 0x7,
     DINJECT  = 0x8,
     DSCRATCH = 0x9,
+    MADDR    = 0xA,     // optional, server advertises 'memblk'
+    MDATA    = 0xB,     // optional, server advertises 'memblk'
+    WGSEL    = 0xC,     // optional, DCONFIG.wgather
+    WGPC     = 0xD,     // optional, DCONFIG.wgather
+    WGCAUSE  = 0xE,     // optional, DCONFIG.wgather
+    LSEL     = 0xF,     // optional, DCONFIG.lanes
+    LSCRATCH = 0x10,    // optional, DCONFIG.lanes
     COUNT
 };
 
+// Shadow cache policy for a DM register
+//  - VOLATILE: value may change behind the debugger's back, always read
+//  - CACHED:   only changed by debugger writes, write-through shadow copy
+enum class DMRegPolicy_t : uint8_t {
+    VOLATILE,
+    CACHED
+};
+
 struct DMRegInfo_t {
     DMReg_t id;
     std::string_view name;
     uint32_t addr;
     const FieldInfo_t* fields;
     size_t num_fields;
+    DMRegPolicy_t policy;
 };
 
 //------------------------------------------------------------------------------
@@ -55,6 +71,9 @@ constexpr FieldInfo_t PLATFORM_FIELDS[] = {
 constexpr FieldInfo_t DCONFIG_FIELDS[] = {
     {"ndmresetcyc",         31,  29},
     {"resethaltreqcyc",     28,  26},
+    {"lanes",               3,  3},     // RO: warp-wide injection (warpinj) and per-lane DSCRATCH (LSEL/LSCRATCH) supported
+    {"warpinj",             2,  2},     // Injections execute on all active lanes of the selected warp
+    {"wgather",             1,  1},     // RO: warp-indexed gather (WGSEL/WGPC/WGCAUSE) supported
     {"ebreakh",             0,  0}
 };
 
@@ -107,6 +126,34 @@ constexpr FieldInfo_t DSCRATCH_FIELDS[] = {
     {"data",         31,  0}
 };
 
+constexpr FieldInfo_t MADDR_FIELDS[] = {
+    {"addr",         31,  0}
+};
+
+constexpr FieldInfo_t MDATA_FIELDS[] = {
+    {"data",         31,  0}
+};
+
+constexpr FieldInfo_t WGSEL_FIELDS[] = {
+    {"wid",          14,  0}
+};
+
+constexpr FieldInfo_t WGPC_FIELDS[] = {
+    {"pc",           31,  0}
+};
+
+constexpr FieldInfo_t WGCAUSE_FIELDS[] = {
+    {"hacause",       2,  0}
+};
+
+constexpr FieldInfo_t LSEL_FIELDS[] = {
+    {"tid",           6,  0}
+};
+
+constexpr FieldInfo_t LSCRATCH_FIELDS[] = {
+    {"data",         31,  0}
+};
+
 
 //------------------------------------------------------------------------------
 // DM Register Definitions
@@ -114,16 +161,23 @@ constexpr FieldInfo_t DSCRATCH_FIELDS[] = {
 
 // Can be indexed using DMReg_t enum
 constexpr DMRegInfo_t DM_REGS[] = {
-    DMRegInfo_t{DMReg_t::PLATFORM, "platform",  0x00, PLATFORM_FIELDS, std::size(PLATFORM_FIELDS)},
-    DMRegInfo_t{DMReg_t::DCONFIG,  "dconfig",   0x01, DCONFIG_FIELDS,  std::size(DCONFIG_FIELDS)},
-    DMRegInfo_t{DMReg_t::DSELECT,  "dselect",   0x02, DSELECT_FIELDS,  std::size(DSELECT_FIELDS)},
-    DMRegInfo_t{DMReg_t::WMASK,    "wmask",     0x03, WMASK_FIELDS,    std::size(WMASK_FIELDS)},
-    DMRegInfo_t{DMReg_t::WACTIVE,  "wactive",   0x04, WACTIVE_FIELDS,  std::size(WACTIVE_FIELDS)},
-    DMRegInfo_t{DMReg_t::WSTATUS,  "wstatus",   0x05, WSTATUS_FIELDS,  std::size(WSTATUS_FIELDS)},
-    DMRegInfo_t{DMReg_t::DCTRL,    "dctrl",     0x06, DCTRL_FIELDS,    std::size(DCTRL_FIELDS)},
-    DMRegInfo_t{DMReg_t::DPC,      "dpc",       0x07, DPC_FIELDS,      std::size(DPC_FIELDS)},
-    DMRegInfo_t{DMReg_t::DINJECT,  "dinject",   0x08, DINJECT_FIELDS,  std::size(DINJECT_FIELDS)},
-    DMRegInfo_t{DMReg_t::DSCRATCH, "dscratch",  0x09, DSCRATCH_FIELDS, std::size(DSCRATCH_FIELDS)}
+    DMRegInfo_t{DMReg_t::PLATFORM, "platform",  0x00, PLATFORM_FIELDS, std::size(PLATFORM_FIELDS), DMRegPolicy_t::VOLATILE},
+    DMRegInfo_t{DMReg_t::DCONFIG,  "dconfig",   0x01, DCONFIG_FIELDS,  std::size(DCONFIG_FIELDS),  DMRegPolicy_t::CACHED},
+    DMRegInfo_t{DMReg_t::DSELECT,  "dselect",   0x02, DSELECT_FIELDS,  std::size(DSELECT_FIELDS),  DMRegPolicy_t::CACHED},
+    DMRegInfo_t{DMReg_t::WMASK,    "wmask",     0x03, WMASK_FIELDS,    std::size(WMASK_FIELDS),    DMRegPolicy_t::CACHED},     // per window (DSELECT.winsel)
+    DMRegInfo_t{DMReg_t::WACTIVE,  "wactive",   0x04, WACTIVE_FIELDS,  std::size(WACTIVE_FIELDS),  DMRegPolicy_t::VOLATILE},
+    DMRegInfo_t{DMReg_t::WSTATUS,  "wstatus",   0x05, WSTATUS_FIELDS,  std::size(WSTATUS_FIELDS),  DMRegPolicy_t::VOLATILE},
+    DMRegInfo_t{DMReg_t::DCTRL,    "dctrl",     0x06, DCTRL_FIELDS,    std::size(DCTRL_FIELDS),    DMRegPolicy_t::VOLATILE},
+    DMRegInfo_t{DMReg_t::DPC,      "dpc",       0x07, DPC_FIELDS,      std::size(DPC_FIELDS),      DMRegPolicy_t::VOLATILE},
+    DMRegInfo_t{DMReg_t::DINJECT,  "dinject",   0x08, DINJECT_FIELDS,  std::size(DINJECT_FIELDS),  DMRegPolicy_t::CACHED},
+    DMRegInfo_t{DMReg_t::DSCRATCH, "dscratch",  0x09, DSCRATCH_FIELDS, std::size(DSCRATCH_FIELDS), DMRegPolicy_t::VOLATILE},    // written by injected csrw
+    DMRegInfo_t{DMReg_t::MADDR,    "maddr",     0x0A, MADDR_FIELDS,    std::size(MADDR_FIELDS),    DMRegPolicy_t::VOLATILE},    // auto-increments on MDATA access
+    DMRegInfo_t{DMReg_t::MDATA,    "mdata",     0x0B, MDATA_FIELDS,    std::size(MDATA_FIELDS),    DMRegPolicy_t::VOLATILE},    // rd: load word @MADDR, wr: store word @MADDR
+    DMRegInfo_t{DMReg_t::WGSEL,    "wgsel",     0x0C, WGSEL_FIELDS,    std::size(WGSEL_FIELDS),    DMRegPolicy_t::VOLATILE},    // advances on WGCAUSE read
+    DMRegInfo_t{DMReg_t::WGPC,     "wgpc",      0x0D, WGPC_FIELDS,     std::size(WGPC_FIELDS),     DMRegPolicy_t::VOLATILE},    // rd: PC of warp @WGSEL (thread 0)
+    DMRegInfo_t{DMReg_t::WGCAUSE,  "wgcause",   0x0E, WGCAUSE_FIELDS,  std::size(WGCAUSE_FIELDS),  DMRegPolicy_t::VOLATILE},    // rd: halt cause of warp @WGSEL, then WGSEL++
+    DMRegInfo_t{DMReg_t::LSEL,     "lsel",      0x0F, LSEL_FIELDS,     std::size(LSEL_FIELDS),     DMRegPolicy_t::VOLATILE},    // advances on LSCRATCH access
+    DMRegInfo_t{DMReg_t::LSCRATCH, "lscratch",  0x10, LSCRATCH_FIELDS, std::size(LSCRATCH_FIELDS), DMRegPolicy_t::VOLATILE}     // rd/wr: DSCRATCH of lane @LSEL (selected warp), then LSEL++
 };
 
 //------------------------------------------------------------------------------
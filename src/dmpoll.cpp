@@ -0,0 +1,68 @@
+#include "dmpoll.h"
+
+#include <algorithm>
+#include <thread>
+
+PollWaiter::PollWaiter(const PollPolicy_t &policy, unsigned initial_delay_us):
+    policy_(policy),
+    start_(std::chrono::steady_clock::now()),
+    deadline_(start_ + std::chrono::milliseconds(policy.timeout_ms)),
+    delay_us_(std::max(1u, initial_delay_us))
+{}
+
+bool PollWaiter::next() {
+    auto now = std::chrono::steady_clock::now();
+    busy_us_ = std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count();
+    if (now >= deadline_)
+        return false;
+
+    if (reads_ > policy_.spin_reads) {
+        // Never wait past the deadline, the last read happens right at it
+        auto until = std::min(now + std::chrono::microseconds(delay_us_), deadline_);
+        if (delay_us_ <= POLL_YIELD_MAX_US) {
+            while (std::chrono::steady_clock::now() < until)
+                std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_until(until);
+        }
+        // A learned first wait that fell short is refined from the bottom of the backoff
+        sleeps_++;
+        if (sleeps_ == 1 && delay_us_ > policy_.min_delay_us)
+            delay_us_ = std::max(1u, policy_.min_delay_us);
+        else
+            delay_us_ = std::min(2 * delay_us_, std::max(1u, policy_.max_delay_us));
+    }
+    reads_++;
+    return true;
+}
+
+uint64_t PollWaiter::elapsed_us() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count();
+}
+
+unsigned PollHistory::initial_delay_us(uint64_t key, const PollPolicy_t &policy) const {
+    if (!policy.adaptive)
+        return policy.min_delay_us;
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.avg_reads <= 1.0 + policy.spin_reads)
+        return policy.min_delay_us;
+
+    // Usually outlasts the spin reads: first wait until it was last seen busy.
+    // Learning the last miss rather than the hit keeps oversleeping out of the estimate.
+    return static_cast<unsigned>(std::clamp<double>(it->second.avg_busy_us, policy.min_delay_us,
+                                                    std::max(policy.min_delay_us, policy.max_delay_us)));
+}
+
+void PollHistory::record(uint64_t key, const PollWaiter &waiter) {
+    Entry_t &e = entries_[key];
+    double reads = waiter.reads();
+    double us = static_cast<double>(waiter.busy_us());
+    if (e.count == 0) {
+        e.avg_reads = reads;
+        e.avg_busy_us = us;
+    } else {
+        e.avg_reads += (reads - e.avg_reads) / POLL_HISTORY_WEIGHT;
+        e.avg_busy_us += (us - e.avg_busy_us) / POLL_HISTORY_WEIGHT;
+    }
+    e.count++;
+}
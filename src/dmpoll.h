@@ -0,0 +1,79 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+#ifndef POLL_DEFAULT_SPIN_READS
+    // Immediate re-reads after a miss before the first sleep
+    #define POLL_DEFAULT_SPIN_READS 1
+#endif
+#ifndef POLL_DEFAULT_MIN_DELAY_US
+    // First sleep of the geometric backoff when there is no history
+    #define POLL_DEFAULT_MIN_DELAY_US 10
+#endif
+#ifndef POLL_YIELD_MAX_US
+    // Shorter waits yield in a loop instead of sleeping (timer slack is tens of us)
+    #define POLL_YIELD_MAX_US 50
+#endif
+#ifndef POLL_HISTORY_WEIGHT
+    // Weight of a new sample in the moving averages (1/N)
+    #define POLL_HISTORY_WEIGHT 8
+#endif
+
+// How a DM register poll waits between reads: a few immediate re-reads, then
+// sleeps growing geometrically from the initial delay up to max_delay_us,
+// until timeout_ms has passed since the first read.
+struct PollPolicy_t {
+    unsigned spin_reads   = POLL_DEFAULT_SPIN_READS;
+    unsigned min_delay_us = POLL_DEFAULT_MIN_DELAY_US;
+    unsigned max_delay_us = 100000;
+    unsigned timeout_ms   = 1000;
+    bool adaptive         = true;       // Start the backoff at the learned completion time
+};
+
+// Wait schedule of one poll operation
+class PollWaiter {
+public:
+    PollWaiter(const PollPolicy_t &policy, unsigned initial_delay_us);
+
+    // Call after a read missed: waits before the next read, false once past the deadline
+    bool next();
+
+    unsigned reads() const { return reads_; }
+    unsigned sleeps() const { return sleeps_; }
+    uint64_t elapsed_us() const;
+    uint64_t busy_us() const { return busy_us_; }  // elapsed time at the last missed read
+
+private:
+    const PollPolicy_t &policy_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point deadline_;
+    unsigned delay_us_;
+    unsigned reads_ = 1;
+    unsigned sleeps_ = 0;
+    uint64_t busy_us_ = 0;
+};
+
+// Moving averages of how long polls took to complete, per (register, field mask)
+class PollHistory {
+public:
+    struct Entry_t {
+        double avg_reads = 0;
+        double avg_busy_us = 0;     // last time the field was seen not ready, a lower bound of completion
+        uint64_t count = 0;
+    };
+
+    static uint64_t key(uint32_t addr, uint32_t mask) { return (static_cast<uint64_t>(addr) << 32) | mask; }
+
+    // Initial backoff delay for the next poll of 'key'
+    unsigned initial_delay_us(uint64_t key, const PollPolicy_t &policy) const;
+
+    // Record a completed poll
+    void record(uint64_t key, const PollWaiter &waiter);
+
+    const std::unordered_map<uint64_t, Entry_t>& entries() const { return entries_; }
+    void reset() { entries_.clear(); }
+
+private:
+    std::unordered_map<uint64_t, Entry_t> entries_;
+};
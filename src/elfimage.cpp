@@ -0,0 +1,149 @@
+#include "elfimage.h"
+#include "logger.h"
+#include "util.h"
+
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+ElfImage::~ElfImage() {
+    close();
+}
+
+void ElfImage::close() {
+    if (map_)
+        munmap(map_, map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    entry_ = 0;
+    segments_.clear();
+    symbols_.clear();
+}
+
+int ElfImage::open(const std::string &path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Logger::gerror("Failed to open ELF file: " + path + " (" + std::strerror(errno) + ")");
+        return RCODE_ERROR;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Elf32_Ehdr))) {
+        Logger::gerror("Not an ELF file: " + path);
+        ::close(fd);
+        return RCODE_INVALID_ARG;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        Logger::gerror("Failed to map ELF file: " + path + " (" + std::strerror(errno) + ")");
+        return RCODE_ERROR;
+    }
+    map_ = map;
+    map_size_ = st.st_size;
+
+    const uint8_t *base = static_cast<const uint8_t*>(map_);
+    const Elf32_Ehdr *eh = reinterpret_cast<const Elf32_Ehdr*>(base);
+    if (std::memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0 || eh->e_ident[EI_CLASS] != ELFCLASS32
+        || eh->e_ident[EI_DATA] != ELFDATA2LSB || eh->e_machine != EM_RISCV) {
+        Logger::gerror("Not a 32-bit little-endian RISC-V ELF file: " + path);
+        close();
+        return RCODE_INVALID_ARG;
+    }
+    if (eh->e_phentsize != sizeof(Elf32_Phdr)
+        || eh->e_phoff + static_cast<uint64_t>(eh->e_phnum) * sizeof(Elf32_Phdr) > map_size_) {
+        Logger::gerror("Truncated ELF program headers: " + path);
+        close();
+        return RCODE_INVALID_ARG;
+    }
+
+    entry_ = eh->e_entry;
+    const Elf32_Phdr *ph = reinterpret_cast<const Elf32_Phdr*>(base + eh->e_phoff);
+    for (unsigned i = 0; i < eh->e_phnum; ++i) {
+        if (ph[i].p_type != PT_LOAD || ph[i].p_memsz == 0)
+            continue;
+        if (ph[i].p_offset + static_cast<uint64_t>(ph[i].p_filesz) > map_size_ || ph[i].p_filesz > ph[i].p_memsz) {
+            Logger::gerror(strfmt("Malformed PT_LOAD segment %u in %s", i, path.c_str()));
+            close();
+            return RCODE_INVALID_ARG;
+        }
+        ElfSegment_t seg;
+        seg.addr = ph[i].p_paddr;
+        seg.data = base + ph[i].p_offset;
+        seg.filesz = ph[i].p_filesz;
+        seg.memsz = ph[i].p_memsz;
+        segments_.push_back(seg);
+    }
+    _read_symbols();
+    return RCODE_OK;
+}
+
+void ElfImage::_read_symbols() {
+    // Optional: a stripped image just symbolizes nothing
+    const uint8_t *base = static_cast<const uint8_t*>(map_);
+    const Elf32_Ehdr *eh = reinterpret_cast<const Elf32_Ehdr*>(base);
+    if (eh->e_shoff == 0 || eh->e_shentsize != sizeof(Elf32_Shdr)
+        || eh->e_shoff + static_cast<uint64_t>(eh->e_shnum) * sizeof(Elf32_Shdr) > map_size_)
+        return;
+    const Elf32_Shdr *sh = reinterpret_cast<const Elf32_Shdr*>(base + eh->e_shoff);
+    for (unsigned i = 0; i < eh->e_shnum; ++i) {
+        if (sh[i].sh_type != SHT_SYMTAB || sh[i].sh_link >= eh->e_shnum)
+            continue;
+        const Elf32_Shdr &strtab = sh[sh[i].sh_link];
+        if (sh[i].sh_offset + static_cast<uint64_t>(sh[i].sh_size) > map_size_
+            || strtab.sh_offset + static_cast<uint64_t>(strtab.sh_size) > map_size_)
+            continue;
+        const Elf32_Sym *syms = reinterpret_cast<const Elf32_Sym*>(base + sh[i].sh_offset);
+        const char *strs = reinterpret_cast<const char*>(base + strtab.sh_offset);
+        size_t nsyms = sh[i].sh_size / sizeof(Elf32_Sym);
+        for (size_t j = 0; j < nsyms; ++j) {
+            unsigned type = ELF32_ST_TYPE(syms[j].st_info);
+            if ((type != STT_FUNC && type != STT_NOTYPE) || syms[j].st_shndx == SHN_UNDEF
+                || syms[j].st_shndx >= SHN_LORESERVE || syms[j].st_name >= strtab.sh_size)
+                continue;
+            const char *name = strs + syms[j].st_name;
+            // Skip unnamed and assembler local labels ($x, .L*)
+            if (name[0] == '\0' || name[0] == '$' || name[0] == '.')
+                continue;
+            if (strnlen(name, strtab.sh_size - syms[j].st_name) == strtab.sh_size - syms[j].st_name)
+                continue;
+            ElfSymbol_t sym;
+            sym.addr = syms[j].st_value;
+            sym.size = syms[j].st_size;
+            sym.name = name;
+            symbols_.push_back(std::move(sym));
+        }
+    }
+    // Sized (function) symbols first among aliases at the same address
+    std::sort(symbols_.begin(), symbols_.end(), [](const ElfSymbol_t &a, const ElfSymbol_t &b) {
+        return a.addr != b.addr ? a.addr < b.addr : a.size > b.size;
+    });
+}
+
+const ElfSymbol_t* ElfImage::find_symbol(uint32_t addr, uint32_t *offset) const {
+    auto it = std::upper_bound(symbols_.begin(), symbols_.end(), addr,
+                               [](uint32_t a, const ElfSymbol_t &sym) { return a < sym.addr; });
+    if (it == symbols_.begin())
+        return nullptr;
+    uint32_t sym_addr = std::prev(it)->addr;
+    // First entry (the sized one, if any) among aliases at that address
+    auto first = std::lower_bound(symbols_.begin(), it, sym_addr,
+                                  [](const ElfSymbol_t &sym, uint32_t a) { return sym.addr < a; });
+    if (first->size != 0 && addr - first->addr >= first->size)
+        return nullptr;
+    if (offset)
+        *offset = addr - first->addr;
+    return &*first;
+}
+
+std::vector<uint8_t> ElfImage::contents(const ElfSegment_t &seg) {
+    std::vector<uint8_t> bytes(seg.memsz, 0);
+    std::memcpy(bytes.data(), seg.data, seg.filesz);
+    return bytes;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One PT_LOAD segment of a memory-mapped ELF image
+struct ElfSegment_t {
+    uint32_t addr = 0;              // Load (physical) address
+    const uint8_t *data = nullptr;  // File contents, filesz bytes
+    uint32_t filesz = 0;
+    uint32_t memsz = 0;             // Zero filled past filesz (.bss)
+};
+
+// Function (or untyped code label) symbol from .symtab
+struct ElfSymbol_t {
+    uint32_t addr = 0;
+    uint32_t size = 0;              // 0 if unknown: extends to the next symbol
+    std::string name;
+};
+
+// Read-only mapping of a 32-bit little-endian RISC-V ELF executable
+class ElfImage {
+public:
+    ElfImage() = default;
+    ~ElfImage();
+    ElfImage(const ElfImage&) = delete;
+    ElfImage& operator=(const ElfImage&) = delete;
+
+    // Map 'path' and collect its non-empty PT_LOAD segments
+    int open(const std::string &path);
+    void close();
+
+    const std::vector<ElfSegment_t>& segments() const { return segments_; }
+    uint32_t entry() const { return entry_; }
+
+    // Symbol covering addr (nullptr if none), offset set to addr - symbol address
+    const ElfSymbol_t* find_symbol(uint32_t addr, uint32_t *offset = nullptr) const;
+
+    // Segment contents as loaded in memory: file bytes, then zeros up to memsz
+    static std::vector<uint8_t> contents(const ElfSegment_t &seg);
+
+private:
+    void *map_ = nullptr;
+    size_t map_size_ = 0;
+    uint32_t entry_ = 0;
+    std::vector<ElfSegment_t> segments_;
+    std::vector<ElfSymbol_t> symbols_;      // Sorted by address
+
+    void _read_symbols();
+};
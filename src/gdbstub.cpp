@@ -8,7 +8,7 @@
 
 #include <algorithm>
 
-#define RECV_BUFSZ 4096
+#define RECV_SLACK 16   // Framing bytes accepted on top of packet_size_
 
 static const std::string target_xml = 
 R"XML(<?xml version="1.0"?>
@@ -80,24 +80,75 @@ constexpr RV_CSR CSR_LIST[] = {
 
 
 // Helpers for packet handling
-std::string checksum_str(const std::string& msg) {
-    uint32_t sum = 0;
-    for (char c : msg) 
-        sum += static_cast<uint32_t>(c);
-    return strfmt("%02x", sum & 0xFF);
+std::string packetify(const std::string& msg) {
+    uint8_t sum = 0;
+    for (char c : msg)
+        sum += static_cast<uint8_t>(c);
+    std::string pkt;
+    pkt.reserve(msg.size() + 4);
+    pkt += '$';
+    pkt += msg;
+    pkt += '#';
+    hex_encode(&sum, 1, pkt);
+    return pkt;
 }
 
-std::string packetify(const std::string& msg) {
-    return strfmt("$%s#%s", msg.c_str(), checksum_str(msg).c_str());
+// Register values are sent in target (little endian) byte order
+static void append_hex_u32le(std::string &out, uint32_t val) {
+    uint8_t bytes[4] = {static_cast<uint8_t>(val), static_cast<uint8_t>(val >> 8),
+                        static_cast<uint8_t>(val >> 16), static_cast<uint8_t>(val >> 24)};
+    hex_encode(bytes, 4, out);
+}
+
+static bool parse_hex_u32le(const char *hex, size_t nchars, uint32_t &val) {
+    uint8_t bytes[4];
+    if (nchars < 8 || !hex_decode(hex, 8, bytes))
+        return false;
+    val = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+// Parse "addr,length" (hex) terminated by 'end', returns false if malformed
+static bool parse_addr_len(const std::string &args, size_t end, uint32_t &addr, uint32_t &length) {
+    size_t comma_pos = args.find(',');
+    if (comma_pos == std::string::npos || comma_pos > end)
+        return false;
+    addr = static_cast<uint32_t>(strtoul(args.c_str(), nullptr, 16));
+    length = static_cast<uint32_t>(strtoul(args.c_str() + comma_pos + 1, nullptr, 16));
+    return true;
+}
+
+// Undo the '}' escapes (byte ^ 0x20) of binary packet data
+static std::vector<uint8_t> unescape_binary(const std::string &str, size_t begin) {
+    std::vector<uint8_t> data;
+    data.reserve(str.size() - begin);
+    for (size_t i = begin; i < str.size(); ++i) {
+        uint8_t c = static_cast<uint8_t>(str[i]);
+        if (c == '}' && i + 1 < str.size()) {
+            c = static_cast<uint8_t>(str[++i]) ^ 0x20;
+        }
+        data.push_back(c);
+    }
+    return data;
 }
 
 
 GDBStub::GDBStub(VortexDebugger* vxdebug, Backend* backend):
+    GDBStub(vxdebug, backend, -1, 0)
+{}
+
+GDBStub::GDBStub(VortexDebugger* vxdebug, Backend* backend, int client_fd, int session_id):
     vxdebug_(vxdebug),
     backend_(backend), 
-    log_(new Logger("GDBStub", 4)),
-    server_(new TCPServer()) 
+    log_(new Logger(session_id > 0 ? strfmt("GDBStub#%d", session_id) : "GDBStub", 4)),
+    server_(new TCPServer()),
+    session_id_(session_id),
+    backend_mtx_(backend->cmd_mutex())
 {
+    if (client_fd >= 0) {
+        server_->attach_client(client_fd);
+    }
+
     // Register command handlers
     cmd_map_["?"]               = &GDBStub::cmd_halted;
     cmd_map_["D"]               = &GDBStub::cmd_detach;
@@ -107,12 +158,16 @@ GDBStub::GDBStub(VortexDebugger* vxdebug, Backend* backend):
     cmd_map_["P"]               = &GDBStub::cmd_write_reg;
     cmd_map_["m"]               = &GDBStub::cmd_read_mem;
     cmd_map_["M"]               = &GDBStub::cmd_write_mem;
+    cmd_map_["X"]               = &GDBStub::cmd_write_mem_bin;
     cmd_map_["c"]               = &GDBStub::cmd_continue;
     cmd_map_["s"]               = &GDBStub::cmd_step;
     cmd_map_["Z"]               = &GDBStub::cmd_insert_bp;
     cmd_map_["z"]               = &GDBStub::cmd_remove_bp;
     // cmd_map_["k"]               = &GDBStub::cmd_kill;
-    // cmd_map_["vCont?"]          = &GDBStub::cmd_vcont_query;
+    cmd_map_["vCont?"]          = &GDBStub::cmd_vcont_query;
+    cmd_map_["vCont;"]          = &GDBStub::cmd_vcont;
+    cmd_map_["QNonStop:"]       = &GDBStub::cmd_non_stop;
+    cmd_map_["vStopped"]        = &GDBStub::cmd_vstopped;
 
     // thread related commands
     cmd_map_["qfThreadInfo"]    = &GDBStub::cmd_thread_list_first;
@@ -124,29 +179,23 @@ GDBStub::GDBStub(VortexDebugger* vxdebug, Backend* backend):
 
     cmd_map_["qSupported"]      = &GDBStub::cmd_supported;
     cmd_map_["qAttached"]       = &GDBStub::cmd_attached;
+    cmd_map_["QStartNoAckMode"] = &GDBStub::cmd_start_noack;
 
     cmd_map_["qXfer:features:read:target.xml:"] = &GDBStub::cmd_qxfer_features_read;
+    cmd_map_["qXfer:threads:read::"] = &GDBStub::cmd_qxfer_threads_read;
     cmd_map_["qRcmd,"]          = &GDBStub::cmd_monitor;
+    cmd_map_["qCRC:"]           = &GDBStub::cmd_crc;
+    cmd_map_["qSearch:memory:"] = &GDBStub::cmd_search_mem;
     cmd_map_["vMustReplyEmpty"] = &GDBStub::cmd_notfound;
 
-    // Build thread map
-    for(int wid=0; wid < backend_->get_num_warps(); ++wid) {
-        int num_threads = backend_->get_num_threads_per_warp();
-        for(int l_tid=0; l_tid < num_threads; ++l_tid) {
-            int global_tid = 1 + wid * num_threads + l_tid;
-            thread_map_[global_tid] = std::make_pair(wid, l_tid);
-        }
-    }
-
-    // Print thread map info
-    std::string thread_map_info = "Thread Map (total threads: " + std::to_string(thread_map_.size()) + "):";
-    for (const auto& [tid, wid_ltid] : thread_map_) {
-        thread_map_info += strfmt(" tid %3d -> (wid:%3d, tid:%3d)\n", tid, wid_ltid.first, wid_ltid.second);
-    }
-    log_->debug(thread_map_info);
+    num_gdb_threads_ = backend_->get_num_warps() * backend_->get_num_threads_per_warp();
+    LOG_DEBUG_LAZY(log_, strfmt("Thread Map (total threads: %d): tid = 1 + wid * %d + l_tid",
+        num_gdb_threads_, backend_->get_num_threads_per_warp()));
 }
 
 GDBStub::~GDBStub() {
+    _stop_waiter();
+    _reap_sessions(true);
     delete log_;
     delete server_;
 }
@@ -161,110 +210,184 @@ int GDBStub::serve_forever(int port, bool allow_reconnect) {
         return RCODE_ERROR;
     }
 
-    while(true) {
-        log_->info("Waiting for GDB connection...");
-        server_->accept_client();
-
-        while (true) {
-            std::string pkt;
-            int rc = recv_packet(pkt);
-            if(rc == RCODE_TRANSPORT_ERR)
-                break;
-            if (rc != RCODE_OK)
-                continue;
-
-            if (pkt.empty())    // empty packets: eg: due to ACK/NACK
-                continue;
-            
-            // strip $ and #xx
-            std::string cmdstr = pkt.substr(1, pkt.length() - 4);
-            
-            // Dispatch
-            bool cmd_found = false;
-            for (const auto& [prefix, fn] : cmd_map_) {
-                if (cmdstr.rfind(prefix, 0) == 0) { // starts_with
-                    log_->debug("Cmd: " + cmdstr);
-                    send_ack();
-                    (this->*fn)(cmdstr);
-                    cmd_found = true;
-                }
-            }
-            if (!cmd_found) {
-                send_ack();
-                cmd_notfound(cmdstr);
-            }
+    log_->info("Waiting for GDB connection...");
+    while (!stop_requested_) {
+        int fd;
+        try {
+            fd = server_->accept_connection(GDBSTUB_ACCEPT_POLL_MS);
         }
+        catch (const std::exception& e) {
+            log_->error(std::string("Failed to accept GDB client: ") + e.what());
+            break;
+        }
+        _reap_sessions(false);
+        if (fd < 0)
+            continue;
 
-        if(!allow_reconnect) {
+        if (!allow_reconnect) {
+            server_->attach_client(fd);
+            _serve_client();
             log_->info("Exiting GDB server.");
             break;
         }
-        log_->info("GDB client disconnected, waiting for new connection...");
+
+        std::lock_guard<std::mutex> lk(sessions_mtx_);
+        if (sessions_.size() >= GDBSTUB_MAX_CLIENTS) {
+            log_->warn(strfmt("Too many GDB clients (max %d), rejecting connection", GDBSTUB_MAX_CLIENTS));
+            TCPServer rejected;
+            rejected.attach_client(fd);     // closed on scope exit
+            continue;
+        }
+        GDBStub *stub = new GDBStub(vxdebug_, backend_, fd, ++next_session_id_);
+        log_->info(strfmt("GDB client #%d connected (%zu active)", next_session_id_, sessions_.size() + 1));
+        sessions_.push_back({stub, std::thread([stub]() {
+            stub->_serve_client();
+            stub->session_done_ = true;
+        })});
     }
+    _reap_sessions(true);
+    server_->stop();
+    return RCODE_OK;
+}
+
+void GDBStub::stop() {
+    stop_requested_ = true;
+    server_->shutdown_client();
+    std::lock_guard<std::mutex> lk(sessions_mtx_);
+    for (auto &session : sessions_)
+        session.stub->stop();
+}
+
+// Join finished sessions (all: ask the others to stop and join them too)
+void GDBStub::_reap_sessions(bool all) {
+    std::lock_guard<std::mutex> lk(sessions_mtx_);
+    for (auto it = sessions_.begin(); it != sessions_.end();) {
+        if (!all && !it->stub->session_done_) {
+            ++it;
+            continue;
+        }
+        if (all)
+            it->stub->stop();
+        it->thread.join();
+        delete it->stub;
+        it = sessions_.erase(it);
+    }
+}
+
+// Packet loop for the attached client, returns when it disconnects
+int GDBStub::_serve_client() {
+    noack_ = false;
+    packet_size_ = GDBSTUB_PACKET_SIZE;
+    non_stop_ = false;
+    stop_reply_pending_ = false;
+    stop_queue_.clear();
+    notif_inflight_ = false;
+    running_wids_.clear();
+    ctx_wid_ = ctx_tid_ = -1;
+    _start_waiter();
+
+    while (!stop_requested_) {
+        std::string pkt;
+        int rc = recv_packet(pkt);
+        if(rc == RCODE_TRANSPORT_ERR)
+            break;
+        if (rc != RCODE_OK)
+            continue;
+
+        if (pkt.empty())    // empty packets: eg: due to ACK/NACK
+            continue;
+        
+        // strip $ and #xx
+        std::string cmdstr = pkt.substr(1, pkt.length() - 4);
+        
+        // Dispatch (backend is shared with the halt waiter, CLI and other clients)
+        auto lk = _lock_backend();
+        bool cmd_found = false;
+        for (const auto& [prefix, fn] : cmd_map_) {
+            if (cmdstr.rfind(prefix, 0) == 0) { // starts_with
+                LOG_DEBUG_LAZY(log_, "Cmd: " + cmdstr);
+                send_ack();
+                (this->*fn)(cmdstr);
+                cmd_found = true;
+            }
+        }
+        if (!cmd_found) {
+            send_ack();
+            cmd_notfound(cmdstr);
+        }
+        _save_context();
+        lk.unlock();
+        run_cv_.notify_all();
+    }
+    _stop_waiter();
+    log_->info("GDB client disconnected");
     return RCODE_OK;
 }
 
 int GDBStub::recv_packet(std::string& out) {
     out.clear();
     try {
-        std::string buf;
-        buf.reserve(RECV_BUFSZ);
+        // Packets are scanned in the server's receive buffer, which is
+        // refilled in large reads rather than one recv() per byte
+        RecvBuffer &rx = server_->rxbuf();
 
         // Get first char
-        char c;
-        if (server_->recv_data(&c, 1) <= 0)
-            return RCODE_ERROR;
+        if (rx.empty() && server_->recv_buffered(-1) <= 0) {
+            return server_->has_client() ? RCODE_ERROR : RCODE_TRANSPORT_ERR;
+        }
+        char c = rx[0];
 
         if(c == '+') {
+            rx.consume(1);
             log_->debug("RX: + (ACK)");
             return RCODE_OK;
         }
         if(c == '-') {
+            rx.consume(1);
             log_->warn("RX: - (NACK)");
             return RCODE_ERROR;
         }
         if(c == '\x03') {
-            cmd_halted("");
+            rx.consume(1);
+            cmd_interrupt();
             return RCODE_OK;
         }
         if (c != '$') {
+            rx.consume(1);
             log_->warn(strfmt("RX: Unexpected start char: 0x%02X (%c)", static_cast<uint8_t>(c), c));
             return RCODE_ERROR;
         }
 
-        uint8_t calculated_checksum = 0;
-        while(true) {
-            if (server_->recv_data(&c, 1) <= 0) {
-                log_->warn("RX: Failed to read packet");
-                return RCODE_ERROR;
-            }
-           
-            calculated_checksum += static_cast<uint8_t>(c);
-            if(buf.size() >= RECV_BUFSZ - 1) {
+        // Wait for '#' and the two checksum chars
+        size_t hash;
+        while ((hash = rx.find('#', 1)) == RecvBuffer::npos || rx.size() < hash + 3) {
+            if (hash == RecvBuffer::npos && rx.size() >= packet_size_ + RECV_SLACK) {
                 log_->warn("RX: Packet too long, discarding");
+                rx.consume(rx.size());
                 return RCODE_ERROR;
             }
-            else {
-                buf += c;
+            if (server_->recv_buffered(-1) <= 0) {
+                log_->warn("RX: Failed to read packet");
+                return server_->has_client() ? RCODE_ERROR : RCODE_TRANSPORT_ERR;
             }
-            if (c == '#') break;
         }
-        calculated_checksum -= static_cast<uint8_t>('#');
-        char checksum_buf[2];
-        if (server_->recv_data(checksum_buf, 2) <= 0) {
-            log_->warn("Failed to read checksum");
-            return RCODE_ERROR;
+
+        uint8_t calculated_checksum = 0;
+        for (size_t i = 1; i < hash; i++) {
+            calculated_checksum += static_cast<uint8_t>(rx[i]);
         }
+        char checksum_buf[3] = {rx[hash + 1], rx[hash + 2], '\0'};
         uint8_t received_checksum = static_cast<uint8_t>(strtol(checksum_buf, nullptr, 16));
-        buf.append(checksum_buf, 2);
-        log_->debug("RX: " + buf);
+        out.assign(rx.data(), hash + 3);
+        rx.consume(hash + 3);
+        LOG_DEBUG_LAZY(log_, "RX: " + out.substr(1));
 
         if (calculated_checksum != received_checksum) {
             log_->warn(strfmt("RX: Checksum mismatch: calculated 0x%02X, received 0x%02X",
                             calculated_checksum, received_checksum));
+            out.clear();
             return RCODE_ERROR;
         }
-        out = "$" + buf;
         return RCODE_OK;
     }
     catch (const std::exception& e) {
@@ -276,16 +399,34 @@ int GDBStub::recv_packet(std::string& out) {
 
 void GDBStub::send_packet(const std::string& msg) {
     std::string pkt = packetify(msg);
+    std::lock_guard<std::mutex> lk(tx_mtx_);
     try {
         server_->send_data(pkt.c_str(), pkt.size());
-        log_->debug("TX: " + pkt);
+        LOG_DEBUG_LAZY(log_, "TX: " + pkt);
     } 
     catch (const std::exception& e) {
         log_->error(std::string("Failed to send packet: ") + e.what());
     }
 }
 
+// Asynchronous notification: like a packet but starts with '%' and is never acked
+void GDBStub::send_notification(const std::string& msg) {
+    std::string pkt = packetify(msg);
+    pkt[0] = '%';
+    std::lock_guard<std::mutex> lk(tx_mtx_);
+    try {
+        server_->send_data(pkt.c_str(), pkt.size());
+        LOG_DEBUG_LAZY(log_, "TX: " + pkt);
+    }
+    catch (const std::exception& e) {
+        log_->error(std::string("Failed to send notification: ") + e.what());
+    }
+}
+
 void GDBStub::send_ack() {
+    if (noack_)
+        return;
+    std::lock_guard<std::mutex> lk(tx_mtx_);
     try {
         server_->send_data("+", 1);
         log_->debug("TX: ACK(+)");
@@ -296,6 +437,229 @@ void GDBStub::send_ack() {
 }
 
 
+//==============================================================================
+// Run control
+//==============================================================================
+int GDBStub::_gdb_tid(int wid, int tid) const {
+    return 1 + wid * backend_->get_num_threads_per_warp() + tid;
+}
+
+std::string GDBStub::_stop_reply(int wid, int tid, uint32_t hacause) const {
+    int sig = 5;    // SIGTRAP: ebreak, step
+    if (hacause == 0x2)
+        sig = non_stop_ ? 0 : 2;    // halt request: vCont;t (non-stop) or interrupt
+    else if (hacause == 0x0)
+        sig = 0;
+    return strfmt("T%02xthread:%x;", sig, _gdb_tid(wid, tid));
+}
+
+void GDBStub::_track_running(const std::vector<int>& wids) {
+    running_wids_.insert(wids.begin(), wids.end());
+}
+
+// Sweep warp state and report warps in running_wids_ that have stopped
+void GDBStub::_collect_stops() {
+    const WarpStateSnapshot_t *snap = nullptr;
+    if (backend_->get_warp_snapshot(snap) != RCODE_OK) {
+        log_->error("Failed to get warp state while waiting for stop");
+        return;
+    }
+    std::vector<int> stopped;
+    for (int wid : running_wids_) {
+        if (!snap->is_active(wid) || snap->is_halted(wid))
+            stopped.push_back(wid);
+    }
+    if (!stopped.empty())
+        _report_stops(stopped);
+}
+
+void GDBStub::_report_stops(const std::vector<int>& wids, int tid) {
+    for (int wid : wids)
+        running_wids_.erase(wid);
+
+    std::map<int, WarpStatus_t> warp_status;
+    backend_->get_warp_status(warp_status, false, true);
+    if (non_stop_) {
+        for (int wid : wids)
+            _queue_stop(_stop_reply(wid, tid, warp_status[wid].hacause));
+        return;
+    }
+
+    // All-stop: stop everything else we resumed, report the first warp
+    if (!running_wids_.empty()) {
+        std::vector<int> others(running_wids_.begin(), running_wids_.end());
+        if (backend_->halt_warps(others) != RCODE_OK)
+            log_->warn("Some warps failed to halt");
+        running_wids_.clear();
+    }
+    backend_->select_warp_thread(wids[0], tid);
+    stop_reply_pending_ = false;
+    send_packet(_stop_reply(wids[0], tid, warp_status[wids[0]].hacause));
+}
+
+void GDBStub::_queue_stop(const std::string& reply) {
+    stop_queue_.push_back(reply);
+    if (!notif_inflight_) {
+        notif_inflight_ = true;
+        send_notification("Stop:" + reply);
+    }
+}
+
+std::unique_lock<std::recursive_mutex> GDBStub::_lock_backend() {
+    auto lk = backend_->lock_cmd();
+    _restore_context();
+    return lk;
+}
+
+// Re-select this client's warp/thread if the CLI or another client moved DSELECT
+void GDBStub::_restore_context() {
+    if (ctx_wid_ < 0)
+        return;
+    int wid, tid;
+    backend_->get_selected_warp_thread(wid, tid);
+    if (wid != ctx_wid_ || tid != ctx_tid_)
+        backend_->select_warp_thread(ctx_wid_, ctx_tid_);
+}
+
+void GDBStub::_save_context() {
+    backend_->get_selected_warp_thread(ctx_wid_, ctx_tid_);
+}
+
+bool GDBStub::_from_gdb_tid(int gtid, int &wid, int &tid) const {
+    if (gtid < 1 || gtid > num_gdb_threads_)
+        return false;
+    int nthreads = backend_->get_num_threads_per_warp();
+    wid = (gtid - 1) / nthreads;
+    tid = (gtid - 1) % nthreads;
+    return true;
+}
+
+void GDBStub::_start_waiter() {
+    _stop_waiter();
+    waiter_stop_ = false;
+    waiter_ = std::thread(&GDBStub::_wait_loop, this);
+}
+
+void GDBStub::_stop_waiter() {
+    if (!waiter_.joinable())
+        return;
+    {
+        auto lk = backend_->lock_cmd();
+        waiter_stop_ = true;
+    }
+    run_cv_.notify_all();
+    waiter_.join();
+}
+
+// Sweeps warp state with exponential backoff while GDB has warps running.
+// The backend lock is only held across a sweep or a halt event wait (which
+// reads the transport), the latter in GDBSTUB_WAIT_SLICE_MS slices, and is
+// handed over whenever the CLI or any GDB client waits in Backend::lock_cmd().
+void GDBStub::_wait_loop() {
+    using clock = std::chrono::steady_clock;
+    unsigned delay_ms = HALT_WAIT_MIN_DELAY_MS;
+    auto next_sweep = clock::now();
+    std::unique_lock<std::recursive_mutex> lk(backend_mtx_);
+    while (!waiter_stop_) {
+        if (running_wids_.empty()) {
+            run_cv_.wait(lk, [this] { return waiter_stop_ || !running_wids_.empty(); });
+            delay_ms = HALT_WAIT_MIN_DELAY_MS;
+            next_sweep = clock::now();
+            continue;
+        }
+        if (backend_->cmd_waiters() > 0) {
+            // Let the other frontend in
+            run_cv_.wait_for(lk, std::chrono::milliseconds(1), [this] { return waiter_stop_ || backend_->cmd_waiters() == 0; });
+            continue;
+        }
+
+        auto now = clock::now();
+        if (now >= next_sweep) {
+            _restore_context();
+            _collect_stops();
+            _save_context();
+            next_sweep = now + std::chrono::milliseconds(delay_ms);
+            delay_ms = std::min(2 * delay_ms, static_cast<unsigned>(HALT_WAIT_MAX_DELAY_MS));
+            continue;
+        }
+
+        unsigned wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(next_sweep - now).count();
+        wait_ms = std::max(1u, wait_ms);
+        if (backend_->halt_events_enabled()) {
+            if (backend_->wait_halt_event(std::min(wait_ms, static_cast<unsigned>(GDBSTUB_WAIT_SLICE_MS))) == RCODE_OK) {
+                delay_ms = HALT_WAIT_MIN_DELAY_MS;
+                next_sweep = clock::now();
+            }
+        } else {
+            // Lock is released while sleeping
+            run_cv_.wait_for(lk, std::chrono::milliseconds(wait_ms), [this] { return waiter_stop_.load(); });
+        }
+    }
+}
+
+
+//==============================================================================
+// qXfer helpers
+//==============================================================================
+// Reply with the chunk of doc selected by "offset,length"
+void GDBStub::_send_xfer_chunk(const std::string& doc, const std::string& range) {
+    // Find the offset and length part: e.g., "0,1000"
+    size_t comma = range.find(',');
+    if (comma == std::string::npos) {
+        send_packet("E01");
+        return;
+    }
+
+    size_t offset = strtoul(range.substr(0, comma).c_str(), nullptr, 16);
+    size_t length = strtoul(range.substr(comma + 1).c_str(), nullptr, 16);
+
+    if (offset >= doc.size()) {
+        // 'l' means "last" chunk (nothing more to send)
+        send_packet("l");
+        return;
+    }
+
+    // Keep the reply within the packet size we advertised (marker + '$', '#', checksum)
+    length = std::min(length, packet_size_ - 5);
+    std::string chunk = doc.substr(offset, length);
+    char marker = (offset + chunk.size() < doc.size()) ? 'm' : 'l';
+
+    // Packet data = marker + chunk contents
+    send_packet(std::string(1, marker) + chunk);
+}
+
+void GDBStub::_build_threads_xml(std::string& xml) {
+    static const char *HACAUSE_NAMES[] = {"none", "ebreak", "haltreq", "step", "resethalt"};
+    xml = "<?xml version=\"1.0\"?>\n<threads>\n";
+
+    const WarpStateSnapshot_t *snap = nullptr;
+    if (backend_->get_warp_snapshot(snap, false, true) != RCODE_OK) {
+        log_->error("Failed to get warp status for thread list");
+        xml += "</threads>\n";
+        return;
+    }
+
+    int nwarps = backend_->get_num_warps();
+    int nthreads = backend_->get_num_threads_per_warp();
+    int warps_per_core = std::max(1, backend_->get_num_warps_per_core());
+    xml.reserve(xml.size() + static_cast<size_t>(nwarps) * nthreads * 96);
+    for (int wid = 0; wid < nwarps; ++wid) {
+        bool active = snap->is_active(wid);
+        if (GDBSTUB_HIDE_INACTIVE_THREADS && !active)
+            continue;
+        bool halted = snap->is_halted(wid);
+        uint32_t hacause = halted && snap->has_hacause ? snap->hacause[wid] : 0;
+        std::string state = !active ? "inactive" : !halted ? "running" :
+            hacause < sizeof(HACAUSE_NAMES) / sizeof(HACAUSE_NAMES[0]) ? HACAUSE_NAMES[hacause] : "halted";
+        for (int l_tid = 0; l_tid < nthreads; ++l_tid) {
+            xml += strfmt("<thread id=\"%x\" core=\"%d\" name=\"w%d.t%d\">%s</thread>\n",
+                _gdb_tid(wid, l_tid), wid / warps_per_core, wid, l_tid, state.c_str());
+        }
+    }
+    xml += "</threads>\n";
+}
+
+
 //==============================================================================
 // Command Handlers
 //==============================================================================
@@ -305,8 +669,13 @@ void GDBStub::send_ack() {
 void GDBStub::cmd_supported(const std::string& cmdstr) {
     std::string args = cmdstr.substr(11); // skip "qSupported:"
     std::vector<std::string> features = tokenize(args, ';');
-    std::string reply = "PacketSize=4096;"; // set max packet size
+    // Size packets to what one backend memory request can move efficiently
+    packet_size_ = backend_->has_mem_bulk() ? GDBSTUB_BULK_PACKET_SIZE : GDBSTUB_PACKET_SIZE;
+    std::string reply = strfmt("PacketSize=%zx;", packet_size_);  // hex
+    reply += "QStartNoAckMode+;";
+    reply += "QNonStop+;";
     reply += "qXfer:features:read+;"; // support feature read
+    reply += "qXfer:threads:read+;";
     // Advertise software breakpoint support
     if(std::find(features.begin(), features.end(), "swbreak+") != features.end()) {
         reply += "swbreak+;";
@@ -315,6 +684,16 @@ void GDBStub::cmd_supported(const std::string& cmdstr) {
     send_packet(reply);
 }
 
+// cmd: QStartNoAckMode
+// desc: Stop sending/expecting '+' acks after this packet
+// reply: OK
+void GDBStub::cmd_start_noack(const std::string& cmdstr) {
+    (void)cmdstr;
+    send_packet("OK");
+    noack_ = true;
+    log_->debug("No-ack mode enabled");
+}
+
 // cmd: qAttached:pid
 // desc: Check if the remote server is attached to a running program
 // reply: '1' if attached to running program, '0' if started by gdb
@@ -329,8 +708,22 @@ void GDBStub::cmd_attached(const std::string& cmdstr) {
 // Reply: Signal that caused the target to stop
 void GDBStub::cmd_halted(const std::string& cmdstr) {
     (void)cmdstr;
-    // For now, always report SIGTRAP
-    send_packet("S05");
+    if (!non_stop_) {
+        // For now, always report SIGTRAP
+        send_packet("S05");
+        return;
+    }
+
+    // Non-stop: report the first halted thread, the rest are drained via vStopped
+    std::map<int, WarpStatus_t> warp_status;
+    backend_->get_warp_status(warp_status, false, true);
+    stop_queue_.clear();
+    for (const auto& [wid, ws] : warp_status) {
+        if (ws.active && ws.halted && running_wids_.count(wid) == 0)
+            stop_queue_.push_back(_stop_reply(wid, 0, ws.hacause));
+    }
+    notif_inflight_ = !stop_queue_.empty();
+    send_packet(stop_queue_.empty() ? "OK" : stop_queue_.front());
 }
 
 // cmd: D:pid
@@ -339,6 +732,8 @@ void GDBStub::cmd_halted(const std::string& cmdstr) {
 void GDBStub::cmd_detach(const std::string& cmdstr) {
     (void)cmdstr;
     is_attached_ = false;
+    running_wids_.clear();
+    stop_reply_pending_ = false;
     backend_->resume_warps();   // resume all warps on detach
     send_packet("OK");
 }
@@ -348,21 +743,21 @@ void GDBStub::cmd_detach(const std::string& cmdstr) {
 // reply: xxx... (concatenated register values, target dependent format)
 void GDBStub::cmd_read_regs(const std::string& cmdstr) {
     (void)cmdstr;
-    // For now, return dummy registers (32 regs, all zero)
     std::string reply;
-    for (int i = 0; i < 32; ++i) {
-        uint32_t regval;
-        backend_->read_gpr(i, regval);
-        reply += strfmt("%08x", swap_endianess32(regval));
+    reply.reserve((33 + std::size(CSR_LIST)) * 8);
+    std::vector<uint32_t> gprs;
+    backend_->read_gprs(gprs);
+    for (uint32_t regval : gprs) {
+        append_hex_u32le(reply, regval);
     }
     uint32_t pc;
     backend_->get_warp_pc(pc);
-    reply += strfmt("%08x", swap_endianess32(pc));
+    append_hex_u32le(reply, pc);
 
-    uint32_t val;
-    for (RV_CSR csr : CSR_LIST) {
-        backend_->read_csr(csr, val);
-        reply += strfmt("%08x", swap_endianess32(val));
+    std::vector<uint32_t> csrs;
+    backend_->read_csrs(std::vector<uint32_t>(std::begin(CSR_LIST), std::end(CSR_LIST)), csrs);
+    for (uint32_t val : csrs) {
+        append_hex_u32le(reply, val);
     }
     send_packet(reply);
 }
@@ -371,15 +766,21 @@ void GDBStub::cmd_read_regs(const std::string& cmdstr) {
 // desc: Write general registers
 // reply: OK if successful
 void GDBStub::cmd_write_regs(const std::string& cmdstr) {
-    std::string args = cmdstr.substr(1); // skip "G"
+    const char *args = cmdstr.c_str() + 1; // skip "G"
+    size_t nchars = cmdstr.size() - 1;
     size_t reg_size = 8; // 8 hex chars = 32 bits
+    uint32_t regvals[33];
+    for (size_t i = 0; i < 33; ++i) {
+        if (!parse_hex_u32le(args + i * reg_size, nchars - std::min(nchars, i * reg_size), regvals[i])) {
+            log_->error("Invalid write registers command: " + cmdstr);
+            send_packet("E01");
+            return;
+        }
+    }
     for (size_t i = 0; i < 32; ++i) {
-        std::string reg_str = args.substr(i * reg_size, reg_size);
-        uint32_t regval = swap_endianess32(static_cast<uint32_t>(strtoul(reg_str.c_str(), nullptr, 16)));
-        backend_->write_gpr(i, regval);
+        backend_->write_gpr(i, regvals[i]);
     }
-    uint32_t pc = swap_endianess32(static_cast<uint32_t>(strtoul(args.substr(32 * reg_size, reg_size).c_str(), nullptr, 16)));
-    backend_->set_warp_pc(pc);
+    backend_->set_warp_pc(regvals[32]);
     
     send_packet("OK");
 }
@@ -406,8 +807,9 @@ void GDBStub::cmd_read_reg(const std::string& cmdstr) {
         send_packet("E02");
         return;
     }
-    regval = swap_endianess32(regval);
-    send_packet(strfmt("%08x", regval));
+    std::string reply;
+    append_hex_u32le(reply, regval);
+    send_packet(reply);
 }
 
 // cmd: P reg_idx=val
@@ -451,16 +853,12 @@ void GDBStub::cmd_write_reg(const std::string& cmdstr) {
 // reply: xx... (binary data as a sequence of hex digits)
 void GDBStub::cmd_read_mem(const std::string& cmdstr) {
     std::string args = cmdstr.substr(1); // skip "m"
-    size_t comma_pos = args.find(',');
-    if (comma_pos == std::string::npos) {
+    uint32_t addr, length;
+    if (!parse_addr_len(args, args.size(), addr, length)) {
         log_->error("Invalid read memory command: " + cmdstr);
         send_packet("E01");
         return;
     }
-    std::string addr_s = args.substr(0, comma_pos);
-    std::string length_s = args.substr(comma_pos + 1);
-    uint32_t addr = static_cast<uint32_t>(strtoul(addr_s.c_str(), nullptr, 16));
-    uint32_t length = static_cast<uint32_t>(strtoul(length_s.c_str(), nullptr, 16));
     std::vector<uint8_t> data;
     int rc = backend_->read_mem(addr, length, data);
     if (rc != RCODE_OK) {
@@ -469,61 +867,130 @@ void GDBStub::cmd_read_mem(const std::string& cmdstr) {
     }
     // Send the memory contents as a hex string
     std::string hex_data;
-    for (uint8_t byte : data) {
-        hex_data += strfmt("%02x", byte);
-    }
+    hex_encode(data.data(), data.size(), hex_data);
     send_packet(hex_data);
 }
 
 
+// GDB 'load' arrives as a sequence of M/X packets: with load_delta set, chunk
+// sized writes skip the parts target memory already holds
+int GDBStub::_write_mem(uint32_t addr, const std::vector<uint8_t>& data) {
+    if (backend_->get_param("load_delta") == "1" && data.size() >= std::stoul(backend_->get_param("load_chunk")))
+        return backend_->load_mem(addr, data, true);
+    return backend_->write_mem(addr, data);
+}
+
 // cmd: M addr,length:xx...
 // desc: Write memory
 // reply: OK if successful
 void GDBStub::cmd_write_mem(const std::string& cmdstr) {
     std::string args = cmdstr.substr(1); // skip "M"
     size_t colon_pos = args.find(':');
-    if (colon_pos == std::string::npos) {
+    uint32_t addr, length;
+    if (colon_pos == std::string::npos || !parse_addr_len(args, colon_pos, addr, length)) {
         log_->error("Invalid write memory command: " + cmdstr);
         send_packet("E01");
         return;
     }
-    std::string addr_length_str = args.substr(0, colon_pos);
-    std::string data_str = args.substr(colon_pos + 1);
-    // Parse addr and length
-    size_t comma_pos = addr_length_str.find(',');
-    if (comma_pos == std::string::npos) {
-        log_->error("Invalid write memory command: " + cmdstr);
-        send_packet("E01");
+
+    // Convert hex string to byte vector
+    size_t nchars = args.size() - colon_pos - 1;
+    if (nchars != 2 * static_cast<size_t>(length)) {
+        log_->error("Data length mismatch in write memory command");
+        send_packet("E02");     // FIXME: Is this correct error code?
+        return;
+    }
+    std::vector<uint8_t> data(length);
+    if (!hex_decode(args.c_str() + colon_pos + 1, nchars, data.data())) {
+        log_->error("Invalid hex data in write memory command");
+        send_packet("E02");
         return;
     }
-    std::string addr_s = addr_length_str.substr(0, comma_pos);
-    std::string length_s = addr_length_str.substr(comma_pos + 1);
-    uint32_t addr = static_cast<uint32_t>(strtoul(addr_s.c_str(), nullptr, 16));
-    uint32_t length = static_cast<uint32_t>(strtoul(length_s.c_str(), nullptr, 16));
 
-    // Convert hex string to byte vector
-    std::vector<uint8_t> data;
-    for (size_t i = 0; i < data_str.length(); i += 2) {
-        std::string byte_str = data_str.substr(i, 2);
-        uint8_t byte = static_cast<uint8_t>(strtoul(byte_str.c_str(), nullptr, 16));
-        data.push_back(byte);
+    int rc = _write_mem(addr, data);
+    send_packet(rc == RCODE_OK ? "OK" : "E03");
+}
+
+
+// cmd: X addr,length:XX...
+// desc: Write memory, binary data with '}' escapes (byte ^ 0x20)
+// reply: OK if successful
+void GDBStub::cmd_write_mem_bin(const std::string& cmdstr) {
+    size_t colon_pos = cmdstr.find(':');
+    uint32_t addr, length;
+    if (colon_pos == std::string::npos || !parse_addr_len(cmdstr.substr(1, colon_pos - 1), colon_pos - 1, addr, length)) {
+        log_->error("Invalid binary write memory command");
+        send_packet("E01");
+        return;
     }
 
+    // Unescape payload
+    std::vector<uint8_t> data = unescape_binary(cmdstr, colon_pos + 1);
+
     if (data.size() != length) {
-        log_->error("Data length mismatch in write memory command");
-        send_packet("E02");     // FIXME: Is this correct error code?
+        log_->error("Data length mismatch in binary write memory command");
+        send_packet("E02");
+        return;
+    }
+    if (length == 0) {      // GDB probes X support with an empty write
+        send_packet("OK");
         return;
     }
 
-    int rc = backend_->write_mem(addr, data);
+    int rc = _write_mem(addr, data);
     send_packet(rc == RCODE_OK ? "OK" : "E03");
 }
 
+// cmd: qCRC:addr,length
+// desc: CRC-32 of a memory region (compare-sections), computed by the stub
+// reply: Cxxxxxxxx or Enn
+void GDBStub::cmd_crc(const std::string& cmdstr) {
+    std::string args = cmdstr.substr(5); // skip "qCRC:"
+    uint32_t addr, length;
+    if (!parse_addr_len(args, args.size(), addr, length)) {
+        log_->error("Invalid CRC command: " + cmdstr);
+        send_packet("E01");
+        return;
+    }
+    uint32_t crc = 0;
+    if (backend_->crc32_mem(addr, length, crc) != RCODE_OK) {
+        send_packet("E03");
+        return;
+    }
+    send_packet(strfmt("C%08x", crc));
+}
+
+// cmd: qSearch:memory:addr;length;pattern
+// desc: Find the first occurrence of a binary (escaped) pattern (find)
+// reply: 0 if not found, 1,addr if found, Enn on error
+void GDBStub::cmd_search_mem(const std::string& cmdstr) {
+    std::string args = cmdstr.substr(15); // skip "qSearch:memory:"
+    size_t semi1 = args.find(';');
+    size_t semi2 = semi1 == std::string::npos ? std::string::npos : args.find(';', semi1 + 1);
+    if (semi2 == std::string::npos) {
+        log_->error("Invalid search memory command");
+        send_packet("E01");
+        return;
+    }
+    uint32_t addr = static_cast<uint32_t>(strtoul(args.c_str(), nullptr, 16));
+    uint32_t length = static_cast<uint32_t>(strtoul(args.c_str() + semi1 + 1, nullptr, 16));
+    std::vector<uint8_t> pattern = unescape_binary(args, semi2 + 1);
+
+    bool found = false;
+    uint32_t found_addr = 0;
+    if (backend_->search_mem(addr, length, pattern, found, found_addr) != RCODE_OK) {
+        send_packet("E03");
+        return;
+    }
+    send_packet(found ? strfmt("1,%x", found_addr) : "0");
+}
 
 // cmd: c [addr]
 // desc: Continue execution, optionally from address addr
 // reply: Sxx (signal that caused the target to stop)
 void GDBStub::cmd_continue(const std::string& cmdstr) {
+    if (_stop_reply_outstanding())
+        return;
     std::string args = cmdstr.substr(1); // skip "c"
     if (!args.empty()) {
         uint32_t addr = static_cast<uint32_t>(strtoul(args.c_str(), nullptr, 16));
@@ -533,21 +1000,24 @@ void GDBStub::cmd_continue(const std::string& cmdstr) {
     int selected_wid, selected_tid;
     backend_->get_selected_warp_thread(selected_wid, selected_tid, true);  
     if(backend_->resume_warps({selected_wid}) != RCODE_OK) {
-        log_->error("Failed to resume the selected warp/thread");
-        send_packet("E01");     // FIXME: Is this correct error code?
-        return;
-    }
-    if(backend_->until_breakpoint() != RCODE_OK) {
-        log_->error("Failed to continue execution until breakpoint");
-        send_packet("E01");     // FIXME: Is this correct error code?
-        return;
+        log_->warn("Selected warp may not have resumed");
     }
 
-    // For now, immediately report halt with SIGTRAP
-    send_packet("S05");
+    // Stop reply is sent by the halt waiter, the main loop keeps serving \x03
+    _track_running({selected_wid});
+    stop_reply_pending_ = true;
 }
 
 
+bool GDBStub::_stop_reply_outstanding() {
+    // All-stop: the previous resume has not been answered, nothing runs twice
+    if (non_stop_ || !stop_reply_pending_)
+        return false;
+    log_->error("Resume request while a stop reply is still pending");
+    send_packet("E01");
+    return true;
+}
+
 // cmd: s [addr]
 // desc: Step execution, optionally from address addr
 // reply: Sxx (signal that caused the target to stop)
@@ -567,6 +1037,153 @@ void GDBStub::cmd_step(const std::string& cmdstr) {
     send_packet("S05");
 }
 
+// cmd: vCont?
+// desc: Query supported vCont actions
+// reply: vCont[;action...]
+void GDBStub::cmd_vcont_query(const std::string& cmdstr) {
+    (void)cmdstr;
+    send_packet("vCont;c;C;s;S;t");
+}
+
+// cmd: vCont[;action[:thread-id]]...
+// desc: Resume/step/stop threads, the leftmost action matching a thread applies
+//       (actions are applied per warp, a step steps the given thread)
+// reply: all-stop: stop reply once a warp stops, non-stop: OK (stops via %Stop)
+void GDBStub::cmd_vcont(const std::string& cmdstr) {
+    if (_stop_reply_outstanding())
+        return;
+    std::vector<std::string> actions = tokenize(cmdstr.substr(6), ';'); // skip "vCont;"
+    int num_warps = backend_->get_num_warps();
+    std::map<int, std::pair<char, int>> warp_action;    // wid -> (action, l_tid)
+    for (const auto& action : actions) {
+        if (action.empty())
+            continue;
+        char act = static_cast<char>(tolower(action[0]));   // C/S carry a signal, ignored
+        size_t colon = action.find(':');
+        std::string tid_str = colon == std::string::npos ? "-1" : action.substr(colon + 1);
+        if (tid_str == "-1") {
+            for (int wid = 0; wid < num_warps; ++wid)
+                warp_action.emplace(wid, std::make_pair(act, 0));
+            continue;
+        }
+        int wid, l_tid;
+        if (!_from_gdb_tid(static_cast<int>(strtoul(tid_str.c_str(), nullptr, 16)), wid, l_tid)) {
+            log_->error("Invalid thread ID in vCont: " + tid_str);
+            send_packet("E01");
+            return;
+        }
+        warp_action.emplace(wid, std::make_pair(act, l_tid));
+    }
+
+    const WarpStateSnapshot_t *snap = nullptr;
+    if (backend_->get_warp_snapshot(snap) != RCODE_OK) {
+        send_packet("E02");
+        return;
+    }
+    std::vector<int> cont_wids, stop_wids;
+    std::vector<std::pair<int, int>> step_threads;
+    for (const auto& [wid, act_tid] : warp_action) {
+        if (!snap->is_active(wid))
+            continue;
+        bool halted = snap->is_halted(wid);
+        switch (act_tid.first) {
+            case 'c': if (halted) cont_wids.push_back(wid); break;
+            case 's': if (halted) step_threads.push_back({wid, act_tid.second}); break;
+            case 't': if (!halted) stop_wids.push_back(wid); break;
+            default:
+                log_->error(strfmt("Unsupported vCont action: %c", act_tid.first));
+                send_packet("E01");
+                return;
+        }
+    }
+
+    // Stop requested warps (non-stop only, all-stop threads are already stopped)
+    if (!stop_wids.empty()) {
+        if (backend_->halt_warps(stop_wids) != RCODE_OK)
+            log_->warn("Some warps failed to halt");
+    }
+    if (!cont_wids.empty()) {
+        if (backend_->resume_warps(cont_wids) != RCODE_OK)
+            log_->warn("Some warps may not have resumed");
+        _track_running(cont_wids);
+    }
+
+    std::vector<std::pair<int, int>> stepped;
+    for (const auto& [wid, l_tid] : step_threads) {
+        if (backend_->select_warp_thread(wid, l_tid) != RCODE_OK || backend_->step_warp() != RCODE_OK) {
+            log_->error("Failed to step warp " + std::to_string(wid));
+            continue;
+        }
+        stepped.push_back({wid, l_tid});
+    }
+
+    if (non_stop_) {
+        send_packet("OK");
+        for (int wid : stop_wids) {
+            running_wids_.erase(wid);
+            _queue_stop(_stop_reply(wid, 0, 0));
+        }
+        for (const auto& [wid, l_tid] : stepped)
+            _queue_stop(_stop_reply(wid, l_tid, 0x3));
+        return;
+    }
+
+    // All-stop: a finished step stops everything else again
+    if (!stepped.empty()) {
+        _report_stops({stepped[0].first}, stepped[0].second);
+        return;
+    }
+    if (running_wids_.empty()) {
+        log_->warn("vCont: no warp to resume");
+        send_packet("S05");
+        return;
+    }
+    stop_reply_pending_ = true;
+}
+
+// cmd: QNonStop:0|1
+// desc: Enter/leave non-stop mode
+// reply: OK
+void GDBStub::cmd_non_stop(const std::string& cmdstr) {
+    non_stop_ = cmdstr.substr(9) == "1";    // skip "QNonStop:"
+    stop_queue_.clear();
+    notif_inflight_ = false;
+    log_->info(std::string("Non-stop mode ") + (non_stop_ ? "enabled" : "disabled"));
+    send_packet("OK");
+}
+
+// cmd: vStopped
+// desc: Acknowledge the last stop notification, fetch the next queued one
+// reply: stop reply, or OK when the queue is empty
+void GDBStub::cmd_vstopped(const std::string& cmdstr) {
+    (void)cmdstr;
+    if (!stop_queue_.empty())
+        stop_queue_.pop_front();
+    if (stop_queue_.empty()) {
+        notif_inflight_ = false;
+        send_packet("OK");
+        return;
+    }
+    send_packet(stop_queue_.front());
+}
+
+// cmd: \x03
+// desc: Interrupt running warps
+// reply: stop reply (all-stop), %Stop notifications (non-stop)
+void GDBStub::cmd_interrupt() {
+    auto lk = _lock_backend();
+    if (running_wids_.empty()) {
+        cmd_halted("");
+        return;
+    }
+    std::vector<int> wids(running_wids_.begin(), running_wids_.end());
+    if (backend_->halt_warps(wids) != RCODE_OK)
+        log_->warn("Some warps failed to halt on interrupt");
+    _collect_stops();
+    _save_context();
+}
+
+
 // cmd: Z type,addr,kind
 // desc: Insert breakpoint/watchpoint
 // reply: OK if successful
@@ -638,26 +1255,32 @@ void GDBStub::cmd_thread_list_first(const std::string& cmdstr) {
 }
 
 // cmd: qsThreadInfo
-// desc: Request next batch of thread IDs
+// desc: Request next batch of thread IDs (GDB prefers qXfer:threads:read)
 // reply: m[tid1,tid2,...] or l
 void GDBStub::cmd_thread_list_next(const std::string& cmdstr) {
-    (void)cmdstr;   
-    if (thread_enum_cursor_ >= thread_map_.size()) {
-        send_packet("l"); // no more threads
+    (void)cmdstr;
+    const WarpStateSnapshot_t *snap = nullptr;
+    if (GDBSTUB_HIDE_INACTIVE_THREADS && backend_->get_warp_snapshot(snap) != RCODE_OK) {
+        send_packet("E02");
         return;
     }
 
     std::string reply = "m";
+    int nthreads = backend_->get_num_threads_per_warp();
     size_t count = 0;
-    for (; thread_enum_cursor_ < thread_map_.size() && count < MAX_THREADS_PER_REPLY; ++thread_enum_cursor_, ++count) {
-        int gtid = std::next(thread_map_.begin(), thread_enum_cursor_)->first;
-        reply += strfmt("%x,", gtid);
+    for (; thread_enum_cursor_ < num_gdb_threads_ && count < MAX_THREADS_PER_REPLY; ++thread_enum_cursor_) {
+        if (snap && !snap->is_active(thread_enum_cursor_ / nthreads))
+            continue;
+        reply += strfmt("%x,", thread_enum_cursor_ + 1);
+        ++count;
+    }
+    if (count == 0) {
+        send_packet("l"); // no more threads
+        return;
     }
 
     // Remove trailing comma
-    if (reply.back() == ',') {
-        reply.pop_back();
-    }
+    reply.pop_back();
     send_packet(reply);
 }
 
@@ -666,16 +1289,13 @@ void GDBStub::cmd_thread_list_next(const std::string& cmdstr) {
 // reply: string (null-terminated)
 void GDBStub::cmd_thread_info(const std::string& cmdstr) {
     std::string args = cmdstr.substr(17); // skip "qThreadExtraInfo,"
-    uint32_t tid = static_cast<uint32_t>(strtoul(args.c_str(), nullptr, 16));
-    auto it = thread_map_.find(tid);
-    if (it == thread_map_.end()) {
+    int g_wid, l_tid;
+    if (!_from_gdb_tid(static_cast<int>(strtoul(args.c_str(), nullptr, 16)), g_wid, l_tid)) {
         log_->error("Invalid thread ID in thread info command: " + args);
         send_packet("");
         return;
     }
     // Send the thread info (name, etc.)
-    uint32_t g_wid = it->second.first;
-    uint32_t l_tid = it->second.second;
     bool active, halted;
     backend_->get_warp_state(g_wid, active, halted);
 
@@ -683,9 +1303,7 @@ void GDBStub::cmd_thread_info(const std::string& cmdstr) {
         g_wid, l_tid, active ? "active" : "inactive", halted ? "halted" : "unhalted");
 
     std::string hex_thread_info;
-    for (char c : thread_info) {
-        hex_thread_info += strfmt("%02x", static_cast<uint8_t>(c));
-    }
+    hex_encode(reinterpret_cast<const uint8_t*>(thread_info.data()), thread_info.size(), hex_thread_info);
     send_packet(hex_thread_info);
 }
 
@@ -696,8 +1314,7 @@ void GDBStub::cmd_curr_thread(const std::string& cmdstr) {
     (void)cmdstr;   
     int selected_wid, selected_tid;
     backend_->get_selected_warp_thread(selected_wid, selected_tid, true);
-    int gtid = selected_wid * backend_->get_num_threads_per_warp() + selected_tid;
-    send_packet(strfmt("QC%x", gtid));
+    send_packet(strfmt("QC%x", _gdb_tid(selected_wid, selected_tid)));
 }
 
 // cmd: Hc tid or Hg tid
@@ -705,15 +1322,12 @@ void GDBStub::cmd_curr_thread(const std::string& cmdstr) {
 // reply: OK if successful
 void GDBStub::cmd_thread_select(const std::string& cmdstr) {
     std::string args = cmdstr.substr(2); // skip "Hc" or "Hg"
-    uint32_t tid = static_cast<uint32_t>(strtoul(args.c_str(), nullptr, 16));
-    auto it = thread_map_.find(tid);
-    if (it == thread_map_.end()) {
+    int g_wid, l_tid;
+    if (!_from_gdb_tid(static_cast<int>(strtoul(args.c_str(), nullptr, 16)), g_wid, l_tid)) {
         log_->error("Invalid thread ID in thread select command: " + args);
         send_packet("E01");
         return;
     }
-    uint32_t g_wid = it->second.first;
-    uint32_t l_tid = it->second.second;
     int rc = backend_->select_warp_thread(g_wid, l_tid);
     send_packet(rc == RCODE_OK ? "OK" : "E02");
 }
@@ -723,15 +1337,13 @@ void GDBStub::cmd_thread_select(const std::string& cmdstr) {
 // reply: OK if alive, E01 if not
 void GDBStub::cmd_thread_alive(const std::string& cmdstr) {
     std::string args = cmdstr.substr(1); // skip "T"
-    uint32_t tid = static_cast<uint32_t>(strtoul(args.c_str(), nullptr, 16));
-    auto it = thread_map_.find(tid);
-    if (it == thread_map_.end()) {
+    int g_wid, l_tid;
+    if (!_from_gdb_tid(static_cast<int>(strtoul(args.c_str(), nullptr, 16)), g_wid, l_tid)) {
         log_->error("Invalid thread ID in thread alive command: " + args);
         send_packet("E01");
         return;
     }
     bool is_active, is_halted;
-    uint32_t g_wid = it->second.first;
     backend_->get_warp_state(g_wid, is_active, is_halted);
     if(is_active) {
         send_packet("OK");
@@ -749,28 +1361,18 @@ void GDBStub::cmd_qxfer_features_read(const std::string& cmdstr) {
         return;
     }
 
-    // Find the offset and length part: e.g., "0,1000"
-    std::string range = cmdstr.substr(prefix.size());
-    size_t comma = range.find(',');
-    if (comma == std::string::npos) {
-        send_packet("E01");
-        return;
-    }
-
-    uint32_t offset = strtoul(range.substr(0, comma).c_str(), nullptr, 16);
-    uint32_t length = strtoul(range.substr(comma + 1).c_str(), nullptr, 16);
+    _send_xfer_chunk(target_xml, cmdstr.substr(prefix.size()));
+}
 
-    if (offset >= target_xml.size()) {
-        // 'l' means "last" chunk (nothing more to send)
-        send_packet("l");
-        return;
+// cmd: qXfer:threads:read::offset,length
+// desc: Serve the thread list as XML, built from one warp status sweep
+void GDBStub::cmd_qxfer_threads_read(const std::string& cmdstr) {
+    std::string range = cmdstr.substr(20); // skip "qXfer:threads:read::"
+    // GDB reads from offset 0 once per update, later chunks reuse the document
+    if (strtoul(range.c_str(), nullptr, 16) == 0 || threads_xml_.empty()) {
+        _build_threads_xml(threads_xml_);
     }
-
-    std::string chunk = target_xml.substr(offset, length);
-    char marker = (offset + chunk.size() < target_xml.size()) ? 'm' : 'l';
-
-    // Packet data = marker + chunk contents
-    send_packet(std::string(1, marker) + chunk);
+    _send_xfer_chunk(threads_xml_, range);
 }
 
 // cmd: qRcmd,cmdhex
@@ -787,9 +1389,21 @@ void GDBStub::cmd_monitor(const std::string& cmdstr) {
     }
 
     log_->info("Got monitor command: " + monitor_cmd);
-    int rc = vxdebug_->__execute_line(monitor_cmd);
-
-    std::string response = strfmt("Monitor cmd executed with rc=%d\n", rc);
+    std::string response;
+    std::vector<std::string> toks = tokenize(monitor_cmd, ' ');
+    if (!toks.empty() && toks[0] == "stats") {
+        // Output goes back to GDB rather than to the debugger console
+        bool json = std::find(toks.begin(), toks.end(), "--json") != toks.end();
+        if (std::find(toks.begin(), toks.end(), "reset") != toks.end()) {
+            backend_->reset_stats();
+            response = "Statistics reset\n";
+        } else {
+            response = backend_->get_stats(json) + "\n";
+        }
+    } else {
+        int rc = vxdebug_->__execute_line(monitor_cmd);
+        response = strfmt("Monitor cmd executed with rc=%d\n", rc);
+    }
     std::string hex_response;
     for (char c : response) {
         hex_response += strfmt("%02x", static_cast<uint8_t>(c));
@@ -2,6 +2,13 @@
 #include <string>
 #include <unordered_map>
 #include <map>
+#include <set>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
 
 // Forward declarations
 class GDBStub;
@@ -12,6 +19,30 @@ class TCPServer;
 
 #define MAX_THREADS_PER_REPLY 64
 
+#ifndef GDBSTUB_HIDE_INACTIVE_THREADS
+    #define GDBSTUB_HIDE_INACTIVE_THREADS 0     // Leave threads of inactive warps out of thread lists
+#endif
+
+#ifndef GDBSTUB_PACKET_SIZE
+    #define GDBSTUB_PACKET_SIZE 4096            // PacketSize advertised to GDB
+#endif
+
+#ifndef GDBSTUB_WAIT_SLICE_MS
+    #define GDBSTUB_WAIT_SLICE_MS 1             // Max time the halt waiter holds the backend per halt event wait
+#endif
+
+#ifndef GDBSTUB_MAX_CLIENTS
+    #define GDBSTUB_MAX_CLIENTS 8               // Concurrent GDB connections per server
+#endif
+
+#ifndef GDBSTUB_ACCEPT_POLL_MS
+    #define GDBSTUB_ACCEPT_POLL_MS 200          // Accept loop wakeup to reap sessions/see stop()
+#endif
+
+#ifndef GDBSTUB_BULK_PACKET_SIZE
+    #define GDBSTUB_BULK_PACKET_SIZE 65536      // PacketSize if the backend supports block memory transfer
+#endif
+
 // fn pointer
 typedef void (GDBStub::*cmd_handler_t)(const std::string&);
 
@@ -20,12 +51,23 @@ public:
     explicit GDBStub(VortexDebugger* vxdebug, Backend* backend);
     ~GDBStub();
 
-    int serve_forever(int port, bool allow_reconnect=true);  // Main loop
+    // Main loop: every client gets its own session thread. Without
+    // allow_reconnect, one client is served in the calling thread.
+    int serve_forever(int port, bool allow_reconnect=true);
+
+    // Ask serve_forever to return, disconnecting clients (thread-safe)
+    void stop();
 
 private:
+    // Session for an accepted client (client_fd < 0: listener)
+    GDBStub(VortexDebugger* vxdebug, Backend* backend, int client_fd, int session_id);
+    int _serve_client();
+    void _reap_sessions(bool all);
+
     // Core helpers
     int recv_packet(std::string& out);
     void send_packet(const std::string& msg);
+    void send_notification(const std::string& msg);
     void send_ack();
 
     // Command handlers
@@ -39,13 +81,21 @@ private:
     void cmd_write_reg(const std::string& cmdstr);
     void cmd_read_mem(const std::string& cmdstr);
     void cmd_write_mem(const std::string& cmdstr);
+    void cmd_write_mem_bin(const std::string& cmdstr);
+    void cmd_crc(const std::string& cmdstr);
+    void cmd_search_mem(const std::string& cmdstr);
+    void cmd_start_noack(const std::string& cmdstr);
     void cmd_continue(const std::string& cmdstr);
     void cmd_step(const std::string& cmdstr);
     void cmd_insert_bp(const std::string& cmdstr);
     void cmd_remove_bp(const std::string& cmdstr);
     // void cmd_kill(const std::string& cmdstr);
     
-    // void cmd_vcont_query(const std::string& cmdstr);
+    void cmd_vcont_query(const std::string& cmdstr);
+    void cmd_vcont(const std::string& cmdstr);
+    void cmd_non_stop(const std::string& cmdstr);
+    void cmd_vstopped(const std::string& cmdstr);
+    void cmd_interrupt();
     // void cmd_target_xml(const std::string& cmdstr);
 
     void cmd_thread_list_first(const std::string& cmdstr);
@@ -56,10 +106,33 @@ private:
     void cmd_thread_alive(const std::string& cmdstr);
 
     void cmd_qxfer_features_read(const std::string& cmdstr);
+    void cmd_qxfer_threads_read(const std::string& cmdstr);
     void cmd_monitor(const std::string& cmdstr);
 
     void cmd_notfound(const std::string& cmdstr);
 
+    // Run control helpers (called with backend_mtx_ held)
+    int _gdb_tid(int wid, int tid) const;
+    std::string _stop_reply(int wid, int tid, uint32_t hacause) const;
+    void _track_running(const std::vector<int>& wids);
+    void _collect_stops();
+    void _report_stops(const std::vector<int>& wids, int tid = 0);
+    void _queue_stop(const std::string& reply);
+    // All-stop resume while the last one awaits its stop reply: answers E01, true
+    bool _stop_reply_outstanding();
+
+    // Halt waiter thread: watches running_wids_ while the main loop serves GDB
+    void _start_waiter();
+    void _stop_waiter();
+    void _wait_loop();
+    std::unique_lock<std::recursive_mutex> _lock_backend();
+    void _restore_context();
+    void _save_context();
+    bool _from_gdb_tid(int gtid, int &wid, int &tid) const;
+    void _send_xfer_chunk(const std::string& doc, const std::string& range);
+    void _build_threads_xml(std::string& xml);
+    int _write_mem(uint32_t addr, const std::vector<uint8_t>& data);
+
     // Internal state
     VortexDebugger* vxdebug_;
     Backend* backend_;
@@ -68,7 +141,39 @@ private:
 
     std::unordered_map<std::string, cmd_handler_t> cmd_map_;
     bool is_attached_ = false;
+    bool noack_ = false;                            // QStartNoAckMode negotiated
+    size_t packet_size_ = GDBSTUB_PACKET_SIZE;      // Max packet size advertised in qSupported
+
+    // Sessions (listener only)
+    struct Session_t {
+        GDBStub *stub;
+        std::thread thread;
+    };
+    std::vector<Session_t> sessions_;
+    std::mutex sessions_mtx_;
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<bool> session_done_{false};
+    int session_id_ = 0;
+    int next_session_id_ = 0;
+
+    // Selected warp/thread of this client, re-selected when another frontend changed it
+    int ctx_wid_ = -1;
+    int ctx_tid_ = -1;
+
+    // Run control state, guarded by backend_mtx_
+    std::recursive_mutex &backend_mtx_;             // Backend::cmd_mutex(), shared with CLI and other clients
+    std::mutex tx_mtx_;                             // Serializes writes to the GDB socket
+    std::condition_variable_any run_cv_;            // Wakes the waiter (new running warps, stop)
+    std::thread waiter_;
+    std::atomic<bool> waiter_stop_{false};
+    std::set<int> running_wids_;                    // Warps resumed by GDB, not yet reported stopped
+    bool non_stop_ = false;                         // QNonStop:1
+    bool stop_reply_pending_ = false;               // All-stop: c/vCont waits for its stop reply, another one is refused
+    std::deque<std::string> stop_queue_;            // Non-stop: stop replies not yet drained by vStopped
+    bool notif_inflight_ = false;                   // Non-stop: %Stop sent, waiting for vStopped
 
-    std::map<int, std::pair<int, int>> thread_map_; // tid -> (g_wid, l_tid)
-    size_t thread_enum_cursor_ = 0;
+    // GDB thread ids are 1 + g_wid * threads_per_warp + l_tid (see _gdb_tid)
+    int num_gdb_threads_ = 0;
+    int thread_enum_cursor_ = 0;
+    std::string threads_xml_;                       // qXfer:threads document, rebuilt at offset 0
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <argparse.h>
 #include "logger.h"
 #include "vxdebug.h"
+#include "util.h"
 
 #ifndef VXDBG_VERSION
     #define VXDBG_VERSION "v0.1"
@@ -30,7 +31,10 @@ std::string banner =
 int main(const int argc, char** argv) {
     ArgParse::ArgumentParser parser("vxdbg", "Vortex Debugger");
     parser.add_argument({"-s", "--script"}, "Script file to execute", ArgParse::STR, "");
+    parser.add_argument({"--attach"}, "Attach to a running target before the script ([tcp:]host:port, unix:<path>, shm:/<name>)", ArgParse::STR, "");
+    parser.add_argument({"--cache-dir"}, "Directory of the persistent platform/assembler caches ('none' disables)", ArgParse::STR, "");
     parser.add_argument({"--log"}, "Log file path", ArgParse::STR, "");
+    parser.add_argument({"--log-async"}, "Write the log file from a background thread", ArgParse::BOOL, "false");
     parser.add_argument({"-v", "--verbose"}, "Set verbosity (0:err, 1:warn, 2:info, 3-9:debug)", ArgParse::INT, "2");
     parser.add_argument({"--version"}, "Show version information and exit", ArgParse::BOOL, "false");
     parser.add_argument({"--no-banner"}, "Do not print banner", ArgParse::BOOL, "false");
@@ -62,7 +66,12 @@ int main(const int argc, char** argv) {
     std::string log_file = parser.get<std::string>("log");
     if (!log_file.empty()) {
         Logger::ginfo("Logging to file: " + log_file);
-        Logger::set_output_file(log_file);
+        Logger::set_output_file(log_file, parser.get<bool>("log_async"));
+    }
+
+    std::string cache_dir = parser.get<std::string>("cache_dir");
+    if (!cache_dir.empty()) {
+        set_cache_dir(cache_dir == "none" ? "" : cache_dir);
     }
 
     // Print banner
@@ -75,6 +84,15 @@ int main(const int argc, char** argv) {
         Logger::ginfo("Starting Vortex Debugger " VXDBG_VERSION);
         VortexDebugger debugger;
 
+        std::string attach = parser.get<std::string>("attach");
+        if (!attach.empty()) {
+            rc = debugger.attach(attach);
+            if (rc != 0) {
+                Logger::gerror("Failed to attach to " + attach);
+                return rc;
+            }
+        }
+
         // Execute script if provided
         std::string script = parser.get<std::string>("script");
         if (!script.empty()) {
@@ -0,0 +1,277 @@
+#include "profiler.h"
+#include "elfimage.h"
+#include "logger.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+
+Profiler::Profiler(Backend *backend):
+    backend_(backend),
+    log_(new Logger("Profiler", 3)),
+    ring_(PROFILE_RING_SZ)
+{}
+
+Profiler::~Profiler() {
+    stop();
+    delete log_;
+}
+
+int Profiler::start(unsigned rate_hz, bool halting) {
+    if (running_) {
+        log_->error("Profiler is already running");
+        return RCODE_ERROR;
+    }
+    if (rate_hz == 0 || rate_hz > PROFILE_MAX_HZ) {
+        log_->error(strfmt("Invalid sample rate %u Hz, must be 1..%u", rate_hz, PROFILE_MAX_HZ));
+        return RCODE_INVALID_ARG;
+    }
+    if (!halting && !backend_->has_warp_gather()) {
+        log_->error("Target has no warp gather registers, running warps can only be sampled by halting them (--halt)");
+        return RCODE_ERROR;
+    }
+    // Reap a sampler that gave up on its own
+    if (thread_.joinable())
+        thread_.join();
+    rate_hz_ = rate_hz;
+    halting_ = halting;
+    {
+        std::lock_guard<std::mutex> lock(table_mtx_);
+        summary_.rate_hz = rate_hz;
+        summary_.halting = halting;
+    }
+    stop_requested_ = false;
+    running_ = true;
+    thread_ = std::thread(&Profiler::_sample_loop, this);
+    log_->info(strfmt("Sampling warp PCs at %u Hz (%s)", rate_hz, halting ? "halting" : "non-intrusive"));
+    return RCODE_OK;
+}
+
+void Profiler::stop() {
+    if (!thread_.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(stop_mtx_);
+        stop_requested_ = true;
+    }
+    stop_cv_.notify_all();
+    thread_.join();
+    running_ = false;
+    std::lock_guard<std::mutex> lock(table_mtx_);
+    _drain();
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(table_mtx_);
+    _drain();
+    counts_.clear();
+    summary_.samples = 0;
+    for (std::atomic<uint64_t> *c : {&sweeps_, &dropped_, &late_, &errors_, &busy_ns_, &elapsed_ns_})
+        c->store(0);
+}
+
+void Profiler::_sample_loop() {
+    using clock = std::chrono::steady_clock;
+    const auto period = std::chrono::nanoseconds(1000000000ull / rate_hz_);
+    std::vector<PcSample_t> batch;
+    batch.reserve(256);
+    unsigned consecutive_errors = 0;
+    auto last = clock::now();
+    auto next = last;
+
+    while (true) {
+        batch.clear();
+        auto t0 = clock::now();
+        int rc;
+        {
+            auto lock = backend_->lock_cmd();
+            rc = backend_->sample_pcs(halting_, batch);
+        }
+        auto t1 = clock::now();
+        sweeps_++;
+        busy_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        if (rc != RCODE_OK) {
+            errors_++;
+            if (++consecutive_errors >= PROFILE_MAX_ERRORS) {
+                log_->error(strfmt("Stopping sampler after %u failed sweeps", consecutive_errors));
+                break;
+            }
+        } else {
+            consecutive_errors = 0;
+        }
+        for (const auto &s : batch)
+            _push(s);
+        if (head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire) >= PROFILE_RING_SZ / 2) {
+            std::unique_lock<std::mutex> lock(table_mtx_, std::try_to_lock);
+            if (lock.owns_lock())
+                _drain();
+        }
+
+        // Fixed rate: a sweep that overruns its tick starts the next one now
+        // instead of bursting to catch up
+        next += period;
+        if (next <= t1) {
+            late_++;
+            next = t1;
+        }
+        std::unique_lock<std::mutex> lock(stop_mtx_);
+        stop_cv_.wait_until(lock, next, [this] { return stop_requested_; });
+        auto now = clock::now();
+        elapsed_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count();
+        last = now;
+        if (stop_requested_)
+            break;
+    }
+    running_ = false;
+}
+
+void Profiler::_push(const PcSample_t &sample) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= PROFILE_RING_SZ) {
+        dropped_++;
+        return;
+    }
+    ring_[head & (PROFILE_RING_SZ - 1)] = sample;
+    head_.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::_drain() {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    summary_.samples += head - tail;
+    for (; tail != head; ++tail) {
+        const PcSample_t &s = ring_[tail & (PROFILE_RING_SZ - 1)];
+        counts_[(static_cast<uint64_t>(s.wid) << 32) | s.pc]++;
+    }
+    tail_.store(head, std::memory_order_release);
+}
+
+ProfileSummary_t Profiler::summary() {
+    std::lock_guard<std::mutex> lock(table_mtx_);
+    return _summary();
+}
+
+ProfileSummary_t Profiler::_summary() {
+    _drain();
+    ProfileSummary_t s = summary_;
+    s.sweeps = sweeps_;
+    s.dropped = dropped_;
+    s.late = late_;
+    s.errors = errors_;
+    s.busy_s = busy_ns_ * 1e-9;
+    s.elapsed_s = elapsed_ns_ * 1e-9;
+    return s;
+}
+
+std::string Profiler::_symbolize(const ElfImage *elf, uint32_t pc, bool with_offset) const {
+    uint32_t offset = 0;
+    const ElfSymbol_t *sym = elf ? elf->find_symbol(pc, &offset) : nullptr;
+    if (!sym)
+        return with_offset ? "" : "??";
+    if (!with_offset || offset == 0)
+        return sym->name;
+    return strfmt("%s+0x%x", sym->name.c_str(), offset);
+}
+
+std::string Profiler::report(const ElfImage *elf, size_t top, bool per_warp) {
+    // Snapshot the table, the sampler may keep running
+    ProfileSummary_t s;
+    std::vector<std::pair<uint64_t, uint64_t>> entries;
+    {
+        std::lock_guard<std::mutex> lock(table_mtx_);
+        s = _summary();
+        entries.assign(counts_.begin(), counts_.end());
+    }
+    std::unordered_map<uint32_t, uint64_t> by_pc;
+    std::map<uint32_t, uint64_t> by_warp;
+    for (const auto &e : entries) {
+        by_pc[static_cast<uint32_t>(e.first)] += e.second;
+        by_warp[static_cast<uint32_t>(e.first >> 32)] += e.second;
+    }
+    auto by_count = [](const std::pair<uint32_t, uint64_t> &a, const std::pair<uint32_t, uint64_t> &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    };
+    auto pct = [&s](uint64_t n) { return s.samples ? 100.0 * n / s.samples : 0.0; };
+
+    std::string out;
+    out += strfmt("%llu samples from %llu sweeps in %.2fs (%u Hz requested, %.0f Hz achieved, %s)\n",
+                  (unsigned long long)s.samples, (unsigned long long)s.sweeps, s.elapsed_s, s.rate_hz,
+                  s.elapsed_s > 0 ? s.sweeps / s.elapsed_s : 0.0, s.halting ? "halting" : "non-intrusive");
+    out += strfmt("Sampler: %.1f us/sweep (%.1f%% busy), %llu late, %llu dropped, %llu failed\n",
+                  s.sweeps ? 1e6 * s.busy_s / s.sweeps : 0.0, s.elapsed_s > 0 ? 100.0 * s.busy_s / s.elapsed_s : 0.0,
+                  (unsigned long long)s.late, (unsigned long long)s.dropped, (unsigned long long)s.errors);
+    if (s.samples == 0)
+        return out;
+
+    std::vector<std::pair<uint32_t, uint64_t>> pcs(by_pc.begin(), by_pc.end());
+    std::sort(pcs.begin(), pcs.end(), by_count);
+    out += strfmt("Flat profile (top %zu of %zu PCs):\n", std::min(top, pcs.size()), pcs.size());
+    out += "     samples       %  pc          symbol\n";
+    for (size_t i = 0; i < pcs.size() && i < top; ++i) {
+        out += strfmt("  %10llu  %5.1f%%  0x%08x  %s\n", (unsigned long long)pcs[i].second, pct(pcs[i].second),
+                      pcs[i].first, _symbolize(elf, pcs[i].first, true).c_str());
+    }
+
+    if (elf) {
+        std::map<std::string, uint64_t> by_func_name;
+        for (const auto &p : pcs)
+            by_func_name[_symbolize(elf, p.first, false)] += p.second;
+        std::vector<std::pair<std::string, uint64_t>> funcs(by_func_name.begin(), by_func_name.end());
+        std::sort(funcs.begin(), funcs.end(), [](const auto &a, const auto &b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        out += "By function:\n";
+        out += "     samples       %  function\n";
+        for (size_t i = 0; i < funcs.size() && i < top; ++i)
+            out += strfmt("  %10llu  %5.1f%%  %s\n", (unsigned long long)funcs[i].second, pct(funcs[i].second),
+                          funcs[i].first.c_str());
+    }
+
+    if (per_warp) {
+        // Hottest PC of every warp
+        std::unordered_map<uint32_t, std::pair<uint32_t, uint64_t>> hottest;
+        for (const auto &e : entries) {
+            auto &h = hottest[static_cast<uint32_t>(e.first >> 32)];
+            if (e.second > h.second || (e.second == h.second && static_cast<uint32_t>(e.first) < h.first))
+                h = {static_cast<uint32_t>(e.first), e.second};
+        }
+        out += "Per warp:\n";
+        out += "   warp     samples       %  hottest pc\n";
+        for (const auto &w : by_warp) {
+            const auto &h = hottest[w.first];
+            out += strfmt("  %5u  %10llu  %5.1f%%  0x%08x %5.1f%%  %s\n", w.first, (unsigned long long)w.second,
+                          pct(w.second), h.first, 100.0 * h.second / w.second, _symbolize(elf, h.first, true).c_str());
+        }
+    }
+    return out;
+}
+
+int Profiler::write_folded(const std::string &path, const ElfImage *elf) {
+    std::vector<std::pair<uint64_t, uint64_t>> entries;
+    {
+        std::lock_guard<std::mutex> lock(table_mtx_);
+        _drain();
+        entries.assign(counts_.begin(), counts_.end());
+    }
+    std::sort(entries.begin(), entries.end());
+
+    std::ofstream ofs(path);
+    if (!ofs) {
+        log_->error("Failed to open " + path + " for writing");
+        return RCODE_ERROR;
+    }
+    for (const auto &e : entries) {
+        uint32_t wid = static_cast<uint32_t>(e.first >> 32);
+        uint32_t pc = static_cast<uint32_t>(e.first);
+        ofs << strfmt("warp%u;%s;0x%08x %llu\n", wid, _symbolize(elf, pc, false).c_str(), pc,
+                      (unsigned long long)e.second);
+    }
+    if (!ofs) {
+        log_->error("Failed to write " + path);
+        return RCODE_ERROR;
+    }
+    log_->info(strfmt("Wrote %zu folded stacks to %s", entries.size(), path.c_str()));
+    return RCODE_OK;
+}
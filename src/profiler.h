@@ -0,0 +1,114 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include "backend.h"
+
+// Forward declarations
+class ElfImage;
+class Logger;
+
+#ifndef PROFILE_RING_SZ
+    #define PROFILE_RING_SZ 65536           // Samples buffered between sampler and count table (power of 2)
+#endif
+
+#ifndef PROFILE_DEFAULT_HZ
+    #define PROFILE_DEFAULT_HZ 1000         // Warp sweeps per second
+#endif
+
+#ifndef PROFILE_MAX_HZ
+    #define PROFILE_MAX_HZ 100000
+#endif
+
+#ifndef PROFILE_MAX_ERRORS
+    #define PROFILE_MAX_ERRORS 16           // Consecutive failed sweeps before the sampler gives up
+#endif
+
+static_assert((PROFILE_RING_SZ & (PROFILE_RING_SZ - 1)) == 0, "PROFILE_RING_SZ must be a power of 2");
+
+// Sampling run totals
+struct ProfileSummary_t {
+    bool halting = false;
+    unsigned rate_hz = 0;
+    uint64_t sweeps = 0;            // Backend::sample_pcs() calls
+    uint64_t samples = 0;           // Counted (warp, PC) samples
+    uint64_t dropped = 0;           // Lost to a full ring
+    uint64_t late = 0;              // Sweeps that missed their tick
+    uint64_t errors = 0;            // Failed sweeps
+    double elapsed_s = 0;           // Wall time sampled
+    double busy_s = 0;              // Time spent sweeping (incl. waiting for the backend)
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Statistical PC sampling profiler
+////////////////////////////////////////////////////////////////////////////////
+// A sampler thread sweeps the PCs of all running warps at a fixed rate, taking
+// the backend command lock per sweep only, and pushes {wid, pc} into a
+// preallocated single producer ring. The ring is folded into a (warp, PC) count
+// table by the sampler when half full and by readers before reporting, so the
+// sampling path never allocates.
+class Profiler {
+public:
+    explicit Profiler(Backend *backend);
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Start sampling at rate_hz sweeps/s; halting samples through haltreq/resumereq
+    int start(unsigned rate_hz, bool halting);
+
+    // Stop the sampler, collected counts are kept until clear()
+    void stop();
+    bool running() const { return running_; }
+    Backend* backend() const { return backend_; }
+
+    // Drop all collected samples
+    void clear();
+
+    ProfileSummary_t summary();
+
+    // Flat profile (top entries by PC, by function with elf) and per-warp totals
+    std::string report(const ElfImage *elf, size_t top, bool per_warp);
+
+    // One "warp<wid>;<function>;<pc> <count>" line per (warp, PC), for flamegraph tools
+    int write_folded(const std::string &path, const ElfImage *elf);
+
+private:
+    Backend *backend_;
+    Logger *log_;
+
+    // Sampler thread
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    bool stop_requested_ = false;
+    std::mutex stop_mtx_;
+    std::condition_variable stop_cv_;
+    bool halting_ = false;
+    unsigned rate_hz_ = PROFILE_DEFAULT_HZ;
+
+    // Sample ring: the sampler advances head_, _drain() advances tail_
+    std::vector<PcSample_t> ring_;
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> tail_{0};
+
+    // Count table, key (wid << 32 | pc), and totals; guarded by table_mtx_
+    std::mutex table_mtx_;
+    std::unordered_map<uint64_t, uint64_t> counts_;
+    ProfileSummary_t summary_;
+
+    // Sampler side counters, read by summary()
+    std::atomic<uint64_t> sweeps_{0}, dropped_{0}, late_{0}, errors_{0};
+    std::atomic<uint64_t> busy_ns_{0}, elapsed_ns_{0};
+
+    void _sample_loop();
+    void _push(const PcSample_t &sample);
+    void _drain();                  // Caller holds table_mtx_
+    ProfileSummary_t _summary();    // Caller holds table_mtx_
+    std::string _symbolize(const ElfImage *elf, uint32_t pc, bool with_offset) const;
+};
@@ -1,5 +1,6 @@
 #include "riscv.h"
 #include "util.h"
+#include "stats.h"
 
 #include <cstdlib>
 #include <stdexcept>
@@ -10,6 +11,8 @@
 #include <cstdint>
 #include <array>
 #include <filesystem>
+#include <mutex>
+#include <unordered_set>
 
 #define get_bit(val, pos) (((val) >> (pos)) & 0x1)
 
@@ -47,6 +50,14 @@ uint32_t rvcsr_name2addr(const std::string &reg_name) {
     throw std::invalid_argument("Invalid RISC-V CSR name: " + reg_name);
 }
 
+bool rvcsr_is_volatile(uint32_t addr) {
+    // mcycle..mhpmcounter31(h), cycle..hpmcounter31(h)
+    uint32_t base = addr & ~0x1fu;
+    if (base == 0xb00 || base == 0xb80 || base == 0xc00 || base == 0xc80)
+        return true;
+    return addr == RV_CSR_VX_ACTIVE_WARPS || addr == RV_CSR_VX_ACTIVE_THREADS;
+}
+
 RVRegType_t rvreg_gettype(const std::string &reg_name) {
     // Check if GPR
     try {
@@ -113,6 +124,108 @@ std::string rv_isa_string(uint32_t misa, bool verbose) {
     return isa_str;
 }
 
+// Parse a GPR operand (arch or abi name)
+static bool _parse_gpr(const std::string &tok, uint32_t &regnum) {
+    try {
+        regnum = rvgpr_name2num(tok);
+        return true;
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+}
+
+// Parse a signed immediate (decimal or 0x-prefixed hex)
+static bool _parse_imm(const std::string &tok, int32_t &imm) {
+    if (tok.empty()) return false;
+    char *end = nullptr;
+    long val = std::strtol(tok.c_str(), &end, 0);
+    if (*end != '\0') return false;
+    imm = static_cast<int32_t>(val);
+    return true;
+}
+
+// Parse a CSR operand (number or name)
+static bool _parse_csr(const std::string &tok, uint32_t &csr) {
+    int32_t num = 0;
+    if (_parse_imm(tok, num)) {
+        if (num < 0 || num > 0xfff) return false;
+        csr = static_cast<uint32_t>(num);
+        return true;
+    }
+    try {
+        csr = rvcsr_name2addr(tok);
+        return true;
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+}
+
+static bool _fits_simm12(int32_t imm) {
+    return imm >= -2048 && imm <= 2047;
+}
+
+bool rv_asm_builtin(const std::string &asm_line, uint32_t &instr) {
+    // Normalize separators: "lw t1, 4(t0)" -> "lw t1 4 t0"
+    std::string line = asm_line;
+    for (char &c : line) {
+        if (c == ',' || c == '(' || c == ')' || c == '\t') c = ' ';
+    }
+    std::vector<std::string> ops;
+    for (const auto &tok : tokenize(strip(line), ' ')) {
+        if (!tok.empty()) ops.push_back(tok);
+    }
+    if (ops.empty()) return false;
+
+    const std::string &mnem = ops[0];
+    uint32_t rd = 0, rs = 0, csr = 0;
+    int32_t imm = 0;
+
+    if (mnem == "ebreak" && ops.size() == 1) {
+        instr = rv_ebreak();
+        return true;
+    }
+    if (mnem == "csrr" && ops.size() == 3) {
+        if (!_parse_gpr(ops[1], rd) || !_parse_csr(ops[2], csr)) return false;
+        instr = rv_csrr(rd, csr);
+        return true;
+    }
+    if (mnem == "csrw" && ops.size() == 3) {
+        if (!_parse_csr(ops[1], csr) || !_parse_gpr(ops[2], rs)) return false;
+        instr = rv_csrw(csr, rs);
+        return true;
+    }
+    if ((mnem == "lw" || mnem == "lb" || mnem == "sw" || mnem == "sb") && ops.size() == 4) {
+        // <op> reg, imm(base)
+        uint32_t base = 0;
+        if (!_parse_gpr(ops[1], rd) || !_parse_imm(ops[2], imm) || !_parse_gpr(ops[3], base)) return false;
+        if (!_fits_simm12(imm)) return false;
+        if (mnem == "lw")       instr = rv_lw(rd, imm, base);
+        else if (mnem == "lb")  instr = rv_lb(rd, imm, base);
+        else if (mnem == "sw")  instr = rv_sw(rd, imm, base);
+        else                    instr = rv_sb(rd, imm, base);
+        return true;
+    }
+    if (mnem == "addi" && ops.size() == 4) {
+        if (!_parse_gpr(ops[1], rd) || !_parse_gpr(ops[2], rs) || !_parse_imm(ops[3], imm)) return false;
+        if (!_fits_simm12(imm)) return false;
+        instr = rv_addi(rd, rs, imm);
+        return true;
+    }
+    if (mnem == "auipc" && ops.size() == 3) {
+        if (!_parse_gpr(ops[1], rd) || !_parse_imm(ops[2], imm)) return false;
+        if (imm < 0 || imm > 0xfffff) return false;
+        instr = rv_auipc(rd, static_cast<uint32_t>(imm));
+        return true;
+    }
+    if (mnem == "jal" && ops.size() == 3) {
+        if (!_parse_gpr(ops[1], rd) || !_parse_imm(ops[2], imm)) return false;
+        if ((imm & 0x1) || imm < -(1 << 20) || imm >= (1 << 20)) return false;
+        instr = rv_jal(rd, imm);
+        return true;
+    }
+    return false;
+}
+
 bool rv_toolchain_check(const std::string &toolchain_prefix) {
     std::string cmd = toolchain_prefix + "-as --version > /dev/null 2>&1";
     int rc = system(cmd.c_str());
@@ -151,8 +264,87 @@ public:
 //  - assumes all instructions are 32-bit (RVC disabled)
 //  - all lines are independent (no labels or branches)
 //  - doesn't handle pseudo-instructions, need to be expanded by user
+//  - lines supported by rv_asm_builtin() never invoke the external toolchain
+static StatCounter __rvasm_hits, __rvasm_builtin, __rvasm_toolchain, __rvasm_toolchain_runs, __rvasm_preloaded;
+
+RvAsmStats_t rv_asm_stats(bool reset) {
+    RvAsmStats_t s = {__rvasm_hits.get(), __rvasm_builtin.get(), __rvasm_toolchain.get(), __rvasm_toolchain_runs.get(),
+                      __rvasm_preloaded.get()};
+    if (reset) {
+        __rvasm_hits.reset();
+        __rvasm_builtin.reset();
+        __rvasm_toolchain.reset();
+        __rvasm_toolchain_runs.reset();
+        __rvasm_preloaded.reset();
+    }
+    return s;
+}
+
+// Cached instruction, preloaded ones came from the on-disk cache
+struct RvAsmCacheEntry_t {
+    uint32_t instr;
+    bool preloaded;
+};
+typedef std::unordered_map<std::string, RvAsmCacheEntry_t> RvAsmCache_t;
+
+// On-disk cache: one file per toolchain prefix, one "<hex word> <asm line>"
+// per line, append only. Several debugger processes may share it: duplicate
+// lines override each other on load, a last line without its newline (a
+// process died mid-append) could be a truncated instruction and is ignored.
+static std::string _rvasm_cache_path(const std::string &toolchain_prefix) {
+    std::string dir = get_cache_dir();
+    if (dir.empty())
+        return "";
+    uint64_t hash = 0xcbf29ce484222325ull;     // FNV-1a
+    for (unsigned char c : toolchain_prefix)
+        hash = (hash ^ c) * 0x100000001b3ull;
+    return dir + "/" + strfmt(RVASM_CACHE_FILE, static_cast<unsigned long long>(hash));
+}
+
+static void _rvasm_cache_load(const std::string &toolchain_prefix, RvAsmCache_t &cache) {
+    std::string path = _rvasm_cache_path(toolchain_prefix);
+    if (path.empty())
+        return;
+    std::ifstream ifs(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    for (size_t pos = 0, nl; (nl = content.find('\n', pos)) != std::string::npos; pos = nl + 1) {
+        std::string line = content.substr(pos, nl - pos);
+        size_t sp = line.find(' ');
+        if (sp != 8 || sp + 1 >= line.size())
+            continue;
+        char *end = nullptr;
+        uint32_t instr = std::strtoul(line.substr(0, sp).c_str(), &end, 16);
+        if (!end || *end != '\0')
+            continue;
+        cache[line.substr(sp + 1)] = {instr, true};
+    }
+}
+
+static void _rvasm_cache_append(const std::string &toolchain_prefix, const std::vector<std::string> &asm_lines,
+                                const std::vector<size_t> &indices, const std::vector<uint32_t> &machine_code) {
+    std::string path = _rvasm_cache_path(toolchain_prefix);
+    if (path.empty())
+        return;
+    std::string out;
+    for (size_t idx : indices)
+        out += strfmt("%08x %s\n", machine_code[idx], asm_lines[idx].c_str());
+    std::error_code ec;
+    std::filesystem::create_directories(get_cache_dir(), ec);
+    std::ofstream ofs(path, std::ios::app);
+    ofs.write(out.data(), out.size());  // Best effort, the cache is only an accelerator
+}
+
 std::vector<uint32_t> rv_asm(const std::vector<std::string> &asm_lines, const std::string &toolchain_prefix) {
-    static std::unordered_map<std::string, uint32_t> __rvasm_cache;
+    // One cache per toolchain prefix: another toolchain may encode a line differently
+    static std::unordered_map<std::string, RvAsmCache_t> __rvasm_caches;
+    static std::mutex __rvasm_mtx;     // Caches are shared by all targets/threads
+    std::lock_guard<std::mutex> lk(__rvasm_mtx);
+    auto cache_it = __rvasm_caches.find(toolchain_prefix);
+    if (cache_it == __rvasm_caches.end()) {
+        cache_it = __rvasm_caches.emplace(toolchain_prefix, RvAsmCache_t()).first;
+        _rvasm_cache_load(toolchain_prefix, cache_it->second);
+    }
+    RvAsmCache_t &__rvasm_cache = cache_it->second;
 
     std::vector<uint32_t> machine_code;
     machine_code.resize(asm_lines.size(), 0);  // Pre-allocate space for machine code
@@ -163,10 +355,21 @@ std::vector<uint32_t> rv_asm(const std::vector<std::string> &asm_lines, const st
     // ---------- Check Cache ----------
     for (size_t i = 0; i < asm_lines.size(); ++i) {
         const auto &line = asm_lines[i];
+        uint32_t instr = 0;
+        if (rv_asm_builtin(line, instr)) {
+            // Encoded in-process, the cache never overrides it
+            machine_code[i] = instr;
+            __rvasm_builtin.add();
+            continue;
+        }
         auto it = __rvasm_cache.find(line);
         if (it != __rvasm_cache.end()) {
             // Cache hit: use cached value
-            machine_code[i] = it->second;
+            machine_code[i] = it->second.instr;
+            if (it->second.preloaded)
+                __rvasm_preloaded.add();
+            else
+                __rvasm_hits.add();
             // printf("ASMCache hit: %s => 0x%08X\n", line.c_str(), it->second);
         } else {
             // Cache miss
@@ -185,6 +388,17 @@ std::vector<uint32_t> rv_asm(const std::vector<std::string> &asm_lines, const st
     }
 
     // ---------- Assemble missing lines ----------
+    // Toolchains found per prefix (under __rvasm_mtx); a missing one is checked
+    // again next time, it may have been installed since
+    static std::unordered_set<std::string> __rvasm_toolchains;
+    if (!__rvasm_toolchains.count(toolchain_prefix)) {
+        if (!rv_toolchain_check(toolchain_prefix))
+            throw std::runtime_error("RISC-V toolchain (" + toolchain_prefix + "-as) not found in PATH, cannot assemble: " + asm_lines[to_assemble_indices[0]]);
+        __rvasm_toolchains.insert(toolchain_prefix);
+    }
+    __rvasm_toolchain_runs.add();
+    __rvasm_toolchain.add(to_assemble_indices.size());
+
     int rc;
     {// Temporary Directory Scope
         // Create a temporary directory for assembly files
@@ -230,7 +444,7 @@ std::vector<uint32_t> rv_asm(const std::vector<std::string> &asm_lines, const st
                 size_t orig_idx = to_assemble_indices[n++];
                 // Store in machine_code vector, update cache
                 machine_code[orig_idx] = instr;
-                __rvasm_cache[asm_lines[orig_idx]] = instr;
+                __rvasm_cache[asm_lines[orig_idx]] = {instr, false};
             }
             
             // Check if we read a partial instruction
@@ -244,6 +458,7 @@ std::vector<uint32_t> rv_asm(const std::vector<std::string> &asm_lines, const st
             }
         }
     }// End Temporary Directory Scope
+    _rvasm_cache_append(toolchain_prefix, asm_lines, to_assemble_indices, machine_code);
 
     return machine_code;
 }
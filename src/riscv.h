@@ -5,6 +5,11 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <cstdint>
+
+#ifndef RVASM_CACHE_FILE
+    #define RVASM_CACHE_FILE "rvasm.%016llx.cache"     // Toolchain assembled lines per toolchain prefix (FNV-1a hash), in get_cache_dir()
+#endif
 
 #ifndef RISCV_TOOLCHAIN_PREFIX
     #define RISCV_TOOLCHAIN_PREFIX "riscv64-unknown-elf"
@@ -58,6 +63,18 @@ constexpr RVRegInfo_t RV_GPRS[] = {
 };
 constexpr size_t RV_GPR_COUNT = std::size(RV_GPRS);
 
+// GPR numbers by ABI name (for instruction encoders)
+enum RV_GPR: uint32_t {
+    RV_GPR_ZERO = 0,  RV_GPR_RA  = 1,  RV_GPR_SP  = 2,  RV_GPR_GP  = 3,
+    RV_GPR_TP   = 4,  RV_GPR_T0  = 5,  RV_GPR_T1  = 6,  RV_GPR_T2  = 7,
+    RV_GPR_S0   = 8,  RV_GPR_S1  = 9,  RV_GPR_A0  = 10, RV_GPR_A1  = 11,
+    RV_GPR_A2   = 12, RV_GPR_A3  = 13, RV_GPR_A4  = 14, RV_GPR_A5  = 15,
+    RV_GPR_A6   = 16, RV_GPR_A7  = 17, RV_GPR_S2  = 18, RV_GPR_S3  = 19,
+    RV_GPR_S4   = 20, RV_GPR_S5  = 21, RV_GPR_S6  = 22, RV_GPR_S7  = 23,
+    RV_GPR_S8   = 24, RV_GPR_S9  = 25, RV_GPR_S10 = 26, RV_GPR_S11 = 27,
+    RV_GPR_T3   = 28, RV_GPR_T4  = 29, RV_GPR_T5  = 30, RV_GPR_T6  = 31
+};
+
 std::string rvgpr_num2name(uint32_t regnum);
 uint32_t rvgpr_name2num(const std::string &reg_name);
 
@@ -128,9 +145,98 @@ const std::unordered_map<uint32_t, std::string_view> RV_CSR_NAMES = {
 std::string rvcsr_num2name(uint32_t addr);
 uint32_t rvcsr_name2addr(const std::string &reg_name);
 
+// CSR may change while the reading warp is halted (counters, warp/thread activity)
+bool rvcsr_is_volatile(uint32_t addr);
+
 // Get register type from name
 RVRegType_t rvreg_gettype(const std::string &reg_name);
 
+////////////////////////////////////////////////////////////////////////////////
+// RISC-V Instruction Encoders (RV32I subset used by the debugger)
+////////////////////////////////////////////////////////////////////////////////
+constexpr uint32_t RV_OPC_LOAD   = 0x03;
+constexpr uint32_t RV_OPC_MISCMEM = 0x0f;
+constexpr uint32_t RV_OPC_OPIMM  = 0x13;
+constexpr uint32_t RV_OPC_AUIPC  = 0x17;
+constexpr uint32_t RV_OPC_STORE  = 0x23;
+constexpr uint32_t RV_OPC_OP     = 0x33;
+constexpr uint32_t RV_OPC_BRANCH = 0x63;
+constexpr uint32_t RV_OPC_JAL    = 0x6f;
+constexpr uint32_t RV_OPC_SYSTEM = 0x73;
+
+constexpr uint32_t rv_enc_itype(uint32_t opc, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+    return ((static_cast<uint32_t>(imm) & 0xfff) << 20) | ((rs1 & 0x1f) << 15) | ((f3 & 0x7) << 12) | ((rd & 0x1f) << 7) | (opc & 0x7f);
+}
+
+constexpr uint32_t rv_enc_rtype(uint32_t opc, uint32_t f3, uint32_t f7, uint32_t rd, uint32_t rs1, uint32_t rs2) {
+    return ((f7 & 0x7f) << 25) | ((rs2 & 0x1f) << 20) | ((rs1 & 0x1f) << 15) | ((f3 & 0x7) << 12) | ((rd & 0x1f) << 7) | (opc & 0x7f);
+}
+
+constexpr uint32_t rv_enc_stype(uint32_t opc, uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+    uint32_t uimm = static_cast<uint32_t>(imm);
+    return (((uimm >> 5) & 0x7f) << 25) | ((rs2 & 0x1f) << 20) | ((rs1 & 0x1f) << 15) | ((f3 & 0x7) << 12) | ((uimm & 0x1f) << 7) | (opc & 0x7f);
+}
+
+constexpr uint32_t rv_enc_btype(uint32_t opc, uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t offset) {
+    uint32_t o = static_cast<uint32_t>(offset);
+    return (((o >> 12) & 0x1) << 31) | (((o >> 5) & 0x3f) << 25) | ((rs2 & 0x1f) << 20) | ((rs1 & 0x1f) << 15) | ((f3 & 0x7) << 12) | (((o >> 1) & 0xf) << 8) | (((o >> 11) & 0x1) << 7) | (opc & 0x7f);
+}
+
+constexpr uint32_t rv_enc_utype(uint32_t opc, uint32_t rd, uint32_t imm20) {
+    return ((imm20 & 0xfffff) << 12) | ((rd & 0x1f) << 7) | (opc & 0x7f);
+}
+
+constexpr uint32_t rv_enc_jtype(uint32_t opc, uint32_t rd, int32_t offset) {
+    uint32_t o = static_cast<uint32_t>(offset);
+    return (((o >> 20) & 0x1) << 31) | (((o >> 1) & 0x3ff) << 21) | (((o >> 11) & 0x1) << 20) | (((o >> 12) & 0xff) << 12) | ((rd & 0x1f) << 7) | (opc & 0x7f);
+}
+
+// csrr rd, csr  (csrrs rd, csr, x0)
+constexpr uint32_t rv_csrr(uint32_t rd, uint32_t csr)               { return rv_enc_itype(RV_OPC_SYSTEM, 0x2, rd, 0, static_cast<int32_t>(csr)); }
+// csrw csr, rs  (csrrw x0, csr, rs)
+constexpr uint32_t rv_csrw(uint32_t csr, uint32_t rs)               { return rv_enc_itype(RV_OPC_SYSTEM, 0x1, 0, rs, static_cast<int32_t>(csr)); }
+// csrrw rd, csr, rs (swap when rd == rs)
+constexpr uint32_t rv_csrrw(uint32_t rd, uint32_t csr, uint32_t rs) { return rv_enc_itype(RV_OPC_SYSTEM, 0x1, rd, rs, static_cast<int32_t>(csr)); }
+constexpr uint32_t rv_lb(uint32_t rd, int32_t imm, uint32_t rs1)    { return rv_enc_itype(RV_OPC_LOAD, 0x0, rd, rs1, imm); }
+constexpr uint32_t rv_lw(uint32_t rd, int32_t imm, uint32_t rs1)    { return rv_enc_itype(RV_OPC_LOAD, 0x2, rd, rs1, imm); }
+constexpr uint32_t rv_lbu(uint32_t rd, int32_t imm, uint32_t rs1)   { return rv_enc_itype(RV_OPC_LOAD, 0x4, rd, rs1, imm); }
+constexpr uint32_t rv_sb(uint32_t rs2, int32_t imm, uint32_t rs1)   { return rv_enc_stype(RV_OPC_STORE, 0x0, rs1, rs2, imm); }
+constexpr uint32_t rv_sw(uint32_t rs2, int32_t imm, uint32_t rs1)   { return rv_enc_stype(RV_OPC_STORE, 0x2, rs1, rs2, imm); }
+constexpr uint32_t rv_addi(uint32_t rd, uint32_t rs1, int32_t imm)  { return rv_enc_itype(RV_OPC_OPIMM, 0x0, rd, rs1, imm); }
+constexpr uint32_t rv_slli(uint32_t rd, uint32_t rs1, uint32_t sh)  { return rv_enc_itype(RV_OPC_OPIMM, 0x1, rd, rs1, static_cast<int32_t>(sh & 0x1f)); }
+constexpr uint32_t rv_add(uint32_t rd, uint32_t rs1, uint32_t rs2)  { return rv_enc_rtype(RV_OPC_OP, 0x0, 0x00, rd, rs1, rs2); }
+constexpr uint32_t rv_xor(uint32_t rd, uint32_t rs1, uint32_t rs2)  { return rv_enc_rtype(RV_OPC_OP, 0x4, 0x00, rd, rs1, rs2); }
+// Branches, offset relative to the branch
+constexpr uint32_t rv_beq(uint32_t rs1, uint32_t rs2, int32_t offset)  { return rv_enc_btype(RV_OPC_BRANCH, 0x0, rs1, rs2, offset); }
+constexpr uint32_t rv_bne(uint32_t rs1, uint32_t rs2, int32_t offset)  { return rv_enc_btype(RV_OPC_BRANCH, 0x1, rs1, rs2, offset); }
+constexpr uint32_t rv_bge(uint32_t rs1, uint32_t rs2, int32_t offset)  { return rv_enc_btype(RV_OPC_BRANCH, 0x5, rs1, rs2, offset); }
+constexpr uint32_t rv_bgeu(uint32_t rs1, uint32_t rs2, int32_t offset) { return rv_enc_btype(RV_OPC_BRANCH, 0x7, rs1, rs2, offset); }
+constexpr uint32_t rv_auipc(uint32_t rd, uint32_t imm20)            { return rv_enc_utype(RV_OPC_AUIPC, rd, imm20); }
+constexpr uint32_t rv_jal(uint32_t rd, int32_t offset)              { return rv_enc_jtype(RV_OPC_JAL, rd, offset); }
+constexpr uint32_t rv_ebreak()                                      { return 0x00100073; }
+constexpr uint32_t rv_fence_i()                                     { return rv_enc_itype(RV_OPC_MISCMEM, 0x1, 0, 0, 0); }
+
+static_assert(rv_ebreak() == rv_enc_itype(RV_OPC_SYSTEM, 0x0, 0, 0, 1), "ebreak encoding mismatch");
+static_assert(rv_csrw(RV_CSR_VX_DSCRATCH, RV_GPR_T0) == 0x7b229073, "csrw encoding mismatch");
+static_assert(rv_csrr(RV_GPR_T0, RV_CSR_VX_DSCRATCH) == 0x7b2022f3, "csrr encoding mismatch");
+static_assert(rv_csrrw(RV_GPR_T0, RV_CSR_VX_DSCRATCH, RV_GPR_T0) == 0x7b2292f3, "csrrw encoding mismatch");
+static_assert(rv_lw(RV_GPR_T1, 0, RV_GPR_T0) == 0x0002a303, "lw encoding mismatch");
+static_assert(rv_sw(RV_GPR_T1, 0, RV_GPR_T0) == 0x0062a023, "sw encoding mismatch");
+static_assert(rv_addi(RV_GPR_T0, RV_GPR_T0, 4) == 0x00428293, "addi encoding mismatch");
+static_assert(rv_add(RV_GPR_T2, RV_GPR_T2, RV_GPR_T1) == 0x006383b3, "add encoding mismatch");
+static_assert(rv_lbu(RV_GPR_T4, 0, RV_GPR_T0) == 0x0002ce83, "lbu encoding mismatch");
+static_assert(rv_slli(RV_GPR_T4, RV_GPR_T4, 24) == 0x018e9e93, "slli encoding mismatch");
+static_assert(rv_xor(RV_GPR_T2, RV_GPR_T2, RV_GPR_T4) == 0x01d3c3b3, "xor encoding mismatch");
+static_assert(rv_beq(RV_GPR_T0, RV_GPR_T1, 24) == 0x00628c63, "beq encoding mismatch");
+static_assert(rv_bne(RV_GPR_T0, RV_GPR_T4, -16) == 0xffd298e3, "bne encoding mismatch");
+static_assert(rv_fence_i() == 0x0000100f, "fence.i encoding mismatch");
+
+// Encode a single assembly line using the built-in encoder.
+// Returns false if the line is not in the supported subset
+// (csrr, csrw, lb, lw, sb, sw, addi, auipc, jal, ebreak).
+bool rv_asm_builtin(const std::string &asm_line, uint32_t &instr);
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // Get human-readable ISA string from MISA CSR value
 std::string rv_isa_string(uint32_t misa, bool verbose=false);
@@ -139,5 +245,15 @@ std::string rv_isa_string(uint32_t misa, bool verbose=false);
 bool rv_toolchain_check(const std::string &toolchain_prefix=RISCV_TOOLCHAIN_PREFIX);
 
 // Assemble RISC-V assembly lines into machine code words
+// (built-in encoder first, external toolchain for everything else). Toolchain
+// results are cached per toolchain prefix, appended to its RVASM_CACHE_FILE
+// and preloaded by the next process.
 std::vector<uint32_t> rv_asm(const std::vector<std::string> &asm_lines, const std::string &toolchain_prefix=RISCV_TOOLCHAIN_PREFIX);
 
+// rv_asm() cache statistics (lines): cache hits on lines assembled by this process, built-in encodes,
+// toolchain assembled, toolchain runs, cache hits on lines preloaded from the on-disk cache
+struct RvAsmStats_t {
+    uint64_t hits, builtin, toolchain, toolchain_runs, preloaded;
+};
+RvAsmStats_t rv_asm_stats(bool reset=false);
+
@@ -0,0 +1,111 @@
+#include "stats.h"
+#include "util.h"
+
+void LatencyHist::record(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    int bucket = 0;
+    while (us && bucket < STATS_HIST_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t prev = max_ns_.load(std::memory_order_relaxed);
+    while (ns > prev && !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+}
+
+void LatencyHist::reset() {
+    for (auto &b : buckets_)
+        b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHist::quantile_ns(double q) const {
+    uint64_t total = count();
+    if (total == 0)
+        return 0;
+    uint64_t target = static_cast<uint64_t>(q * total + 0.5);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < STATS_HIST_BUCKETS - 1; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= target)
+            return (1ull << i) * 1000;     // bucket i holds [2^(i-1), 2^i) us
+    }
+    return max_ns();
+}
+
+
+// ----- StatsWriter ----------------------------------------------------------
+
+void StatsWriter::_key(const std::string &name) {
+    if (json_) {
+        out_ += first_item_ ? "" : ",";
+        out_ += "\"" + name + "\":";
+    } else {
+        out_ += strfmt("  %-22s ", name.c_str());
+    }
+    first_item_ = false;
+}
+
+void StatsWriter::begin_section(const std::string &name) {
+    if (json_) {
+        out_ += first_section_ ? "{" : ",";
+        out_ += "\"" + name + "\":{";
+    } else {
+        out_ += "[" + name + "]\n";
+    }
+    first_section_ = false;
+    first_item_ = true;
+}
+
+void StatsWriter::end_section() {
+    if (json_)
+        out_ += "}";
+}
+
+void StatsWriter::counter(const std::string &name, uint64_t value) {
+    _key(name);
+    out_ += json_ ? std::to_string(value) : std::to_string(value) + "\n";
+}
+
+void StatsWriter::hist(const std::string &name, const LatencyHist &hist) {
+    uint64_t n = hist.count();
+    double avg_us = n ? hist.sum_ns() / 1000.0 / n : 0.0;
+    double p50_us = hist.quantile_ns(0.5) / 1000.0;
+    double p99_us = hist.quantile_ns(0.99) / 1000.0;
+    double max_us = hist.max_ns() / 1000.0;
+    _key(name);
+    if (json_) {
+        out_ += strfmt("{\"count\":%llu,\"avg_us\":%.1f,\"p50_us\":%.0f,\"p99_us\":%.0f,\"max_us\":%.1f}",
+            (unsigned long long)n, avg_us, p50_us, p99_us, max_us);
+    } else {
+        out_ += strfmt("n=%-8llu avg=%.1fus p50<=%.0fus p99<=%.0fus max=%.1fus\n",
+            (unsigned long long)n, avg_us, p50_us, p99_us, max_us);
+    }
+}
+
+void StatsWriter::rate(const std::string &name, uint64_t bytes, uint64_t ns) {
+    double bps = ns ? bytes * 1e9 / ns : 0.0;
+    _key(name);
+    out_ += json_ ? strfmt("%.0f", bps) : strfmt("%.1f KiB/s\n", bps / 1024.0);
+}
+
+void StatsWriter::poll_history(const std::string &name, uint64_t count, double avg_reads, double avg_busy_us) {
+    _key(name);
+    if (json_) {
+        out_ += strfmt("{\"count\":%llu,\"avg_reads\":%.2f,\"avg_busy_us\":%.1f}", (unsigned long long)count, avg_reads, avg_busy_us);
+    } else {
+        out_ += strfmt("n=%-8llu reads=%.2f busy=%.1fus\n", (unsigned long long)count, avg_reads, avg_busy_us);
+    }
+}
+
+std::string StatsWriter::str() {
+    if (json_)
+        return out_ + (first_section_ ? "{}" : "}");
+    return out_;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef STATS_HIST_BUCKETS
+    // Latency buckets: [0, 1us), [1us, 2us), [2us, 4us) ... last bucket is open ended
+    #define STATS_HIST_BUCKETS 24
+#endif
+
+// Event counter, relaxed atomics: cheap enough to stay enabled
+class StatCounter {
+public:
+    void add(uint64_t n = 1) { val_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t get() const { return val_.load(std::memory_order_relaxed); }
+    void reset() { val_.store(0, std::memory_order_relaxed); }
+private:
+    std::atomic<uint64_t> val_{0};
+};
+
+// Latency histogram with power-of-two microsecond buckets
+class LatencyHist {
+public:
+    void record(uint64_t ns);
+    void reset();
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum_ns() const { return sum_ns_.load(std::memory_order_relaxed); }
+    uint64_t max_ns() const { return max_ns_.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the q-quantile (0 < q <= 1)
+    uint64_t quantile_ns(double q) const;
+
+private:
+    std::atomic<uint64_t> buckets_[STATS_HIST_BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+// Records the lifetime of the scope into a histogram
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHist &hist):
+        hist_(hist), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency() {
+        hist_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+    }
+private:
+    LatencyHist &hist_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Formats counters/histograms grouped in sections as text or JSON
+class StatsWriter {
+public:
+    explicit StatsWriter(bool json): json_(json) {}
+
+    void begin_section(const std::string &name);
+    void end_section();
+    void counter(const std::string &name, uint64_t value);
+    void hist(const std::string &name, const LatencyHist &hist);
+    void rate(const std::string &name, uint64_t bytes, uint64_t ns);    // bytes/sec over busy time
+    void poll_history(const std::string &name, uint64_t count, double avg_reads, double avg_busy_us);
+
+    std::string str();
+
+private:
+    bool json_;
+    bool first_section_ = true;
+    bool first_item_ = true;
+    std::string out_;
+
+    void _key(const std::string &name);
+};
@@ -0,0 +1,112 @@
+#include "trace.h"
+#include "logger.h"
+#include "riscv.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+void InstrTrace::reset(uint32_t wid, uint32_t tid, const std::vector<uint32_t> &regs) {
+    wid_ = wid;
+    tid_ = tid;
+    regs_ = regs;
+    data_.clear();
+}
+
+void InstrTrace::append(uint32_t pc, const uint32_t *values) {
+    data_.push_back(pc);
+    data_.insert(data_.end(), values, values + regs_.size());
+}
+
+static void put_u32(std::string &out, uint32_t v) {
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+static uint32_t get_u32(const char *p) {
+    const uint8_t *b = reinterpret_cast<const uint8_t*>(p);
+    return b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+int InstrTrace::save(const std::string &path) const {
+    std::string out(INSTR_TRACE_MAGIC, sizeof(INSTR_TRACE_MAGIC));
+    put_u32(out, INSTR_TRACE_VERSION);
+    put_u32(out, wid_);
+    put_u32(out, tid_);
+    put_u32(out, regs_.size());
+    put_u32(out, size());
+    out.reserve(out.size() + 4 * (regs_.size() + data_.size()));
+    for (uint32_t r : regs_)
+        put_u32(out, r);
+    for (uint32_t v : data_)
+        put_u32(out, v);
+
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs || !ofs.write(out.data(), out.size())) {
+        Logger::gerror("Failed to write trace file: " + path);
+        return RCODE_ERROR;
+    }
+    return RCODE_OK;
+}
+
+int InstrTrace::load(const std::string &path) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        Logger::gerror("Failed to open trace file: " + path);
+        return RCODE_ERROR;
+    }
+    std::string in((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    const size_t hdr_sz = sizeof(INSTR_TRACE_MAGIC) + 5 * 4;
+    if (in.size() < hdr_sz || std::memcmp(in.data(), INSTR_TRACE_MAGIC, sizeof(INSTR_TRACE_MAGIC)) != 0) {
+        Logger::gerror("Not a trace file: " + path);
+        return RCODE_INVALID_ARG;
+    }
+    const char *p = in.data() + sizeof(INSTR_TRACE_MAGIC);
+    uint32_t version = get_u32(p);
+    uint32_t nregs = get_u32(p + 12);
+    uint64_t nrecords = get_u32(p + 16);
+    if (version != INSTR_TRACE_VERSION || nregs > RV_GPR_COUNT
+        || in.size() != hdr_sz + 4 * (nregs + nrecords * (1 + nregs))) {
+        Logger::gerror(strfmt("Unsupported or truncated trace file: %s (version %u)", path.c_str(), version));
+        return RCODE_INVALID_ARG;
+    }
+    wid_ = get_u32(p + 4);
+    tid_ = get_u32(p + 8);
+    p = in.data() + hdr_sz;
+    regs_.resize(nregs);
+    for (uint32_t i = 0; i < nregs; ++i, p += 4)
+        regs_[i] = get_u32(p);
+    data_.resize(nrecords * stride());
+    for (size_t i = 0; i < data_.size(); ++i, p += 4)
+        data_[i] = get_u32(p);
+    return RCODE_OK;
+}
+
+std::string InstrTrace::format(size_t i) const {
+    std::string s = strfmt("%8zu  0x%08x", i, pc(i));
+    for (size_t r = 0; r < regs_.size(); ++r)
+        s += strfmt("  %s=0x%08x", rvgpr_num2name(regs_[r]).c_str(), values(i)[r]);
+    return s;
+}
+
+long InstrTrace::first_difference(const InstrTrace &a, const InstrTrace &b) {
+    // Registers recorded by both: (index in a, index in b)
+    std::vector<std::pair<size_t, size_t>> common;
+    for (size_t i = 0; i < a.regs_.size(); ++i) {
+        for (size_t j = 0; j < b.regs_.size(); ++j) {
+            if (a.regs_[i] == b.regs_[j])
+                common.push_back({i, j});
+        }
+    }
+    size_t n = std::min(a.size(), b.size());
+    for (size_t k = 0; k < n; ++k) {
+        if (a.pc(k) != b.pc(k))
+            return static_cast<long>(k);
+        for (const auto &c : common) {
+            if (a.values(k)[c.first] != b.values(k)[c.second])
+                return static_cast<long>(k);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#define INSTR_TRACE_MAGIC   "VXTRACE"   // 8 bytes with the terminator
+#define INSTR_TRACE_VERSION 1
+
+// Instruction trace of one warp/thread, as recorded by Backend::step_warp():
+// one fixed size record per step, the PC after the step followed by the values
+// of the traced GPRs. Saved as a little-endian binary file:
+//   "VXTRACE\0", u32 version, u32 wid, u32 tid, u32 nregs, u32 nrecords,
+//   u32 regs[nregs], then nrecords x {u32 pc, u32 values[nregs]}
+class InstrTrace {
+public:
+    // Start an empty trace, recording the given GPRs with every PC
+    void reset(uint32_t wid, uint32_t tid, const std::vector<uint32_t> &regs);
+    void reserve(size_t nrecords) { data_.reserve(nrecords * stride()); }
+    void append(uint32_t pc, const uint32_t *values);
+
+    uint32_t wid() const { return wid_; }
+    uint32_t tid() const { return tid_; }
+    const std::vector<uint32_t>& regs() const { return regs_; }
+    size_t size() const { return data_.size() / stride(); }
+    uint32_t pc(size_t i) const { return data_[i * stride()]; }
+    const uint32_t* values(size_t i) const { return &data_[i * stride() + 1]; }
+
+    int save(const std::string &path) const;
+    int load(const std::string &path);
+
+    // "<index>  <pc>  <reg>=<value>..." for record i
+    std::string format(size_t i) const;
+
+    // First record where the PCs, or a register both traces record, differ;
+    // -1 if the traces agree over their common length
+    static long first_difference(const InstrTrace &a, const InstrTrace &b);
+
+private:
+    uint32_t wid_ = 0;
+    uint32_t tid_ = 0;
+    std::vector<uint32_t> regs_;
+    std::vector<uint32_t> data_;
+
+    size_t stride() const { return 1 + regs_.size(); }
+};
@@ -1,14 +1,14 @@
 #include "transport.h"
 #include "logger.h"
 #include "tcputils.h"
+#include "shmutils.h"
 #include "util.h"
 
+#include <algorithm>
 #include <cstring>
 #include <chrono>
 #include <thread>
 
-#define MAX_BATCH_SZ 8
-
 //==============================================================================
 // Transport Base Class
 //==============================================================================
@@ -37,16 +37,123 @@ int Transport::handshake() {
         return rc;
     }
 
-    if (rbuf != "+P") {
+    // fmt: "+P" or "+P:<cap>,<cap>,..."
+    if (rbuf.compare(0, 2, "+P") != 0 || (rbuf.length() > 2 && rbuf[2] != ':')) {
         log_->error("Invalid handshake response: " + rbuf);
         return RCODE_ERROR;
     }
 
-    log_->info("Handshake successful");
+    binary_ = false;
+    halt_events_ = false;
+    halt_event_pending_ = false;
+    max_batch_ = TRANSPORT_MAX_BATCH_SZ;
+    caps_.clear();
+    if (rbuf.length() > 3)
+        caps_ = tokenize(rbuf.substr(3), ',');
+    bool has_bin = false;
+    for (const auto &cap : caps_) {
+        if (cap == TRANSPORT_BIN_CAP) {
+            has_bin = true;
+        } else if (cap.compare(0, 6, "batch=") == 0) {
+            size_t n = std::strtoul(cap.c_str() + 6, nullptr, 10);
+            if (n > 0) max_batch_ = n;
+        }
+    }
+
+    if (has_bin && allow_binary_) {
+        rc = _send_buf("b");
+        if (rc == RCODE_OK)
+            rc = _recv_buf(rbuf);
+        if (rc != RCODE_OK) {
+            log_->error("Failed to negotiate binary protocol");
+            return rc;
+        }
+        if (rbuf == "+B") {
+            binary_ = true;
+        } else {
+            log_->warn("Server refused binary protocol, using ASCII");
+        }
+    }
+
+    log_->info(std::string("Handshake successful (") + (binary_ ? "binary" : "ascii") + " protocol)");
     return RCODE_OK;
 }
 
+bool Transport::has_cap(const std::string &cap) const {
+    return std::find(caps_.begin(), caps_.end(), cap) != caps_.end();
+}
+
+int Transport::enable_halt_events() {
+    if (!has_cap(TRANSPORT_HALTEV_CAP)) {
+        log_->debug("Server does not support halt notifications");
+        return RCODE_ERROR;
+    }
+    std::string resp;
+    int rc = send_cmd("e", resp);
+    if (rc != RCODE_OK) {
+        log_->error("Failed to enable halt notifications");
+        return rc;
+    }
+    halt_events_ = true;
+    log_->debug("Halt notifications enabled");
+    return RCODE_OK;
+}
+
+int Transport::wait_halt_event(unsigned timeout_ms) {
+    _drain_stale();
+    if (!halt_event_pending_) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (!halt_event_pending_) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) break;
+            unsigned remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+            int rc = _wait_incoming(std::max(remaining, 1u));
+            if (rc != RCODE_OK && rc != RCODE_TIMEOUT) return rc;
+        }
+    }
+    if (!halt_event_pending_)
+        return RCODE_TIMEOUT;
+    halt_event_pending_ = false;
+    return RCODE_OK;
+}
+
+void Transport::_on_notification(const std::string &msg) {
+    stats_.notifications.add();
+    LOG_DEBUG_LAZY(log_, "Notification: " + msg);
+    if (msg == "!H") {
+        halt_event_pending_ = true;
+    } else {
+        log_->warn("Ignoring unknown notification: " + msg);
+    }
+}
+
+void TransportStats_t::reset() {
+    for (StatCounter *c : {&reads, &writes, &batches, &bytes_tx, &bytes_rx, &timeouts, &poll_retries, &nacks, &notifications})
+        c->reset();
+    for (LatencyHist *h : {&read_reg, &write_reg, &read_regs, &write_regs, &flush, &batch})
+        h->reset();
+}
+
+void TransportStats_t::dump(StatsWriter &w) const {
+    w.counter("reads", reads.get());
+    w.counter("writes", writes.get());
+    w.counter("batches", batches.get());
+    w.counter("bytes_tx", bytes_tx.get());
+    w.counter("bytes_rx", bytes_rx.get());
+    w.counter("timeouts", timeouts.get());
+    w.counter("poll_retries", poll_retries.get());
+    w.counter("nacks", nacks.get());
+    w.counter("notifications", notifications.get());
+    w.hist("read_reg", read_reg);
+    w.hist("write_reg", write_reg);
+    w.hist("read_regs", read_regs);
+    w.hist("write_regs", write_regs);
+    w.hist("flush", flush);
+    w.hist("batch", batch);
+}
+
 int Transport::send_cmd(const std::string &cmd, std::string &response) {
+    _drain_stale();
     int rc = _send_buf(cmd);
     if (rc != RCODE_OK) {
         log_->error("Failed to send command: " + cmd);
@@ -65,73 +172,46 @@ int Transport::send_cmd(const std::string &cmd, std::string &response) {
 }
 
 int Transport::read_reg(const uint32_t addr, uint32_t &data) {
-    int rc = RCODE_OK;
-   
-    // Send read command (fmt: "rXXXX")
-    std::string sbuf = strfmt("r%04x", addr);
-    rc = _send_buf(sbuf);
-    if (rc != RCODE_OK)  return rc;
-
-    // Receive response (fmt: "+XXXXXXXX" or "-")
-    std::string rbuf;
-    rc = _recv_buf(rbuf);
-    if (rc != RCODE_OK) { return rc; }
-
-    // Parse response
-    if(rbuf[0] == '+') {
-        if (rbuf.length() != 9) {
-            log_->error("Invalid register read response length");
-            return RCODE_ERROR;
-        }
-        data = std::strtoul(rbuf.c_str() + 1, nullptr, 16);
-    } 
-    else if(rbuf[0] == '-') {
-        log_->error("Register read failed (got NACK)");
-        return RCODE_ERROR;
-    } 
-    else {
-        log_->error("Failed to parse register read response");
-        return RCODE_ERROR;
-    }
-    return RCODE_OK;
+    ScopedLatency lat(stats_.read_reg);
+    queue_read_reg(addr, &data);
+    return flush();
 }
 
 int Transport::write_reg(const uint32_t addr, const uint32_t data) {
-    int rc = RCODE_OK;
-
-    // Send write command (fmt: "wXXXX:XXXXXXXX")
-    std::string sbuf = strfmt("w%04x:%08x", addr, data);
-    rc = _send_buf(sbuf);
-    if (rc != RCODE_OK) return rc;
-
-    // Receive response (fmt: "+" or "-")
-    std::string rbuf;
-    rc = _recv_buf(rbuf);
-    if (rc != RCODE_OK) return rc;
+    ScopedLatency lat(stats_.write_reg);
+    queue_write_reg(addr, data);
+    return flush();
+}
 
-    if(rbuf[0] == '+') {
-        return RCODE_OK;
-    }
-    else if(rbuf[0] == '-') {
-        log_->error("Register write failed (got NACK)");
-        return RCODE_ERROR;
-    }
-    else {
-        log_->error("Failed to parse register write response");
-        return RCODE_ERROR;
+int Transport::read_regs(const std::vector<uint32_t> &addrs, std::vector<uint32_t> &data) {
+    ScopedLatency lat(stats_.read_regs);
+    _drain_stale();
+    data.clear();
+    data.reserve(addrs.size());
+    for (size_t i = 0; i < addrs.size(); i += max_batch_) {
+        size_t n = std::min(max_batch_, addrs.size() - i);
+        int rc = _read_regs_chunk(&addrs[i], n, data);
+        if (rc != RCODE_OK) return rc;
     }
     return RCODE_OK;
 }
 
-int Transport::read_regs(const std::vector<uint32_t> &addrs, std::vector<uint32_t> &data) {
-    if(addrs.empty()) return RCODE_OK;
-
-    size_t n = addrs.size();
-    if(n > MAX_BATCH_SZ) {
-        log_->error("Too many addresses in batch read");
-        return RCODE_BUFFER_OVRFLW;
+int Transport::write_regs(const std::vector<uint32_t> &addrs, const std::vector<uint32_t> &data) {
+    ScopedLatency lat(stats_.write_regs);
+    _drain_stale();
+    if(addrs.size() != data.size()) {
+        log_->error("Address and data count mismatch for batch write");
+        return RCODE_INVALID_ARG;
+    }
+    for (size_t i = 0; i < addrs.size(); i += max_batch_) {
+        size_t n = std::min(max_batch_, addrs.size() - i);
+        int rc = _write_regs_chunk(&addrs[i], &data[i], n);
+        if (rc != RCODE_OK) return rc;
     }
+    return RCODE_OK;
+}
 
+int Transport::_read_regs_chunk(const uint32_t *addrs, size_t n, std::vector<uint32_t> &data) {
     // Build read command (fmt: "RXXXX,XXXX,XXXX")
     std::string sbuf = "R";
     for(size_t i = 0; i < n; ++i) {
@@ -141,6 +221,8 @@ int Transport::read_regs(const std::vector<uint32_t> &addrs, std::vector<uint32_
     }
     int rc = _send_buf(sbuf);
     if (rc != RCODE_OK) { return rc; }
+    stats_.batches.add();
+    stats_.reads.add(n);
 
     // Receive response (fmt: "+XXXXXXXX,XXXXXXXX" or "-")
     std::string rbuf;
@@ -148,17 +230,17 @@ int Transport::read_regs(const std::vector<uint32_t> &addrs, std::vector<uint32_
     if (rc != RCODE_OK) { return rc; }
 
     // Parse response
-    if(rbuf[0] == '+') {
+    if(!rbuf.empty() && rbuf[0] == '+') {
         std::vector<std::string> tokens = tokenize(rbuf.substr(1), ',');
         if(tokens.size() != n) {
             log_->error("Batch read response size mismatch");
             return RCODE_INVALID_ARG;
         }
-        data.clear();
         for(const auto& tok : tokens) {
             data.push_back(std::strtoul(tok.c_str(), nullptr, 16));
         }
-    } else if(rbuf[0] == '-') {
+    } else if(!rbuf.empty() && rbuf[0] == '-') {
+        stats_.nacks.add();
         log_->error("Batch register read failed (got NACK)");
         return RCODE_ERROR;
     } else {
@@ -168,20 +250,8 @@ int Transport::read_regs(const std::vector<uint32_t> &addrs, std::vector<uint32_
     return RCODE_OK;
 }
 
-int Transport::write_regs(const std::vector<uint32_t> &addrs, const std::vector<uint32_t> &data) {
-    if(addrs.empty()) return RCODE_OK;
-    if(addrs.size() != data.size()) {
-        log_->error("Address and data count mismatch for batch write");
-        return RCODE_INVALID_ARG;
-    }
-
-    size_t n = addrs.size();
-    if(n > MAX_BATCH_SZ) {
-        log_->error("Too many addresses in batch write");
-        return RCODE_BUFFER_OVRFLW;
-    }
-    
-    // Build command: "W<addr1>,<addr2>:<val1>,<val2>"
+int Transport::_write_regs_chunk(const uint32_t *addrs, const uint32_t *data, size_t n) {
+    // Build command: "W<addr1>,<addr2>;<val1>,<val2>"
     std::string sbuf = "W";   
     for(size_t i = 0; i < n; ++i) {
         sbuf += strfmt("%04x", addrs[i]);
@@ -200,6 +270,8 @@ int Transport::write_regs(const std::vector<uint32_t> &addrs, const std::vector<
         log_->error("Failed to send batch write command");
         return RCODE_ERROR;
     }
+    stats_.batches.add();
+    stats_.writes.add(n);
 
     // Receive response (fmt: "+" or "-")
     std::string rbuf;
@@ -209,10 +281,11 @@ int Transport::write_regs(const std::vector<uint32_t> &addrs, const std::vector<
         return RCODE_ERROR;
     }
 
-    if(rbuf[0] == '+') {
+    if(!rbuf.empty() && rbuf[0] == '+') {
         return RCODE_OK;
     }
-    else if(rbuf[0] == '-') {
+    else if(!rbuf.empty() && rbuf[0] == '-') {
+        stats_.nacks.add();
         log_->error("Batch register write failed (got NACK)");
         return RCODE_ERROR;
     }
@@ -222,62 +295,291 @@ int Transport::write_regs(const std::vector<uint32_t> &addrs, const std::vector<
     }
 }
 
+int Transport::batch(const std::vector<BatchOp_t> &ops, std::vector<uint32_t> &results,
+                     const PollPolicy_t &poll_policy, PollHistory *poll_history) {
+    ScopedLatency lat(stats_.batch);
+    // Size results up front, queued reads keep pointers into it
+    size_t nresults = 0;
+    for (const auto &op : ops)
+        if (op.kind != BatchOp_t::WRITE) nresults++;
+    results.assign(nresults, 0);
+
+    // Reads directly following a POLL are issued speculatively in the same flush,
+    // and re-issued only if the poll condition was not met on the first try.
+    // Anything else waits for the poll: a failed poll returns before the rest
+    // of the batch is queued, so later writes never reach an unfinished DM op.
+    const BatchOp_t *poll_op = nullptr;
+    uint32_t *poll_dst = nullptr;
+    size_t spec_begin = 0, spec_end = 0;    // op indices of speculative reads
+    size_t spec_ridx = 0;                   // result index of first speculative read
+
+    auto resolve_poll = [&]() -> int {
+        int rc = flush();
+        if (rc != RCODE_OK || !poll_op) return rc;
+        uint64_t key = PollHistory::key(poll_op->addr, poll_op->mask);
+        PollWaiter waiter(poll_policy, poll_history ? poll_history->initial_delay_us(key, poll_policy)
+                                                    : poll_policy.min_delay_us);
+        while ((*poll_dst & poll_op->mask) != poll_op->data) {
+            if (!waiter.next()) {
+                log_->error(strfmt("Batch poll of 0x%04x timed out (value: 0x%08x, mask: 0x%08x, expected: 0x%08x)",
+                            poll_op->addr, *poll_dst, poll_op->mask, poll_op->data));
+                return RCODE_TIMEOUT;
+            }
+            stats_.poll_retries.add();
+            rc = read_reg(poll_op->addr, *poll_dst);
+            if (rc != RCODE_OK) return rc;
+            if ((*poll_dst & poll_op->mask) == poll_op->data) {
+                // Speculative reads may have observed pre-completion state
+                for (size_t k = spec_begin; k < spec_end; ++k)
+                    queue_read_reg(ops[k].addr, &results[spec_ridx + (k - spec_begin)]);
+                rc = flush();
+                if (rc != RCODE_OK) return rc;
+            }
+        }
+        if (poll_history)
+            poll_history->record(key, waiter);
+        poll_op = nullptr;
+        return RCODE_OK;
+    };
+
+    size_t ridx = 0;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const BatchOp_t &op = ops[i];
+        if (poll_op && op.kind != BatchOp_t::READ) {
+            int rc = resolve_poll();
+            if (rc != RCODE_OK) return rc;
+        }
+        if (op.kind == BatchOp_t::WRITE) {
+            queue_write_reg(op.addr, op.data);
+            continue;
+        }
+        uint32_t *dst = &results[ridx++];
+        queue_read_reg(op.addr, dst);
+        if (op.kind == BatchOp_t::POLL) {
+            poll_op = &op;
+            poll_dst = dst;
+            spec_begin = spec_end = i + 1;
+            spec_ridx = ridx;
+        } else if (poll_op) {
+            spec_end = i + 1;
+        }
+    }
+    return resolve_poll();
+}
 
+void Transport::queue_read_reg(const uint32_t addr, uint32_t *data) {
+    queue_.push_back({false, addr, 0, data});
+}
 
-// =============================================================================
-// TCP Transport Implementation
-// =============================================================================
+void Transport::queue_write_reg(const uint32_t addr, const uint32_t data) {
+    queue_.push_back({true, addr, data, nullptr});
+}
 
-TCPTransport::TCPTransport():
-    Transport("TCP"),
-    client_(new TCPClient()),
-    recv_buf_()
-{}
+std::string Transport::_format_regop(const RegOp_t &op) const {
+    // fmt: "rXXXX" (read), "wXXXX:XXXXXXXX" (write)
+    return op.write ? strfmt("w%04x:%08x", op.addr, op.data) : strfmt("r%04x", op.addr);
+}
 
-TCPTransport::~TCPTransport() {
-    delete client_;     // Destructor handles disconnect if needed
+int Transport::_parse_regop_resp(const RegOp_t &op, const std::string &rbuf) {
+    // fmt: "+XXXXXXXX" (read), "+" (write) or "-" (NACK)
+    if(rbuf.empty()) {
+        log_->error("Empty register op response");
+        return RCODE_ERROR;
+    }
+    if(rbuf[0] == '-') {
+        log_->error(strfmt("Register %s 0x%04x failed (got NACK)", op.write ? "write" : "read", op.addr));
+        return RCODE_ERROR;
+    }
+    if(rbuf[0] != '+') {
+        log_->error(strfmt("Failed to parse register %s response", op.write ? "write" : "read"));
+        return RCODE_ERROR;
+    }
+    if(!op.write) {
+        if (rbuf.length() != 9) {
+            log_->error("Invalid register read response length");
+            return RCODE_ERROR;
+        }
+        uint32_t data = std::strtoul(rbuf.c_str() + 1, nullptr, 16);
+        if(op.result) *op.result = data;
+    }
+    return RCODE_OK;
 }
 
-int TCPTransport::connect(const std::map<std::string, std::string> &args) {
-    if (args.find("ip") == args.end() || args.find("port") == args.end()) {
-        log_->error("TCPTransport requires 'ip' and 'port' arguments");
-        return RCODE_INVALID_ARG;
+void Transport::_pack_regop(const RegOp_t &op, uint8_t *rec) const {
+    rec[0] = op.write ? TRANSPORT_BIN_OP_WRITE : TRANSPORT_BIN_OP_READ;
+    rec[1] = 0;
+    rec[2] = op.addr & 0xff;
+    rec[3] = (op.addr >> 8) & 0xff;
+    rec[4] = op.data & 0xff;
+    rec[5] = (op.data >> 8) & 0xff;
+    rec[6] = (op.data >> 16) & 0xff;
+    rec[7] = (op.data >> 24) & 0xff;
+}
+
+int Transport::_unpack_regop_resp(const RegOp_t &op, const uint8_t *rec) {
+    uint8_t expected = op.write ? TRANSPORT_BIN_OP_WRITE : TRANSPORT_BIN_OP_READ;
+    if (rec[0] != expected) {
+        log_->error(strfmt("Unexpected binary response opcode 0x%02x", rec[0]));
+        return RCODE_ERROR;
     }
-    try {
-        std::string ip = args.at("ip");
-        uint16_t port = static_cast<uint16_t>(std::stoi(args.at("port")));
-        client_->connect(ip, port);
-    } catch (const std::exception &e) {
-        log_->error("Connection failed: " + std::string(e.what()));
+    if (rec[1] != 0) {
+        log_->error(strfmt("Register %s 0x%04x failed (got NACK)", op.write ? "write" : "read", op.addr));
         return RCODE_ERROR;
     }
-    log_->info("Connected to " + client_->get_ip() + ":" + std::to_string(client_->get_port()));
+    if (!op.write && op.result) {
+        *op.result = static_cast<uint32_t>(rec[4]) | (static_cast<uint32_t>(rec[5]) << 8) |
+                     (static_cast<uint32_t>(rec[6]) << 16) | (static_cast<uint32_t>(rec[7]) << 24);
+    }
+    return RCODE_OK;
+}
+
+int Transport::_send_regops(const std::vector<RegOp_t> &ops, size_t begin, size_t end) {
+    if (!binary_) {
+        for (size_t i = begin; i < end; ++i) {
+            int rc = _send_buf(_format_regop(ops[i]));
+            if (rc != RCODE_OK) return rc;
+        }
+        return RCODE_OK;
+    }
+    // Binary: pack all records and send them at once
+    txbuf_.resize((end - begin) * TRANSPORT_BIN_REC_SZ);
+    for (size_t i = begin; i < end; ++i)
+        _pack_regop(ops[i], &txbuf_[(i - begin) * TRANSPORT_BIN_REC_SZ]);
+    return _send_raw(txbuf_.data(), txbuf_.size());
+}
+
+int Transport::_recv_regop_resp(const RegOp_t &op, int &status) {
+    if (!binary_) {
+        std::string rbuf;
+        int rc = _recv_buf(rbuf);
+        if (rc != RCODE_OK) return rc;
+        status = _parse_regop_resp(op, rbuf);
+        return RCODE_OK;
+    }
+    uint8_t rec[TRANSPORT_BIN_REC_SZ];
+    int rc = _recv_raw(rec, sizeof(rec));
+    if (rc != RCODE_OK) return rc;
+    status = _unpack_regop_resp(op, rec);
     return RCODE_OK;
 }
 
-int TCPTransport::disconnect() {
-    client_->disconnect();
-    log_->info("Disconnected from " + client_->get_ip() + ":" + std::to_string(client_->get_port()));
+int Transport::_drain_stale() {
+    // Discard responses of commands abandoned by a previous failed flush
+    while (stale_responses_ > 0) {
+        int rc;
+        if (binary_) {
+            uint8_t rec[TRANSPORT_BIN_REC_SZ];
+            rc = _recv_raw(rec, sizeof(rec));
+        } else {
+            std::string rbuf;
+            rc = _recv_buf(rbuf);
+        }
+        if (rc != RCODE_OK) {
+            log_->warn(strfmt("Dropping %zu stale responses", stale_responses_));
+            stale_responses_ = 0;
+            return rc;
+        }
+        stale_responses_--;
+    }
     return RCODE_OK;
 }
 
-bool TCPTransport::is_connected() const {
-    return client_->is_connected();
+int Transport::flush() {
+    if (queue_.empty()) return RCODE_OK;
+
+    ScopedLatency lat(stats_.flush);
+    std::vector<RegOp_t> ops;
+    ops.swap(queue_);
+    _drain_stale();
+    for (const auto &op : ops)
+        (op.write ? stats_.writes : stats_.reads).add();
+
+    int first_err = RCODE_OK;
+    size_t nsent = 0, nrecv = 0;
+    while (nrecv < ops.size()) {
+        // Keep up to window_ commands in flight
+        size_t nsend = std::min<size_t>(ops.size() - nsent, window_ - (nsent - nrecv));
+        if (nsend > 0) {
+            int rc = _send_regops(ops, nsent, nsent + nsend);
+            if (rc != RCODE_OK) {
+                // A partial send leaves the stream out of sync, recovery needs a reconnect
+                log_->error("Failed to send pipelined command");
+                stale_responses_ = nsent - nrecv;
+                return rc;
+            }
+            nsent += nsend;
+        }
+
+        int status = RCODE_OK;
+        int rc = _recv_regop_resp(ops[nrecv], status);
+        if (rc != RCODE_OK) {
+            // Responses still in flight will arrive later, discard them before the next op
+            stale_responses_ = nsent - nrecv - 1;
+            return rc;
+        }
+        if (status != RCODE_OK) {
+            stats_.nacks.add();
+            if (first_err == RCODE_OK)
+                first_err = status;
+        }
+        nrecv++;
+    }
+    return first_err;
 }
 
-int TCPTransport::_send_buf(const std::string &data) {
-    if (!client_->is_connected()) return RCODE_ERROR;
+
+// =============================================================================
+// Stream Transport Implementation
+// =============================================================================
+
+StreamTransport::StreamTransport(const std::string &name, ByteStream *stream):
+    Transport(name),
+    stream_(stream)
+{}
+
+StreamTransport::~StreamTransport() {
+    delete stream_;     // Destructor handles disconnect if needed
+}
+
+int StreamTransport::disconnect() {
+    stream_->disconnect();
+    log_->info("Disconnected from " + peer_);
+    return RCODE_OK;
+}
+
+bool StreamTransport::is_connected() const {
+    return stream_->is_connected();
+}
+
+int StreamTransport::_send_buf(const std::string &data) {
+    if (!stream_->is_connected()) return RCODE_ERROR;
     if (data.empty()) return RCODE_OK;
 
     // Ensure newline termination
-    std::string msg = data; // Make a copy to modify
-    if (msg.back() != '\n') {
-        msg.push_back('\n');
+    send_buf_.assign(data);
+    if (send_buf_.back() != '\n') {
+        send_buf_.push_back('\n');
+    }
+
+    try {
+        stream_->send_data(send_buf_.data(), send_buf_.size());
+        stats_.bytes_tx.add(send_buf_.size());
+        LOG_DEBUG_LAZY(log_, "TX: " + data);
+    } catch (const std::exception& e) {
+        log_->error("Send failed: " + std::string(e.what()));
+        return RCODE_ERROR;
     }
+    return RCODE_OK;
+}
+
+int StreamTransport::_send_raw(const uint8_t *buf, size_t len) {
+    if (!stream_->is_connected()) return RCODE_ERROR;
+    if (len == 0) return RCODE_OK;
 
     try {
-        client_->send_data(msg.c_str(), msg.size());
-        log_->debug("TX: " + data);
+        stream_->send_data(reinterpret_cast<const char*>(buf), len);
+        stats_.bytes_tx.add(len);
+        LOG_DEBUG_LAZY(log_, strfmt("TX: <%zu bytes>", len));
     } catch (const std::exception& e) {
         log_->error("Send failed: " + std::string(e.what()));
         return RCODE_ERROR;
@@ -285,52 +587,185 @@ int TCPTransport::_send_buf(const std::string &data) {
     return RCODE_OK;
 }
 
+int StreamTransport::_fill_recv_buf(std::chrono::steady_clock::time_point start_time) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        start_time + std::chrono::milliseconds(timeout_ms_) - std::chrono::steady_clock::now()).count();
+    if (remaining <= 0) {
+        stats_.timeouts.add();
+        log_->error("Receive timeout - no response from server");
+        return RCODE_TIMEOUT;
+    }
+
+    // Block in poll() until data arrives or the deadline passes
+    try {
+        ssize_t received = stream_->recv_buffered(static_cast<int>(remaining));
+        if (received > 0) {
+            stats_.bytes_rx.add(received);
+            return RCODE_OK;
+        }
+    } catch (const std::exception& e) {
+        log_->error("Receive failed: " + std::string(e.what()));
+        return RCODE_ERROR;
+    }
 
-int TCPTransport::_recv_buf(std::string &out) {
-    if (!client_->is_connected()) return RCODE_ERROR;
+    if (!stream_->is_connected()) {
+        log_->error("Client disconnected while waiting for data");
+        return RCODE_TRANSPORT_ERR;
+    }
+    return RCODE_OK;    // timeout is reported by the next call
+}
+
+int StreamTransport::_recv_buf(std::string &out) {
+    if (!stream_->is_connected()) return RCODE_ERROR;
     out.clear();
 
-    // Add timeout logic using the configured timeout
+    RecvBuffer &rx = stream_->rxbuf();
     auto start_time = std::chrono::steady_clock::now();
-    const auto timeout_duration = std::chrono::milliseconds(timeout_ms_);
-
     while (true) {
         // See if we already have a full line
-        size_t pos = recv_buf_.find('\n');
-        if (pos != std::string::npos) {
-            out = recv_buf_.substr(0, pos);
-            recv_buf_.erase(0, pos + 1);
-            log_->debug("RX: " + out);
+        size_t nl = rx.find('\n');
+        if (nl != RecvBuffer::npos) {
+            out.assign(rx.data(), nl);
+            rx.consume(nl + 1);
+            if (!out.empty() && out[0] == '!') {
+                _on_notification(out);
+                continue;
+            }
+            LOG_DEBUG_LAZY(log_, "RX: " + out);
             return RCODE_OK;
         }
 
         // Otherwise, read more data
-        char tmp[256];
-        ssize_t n = 0;
-        try {
-            n = client_->recv_data(tmp, sizeof(tmp));
-        } catch (const std::exception& e) {
-            log_->error("Receive failed: " + std::string(e.what()));
-            return RCODE_ERROR;
-        }
+        int rc = _fill_recv_buf(start_time);
+        if (rc != RCODE_OK) return rc;
+    }
+}
 
-        if (n > 0) {
-            recv_buf_.append(tmp, n);
-        } else {
-            // No new data — check timeout
-            auto elapsed = std::chrono::steady_clock::now() - start_time;
-            if (elapsed > timeout_duration) {
-                log_->error("Receive timeout - no response from server");
-                return RCODE_TIMEOUT;
-            }
-            
-            if (!client_->is_connected()) {
+int StreamTransport::_recv_raw(uint8_t *buf, size_t len) {
+    if (!stream_->is_connected()) return RCODE_ERROR;
+
+    RecvBuffer &rx = stream_->rxbuf();
+    auto start_time = std::chrono::steady_clock::now();
+    while (!_consume_notifications() || rx.size() < len) {
+        int rc = _fill_recv_buf(start_time);
+        if (rc != RCODE_OK) return rc;
+    }
+    std::memcpy(buf, rx.data(), len);
+    rx.consume(len);
+    return RCODE_OK;
+}
+
+bool StreamTransport::_consume_notifications() {
+    RecvBuffer &rx = stream_->rxbuf();
+    while (!rx.empty() && rx[0] == '!') {
+        size_t nl = rx.find('\n');
+        if (nl == RecvBuffer::npos)
+            return false;
+        std::string line(rx.data(), nl);
+        rx.consume(nl + 1);
+        _on_notification(line);
+    }
+    return true;
+}
+
+int StreamTransport::_wait_incoming(unsigned timeout_ms) {
+    if (!stream_->is_connected()) return RCODE_TRANSPORT_ERR;
+    _consume_notifications();
+    if (halt_event_pending_) return RCODE_OK;
+
+    try {
+        ssize_t received = stream_->recv_buffered(static_cast<int>(timeout_ms));
+        if (received == 0) {
+            if (!stream_->is_connected()) {
                 log_->error("Client disconnected while waiting for data");
                 return RCODE_TRANSPORT_ERR;
             }
-            
-            // Small delay before retrying
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return RCODE_TIMEOUT;
         }
+        stats_.bytes_rx.add(received);
+    } catch (const std::exception& e) {
+        log_->error("Wait failed: " + std::string(e.what()));
+        return RCODE_TRANSPORT_ERR;
+    }
+    _consume_notifications();
+    return RCODE_OK;
+}
+
+
+// =============================================================================
+// TCP / Unix socket / Shared memory Transports
+// =============================================================================
+
+TCPTransport::TCPTransport():
+    StreamTransport("TCP", new TCPClient())
+{}
+
+TCPClient *TCPTransport::_client() const {
+    return static_cast<TCPClient*>(stream_);
+}
+
+int TCPTransport::connect(const std::map<std::string, std::string> &args) {
+    if (args.find("ip") == args.end() || args.find("port") == args.end()) {
+        log_->error("TCPTransport requires 'ip' and 'port' arguments");
+        return RCODE_INVALID_ARG;
+    }
+    try {
+        std::string ip = args.at("ip");
+        uint16_t port = static_cast<uint16_t>(std::stoi(args.at("port")));
+        _client()->connect(ip, port);
+    } catch (const std::exception &e) {
+        log_->error("Connection failed: " + std::string(e.what()));
+        return RCODE_ERROR;
+    }
+    peer_ = _client()->get_ip() + ":" + std::to_string(_client()->get_port());
+    log_->info("Connected to " + peer_);
+    return RCODE_OK;
+}
+
+UnixTransport::UnixTransport():
+    StreamTransport("Unix", new TCPClient())
+{}
+
+TCPClient *UnixTransport::_client() const {
+    return static_cast<TCPClient*>(stream_);
+}
+
+int UnixTransport::connect(const std::map<std::string, std::string> &args) {
+    if (args.find("path") == args.end()) {
+        log_->error("UnixTransport requires a 'path' argument");
+        return RCODE_INVALID_ARG;
+    }
+    try {
+        _client()->connect_unix(args.at("path"));
+    } catch (const std::exception &e) {
+        log_->error("Connection failed: " + std::string(e.what()));
+        return RCODE_ERROR;
     }
-}
\ No newline at end of file
+    peer_ = "unix:" + _client()->get_ip();
+    log_->info("Connected to " + peer_);
+    return RCODE_OK;
+}
+
+ShmTransport::ShmTransport():
+    StreamTransport("Shm", new ShmChannel())
+{}
+
+ShmChannel *ShmTransport::_channel() const {
+    return static_cast<ShmChannel*>(stream_);
+}
+
+int ShmTransport::connect(const std::map<std::string, std::string> &args) {
+    if (args.find("name") == args.end()) {
+        log_->error("ShmTransport requires a 'name' argument");
+        return RCODE_INVALID_ARG;
+    }
+    try {
+        _channel()->open(args.at("name"));
+    } catch (const std::exception &e) {
+        log_->error("Connection failed: " + std::string(e.what()));
+        return RCODE_ERROR;
+    }
+    peer_ = "shm:" + _channel()->get_name();
+    log_->info("Connected to " + peer_);
+    return RCODE_OK;
+}
@@ -3,15 +3,82 @@
 #include <vector>
 #include <map>
 #include <cstdint>
+#include <chrono>
+#include "stats.h"
+#include "dmpoll.h"
 
 #ifndef TRANSPORT_TIMEOUT_MS
     // Default timeout in milliseconds
     #define TRANSPORT_TIMEOUT_MS 1000
 #endif
 
+#ifndef TRANSPORT_MAX_BATCH_SZ
+    // Default max registers per R/W batch command (server may advertise 'batch=N')
+    #define TRANSPORT_MAX_BATCH_SZ 8
+#endif
+
+#ifndef TRANSPORT_WINDOW_SZ
+    // Default number of pipelined commands in flight
+    #define TRANSPORT_WINDOW_SZ 16
+#endif
+
 // Forward declarations
 class Logger;
 
+// Binary wire protocol (negotiated during handshake)
+//  Each register op is a fixed 8-byte little-endian record, both directions:
+//  [0] opcode, [1] status (0: ok, 1: nack; 0 in requests), [2:3] addr, [4:7] data
+//  Opcodes have the MSB set so the server can tell records apart from ASCII commands.
+#define TRANSPORT_BIN_CAP       "bin"
+#define TRANSPORT_BIN_OP_READ   0xA1
+#define TRANSPORT_BIN_OP_WRITE  0xA2
+#define TRANSPORT_BIN_REC_SZ    8
+
+// DM implements the MADDR/MDATA block memory access registers
+#define TRANSPORT_MEMBLK_CAP    "memblk"
+
+// Server can push halt notifications ("!H" lines, sent only between responses)
+#define TRANSPORT_HALTEV_CAP    "haltev"
+
+// DM holds later register ops while an injection is in progress, so pipelined
+// injections may be queued back to back without polling injectstate in between.
+// Injections only pipeline with it: without it each one is polled to completion
+// before the next DINJECT is written, a round trip per injected instruction.
+#define TRANSPORT_INJSEQ_CAP    "injseq"
+
+
+// A single op of a mixed Transport::batch()
+struct BatchOp_t {
+    enum Kind_t : uint8_t { READ, WRITE, POLL };
+    Kind_t kind;
+    uint32_t addr;
+    uint32_t data;      // WRITE: value to write, POLL: expected (masked) value
+    uint32_t mask;      // POLL: mask applied to the read value
+
+    static BatchOp_t rd(uint32_t addr) { return {READ, addr, 0, 0}; }
+    static BatchOp_t wr(uint32_t addr, uint32_t value) { return {WRITE, addr, value, 0}; }
+    static BatchOp_t poll(uint32_t addr, uint32_t mask, uint32_t expected) { return {POLL, addr, expected, mask}; }
+};
+
+
+// Per-op counters and latencies (see 'stats' command)
+struct TransportStats_t {
+    StatCounter reads, writes;          // Register ops (single, pipelined and batched)
+    StatCounter batches;                // R/W batch commands
+    StatCounter bytes_tx, bytes_rx;
+    StatCounter timeouts;               // Receive timeouts
+    StatCounter poll_retries;           // Extra reads of batch() POLL ops
+    StatCounter nacks;
+    StatCounter notifications;
+    LatencyHist read_reg, write_reg;    // Blocking single register ops
+    LatencyHist read_regs, write_regs;  // R/W batch calls
+    LatencyHist flush;                  // Pipelined flush (any size)
+    LatencyHist batch;                  // Mixed batch() calls
+
+    void reset();
+    void dump(StatsWriter &w) const;
+};
+
 
 // Abstract base class for transport mechanisms (e.g., TCP, Serial, etc.)
 class Transport {
@@ -33,6 +100,26 @@ public:
     // Set communication timeout (in milliseconds)
     void set_timeout(unsigned timeout_ms) { timeout_ms_ = timeout_ms; }
 
+    // Set max number of pipelined commands in flight (min 1)
+    void set_window(unsigned window) { window_ = window ? window : 1; }
+    unsigned get_window() const { return window_; }
+
+    // Allow negotiating the binary wire protocol on next handshake (default: true)
+    void set_allow_binary(bool allow) { allow_binary_ = allow; }
+    bool is_binary() const { return binary_; }
+
+    // Check if the server advertised capability 'cap' in the handshake
+    bool has_cap(const std::string &cap) const;
+
+    // ----- Asynchronous halt notifications -----
+    // Ask the server to push a notification when any warp halts
+    int enable_halt_events();
+    bool halt_events_enabled() const { return halt_events_; }
+
+    // Wait up to timeout_ms for a halt notification.
+    // Returns RCODE_OK if one arrived (since the last call), RCODE_TIMEOUT otherwise.
+    int wait_halt_event(unsigned timeout_ms);
+
     
     // ----- Low-level buffer send/receive -----
     // Sends data as a string with automatic newline termination.
@@ -41,11 +128,19 @@ public:
     // Receives a line-terminated string into 'data' (newline removed).
     virtual int _recv_buf(std::string &data) = 0;
 
+    // Sends/receives exactly 'len' raw bytes (binary protocol)
+    virtual int _send_raw(const uint8_t *buf, size_t len) = 0;
+    virtual int _recv_raw(uint8_t *buf, size_t len) = 0;
+
+    // Block until incoming data is available or timeout expires, consuming any
+    // notifications received meanwhile. Returns RCODE_TIMEOUT if nothing arrived.
+    virtual int _wait_incoming(unsigned timeout_ms) = 0;
+
     // ----- Communication API: Blocking Register Read/Write -----
     // Send a arbitrary command string
     int send_cmd(const std::string &cmd, std::string &response);
 
-    // Handshake
+    // Handshake, negotiates the binary protocol if the server advertises it
     int handshake();
 
     // Read a single register
@@ -54,38 +149,153 @@ public:
     // Write a single register
     int write_reg(const uint32_t addr, const uint32_t data);
 
-    // Read multiple registers in a batch
+    // Read multiple registers in a batch (split into server sized chunks)
     int read_regs(const std::vector<uint32_t> &addrs, std::vector<uint32_t> &data);
 
-    // Write multiple registers in a batch
+    // Write multiple registers in a batch (split into server sized chunks)
     int write_regs(const std::vector<uint32_t> &addrs, const std::vector<uint32_t> &data);
 
+    // Execute an ordered list of mixed read/write/poll ops.
+    // Ops are pipelined, a POLL waits (re-reading as scheduled by 'poll_policy', starting from
+    // the completion times learned in 'poll_history' if given) until (value & mask) == expected
+    // before any later op is issued; only READs right after it go out speculatively. If the
+    // POLL fails (timeout or error) the batch stops there, no later WRITE is ever sent.
+    // 'results' receives one value per READ/POLL op (final polled value), in op order.
+    int batch(const std::vector<BatchOp_t> &ops, std::vector<uint32_t> &results,
+              const PollPolicy_t &poll_policy, PollHistory *poll_history = nullptr);
+
+    // Max registers per R/W batch command
+    size_t get_max_batch() const { return max_batch_; }
+
+    // ----- Communication API: Pipelined Register Read/Write -----
+    // Queue a register read, value is stored to *data when the op completes in flush()
+    void queue_read_reg(const uint32_t addr, uint32_t *data);
+
+    // Queue a register write
+    void queue_write_reg(const uint32_t addr, const uint32_t data);
+
+    // Issue all queued ops keeping up to 'window' commands in flight.
+    // Responses are matched in order. Returns first error, all ops are drained regardless.
+    int flush();
+
+    // Number of queued (not yet issued) ops
+    size_t queued() const { return queue_.size(); }
+
+    TransportStats_t& stats() { return stats_; }
 
 private:
+    struct RegOp_t {
+        bool write;
+        uint32_t addr;
+        uint32_t data;
+        uint32_t *result;       // read destination (may be null)
+    };
+
     std::string name_;                                  // Transport name (for logging)
+    std::vector<RegOp_t> queue_;                        // Pending pipelined ops
+    size_t stale_responses_ = 0;                        // In-flight responses abandoned after an error
+    bool allow_binary_ = true;                          // Negotiate binary protocol in handshake
+    bool binary_ = false;                               // Binary protocol active
+    size_t max_batch_ = TRANSPORT_MAX_BATCH_SZ;         // Max registers per R/W command
+    std::vector<std::string> caps_;                     // Capabilities advertised in handshake
+    bool halt_events_ = false;                          // Server pushes halt notifications
+    std::vector<uint8_t> txbuf_;                        // Reusable buffer for binary records
+
+    std::string _format_regop(const RegOp_t &op) const;
+    int _parse_regop_resp(const RegOp_t &op, const std::string &rbuf);
+    void _pack_regop(const RegOp_t &op, uint8_t *rec) const;
+    int _unpack_regop_resp(const RegOp_t &op, const uint8_t *rec);
+    int _send_regops(const std::vector<RegOp_t> &ops, size_t begin, size_t end);
+    int _recv_regop_resp(const RegOp_t &op, int &status);
+    int _drain_stale();
+    int _read_regs_chunk(const uint32_t *addrs, size_t n, std::vector<uint32_t> &data);
+    int _write_regs_chunk(const uint32_t *addrs, const uint32_t *data, size_t n);
 
 protected:
+    bool halt_event_pending_ = false;                   // Halt notification received, not yet consumed
+    TransportStats_t stats_;
+
+    // Handle an unsolicited notification line (starting with '!')
+    void _on_notification(const std::string &msg);
+
     Logger *log_;
     unsigned timeout_ms_ = TRANSPORT_TIMEOUT_MS;        // Communication timeout in milliseconds
+    unsigned window_ = TRANSPORT_WINDOW_SZ;             // Max pipelined commands in flight
 };
 
 
 
 // -----------------------------------------------------------------------------
-// TCP Transport implementation
-class TCPTransport : public Transport {
+// Byte stream transport: line/binary framing over a connected ByteStream
+// (TCP or Unix socket, shared memory ring), subclasses only connect it
+class StreamTransport : public Transport {
 public:
-    TCPTransport();
-    ~TCPTransport();
+    ~StreamTransport();
 
-    int connect(const std::map<std::string, std::string> &args) override;
     int disconnect() override;
     bool is_connected() const override;
 
     int _send_buf(const std::string &data) override;
     int _recv_buf(std::string &data) override;
+    int _send_raw(const uint8_t *buf, size_t len) override;
+    int _recv_raw(uint8_t *buf, size_t len) override;
+    int _wait_incoming(unsigned timeout_ms) override;
+
+protected:
+    // Takes ownership of the stream
+    StreamTransport(const std::string &name, class ByteStream *stream);
+
+    class ByteStream *stream_;
+    std::string peer_;              // Peer description for log messages
+
+private:
+    std::string send_buf_;          // Reusable buffer for outgoing lines
+
+    // Wait for more data in the stream's receive buffer, fails once timeout
+    // expires since 'start'
+    int _fill_recv_buf(std::chrono::steady_clock::time_point start);
+
+    // Consume complete notification lines at the head of the receive buffer.
+    // Returns false if a partial notification is pending.
+    bool _consume_notifications();
+};
+
+// -----------------------------------------------------------------------------
+// TCP Transport implementation
+class TCPTransport : public StreamTransport {
+public:
+    TCPTransport();
+
+    // Args: 'ip', 'port'
+    int connect(const std::map<std::string, std::string> &args) override;
 
 private:
-    class TCPClient *client_;
-    std::string recv_buf_; // Buffer for incoming data
-};
\ No newline at end of file
+    class TCPClient *_client() const;
+};
+
+// -----------------------------------------------------------------------------
+// Unix domain socket transport, for servers on the same host
+class UnixTransport : public StreamTransport {
+public:
+    UnixTransport();
+
+    // Args: 'path'
+    int connect(const std::map<std::string, std::string> &args) override;
+
+private:
+    class TCPClient *_client() const;
+};
+
+// -----------------------------------------------------------------------------
+// Shared memory transport: SPSC byte rings in a POSIX shared memory segment
+// created by the server (see lib/shmutils.h), for co-located simulators
+class ShmTransport : public StreamTransport {
+public:
+    ShmTransport();
+
+    // Args: 'name'
+    int connect(const std::map<std::string, std::string> &args) override;
+
+private:
+    class ShmChannel *_channel() const;
+};
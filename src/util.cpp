@@ -5,6 +5,11 @@
 #include <cstdarg>
 #include <cstdint>
 #include <stdexcept>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <filesystem>
+#include <unistd.h>
 
 
 std::string rcode_str(int code) {
@@ -81,6 +86,40 @@ std::string hex2str(uint32_t value, size_t num_prefix, char prefix_char, bool up
 }
 
 
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+// Hex digit value for each char, -1 if not a hex digit
+static const struct HexLut_t {
+    int8_t val[256];
+    constexpr HexLut_t(): val() {
+        for (int i = 0; i < 256; i++) val[i] = -1;
+        for (int i = 0; i < 10; i++) val['0' + i] = i;
+        for (int i = 0; i < 6; i++) { val['a' + i] = 10 + i; val['A' + i] = 10 + i; }
+    }
+} HEX_LUT;
+
+void hex_encode(const uint8_t *data, size_t len, std::string &out) {
+    size_t pos = out.size();
+    out.resize(pos + 2 * len);
+    char *dst = &out[pos];
+    for (size_t i = 0; i < len; i++) {
+        dst[2 * i]     = HEX_DIGITS[data[i] >> 4];
+        dst[2 * i + 1] = HEX_DIGITS[data[i] & 0xF];
+    }
+}
+
+bool hex_decode(const char *hex, size_t nchars, uint8_t *out) {
+    for (size_t i = 0; i + 1 < nchars; i += 2) {
+        int hi = HEX_LUT.val[static_cast<uint8_t>(hex[i])];
+        int lo = HEX_LUT.val[static_cast<uint8_t>(hex[i + 1])];
+        if (hi < 0 || lo < 0)
+            return false;
+        out[i / 2] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+
 // Parses a string of the form "IP:port" into its components.
 // Either/Both IP and port can be omitted to use defaults.
 void parse_tcp_hostportstr(const std::string &str, std::string &ip, uint16_t &port) {
@@ -210,3 +249,48 @@ std::string hexdump(const std::vector<uint8_t>& data, size_t base_addr, size_t b
     }
     return out;
 }
+
+static std::mutex __cache_dir_mtx;
+static bool __cache_dir_set = false;
+static std::string __cache_dir;
+
+std::string get_cache_dir() {
+    std::lock_guard<std::mutex> lk(__cache_dir_mtx);
+    if (!__cache_dir_set) {
+        const char *env;
+        if ((env = std::getenv("VXDEBUG_CACHE_DIR")))
+            __cache_dir = env;
+        else if ((env = std::getenv("XDG_CACHE_HOME")) && *env)
+            __cache_dir = std::string(env) + "/vxdebug";
+        else if ((env = std::getenv("HOME")) && *env)
+            __cache_dir = std::string(env) + "/.cache/vxdebug";
+        __cache_dir_set = true;
+    }
+    return __cache_dir;
+}
+
+void set_cache_dir(const std::string &dir) {
+    std::lock_guard<std::mutex> lk(__cache_dir_mtx);
+    __cache_dir = dir;
+    __cache_dir_set = true;
+}
+
+bool write_file_atomic(const std::string &path, const std::string &content) {
+    std::error_code ec;
+    std::filesystem::path p(path);
+    if (p.has_parent_path())
+        std::filesystem::create_directories(p.parent_path(), ec);
+
+    std::string tmp = path + strfmt(".%d.tmp", static_cast<int>(getpid()));
+    {
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        if (!ofs || !ofs.write(content.data(), content.size()))
+            return false;
+    }
+    std::filesystem::rename(tmp, p, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
@@ -84,6 +84,12 @@ std::string vecjoin(const std::vector<T> &vec, const std::string &sep = ",") {
 
 uint32_t parse_uint(std::string str);
 
+// Table-driven hex encode/decode (lowercase, no separators)
+// - hex_encode appends 2*len chars to 'out'
+// - hex_decode converts nchars/2 bytes, returns false on a non-hex digit
+void hex_encode(const uint8_t *data, size_t len, std::string &out);
+bool hex_decode(const char *hex, size_t nchars, uint8_t *out);
+
 // Pretty hexdump for vector<uint8_t>
 std::string hexdump(const std::vector<uint8_t>& data, size_t base_addr = 0, size_t bytes_per_word = 4, 
                 size_t words_per_col = 4, bool enable_ascii = true);
@@ -94,4 +100,14 @@ inline uint32_t swap_endianess32(uint32_t val) {
            ((val >> 8)  & 0x0000FF00) |
            ((val << 8)  & 0x00FF0000) |
            ((val << 24) & 0xFF000000);
-}
\ No newline at end of file
+}
+// Directory for caches persisted across debugger runs (platform info, assembler).
+// Defaults to $VXDEBUG_CACHE_DIR, $XDG_CACHE_HOME/vxdebug or ~/.cache/vxdebug;
+// empty disables persistence.
+std::string get_cache_dir();
+void set_cache_dir(const std::string &dir);
+
+// Replace 'path' with 'content' through a temporary file and rename(), so that
+// concurrent readers see the old or the new file, never a partial one.
+// Creates missing parent directories. Returns false on error.
+bool write_file_atomic(const std::string &path, const std::string &content);
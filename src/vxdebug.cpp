@@ -3,13 +3,20 @@
 #include <argparse.h>
 #include "util.h"
 #include "dmdefs.h"
+#include "riscv.h"
 #include "backend.h"
 #include "gdbstub.h"
+#include "elfimage.h"
+#include "profiler.h"
+#include "trace.h"
 
 #include <sstream>
 #include <algorithm>
 #include <unistd.h>
 #include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 #ifdef USE_READLINE
 #include <readline/readline.h>
@@ -40,45 +47,67 @@ VortexDebugger::VortexDebugger():
     log_(new Logger("", 3)),
     backend_(new Backend())
 {
+    targets_.push_back({VXDBG_DEFAULT_TARGET, backend_, new VortexDebugger(backend_, VXDBG_DEFAULT_TARGET)});
+    register_commands();
+}
+
+VortexDebugger::VortexDebugger(Backend *backend, const std::string &target_name):
+    log_(new Logger(target_name, 3)),
+    backend_(backend),
+    is_view_(true)
+{
+    register_commands();
+}
+
+VortexDebugger::~VortexDebugger() {
+    stop_bg_gdbservers();
+    delete profiler_;
+    for (auto &target : targets_) {
+        delete target.view;
+        delete target.backend;
+    }
+    delete log_;
+}
+
+void VortexDebugger::register_commands() {
     // Register commands using the helper function
     register_command("help",      {"h"},         "Show this help message", &VortexDebugger::cmd_help);
-    register_command("exit",      {"quit", "q"}, "Exit the debugger", &VortexDebugger::cmd_exit);
+    register_command("exit",      {"quit", "q"}, "Exit the debugger", &VortexDebugger::cmd_exit, false);
     register_command("init",      {},            "Initialize the target program", &VortexDebugger::cmd_init);
     register_command("transport", {"t"},         "Set backend transport", &VortexDebugger::cmd_transport);
-    register_command("source",    {"src"},       "Execute commands from a script file", &VortexDebugger::cmd_source);
+    register_command("source",    {"src"},       "Execute commands from a script file", &VortexDebugger::cmd_source, false);
     register_command("reset",     {"R"},         "Reset the target system", &VortexDebugger::cmd_reset);
     register_command("info",      {"i"},         "Display information about the target", &VortexDebugger::cmd_info);
     register_command("halt",      {"h"},         "Halt warps", &VortexDebugger::cmd_halt);
     register_command("continue",  {"c"},         "Continue/resume warps", &VortexDebugger::cmd_continue);
     register_command("select",    {"sel"},       "Select current warp and thread", &VortexDebugger::cmd_select);
     register_command("stepi",     {"s"},         "Single step instruction", &VortexDebugger::cmd_stepi);
+    register_command("trace",     {"tr"},        "Record, show or compare instruction traces", &VortexDebugger::cmd_trace);
     register_command("inject",    {"inj"},       "Inject instruction", &VortexDebugger::cmd_inject);
     register_command("reg",       {"r"},         "Register operations", &VortexDebugger::cmd_reg);
     register_command("mem",       {"m"},         "Memory operations", &VortexDebugger::cmd_mem);
+    register_command("load",      {"ld"},        "Load an ELF program image", &VortexDebugger::cmd_load);
     register_command("dmreg",     {"d"},         "Debug module register operations", &VortexDebugger::cmd_dmreg);
     register_command("break",     {"b"},         "Breakpoint operations", &VortexDebugger::cmd_break);
-    register_command("gdbserver", {"gdb"},       "Start GDB server", &VortexDebugger::cmd_gdbserver);
+    register_command("gdbserver", {"gdb"},       "Start GDB server", &VortexDebugger::cmd_gdbserver, false);
     register_command("param",     {},            "Get/Set debugger parameters", &VortexDebugger::cmd_param);
-
-}
-
-VortexDebugger::~VortexDebugger() {
-    if (backend_) {
-        delete backend_;
-    }
+    register_command("stats",     {},            "Show/reset transport and backend statistics", &VortexDebugger::cmd_stats);
+    register_command("profile",   {"prof"},      "Sample warp PCs and report a statistical profile", &VortexDebugger::cmd_profile, false);
+    register_command("target",    {"tgt"},       "Manage and broadcast to debug targets", &VortexDebugger::cmd_target, false);
 }
 
 void VortexDebugger::register_command(const std::string& primary_name, 
                                      const std::vector<std::string>& aliases,
                                      const std::string& description,
-                                     CommandHandler_t handler) {
+                                     CommandHandler_t handler,
+                                     bool locks_backend) {
     // Check if primary command already exists
     if (command_.find(primary_name) != command_.end()) {
         throw std::runtime_error("Command already registered: " + primary_name);
     }
 
     // Register the primary command
-    command_[primary_name] = {description, handler};
+    command_[primary_name] = {description, handler, locks_backend};
     
     // Map primary command to itself in alias map
     alias_map_[primary_name] = primary_name;
@@ -103,6 +132,11 @@ int VortexDebugger::execute_command(const std::string &cmd, const std::vector<st
         throw std::runtime_error("INTERNAL ERROR: Primary command not found: " + primary_cmd);
     }
     
+    // Backend may be shared with background GDB clients
+    std::unique_lock<std::recursive_mutex> lk;
+    if (cmd_it->second.locks_backend)
+        lk = backend_->lock_cmd();
+
     auto handler = cmd_it->second.handler;
     return (this->*handler)(args);
 }
@@ -233,6 +267,7 @@ int VortexDebugger::__execute_line(const std::string &input) {
 ////////////////////////////////////////////////////////////////////////////////
 // Utility Functions
 std::string VortexDebugger::get_prompt() const {
+    auto lk = backend_->lock_cmd();
     std::string prompt = ANSI_GRN;
     
     // Connection indicator
@@ -243,6 +278,9 @@ std::string VortexDebugger::get_prompt() const {
     }
     
     prompt += "vxdbg";
+    if (targets_.size() > 1) {
+        prompt += ":" + targets_[curr_target_].name;
+    }
     
     if(backend_->transport_connected() ) {
         // Add warp/thread selection info if available
@@ -316,13 +354,14 @@ int VortexDebugger::cmd_exit(const std::vector<std::string>& args) {
 int VortexDebugger::cmd_init(const std::vector<std::string>& args) {
     ArgParse::ArgumentParser parser("init", "Initialize the target program");
     // parser.add_argument({"-r", "--reset"}, "Reset target before running", ArgParse::BOOL, "false");
+    parser.add_argument({"--attach"}, "Attach to the running target: reuse the cached platform record, leave warps alone", ArgParse::BOOL, "false");
     int rc = parser.parse_args(args);
     if (rc != 0) {return rc;}
 
     // bool reset = parser.get<bool>("reset");
 
     log_->info("Initializing target platform...");
-    rc = backend_->initialize();
+    rc = backend_->initialize(false, parser.get<bool>("attach"));
     if (rc != RCODE_OK) {
         log_->error("Failed to start target execution");
         return rc;
@@ -341,9 +380,26 @@ int VortexDebugger::cmd_source(const std::vector<std::string>& args) {
     return execute_script(script_file);
 }
 
+int VortexDebugger::attach(const std::string &spec) {
+    std::string option = "--tcp", addr = spec;
+    for (const char *type : {"tcp", "unix", "shm"}) {
+        std::string prefix = std::string(type) + ":";
+        if (spec.rfind(prefix, 0) == 0) {
+            option = std::string("--") + type;
+            addr = spec.substr(prefix.size());
+            break;
+        }
+    }
+    int rc = execute_command("transport", {"transport", option, addr});
+    if (rc != RCODE_OK) return rc;
+    return execute_command("init", {"init", "--attach"});
+}
+
 int VortexDebugger::cmd_transport(const std::vector<std::string>& args) {
     ArgParse::ArgumentParser parser("transport", "Set backend transport");
     parser.add_argument({"--tcp"}, "Connect via TCP (host:port)", ArgParse::STR, "");
+    parser.add_argument({"--unix"}, "Connect via a Unix domain socket (path)", ArgParse::STR, "");
+    parser.add_argument({"--shm"}, "Connect via shared memory rings of a co-located server (/name)", ArgParse::STR, "");
     int rc = parser.parse_args(args);
     if (rc != 0) {return rc;}
 
@@ -372,6 +428,20 @@ int VortexDebugger::cmd_transport(const std::vector<std::string>& args) {
         if (rc != RCODE_OK) return rc;
         rc = backend_->transport_connect({{"ip", ip}, {"port", std::to_string(port)}});
         if (rc != RCODE_OK) return rc;
+    } else if (parser.get<std::string>("unix") != "") {
+        log_->info("Setting transport to Unix socket");
+        int rc;
+        rc = backend_->transport_setup("unix");
+        if (rc != RCODE_OK) return rc;
+        rc = backend_->transport_connect({{"path", parser.get<std::string>("unix")}});
+        if (rc != RCODE_OK) return rc;
+    } else if (parser.get<std::string>("shm") != "") {
+        log_->info("Setting transport to shared memory");
+        int rc;
+        rc = backend_->transport_setup("shm");
+        if (rc != RCODE_OK) return rc;
+        rc = backend_->transport_connect({{"name", parser.get<std::string>("shm")}});
+        if (rc != RCODE_OK) return rc;
     } else {
         log_->error("No transport type specified, see 'help transport' for usage.");
         return 1;
@@ -574,10 +644,13 @@ int VortexDebugger::cmd_continue(const std::vector<std::string>& args) {
 
     if (continue_all) {                 // Continue all warps
         log_->info("Continuing all warps...");
-        backend_->resume_warps();
-
         bool any_breakpoints;
         CHECK_ERRS(backend_->any_breakpoints(any_breakpoints));
+        // Emulated breakpoints are reached by stepping, the warps must stay halted
+        bool emulated = backend_->get_param("emulated_breakpoints") == "1";
+        if (!(emulated && any_breakpoints))
+            backend_->resume_warps();
+
         if (any_breakpoints) {
             log_->info("Breakpoints set, Continuing until breakpoint...");
             backend_->until_breakpoint(true);
@@ -665,19 +738,92 @@ int VortexDebugger::cmd_stepi(const std::vector<std::string>& args) {
     if (rc != 0) return rc;
 
     int count = parser.get<int>("count");
-    
-    for (int i = 0; i < count; i++) {
-        log_->info("Executing single step " + std::to_string(i + 1) + "/" + std::to_string(count));
-        
+    uint32_t nsteps = 0;
+    if (count <= 1)
         rc = backend_->step_warp();
-        if (rc != 0) {
-            log_->error("Single step failed");
-            return 1;
-        }
+    else
+        rc = backend_->step_warp(static_cast<uint32_t>(count), nsteps);
+    if (rc != 0) {
+        log_->error("Single step failed");
+        return 1;
+    }
+    if (count > 1) {
+        uint32_t pc = 0;
+        CHECK_ERRS(backend_->get_warp_pc(pc));
+        log_->info(strfmt("Stepped %u/%d instructions, PC=0x%08X", nsteps, count, pc));
     }
     return 0;
 }
 
+int VortexDebugger::cmd_trace(const std::vector<std::string>& args) {
+    ArgParse::ArgumentParser parser("trace", "Record, show or compare instruction traces");
+    parser.add_argument({"operation"}, "Operation: run <count>, show <file>, diff <file> <file2>", ArgParse::STR, "", true, "", {"run", "show", "diff"});
+    parser.add_argument({"arg"}, "Step count (run) or trace file (show, diff)", ArgParse::STR, "");
+    parser.add_argument({"arg2"}, "Second trace file (diff)", ArgParse::STR, "");
+    parser.add_argument({"-r", "--regs"}, "Comma-separated GPRs to record with every PC (run)", ArgParse::STR, "");
+    parser.add_argument({"-o", "--output"}, "Trace file to write (run)", ArgParse::STR, "");
+    parser.add_argument({"-n", "--count"}, "Records to print, 0 for all (run, show)", ArgParse::INT, "16");
+    int rc = parser.parse_args(args);
+    if (rc != 0) return rc;
+
+    std::string operation = parser.get<std::string>("operation");
+    std::string arg = parser.get<std::string>("arg");
+    int nprint = parser.get<int>("count");
+    auto print_records = [this, nprint](const InstrTrace &trace) {
+        size_t n = nprint > 0 ? std::min<size_t>(nprint, trace.size()) : trace.size();
+        std::string out;
+        for (size_t i = trace.size() - n; i < trace.size(); ++i)
+            out += "\n" + trace.format(i);
+        log_->info(strfmt("Trace of warp %u thread %u: %zu records%s", trace.wid(), trace.tid(), trace.size(),
+                          n < trace.size() ? strfmt(", last %zu:", n).c_str() : ":") + out);
+    };
+
+    InstrTrace trace;
+    if (operation == "run") {
+        int count = arg.empty() ? 0 : static_cast<int>(parse_uint(arg));
+        if (count <= 0) {
+            log_->error("Step count required, see 'help trace'");
+            return RCODE_INVALID_ARG;
+        }
+        std::vector<uint32_t> regs;
+        for (const auto &name : tokenize(parser.get<std::string>("regs"), ',')) {
+            if (rvreg_gettype(name) != RVRegType_t::GPR) {
+                log_->error("Only GPRs can be traced: " + name);
+                return RCODE_INVALID_ARG;
+            }
+            regs.push_back(rvgpr_name2num(name));
+        }
+        int wid = 0, tid = 0;
+        CHECK_ERRS(backend_->get_selected_warp_thread(wid, tid));
+        trace.reset(wid, tid, regs);
+        uint32_t nsteps = 0;
+        CHECK_ERRS(backend_->step_warp(static_cast<uint32_t>(count), nsteps, &trace));
+        print_records(trace);
+        std::string output = parser.get<std::string>("output");
+        if (!output.empty()) {
+            CHECK_ERRS(trace.save(output));
+            log_->info(strfmt("Wrote %zu records to %s", trace.size(), output.c_str()));
+        }
+    }
+    else if (operation == "show") {
+        CHECK_ERRS(trace.load(arg));
+        print_records(trace);
+    }
+    else if (operation == "diff") {
+        InstrTrace other;
+        CHECK_ERRS(trace.load(arg));
+        CHECK_ERRS(other.load(parser.get<std::string>("arg2")));
+        long k = InstrTrace::first_difference(trace, other);
+        if (k < 0) {
+            log_->info(strfmt("Traces agree over %zu records (%zu vs %zu)", std::min(trace.size(), other.size()),
+                              trace.size(), other.size()));
+        } else {
+            log_->info(strfmt("Traces diverge at record %ld:\n  %s\n  %s", k, trace.format(k).c_str(), other.format(k).c_str()));
+        }
+    }
+    return RCODE_OK;
+}
+
 int VortexDebugger::cmd_inject(const std::vector<std::string>& args) {
     ArgParse::ArgumentParser parser("inject", "Inject instruction into selected warp/thread");
     parser.add_argument({"instruction"}, "32-bit instruction value (hex or decimal)", ArgParse::STR, "", true);
@@ -708,6 +854,11 @@ int VortexDebugger::cmd_inject(const std::vector<std::string>& args) {
 
     // Get instruction to inject
     std::string instr = parser.get<std::string>("instruction");
+    // Arbitrary instruction may store to memory or clobber registers
+    CHECK_ERRS(backend_->restore_scratch());
+    backend_->memcache_invalidate();
+    backend_->regcache_invalidate(selected_wid);
+    backend_->warpstate_invalidate();
     try {
         uint32_t instr_word = parse_uint(instr);
         CHECK_ERRS(backend_->inject_instruction(instr_word));
@@ -726,12 +877,37 @@ int VortexDebugger::cmd_reg(const std::vector<std::string>& args) {
     parser.add_argument({"operation"}, "Operation: read(r), write(w)", ArgParse::STR, "", true, "", {"r", "w", "read", "write"});
     parser.add_argument({"name"}, "Register name", ArgParse::STR, "");
     parser.add_argument({"value"}, "Value to write (for write operations)", ArgParse::STR, "");
+    parser.add_argument({"-a", "--all-threads"}, "Read a GPR in every thread (lane) of the selected warp", ArgParse::BOOL, "false");
     int rc = parser.parse_args(args);
     if (rc != 0) return rc;
 
     std::string operation = parser.get<std::string>("operation");
     std::string name = parser.get<std::string>("name");
 
+    if (parser.get<bool>("all_threads")) {
+        if ((operation != "r" && operation != "read") || rvreg_gettype(name) != RVRegType_t::GPR) {
+            log_->error("--all-threads only reads GPRs");
+            return 1;
+        }
+        uint32_t tmask = 0;
+        std::vector<uint32_t> values;
+        CHECK_ERRS(backend_->read_csr(RV_CSR_VX_ACTIVE_THREADS, tmask));
+        CHECK_ERRS(backend_->read_gpr_lanes(rvgpr_name2num(name), values));
+        int wid = -1, tid = -1;
+        backend_->get_selected_warp_thread(wid, tid);
+        std::string out = strfmt("Register %s of warp %d (active threads 0x%08X):", name.c_str(), wid, tmask);
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i % 4 == 0)
+                out += "\n";
+            if (i >= 32 || (tmask >> i) & 1)     // The mask CSR covers 32 lanes
+                out += strfmt("  %2zu: 0x%08X", i, values[i]);
+            else
+                out += strfmt("  %2zu: %-10s", i, "-");
+        }
+        log_->info(out);
+        return 0;
+    }
+
     if (operation == "r" || operation == "read") {
         uint32_t reg_value;
         CHECK_ERRS(backend_->read_reg(name, reg_value));
@@ -752,10 +928,10 @@ int VortexDebugger::cmd_reg(const std::vector<std::string>& args) {
 
 int VortexDebugger::cmd_mem(const std::vector<std::string>& args) {
     ArgParse::ArgumentParser parser("mem", "Memory operations");
-    parser.add_argument({"operation"}, "Operation: read(r) or write(w)", ArgParse::STR, "", true, "", {"r", "w", "read", "write", "loadbin"});
+    parser.add_argument({"operation"}, "Operation: read(r), write(w), crc or find", ArgParse::STR, "", true, "", {"r", "w", "read", "write", "loadbin", "crc", "find"});
     parser.add_argument({"address"}, "Memory address", ArgParse::STR, "");
-    parser.add_argument({"length"}, "Length in bytes (for read)", ArgParse::INT, "4");
-    parser.add_argument({"value"}, "Comma-separated list of values to write (for write operations)", ArgParse::STR, "");
+    parser.add_argument({"length"}, "Length in bytes (for read, crc and find)", ArgParse::INT, "4");
+    parser.add_argument({"value"}, "Comma-separated list of byte values (to write, or to find)", ArgParse::STR, "");
     parser.add_argument({"-a", "--ascii"}, "Display memory as ASCII (for read operations)", ArgParse::BOOL, "false");
     parser.add_argument({"-b", "--bytes"}, "Display memory as bytes (for read operations)", ArgParse::BOOL, "false");
     int rc = parser.parse_args(args);
@@ -783,6 +959,25 @@ int VortexDebugger::cmd_mem(const std::vector<std::string>& args) {
         CHECK_ERRS(backend_->write_mem(address, mem_data));
         log_->info(strfmt("Wrote %zu bytes to address 0x%08X", mem_data.size(), address));
     }
+    else if (operation == "crc") {
+        uint32_t crc = 0;
+        CHECK_ERRS(backend_->crc32_mem(address, length, crc));
+        log_->info(strfmt("CRC32 of %d bytes at address 0x%08X: 0x%08X", length, address, crc));
+    }
+    else if (operation == "find") {
+        std::vector<std::string> tokens = tokenize(parser.get<std::string>("value"), ',');
+        std::vector<uint8_t> pattern;
+        for (const auto &token : tokens) {
+            pattern.push_back(static_cast<uint8_t>(parse_uint(token)));
+        }
+        bool found = false;
+        uint32_t found_addr = 0;
+        CHECK_ERRS(backend_->search_mem(address, length, pattern, found, found_addr));
+        if (found)
+            log_->info(strfmt("Pattern found at address 0x%08X", found_addr));
+        else
+            log_->info(strfmt("Pattern not found in %d bytes at address 0x%08X", length, address));
+    }
     else if (operation == "loadbin") {
         uint32_t address = parse_uint(parser.get<std::string>("address"));
         std::string filepath = parser.get<std::string>("value");
@@ -803,6 +998,36 @@ int VortexDebugger::cmd_mem(const std::vector<std::string>& args) {
     return 0;
 }
 
+int VortexDebugger::cmd_load(const std::vector<std::string>& args) {
+    ArgParse::ArgumentParser parser("load", "Load the PT_LOAD segments of an ELF program image");
+    parser.add_argument({"file"}, "ELF file", ArgParse::STR, "", true);
+    parser.add_argument({"-d", "--delta"}, "Skip chunks whose target checksum matches (needs param scratch_mem)", ArgParse::BOOL, "false");
+    parser.add_argument({"-p", "--pc"}, "Set the selected warp PC to the entry point", ArgParse::BOOL, "false");
+    int rc = parser.parse_args(args);
+    if (rc != 0) return rc;
+
+    std::string filepath = parser.get<std::string>("file");
+    ElfImage elf;
+    CHECK_ERRS(elf.open(filepath));
+
+    bool delta = parser.get<bool>("delta");
+    LoadStats_t total;
+    for (const auto &seg : elf.segments()) {
+        LoadStats_t st;
+        CHECK_ERRS(backend_->load_mem(seg.addr, ElfImage::contents(seg), delta, &st));
+        log_->info(strfmt("Segment 0x%08X (%u bytes): %u chunks skipped, %u written", seg.addr, seg.memsz,
+                          st.chunks_skipped, st.chunks_written));
+        total.chunks_skipped += st.chunks_skipped;
+        total.chunks_written += st.chunks_written;
+        total.bytes_written += st.bytes_written;
+    }
+    if (parser.get<bool>("pc"))
+        CHECK_ERRS(backend_->set_warp_pc(elf.entry()));
+    log_->info(strfmt("Loaded '%s': %zu segments, %llu bytes written, %u chunks unchanged (entry 0x%08X)", filepath.c_str(),
+                      elf.segments().size(), static_cast<unsigned long long>(total.bytes_written), total.chunks_skipped, elf.entry()));
+    return 0;
+}
+
 int VortexDebugger::cmd_dmreg(const std::vector<std::string>& args) {
     ArgParse::ArgumentParser parser("dmreg", "Debug module register operations");
     parser.add_argument({"operation"}, "Operation: read or write", ArgParse::STR, "", true, "", {"r", "read", "w", "write"});
@@ -826,6 +1051,7 @@ int VortexDebugger::cmd_dmreg(const std::vector<std::string>& args) {
         uint32_t reg_value = parse_uint(value);
         auto dmreg_id = get_dmreg_id(name);
         CHECK_ERRS(backend_->dmreg_wr(dmreg_id, reg_value));
+        backend_->warpstate_invalidate();   // raw writes may halt/resume warps
         log_->info(strfmt("Wr DM[%s]: 0x%08X", name.c_str(), reg_value));
     } 
     else {
@@ -863,9 +1089,13 @@ int VortexDebugger::cmd_break(const std::vector<std::string>& args) {
     } 
     else if (operation == "ls") {
         std::unordered_map<uint32_t, BreakPointInfo_t> baddrs = backend_->get_breakpoints();
+        bool emulated = backend_->get_param("emulated_breakpoints") == "1";
         log_->info("Current breakpoints:");
         for (const auto& [addr, info] : baddrs) {
-            log_->info(strfmt(" - 0x%08X : instr=0x%08X", addr, info.replaced_instr));
+            if (info.inserted)
+                log_->info(strfmt(" - 0x%08X : instr=0x%08X hits=%u", addr, info.replaced_instr, info.hit_count));
+            else
+                log_->info(strfmt(" - 0x%08X : %s hits=%u", addr, emulated ? "emulated" : "pending", info.hit_count));
         }
     } 
     else {
@@ -878,10 +1108,28 @@ int VortexDebugger::cmd_break(const std::vector<std::string>& args) {
 int VortexDebugger::cmd_gdbserver(const std::vector<std::string>& args) {
     ArgParse::ArgumentParser parser("gdbserver", "Start GDB server for remote debugging");
     parser.add_argument({"--port"}, "Port to listen on", ArgParse::INT, "3333");
+    parser.add_argument({"--all"}, "Serve every target, target i on port+i", ArgParse::BOOL, "false");
+    parser.add_argument({"--bg"}, "Serve in the background, keep the console usable", ArgParse::BOOL, "false");
+    parser.add_argument({"--stop"}, "Stop background GDB servers", ArgParse::BOOL, "false");
     int rc = parser.parse_args(args);
     if (rc != 0) return rc;
 
     int port = parser.get<int>("port");
+    bool background = parser.get<bool>("bg");
+    if (parser.get<bool>("stop")) {
+        stop_bg_gdbservers();
+        return RCODE_OK;
+    }
+    if (parser.get<bool>("all") && !targets_.empty()) {
+        return serve_gdb_all(port, background);
+    }
+    if (background) {
+        if (is_view_) {
+            log_->error("Background GDB servers can only be started from the console");
+            return RCODE_ERROR;
+        }
+        return start_bg_gdbserver(curr_target_, backend_, port);
+    }
     
     // Start GDB server
     GDBStub gdbstub(this, backend_);
@@ -927,3 +1175,305 @@ int VortexDebugger::cmd_param(const std::vector<std::string>& args) {
     }
     return 0;
 }
+
+int VortexDebugger::cmd_stats(const std::vector<std::string>& args) {
+    ArgParse::ArgumentParser parser("stats", "Show/reset transport and backend statistics");
+    parser.add_argument({"operation"}, "Operation", ArgParse::STR, "dump", false, "", {"dump", "reset"});
+    parser.add_argument({"--json"}, "Print as JSON", ArgParse::BOOL, "false");
+    int rc = parser.parse_args(args);
+    if (rc != 0) return rc;
+
+    if (parser.get<std::string>("operation") == "reset") {
+        backend_->reset_stats();
+        log_->info("Statistics reset");
+        return RCODE_OK;
+    }
+    std::string out = backend_->get_stats(parser.get<bool>("json"));
+    // JSON goes to stdout unprefixed so it can be piped into other tools
+    if (parser.get<bool>("json"))
+        std::cout << out << std::endl;
+    else
+        log_->info("Statistics:\n" + out);
+    return RCODE_OK;
+}
+
+int VortexDebugger::cmd_target(const std::vector<std::string>& args) {
+    if (is_view_) {
+        log_->error("Target commands are not available inside a broadcast");
+        return RCODE_ERROR;
+    }
+
+    // target all <command> [args...]: the remainder is a command line, not parsed here
+    if (args.size() >= 2 && args[1] == "all") {
+        if (args.size() < 3) {
+            log_->error("No command given to broadcast");
+            return RCODE_INVALID_ARG;
+        }
+        return broadcast_command(std::vector<std::string>(args.begin() + 2, args.end()));
+    }
+
+    ArgParse::ArgumentParser parser("target", "Manage debug targets (target all <cmd> runs cmd on every target)");
+    parser.add_argument({"operation"}, "Operation", ArgParse::STR, "list", false, "", {"list", "add", "select", "remove"});
+    parser.add_argument({"name"}, "Target name", ArgParse::STR, "");
+    parser.add_argument({"--tcp"}, "Connect the new target via TCP (host:port)", ArgParse::STR, "");
+    parser.add_argument({"--unix"}, "Connect the new target via a Unix domain socket (path)", ArgParse::STR, "");
+    parser.add_argument({"--shm"}, "Connect the new target via shared memory (/name)", ArgParse::STR, "");
+    int rc = parser.parse_args(args);
+    if (rc != 0) return rc;
+
+    std::string operation = parser.get<std::string>("operation");
+    std::string name = parser.get<std::string>("name");
+
+    if (operation == "list") {
+        std::string out = "Targets:\n";
+        for (size_t i = 0; i < targets_.size(); ++i) {
+            out += strfmt("  %c %-16s %s\n", i == curr_target_ ? '*' : ' ', targets_[i].name.c_str(),
+                targets_[i].backend->transport_connected() ? "connected" : "disconnected");
+        }
+        log_->info(out);
+        return RCODE_OK;
+    }
+
+    if (name.empty()) {
+        log_->error("Target name required, see 'help target' for usage.");
+        return RCODE_INVALID_ARG;
+    }
+    int idx = find_target(name);
+
+    if (operation == "add") {
+        if (idx >= 0) {
+            log_->error("Target already exists: " + name);
+            return RCODE_INVALID_ARG;
+        }
+        Backend *backend = new Backend(name);
+        targets_.push_back({name, backend, new VortexDebugger(backend, name)});
+        curr_target_ = targets_.size() - 1;
+        backend_ = backend;
+        log_->info("Added and selected target: " + name);
+
+        for (const char *type : {"tcp", "unix", "shm"}) {
+            std::string addr = parser.get<std::string>(type);
+            if (!addr.empty())
+                return targets_.back().view->execute_command("transport", {"transport", std::string("--") + type, addr});
+        }
+        return RCODE_OK;
+    }
+
+    if (idx < 0) {
+        log_->error("Unknown target: " + name);
+        return RCODE_INVALID_ARG;
+    }
+
+    if (operation == "select") {
+        curr_target_ = static_cast<size_t>(idx);
+        backend_ = targets_[curr_target_].backend;
+        log_->info("Selected target: " + name);
+    }
+    else if (operation == "remove") {
+        if (targets_.size() == 1) {
+            log_->error("Cannot remove the last target");
+            return RCODE_ERROR;
+        }
+        for (const auto &bg : bg_servers_) {
+            if (bg.target_name == name) {
+                log_->error(strfmt("Target %s is served by GDB on port %d, stop it first", name.c_str(), bg.port));
+                return RCODE_ERROR;
+            }
+        }
+        if (profiler_ && profiler_->backend() == targets_[idx].backend) {
+            if (profiler_->running()) {
+                log_->error(strfmt("Target %s is being profiled, stop it first", name.c_str()));
+                return RCODE_ERROR;
+            }
+            delete profiler_;
+            profiler_ = nullptr;
+        }
+        delete targets_[idx].view;
+        delete targets_[idx].backend;
+        targets_.erase(targets_.begin() + idx);
+        if (curr_target_ >= targets_.size() || static_cast<size_t>(idx) == curr_target_)
+            curr_target_ = 0;
+        else if (static_cast<size_t>(idx) < curr_target_)
+            curr_target_--;
+        backend_ = targets_[curr_target_].backend;
+        log_->info("Removed target: " + name + ", selected: " + targets_[curr_target_].name);
+    }
+    return RCODE_OK;
+}
+
+int VortexDebugger::cmd_profile(const std::vector<std::string>& args) {
+    ArgParse::ArgumentParser parser("profile", "Sample warp PCs and report a statistical profile");
+    parser.add_argument({"operation"}, "Operation: start, stop, report, clear, or run (start, wait, stop, report)", ArgParse::STR, "report", false, "", {"start", "stop", "report", "clear", "run"});
+    parser.add_argument({"-r", "--rate"}, "Warp sweeps per second", ArgParse::INT, std::to_string(PROFILE_DEFAULT_HZ));
+    parser.add_argument({"--halt"}, "Sample by briefly halting running warps (no warp gather registers)", ArgParse::BOOL, "false");
+    parser.add_argument({"-t", "--time"}, "Seconds to sample (for run)", ArgParse::INT, "1");
+    parser.add_argument({"-e", "--elf"}, "ELF file to symbolize PCs with", ArgParse::STR, "");
+    parser.add_argument({"-n", "--top"}, "Entries in the flat profile", ArgParse::INT, "20");
+    parser.add_argument({"-w", "--per-warp"}, "Show per-warp totals", ArgParse::BOOL, "false");
+    parser.add_argument({"-o", "--folded"}, "Write folded stacks (flamegraph input) to this file", ArgParse::STR, "");
+    int rc = parser.parse_args(args);
+    if (rc != 0) return rc;
+
+    if (is_view_) {
+        log_->error("The profiler can only be driven from the console");
+        return RCODE_ERROR;
+    }
+    std::string operation = parser.get<std::string>("operation");
+    if (operation == "start" || operation == "run") {
+        int rate = parser.get<int>("rate");
+        if (rate <= 0) {
+            log_->error("Sample rate must be positive");
+            return RCODE_INVALID_ARG;
+        }
+        if (profiler_ && profiler_->running()) {
+            log_->error("Profiler is already running, stop it first");
+            return RCODE_ERROR;
+        }
+        // A new run starts from an empty profile of the selected target
+        delete profiler_;
+        profiler_ = new Profiler(backend_);
+        CHECK_ERRS(profiler_->start(static_cast<unsigned>(rate), parser.get<bool>("halt")));
+        if (operation == "start")
+            return RCODE_OK;
+        std::this_thread::sleep_for(std::chrono::seconds(std::max(parser.get<int>("time"), 0)));
+        profiler_->stop();
+    }
+    else if (operation == "stop") {
+        if (!profiler_ || !profiler_->running()) {
+            log_->error("Profiler is not running");
+            return RCODE_ERROR;
+        }
+        profiler_->stop();
+        ProfileSummary_t summary = profiler_->summary();
+        log_->info(strfmt("Profiler stopped: %llu samples from %llu sweeps", (unsigned long long)summary.samples,
+                          (unsigned long long)summary.sweeps));
+        return RCODE_OK;
+    }
+    else if (operation == "clear") {
+        if (profiler_)
+            profiler_->clear();
+        log_->info("Profile cleared");
+        return RCODE_OK;
+    }
+
+    if (!profiler_) {
+        log_->error("No profile collected, use 'profile start' or 'profile run' first");
+        return RCODE_ERROR;
+    }
+    ElfImage elf;
+    const ElfImage *symbols = nullptr;
+    std::string elfpath = parser.get<std::string>("elf");
+    if (!elfpath.empty()) {
+        CHECK_ERRS(elf.open(elfpath));
+        symbols = &elf;
+    }
+    int top = parser.get<int>("top");
+    log_->info("Profile:\n" + profiler_->report(symbols, top > 0 ? top : 0, parser.get<bool>("per_warp")));
+    std::string folded = parser.get<std::string>("folded");
+    if (!folded.empty())
+        CHECK_ERRS(profiler_->write_folded(folded, symbols));
+    return RCODE_OK;
+}
+
+int VortexDebugger::find_target(const std::string &name) const {
+    for (size_t i = 0; i < targets_.size(); ++i) {
+        if (targets_[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Run one command on every target in parallel. Targets own separate backends
+// and transports, so workers never share backend state. Output lines carry the
+// target name (view logger prefix); a summary is printed once all are done.
+int VortexDebugger::broadcast_command(const std::vector<std::string> &cmd_toks) {
+    size_t ntargets = targets_.size();
+    std::vector<int> results(ntargets, RCODE_ERROR);
+    std::vector<std::string> errors(ntargets);
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < ntargets; i = next++) {
+            try {
+                results[i] = targets_[i].view->execute_command(cmd_toks[0], cmd_toks);
+            } catch (const std::exception &e) {
+                errors[i] = e.what();
+            }
+        }
+    };
+
+    size_t nworkers = std::min<size_t>(ntargets, VXDBG_MAX_TARGET_WORKERS);
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < nworkers; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+
+    int rc = RCODE_OK;
+    std::string out = strfmt("Broadcast '%s' to %zu targets:\n", cmd_toks[0].c_str(), ntargets);
+    for (size_t i = 0; i < ntargets; ++i) {
+        std::string status = !errors[i].empty() ? "exception: " + errors[i] :
+            results[i] == RCODE_OK ? "OK" : rcode_str(results[i]);
+        out += strfmt("  %-16s %s\n", targets_[i].name.c_str(), status.c_str());
+        if (results[i] != RCODE_OK)
+            rc = results[i];
+    }
+    log_->info(out);
+    return rc;
+}
+
+// One GDB server per target, target i listens on base_port + i
+int VortexDebugger::serve_gdb_all(int base_port, bool background) {
+    if (background) {
+        for (size_t i = 0; i < targets_.size(); ++i) {
+            CHECK_ERRS(start_bg_gdbserver(i, targets_[i].backend, base_port + static_cast<int>(i)));
+        }
+        return RCODE_OK;
+    }
+
+    std::vector<int> results(targets_.size(), RCODE_OK);
+    std::vector<std::thread> servers;
+    for (size_t i = 0; i < targets_.size(); ++i) {
+        int port = base_port + static_cast<int>(i);
+        log_->info(strfmt("Target %s: GDB server on port %d", targets_[i].name.c_str(), port));
+        servers.emplace_back([this, i, port, &results]() {
+            GDBStub gdbstub(targets_[i].view, targets_[i].backend);
+            results[i] = gdbstub.serve_forever(port);
+        });
+    }
+    int rc = RCODE_OK;
+    for (size_t i = 0; i < servers.size(); ++i) {
+        servers[i].join();
+        if (results[i] != RCODE_OK) {
+            log_->error("GDB server failed for target " + targets_[i].name);
+            rc = results[i];
+        }
+    }
+    return rc;
+}
+
+int VortexDebugger::start_bg_gdbserver(size_t target_idx, Backend *backend, int port) {
+    for (const auto &bg : bg_servers_) {
+        if (bg.port == port) {
+            log_->error(strfmt("A GDB server is already running on port %d", port));
+            return RCODE_INVALID_ARG;
+        }
+    }
+    const Target_t &target = targets_[target_idx];
+    GDBStub *stub = new GDBStub(target.view, backend);
+    bg_servers_.push_back({target.name, port, stub, std::thread([stub, port]() {
+        stub->serve_forever(port);
+    })});
+    log_->info(strfmt("GDB server for target %s running in background on port %d", target.name.c_str(), port));
+    return RCODE_OK;
+}
+
+void VortexDebugger::stop_bg_gdbservers() {
+    for (auto &bg : bg_servers_) {
+        bg.stub->stop();
+        bg.thread.join();
+        delete bg.stub;
+        log_->info(strfmt("Stopped GDB server on port %d (target %s)", bg.port, bg.target_name.c_str()));
+    }
+    bg_servers_.clear();
+}
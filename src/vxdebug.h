@@ -2,15 +2,24 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <thread>
 
 // Forward declarations
 class Backend;
 class VortexDebugger;
 class Logger;
+class GDBStub;
+class Profiler;
 
 typedef int (VortexDebugger::*CommandHandler_t)(const std::vector<std::string>&);
 enum VxDbgState_t { STOPPED, RUNNING, EXIT };
 
+#ifndef VXDBG_MAX_TARGET_WORKERS
+    #define VXDBG_MAX_TARGET_WORKERS 16     // Max threads used to broadcast a command to targets
+#endif
+
+#define VXDBG_DEFAULT_TARGET "default"
+
 class VortexDebugger {
 public:
     VortexDebugger();
@@ -19,6 +28,10 @@ public:
     int execute_command(const std::string &cmd, const std::vector<std::string>& args);
     int execute_script(const std::string &script);
     int start_cli();
+
+    // Connect ("[tcp:]host:port", "unix:<path>" or "shm:/<name>") and
+    // initialize without resetting the target (init --attach)
+    int attach(const std::string &spec);
     int __execute_line(const std::string &raw_input);
     VxDbgState_t get_state() const { return running_; }
 
@@ -34,24 +47,62 @@ public:
     int cmd_continue(const std::vector<std::string>& args);
     int cmd_select(const std::vector<std::string>& args);
     int cmd_stepi(const std::vector<std::string>& args);
+    int cmd_trace(const std::vector<std::string>& args);
     int cmd_inject(const std::vector<std::string>& args);
     int cmd_reg(const std::vector<std::string>& args);
     int cmd_mem(const std::vector<std::string>& args);
+    int cmd_load(const std::vector<std::string>& args);
     int cmd_dmreg(const std::vector<std::string>& args);
     int cmd_break(const std::vector<std::string>& args);
     int cmd_gdbserver(const std::vector<std::string>& args);
     int cmd_param(const std::vector<std::string>& args);
+    int cmd_target(const std::vector<std::string>& args);
+    int cmd_stats(const std::vector<std::string>& args);
+    int cmd_profile(const std::vector<std::string>& args);
 
 private:
+    // Per-target view: runs commands against a borrowed backend (see cmd_target)
+    VortexDebugger(Backend *backend, const std::string &target_name);
+
     Logger *log_;
-    Backend *backend_;
+    Backend *backend_;                  // Backend of the selected target
     VxDbgState_t running_ = STOPPED;
 
+    // Target registry (empty in per-target views)
+    struct Target_t {
+        std::string name;
+        Backend *backend;
+        VortexDebugger *view;           // Executes broadcast commands on this target
+    };
+    std::vector<Target_t> targets_;
+    size_t curr_target_ = 0;
+    bool is_view_ = false;
+
+    void register_commands();
+    int find_target(const std::string &name) const;
+    int broadcast_command(const std::vector<std::string> &cmd_toks);
+    int serve_gdb_all(int base_port, bool background);
+
+    // GDB servers running in the background (gdbserver --bg)
+    struct BgServer_t {
+        std::string target_name;
+        int port;
+        GDBStub *stub;
+        std::thread thread;
+    };
+    std::vector<BgServer_t> bg_servers_;
+    int start_bg_gdbserver(size_t target_idx, Backend *backend, int port);
+    void stop_bg_gdbservers();
+
+    // PC sampling profiler of the last 'profile start' (samples its own thread)
+    Profiler *profiler_ = nullptr;
+
     // Helper function to register commands and aliases
     void register_command(const std::string& primary_name, 
                          const std::vector<std::string>& aliases,
                          const std::string& description,
-                         CommandHandler_t handler);
+                         CommandHandler_t handler,
+                         bool locks_backend = true);
 
     
     // prompt generation
@@ -64,6 +115,7 @@ private:
     struct Command_t {
         std::string description;
         CommandHandler_t handler;
+        bool locks_backend;     // Hold Backend::cmd_mutex() while running
     };
     std::map<std::string, Command_t> command_;
     std::map<std::string, std::string> alias_map_;